@@ -2,6 +2,7 @@
 
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "platform.hpp"
 #include "sodium_array.hpp"
@@ -65,6 +66,12 @@ uc32 blind15_factor(ustring_view server_pk);
 /// id can be 05-prefixed (33 bytes) or unprefixed (32 bytes).
 uc32 blind25_factor(ustring_view session_id, ustring_view server_pk);
 
+/// Returns the blinding factors for 25 blinding of many session ids (each 32 or 33 bytes, as in
+/// `blind25_factor`) with the same server pubkey.  This is equivalent to calling `blind25_factor`
+/// on each session id, but faster as the underlying hashes are computed together.
+std::vector<uc32> blind25_factors(
+        const std::vector<ustring_view>& session_ids, ustring_view server_pk);
+
 /// Computes the two possible 15-blinded ids from a session id and server pubkey.  Values accepted
 /// and returned are hex-encoded.
 std::array<std::string, 2> blind15_id(std::string_view session_id, std::string_view server_pk);
@@ -85,6 +92,12 @@ std::string blind25_id(std::string_view session_id, std::string_view server_pk);
 /// be passed unprefixed (i.e. 32 bytes instead of 33 with the 05 prefix).
 ustring blind25_id(ustring_view session_id, ustring_view server_pk);
 
+/// Same as above, but computes the 25-blinded ids of many session ids at once (for instance, for
+/// looking up all of a user's contacts on a community server).  Returns the 33-byte blinded ids
+/// in the same order as `session_ids`.  Throws if any of the session ids are invalid.
+std::vector<ustring> blind25_ids(
+        const std::vector<ustring_view>& session_ids, ustring_view server_pk);
+
 /// Computes the 15-blinded id from a 32-byte Ed25519 pubkey, i.e. from the known underlying Ed25519
 /// pubkey behind a (X25519) Session ID.  Unlike blind15_id, knowing the true Ed25519 pubkey allows
 /// thie method to compute the correct sign and so using this does not require considering that the
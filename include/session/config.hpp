@@ -65,6 +65,39 @@ struct config_parse_error : config_error {
 struct config_value_error : config_parse_error {
     using config_parse_error::config_parse_error;
 };
+/// Type thrown (or passed to the error handler) for a delta config message whose base message is
+/// not available, and so cannot be applied.
+struct missing_delta_base : config_error {
+    using config_error::config_error;
+};
+
+/// Approximate breakdown of the memory held by a config or keys object, as returned by
+/// `ConfigBase::memory_usage()` and `groups::Keys::memory_usage()`.  All values are in bytes, and
+/// are estimates: they count the objects, strings, container nodes and buffers being held, but not
+/// memory allocator overhead.
+struct MemoryUsage {
+    /// The live config data, including unknown top-level keys that are preserved as-is.
+    size_t data = 0;
+    /// The diff of the current config message, plus the lagged diffs of earlier messages that are
+    /// carried along for conflict resolution.
+    size_t diffs = 0;
+    /// State held for changes that have not been pushed (or confirmed) yet: for a dirty config,
+    /// the copy of the data from before the changes that is used to compute the next diff; for
+    /// keys, the pending key and key message.
+    size_t pending = 0;
+    /// Message hashes: the current message hash, obsolete hashes waiting to be returned from
+    /// `push()`, delta chain hashes, and the cache of already-merged hashes; for keys, the hashes
+    /// of the active key messages.
+    size_t hashes = 0;
+    /// Encryption, decryption and signing keys, and key material derived from them.
+    size_t keys = 0;
+    /// Everything else: the objects themselves (and their fixed-size members), and any indexes
+    /// that are kept on top of the config data.
+    size_t other = 0;
+
+    /// Returns the sum of all the above.
+    size_t total() const { return data + diffs + pending + hashes + keys + other; }
+};
 
 /// Class for a parsed, read-only config message; also serves as the base class of a
 /// MutableConfigMessage which allows setting values.
@@ -100,6 +133,10 @@ class ConfigMessage {
     // config, or there were multiple but one of them referenced all the others).
     int unmerged_ = -1;
 
+    // If this message was reconstructed from a delta message (see `delta_chain()`) then this holds
+    // the indices of the input configs it was reconstructed from.
+    std::vector<int> delta_chain_;
+
   public:
     constexpr static int DEFAULT_DIFF_LAGS = 5;
 
@@ -122,7 +159,8 @@ class ConfigMessage {
     virtual ~ConfigMessage() = default;
 
     /// Initializes a config message by parsing a serialized message.  Throws on any error.  See the
-    /// vector version below for argument descriptions.
+    /// vector version below for argument descriptions.  A delta message cannot be loaded on its own
+    /// (as it requires its base message), and throws a `missing_delta_base` exception.
     explicit ConfigMessage(
             ustring_view serialized,
             verify_callable verifier = nullptr,
@@ -211,6 +249,17 @@ class ConfigMessage {
     /// data), this will return -1.
     int unmerged_index() const { return unmerged_; }
 
+    /// If the config we used (see `unmerged_index()`) was a delta message then this contains the
+    /// indices of the input configs it was reconstructed from: the full message that starts the
+    /// chain, followed by any intermediate delta messages, in order.  Those messages must not be
+    /// deleted while this message is current, as they are required to reconstruct it.  Empty if we
+    /// merged, or if the message we used was not a delta.
+    const std::vector<int>& delta_chain() const { return delta_chain_; }
+
+    /// Returns the number of bytes that this message's lagged diffs (i.e. the diffs of previous
+    /// messages that are carried along for conflict resolution) take up when serialized.
+    size_t lagged_diffs_bytes() const;
+
     /// Read-only access to the optional verified signature if this message contained a valid,
     /// verified signature when it was parsed.  Returns nullopt otherwise (e.g. not loaded from
     /// verification at all; loaded without a verification function; or had no signature and a
@@ -233,8 +282,22 @@ class ConfigMessage {
     /// this argument.
     virtual ustring serialize(bool enable_signing = true);
 
+    /// Same as `serialize()`, but rather than returning a copy of the serialized data this invokes
+    /// `f` with a view of it.  The view is only valid for the duration of the call.  This is used
+    /// when the serialized value is just the input to some other transformation (such as
+    /// compression and encryption when pushing) to avoid an extra copy of the data.
+    void serialize_view(const std::function<void(ustring_view)>& f, bool enable_signing = true);
+
+    /// Adds estimates of the memory used by this message (its data, diffs and, for a mutable
+    /// message, the data snapshot used to compute its diff) to `usage`.
+    virtual void add_memory_usage(MemoryUsage& usage) const;
+
   protected:
     ustring serialize_impl(const oxenc::bt_dict& diff, bool enable_signing = true);
+    void serialize_impl(
+            const oxenc::bt_dict& diff,
+            const std::function<void(ustring_view)>& f,
+            bool enable_signing = true);
 };
 
 // Constructor tag
@@ -247,6 +310,9 @@ class MutableConfigMessage : public ConfigMessage {
   protected:
     dict orig_data_{data_};
 
+    // The seqno and hash of the message this one was incremented from, if any.
+    std::optional<seqno_hash_t> delta_base_;
+
     friend class ConfigMessage;
 
   public:
@@ -334,10 +400,39 @@ class MutableConfigMessage : public ConfigMessage {
     /// pruning.
     bool prune();
 
+    /// Collapses the lagged diffs carried by this message by removing changes from older diffs
+    /// that are completely overwritten by a newer diff, that is, changes at a key that a later
+    /// lagged diff sets or removes.  Since merging always replays the lagged diffs in order (and a
+    /// removed change could only ever be followed by the overwriting one) this does not change the
+    /// result of any merge, and it keeps all the lagged diff seqnos and hashes (so that other
+    /// clients still recognize the messages they came from), but can substantially shrink the
+    /// message when consecutive changes touch the same keys.
+    ///
+    /// Returns the number of serialized bytes saved.
+    size_t collapse_lagged_diffs();
+
     /// Calculates the hash of the current message.  Can optionally be given the already-serialized
     /// value, if available; if empty/omitted, `serialize()` will be called to compute it.
     const hash_t& hash() override;
 
+    /// The seqno and hash of the message this one was derived from via `increment()`, that is, the
+    /// message that a delta produced by `serialize_delta()` applies to.  nullopt if this message
+    /// was not produced by incrementing another message (e.g. the result of a merge).
+    const std::optional<seqno_hash_t>& delta_base() const { return delta_base_; }
+
+    /// Serializes this config as a delta message, invoking `f` with a view of it (which is only
+    /// valid for the duration of the call).  A delta message carries only this message's diff and
+    /// the new values it references, along with the seqno and hash of the base message (see
+    /// `delta_base()`) and of the full message it reconstructs, which makes it much smaller than
+    /// the full message when only a few values changed in a large config.  Recipients can only
+    /// load it (via the multi-message constructor) if they also have the base message.
+    ///
+    /// Delta messages are never signed: this throws a std::logic_error if the message has a signer
+    /// or verifier, or if it has no delta base.
+    void serialize_delta(const std::function<void(ustring_view)>& f);
+
+    void add_memory_usage(MemoryUsage& usage) const override;
+
   protected:
     const hash_t& hash(ustring_view serialized);
     void increment_impl();
@@ -386,6 +481,25 @@ void verify_config_sig(
         std::optional<std::array<unsigned char, 64>>* verified_signature = nullptr,
         bool trust_signature = false);
 
+/// API: base/is_delta_message
+///
+/// Returns true if the given serialized config message is a delta message (as produced by
+/// `MutableConfigMessage::serialize_delta`) rather than a full config message.
+///
+/// A delta message has the seqno in "#", as usual, but is followed by a "%" dict containing the
+/// new values referenced by the diff in place of the "&" full data (which means clients that don't
+/// support delta messages reject it as unparseable, rather than loading it as a full config).  The
+/// diff is in "=", and ">" holds a list of the base message's seqno and hash, and the hash of the
+/// full message that applying the delta produces.
+///
+/// Inputs:
+/// - `serialized` -- the serialized config message
+///
+/// Outputs:
+/// - `bool` -- true if this looks like a delta message; false otherwise (including if it is not
+///   parseable at all).
+bool is_delta_message(ustring_view serialized);
+
 }  // namespace session::config
 
 namespace oxenc::detail {
@@ -157,6 +157,122 @@ LIBSESSION_EXPORT config_string_list* config_merge(
 /// - `bool` -- returns true if object contains updated data
 LIBSESSION_EXPORT bool config_needs_push(const config_object* conf);
 
+/// API: base/config_set_delta_snapshot_interval
+///
+/// Enables or disables delta pushes, where a push of a small change produces a message containing
+/// just the change relative to the previously stored message rather than the whole config.  A full
+/// message is pushed at least every `interval` pushes.  This should only be enabled once all
+/// clients sharing the config understand delta messages.
+///
+/// Declaration:
+/// ```cpp
+/// VOID config_set_delta_snapshot_interval(
+///     [in]   config_object*      conf,
+///     [in]   int                 interval
+/// );
+/// ```
+///
+/// Inputs:
+/// - `conf` -- [in] Pointer to config_object object
+/// - `interval` -- [in] the maximum delta chain length; 0 or 1 disables delta pushes (the default).
+LIBSESSION_EXPORT void config_set_delta_snapshot_interval(config_object* conf, int interval);
+
+/// API: base/config_needs_full_message
+///
+/// Returns true if the most recent config_merge() was given delta messages whose base message is
+/// not available.  The caller should re-fetch all currently stored messages for the config and
+/// merge them.
+///
+/// Declaration:
+/// ```cpp
+/// BOOL config_needs_full_message(
+///     [in]   const config_object*      conf
+/// );
+/// ```
+///
+/// Inputs:
+/// - `conf` -- [in] Pointer to config_object object
+///
+/// Outputs:
+/// - `bool` -- returns true if a delta message could not be applied by the last merge
+LIBSESSION_EXPORT bool config_needs_full_message(const config_object* conf);
+
+/// API: base/config_set_lagged_diff_budget
+///
+/// Sets a size budget for the lagged diffs that each pushed message carries for conflict
+/// resolution: when exceeded, changes in older lagged diffs that are overwritten by newer ones are
+/// removed.  This does not affect merging, and messages remain readable by older clients.
+///
+/// Declaration:
+/// ```cpp
+/// VOID config_set_lagged_diff_budget(
+///     [in]   config_object*      conf,
+///     [in]   size_t              bytes
+/// );
+/// ```
+///
+/// Inputs:
+/// - `conf` -- [in] Pointer to config_object object
+/// - `bytes` -- [in] the lagged diff size above which diffs get collapsed; 0 (the default)
+///   disables collapsing.
+LIBSESSION_EXPORT void config_set_lagged_diff_budget(config_object* conf, size_t bytes);
+
+/// API: base/config_last_push_size
+///
+/// Retrieves the sizes of the message produced by the most recent config_push() call.  All values
+/// are 0 if nothing has been pushed yet.
+///
+/// Declaration:
+/// ```cpp
+/// VOID config_last_push_size(
+///     [in]   const config_object*      conf,
+///     [out]  size_t*                   serialized,
+///     [out]  size_t*                   lagged_diffs,
+///     [out]  size_t*                   pushed
+/// );
+/// ```
+///
+/// Inputs:
+/// - `conf` -- [in] Pointer to config_object object
+/// - `serialized` -- [out] if not NULL, set to the size of the serialized message before
+///   compression
+/// - `lagged_diffs` -- [out] if not NULL, set to how much of the serialized size was taken up by
+///   the lagged diffs of earlier messages
+/// - `pushed` -- [out] if not NULL, set to the size of the final, encrypted message
+LIBSESSION_EXPORT void config_last_push_size(
+        const config_object* conf, size_t* serialized, size_t* lagged_diffs, size_t* pushed);
+
+/// Estimated memory usage of a config object, in bytes; see `config_memory_usage()`.
+typedef struct config_memory_usage {
+    size_t data;     // live config data
+    size_t diffs;    // current message diff and lagged diffs of earlier messages
+    size_t pending;  // state held for changes not yet pushed or confirmed
+    size_t hashes;   // current, obsolete, delta chain and already-merged message hashes
+    size_t keys;     // encryption, decryption and signing keys and derived key material
+    size_t other;    // everything else (the objects themselves and any indexes)
+    size_t total;    // the sum of all of the above
+} config_memory_usage;
+
+/// API: base/config_get_memory_usage
+///
+/// Retrieves an estimate of the memory held by a config object, broken down by what it is used
+/// for.  This is cheap enough to call periodically, e.g. to decide which idle config objects to
+/// dump and free when memory is tight.
+///
+/// Declaration:
+/// ```cpp
+/// VOID config_get_memory_usage(
+///     [in]   const config_object*      conf,
+///     [out]  config_memory_usage*      usage
+/// );
+/// ```
+///
+/// Inputs:
+/// - `conf` -- [in] Pointer to config_object object
+/// - `usage` -- [out] the struct to fill with the memory usage estimates
+LIBSESSION_EXPORT void config_get_memory_usage(
+        const config_object* conf, config_memory_usage* usage);
+
 /// Returned struct of config push data.
 typedef struct config_push_data {
     // The config seqno (to be provided later in `config_confirm_pushed`).
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cassert>
+#include <deque>
 #include <memory>
 #include <session/config.hpp>
 #include <session/util.hpp>
@@ -134,6 +135,16 @@ class ConfigSig {
     void clear_sig_keys();
 };
 
+/// Sizes of a message produced by `ConfigBase::push()`.
+struct PushSize {
+    /// Size of the serialized config message, before compression.
+    size_t serialized = 0;
+    /// How much of `serialized` was taken up by the lagged diffs of earlier messages.
+    size_t lagged_diffs = 0;
+    /// Size of the final (compressed, padded and encrypted) message.
+    size_t pushed = 0;
+};
+
 /// Base config type for client-side configs containing common functionality needed by all config
 /// sub-types.
 class ConfigBase : public ConfigSig {
@@ -165,6 +176,64 @@ class ConfigBase : public ConfigSig {
     // these are returned (and cleared) when `push` is called.
     std::unordered_set<std::string> _old_hashes;
 
+    // Hashes of messages that have already been successfully merged, so that merging them again
+    // (e.g. because the client re-polled and got the same messages back) can be skipped before
+    // doing any unwrapping, decryption or parsing.  This is bounded to the most recent
+    // `SEEN_HASHES_MAX` hashes: `_seen_hashes_order` holds them in the order they were added (for
+    // eviction) and `_seen_hashes` is the lookup index.
+    static constexpr size_t SEEN_HASHES_MAX = 250;
+    std::deque<std::string> _seen_hashes_order;
+    std::unordered_set<std::string> _seen_hashes;
+
+    // Hashes of the messages that the current config depends on through delta messages (see
+    // `set_delta_snapshot_interval()`): the full message at the start of the chain, followed by
+    // the delta messages up to (but not including) the current message.  These are never returned
+    // as obsolete until the chain is replaced by a new full message.
+    std::vector<std::string> _delta_chain;
+
+    // When dirty, the hash of the (clean) message our current config was incremented from, which
+    // is the base of a delta push.  Empty if not known, or if the current config wasn't produced
+    // by incrementing a pushed message.
+    std::string _delta_base_hash;
+
+    // The maximum number of messages in a delta chain; 0 (the default) disables delta pushes.
+    int _delta_snapshot_interval = 0;
+
+    // Set if the last merge included delta messages whose base we don't have.
+    bool _needs_full_message = false;
+
+    // Lagged diff size (in bytes) above which we collapse the lagged diffs of new messages; 0
+    // disables collapsing.
+    size_t _lagged_diff_budget = 0;
+
+    // Sizes of the last pushed message.
+    PushSize _last_push_size;
+
+    // Number of times `dirty()` has been called (i.e. local modifications) over the lifetime of
+    // this object.
+    uint64_t _edit_count = 0;
+
+    // Incremented whenever the config data may have changed, either from a local modification or
+    // from merging.
+    uint64_t _data_version = 0;
+
+    // Adds hashes to the seen hashes cache, evicting the oldest ones if necessary.
+    void remember_merged(const std::vector<std::string>& hashes);
+
+    // The body of `merge()` (protobuf unwrapping, then `_merge()`) for messages that are not
+    // already in the seen hashes cache.
+    std::vector<std::string> merge_unseen(
+            const std::vector<std::pair<std::string, ustring_view>>& configs);
+
+    // Cached key material for unwrapping protobuf-wrapped messages (see `accepts_protobuf()`): the
+    // 32-byte seed the values were derived from, followed by the derived Ed25519 pubkey, X25519
+    // pubkey, and X25519 secret key.  Computed on first use, and recomputed if the encryption key
+    // (i.e. `_keys.front()`) changes.
+    sodium_array<unsigned char> _unwrap_keys;
+
+    // Returns `_unwrap_keys`, (re)computing it if needed.  Must not be called with empty `_keys`.
+    const sodium_array<unsigned char>& unwrap_keys();
+
   protected:
     // Constructs a base config by loading the data from a dump as produced by `dump()`.  If the
     // dump is nullopt then an empty base config is constructed with no config settings and seqno
@@ -894,6 +963,18 @@ class ConfigBase : public ConfigSig {
     /// message is performed; if successful then the unwrapped raw value is used; if the protobuf
     /// unwrapping fails, the value is used directly as a raw value.
     ///
+    /// Messages whose hashes have already been successfully merged (we remember a bounded number of
+    /// recent hashes, and persist them in the dump), or that match our current message hash, are
+    /// skipped without being decrypted or parsed, but are still included in the returned list of
+    /// hashes just as they would have been if they were processed again.  Such messages are not
+    /// skipped, however, when they might be needed as the base of a delta message: that is, when
+    /// `needs_full_message()` is set, or when one of the new messages is a delta that can't be
+    /// applied without them.
+    ///
+    /// Delta messages (see `set_delta_snapshot_interval()`) are applied to the message they are
+    /// based on, which must be either the current config or one of the given messages.  Deltas
+    /// that can't be applied are left out of the returned hashes, and set `needs_full_message()`.
+    ///
     /// After this call the caller should check `needs_push()` to see if the data on hand was
     /// updated and needs to be pushed to the server again (for example, because the data contained
     /// conflicts that required another update to resolve).
@@ -989,7 +1070,8 @@ class ConfigBase : public ConfigSig {
     /// API: base/ConfigBase::current_hashes
     ///
     /// The current config hash(es); this can be empty if the current hash is unknown or the current
-    /// state is not clean (i.e. a push is needed or pending).
+    /// state is not clean (i.e. a push is needed or pending).  If the current config was pushed as
+    /// a delta message then this also includes the hashes of the messages it depends on.
     ///
     /// Inputs: None
     ///
@@ -997,6 +1079,135 @@ class ConfigBase : public ConfigSig {
     /// - `std::vector<std::string>` -- Returns current config hashes
     std::vector<std::string> current_hashes() const;
 
+    /// API: base/ConfigBase::set_delta_snapshot_interval
+    ///
+    /// Enables or disables delta pushes.  When enabled, a push of changes made on top of a message
+    /// that is already stored on the server produces a delta message that contains only the
+    /// changed values and a reference to that message, rather than the entire config, which
+    /// substantially reduces the push size for small changes to large configs.  A full message is
+    /// pushed instead when the delta chain (the full message it starts from, plus the deltas
+    /// following it) would exceed `interval` messages, i.e. at least every `interval` pushes, or
+    /// when the change can't be expressed as a delta (e.g. after a merge).
+    ///
+    /// The messages a delta depends on are not returned as obsolete by `push()` until a full
+    /// message replaces them, and are included in `current_hashes()`.
+    ///
+    /// This should only be enabled once all clients that share this config understand delta
+    /// messages: older clients cannot parse them.  Delta messages are never used for configs with
+    /// signatures.
+    ///
+    /// Inputs:
+    /// - `interval` -- the maximum delta chain length, including the full message at the start of
+    ///   the chain.  0 or 1 disables delta pushes (the default).
+    void set_delta_snapshot_interval(int interval) { _delta_snapshot_interval = interval; }
+
+    /// API: base/ConfigBase::delta_snapshot_interval
+    ///
+    /// Returns the current delta snapshot interval (see `set_delta_snapshot_interval()`).
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `int` -- the maximum delta chain length, or 0 if delta pushes are disabled.
+    int delta_snapshot_interval() const { return _delta_snapshot_interval; }
+
+    /// API: base/ConfigBase::needs_full_message
+    ///
+    /// Returns true if the most recent `merge()` was given delta messages that could not be
+    /// applied because the message they are based on is not available (for example, because this
+    /// client has local changes, or missed the messages in between).  Such messages are not
+    /// treated as successfully parsed.  The caller should re-fetch all of the messages currently
+    /// stored for this config (which will include the full message and intermediate deltas that
+    /// the delta requires) and merge them.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `bool` -- Returns true if a delta message could not be applied by the last merge.
+    bool needs_full_message() const { return _needs_full_message; }
+
+    /// API: base/ConfigBase::set_lagged_diff_budget
+    ///
+    /// Sets a size budget for the lagged diffs (i.e. the diffs of the previous few messages, used
+    /// for conflict resolution) that each pushed message carries.  When a change is made and the
+    /// lagged diffs of the new message exceed this many bytes, changes in older diffs that are
+    /// overwritten by newer ones (e.g. the same value being updated repeatedly) are removed from
+    /// them; see `MutableConfigMessage::collapse_lagged_diffs()`.  This does not change how
+    /// messages merge, and the messages are still fully understood by older clients.
+    ///
+    /// The budget is a target rather than a hard limit: no lagged diffs are removed entirely, as
+    /// clients rely on them to recognize (and not re-merge) the recent messages they come from.
+    ///
+    /// When delta pushes are enabled (see `set_delta_snapshot_interval()`), a change that collapses
+    /// any lagged diffs is always pushed as a full message, as recipients of a delta could not
+    /// reproduce the collapsed message from its base.
+    ///
+    /// Inputs:
+    /// - `bytes` -- the lagged diff size above which diffs get collapsed; 0 (the default) disables
+    ///   collapsing.
+    void set_lagged_diff_budget(size_t bytes) { _lagged_diff_budget = bytes; }
+
+    /// API: base/ConfigBase::lagged_diff_budget
+    ///
+    /// Returns the current lagged diff budget (see `set_lagged_diff_budget()`).
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `size_t` -- the budget, in bytes, or 0 if disabled.
+    size_t lagged_diff_budget() const { return _lagged_diff_budget; }
+
+    /// API: base/ConfigBase::last_push_size
+    ///
+    /// Returns the sizes of the message produced by the most recent `push()` call, including how
+    /// many bytes were overhead from lagged diffs.  (These are also logged at debug level).  All
+    /// values are zero if `push()` has not been called.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `PushSize` -- the sizes of the last pushed message.
+    const PushSize& last_push_size() const { return _last_push_size; }
+
+    /// API: base/ConfigBase::edit_count
+    ///
+    /// Returns a counter of local modifications made to this object since it was constructed.
+    /// The value itself is not meaningful (and is not preserved in dumps); it is intended for
+    /// callers that need to detect whether edits have been made since they last checked, such as
+    /// `PushScheduler`.  Changes resulting from merging config messages are not counted.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `uint64_t` -- the number of local modifications made so far.
+    uint64_t edit_count() const { return _edit_count; }
+
+    /// API: base/ConfigBase::data_version
+    ///
+    /// Returns a counter that changes whenever the config data may have changed, whether from a
+    /// local modification or from merging config messages.  Like `edit_count()`, the value itself
+    /// is not meaningful (and is not preserved in dumps); it is intended for caches derived from
+    /// the config data, which are still valid as long as this value has not changed.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `uint64_t` -- the current data version.
+    uint64_t data_version() const { return _data_version; }
+
+    /// API: base/ConfigBase::memory_usage
+    ///
+    /// Returns an estimate of the memory held by this config object, broken down by what it is
+    /// used for (see `MemoryUsage`).  This walks the config data (but does no serialization or
+    /// other expensive work), so is cheap enough to call periodically, for instance to decide which
+    /// idle config objects to dump and destroy when memory is tight.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `MemoryUsage` -- the estimated memory usage.
+    virtual MemoryUsage memory_usage() const;
+
     /// API: base/ConfigBase::needs_push
     ///
     /// Returns true if this object contains updated data that has not yet been confirmed stored on
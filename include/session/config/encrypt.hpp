@@ -1,6 +1,8 @@
 #pragma once
 
+#include <optional>
 #include <stdexcept>
+#include <vector>
 
 #include "../types.hpp"
 
@@ -81,6 +83,25 @@ ustring decrypt(ustring_view ciphertext, ustring_view key_base, std::string_view
 /// - `domain` -- short string for the keyed hash
 void decrypt_inplace(ustring& ciphertext, ustring_view key_base, std::string_view domain);
 
+/// API: encrypt/decrypt_multi
+///
+/// Decrypts multiple values produced by `encrypt()` using the same `key_base` and `domain`.  This
+/// is equivalent to calling `decrypt()` on each value, but derives the per-message decryption
+/// keys together, which is considerably faster when there are many values.
+///
+/// Inputs:
+/// - `ciphertexts` -- messages to decrypt
+/// - `key_base` -- Fixed key that all clients, must be 32 bytes.
+/// - `domain` -- short string for the keyed hash
+///
+/// Outputs:
+/// - `std::vector<std::optional<ustring>>` -- the decrypted values, in the same order as
+///   `ciphertexts`, with std::nullopt for any value that failed to decrypt.
+std::vector<std::optional<ustring>> decrypt_multi(
+        const std::vector<ustring_view>& ciphertexts,
+        ustring_view key_base,
+        std::string_view domain);
+
 /// Returns the target size of the message with padding, assuming an additional `overhead` bytes of
 /// overhead (e.g. from encrypt() overhead) will be appended.  Will always return a value >= s +
 /// overhead.
@@ -107,4 +128,21 @@ inline constexpr size_t padded_size(size_t s, size_t overhead = ENCRYPT_DATA_OVE
 /// default, if omitted, is the space used by the `encrypt()` function defined above.
 void pad_message(ustring& data, size_t overhead = ENCRYPT_DATA_OVERHEAD);
 
+/// API: encrypt/encrypt_padded
+///
+/// Pads and encrypts a message in one step.  The result is identical to copying `data` and then
+/// calling `pad_message()` and `encrypt_inplace()` on the copy, but is built with a single
+/// allocation of the final size: the data is copied directly to its padded position and then
+/// encrypted in place, rather than being shifted to insert the padding and reallocated to append
+/// the encryption overhead.
+///
+/// Inputs:
+/// - `data` -- the message to pad and encrypt
+/// - `key_base` -- Fixed key that all clients, must be 32 bytes.
+/// - `domain` -- short string for the keyed hash
+///
+/// Outputs:
+/// - `ustring` -- the padded, encrypted message bytes
+ustring encrypt_padded(ustring_view data, ustring_view key_base, std::string_view domain);
+
 }  // namespace session::config
@@ -15,7 +15,10 @@ typedef struct config_group_keys {
     void* internals;
 
     // When an error occurs in the C API this string will be set to the specific error message.  May
-    // be empty.
+    // be empty.  Errors from concurrent calls on the same object are written one at a time, but if
+    // multiple threads use the object at once this may hold the error from another thread's call;
+    // callers that need the error of a specific call must not make other calls until they have
+    // read it.
     const char* last_error;
 
     // Sometimes used as the backing buffer for `last_error`.  Should not be touched externally.
@@ -246,6 +249,40 @@ LIBSESSION_EXPORT bool groups_keys_load_message(
         config_object* info,
         config_object* members) LIBSESSION_WARN_UNUSED;
 
+/// API: groups/groups_keys_load_messages
+///
+/// Loads many key config messages at once (for instance, all the historical key messages when
+/// joining an existing group).  This has the same result as calling `groups_keys_load_message` on
+/// each of them, but verifies the messages' signatures as a batch, skips decrypting messages whose
+/// keys would be immediately expired, and updates the info/member configs just once.
+///
+/// Invalid messages are skipped (and left out of the returned list) rather than failing the whole
+/// call.
+///
+/// Inputs:
+/// - `conf` -- [in] Pointer to the config object
+/// - `msg_hashes` -- [in] array of null-terminated C strings containing the message hashes
+/// - `msgs` -- [in] array of pointers to the incoming key config messages
+/// - `lengths` -- [in] array of the lengths of the messages
+/// - `timestamps_ms` -- [in] array of the timestamps (from the swarm) of the messages
+/// - `count` -- [in] the length of the four arrays
+/// - `info` -- [in] the info config object to update with newly discovered keys
+/// - `members` -- [in] the members config object to update with newly discovered keys
+///
+/// Outputs:
+/// - `config_string_list*` -- pointer to the list of hashes of the valid messages, or NULL on
+///   error (and sets `conf->last_error`).  The returned pointer belongs to the caller and must be
+///   free()d when done.
+LIBSESSION_EXPORT config_string_list* groups_keys_load_messages(
+        config_group_keys* conf,
+        const char** msg_hashes,
+        const unsigned char** msgs,
+        const size_t* lengths,
+        const int64_t* timestamps_ms,
+        size_t count,
+        config_object* info,
+        config_object* members) LIBSESSION_WARN_UNUSED;
+
 /// API: groups/groups_keys_current_hashes
 ///
 /// Returns the hashes of currently active keys messages, that is, messages that have a decryption
@@ -289,6 +326,17 @@ LIBSESSION_EXPORT bool groups_keys_needs_rekey(const config_group_keys* conf)
 /// - `bool` -- `true` if a dump is needed, `false` otherwise.
 LIBSESSION_EXPORT bool groups_keys_needs_dump(const config_group_keys* conf) LIBSESSION_WARN_UNUSED;
 
+/// API: groups/groups_keys_memory_usage
+///
+/// Retrieves an estimate of the memory held by a keys object, in the same form as
+/// `config_get_memory_usage()`.
+///
+/// Inputs:
+/// - `conf` -- [in] Pointer to the keys config object
+/// - `usage` -- [out] the struct to fill with the memory usage estimates
+LIBSESSION_EXPORT void groups_keys_memory_usage(
+        const config_group_keys* conf, config_memory_usage* usage);
+
 /// API: groups/groups_keys_dump
 ///
 /// Produces a dump of the keys object state to be stored by the application to later restore the
@@ -443,6 +491,41 @@ LIBSESSION_EXPORT bool groups_keys_swarm_verify_subaccount_flags(
         bool write,
         bool del);
 
+/// API: groups/groups_keys_swarm_verify_subaccount_requests
+///
+/// Verifies the subaccount authentication values of many requests to a group swarm at once (as a
+/// storage server would need to do).  Each request is valid if its subaccount token has (at least)
+/// read permission plus any required write/delete permission, is signed by the group, and the
+/// request data is signed by the token's blinded pubkey.  Repeated tokens are only verified once
+/// and signatures are verified in batches, making this much faster than verifying one at a time.
+///
+/// Inputs:
+/// - note that this function does not take a config object.
+/// - `group_id` -- the group id/pubkey, in hex, beginning with "03".
+/// - `subaccounts` -- array of `count` pointers to 36-byte subaccount tokens.
+/// - `subaccount_sigs` -- array of `count` pointers to 64-byte admin subaccount signatures.
+/// - `msgs` -- array of `count` pointers to the signed request data.
+/// - `msg_lens` -- array of `count` lengths of the `msgs` values.
+/// - `signatures` -- array of `count` pointers to 64-byte request signatures.
+/// - `count` -- the number of requests.
+/// - `write`, `del` -- if true, require write or delete permissions, respectively.
+/// - `valid` -- [out] array of `count` bools that will be set to whether each request is valid.
+///
+/// Outputs:
+/// - the number of valid requests (i.e. `count` if all are valid).  Returns 0 (and sets all of
+///   `valid` to false) if `group_id` is invalid.
+LIBSESSION_EXPORT size_t groups_keys_swarm_verify_subaccount_requests(
+        const char* group_id,
+        const unsigned char* const* subaccounts,
+        const unsigned char* const* subaccount_sigs,
+        const unsigned char* const* msgs,
+        const size_t* msg_lens,
+        const unsigned char* const* signatures,
+        size_t count,
+        bool write,
+        bool del,
+        bool* valid);
+
 /// API: groups/groups_keys_swarm_subaccount_sign
 ///
 /// This helper function generates the required signature for swarm subaccount authentication,
@@ -511,6 +594,89 @@ LIBSESSION_EXPORT bool groups_keys_swarm_subaccount_sign_binary(
         unsigned char* subaccount_sig,
         unsigned char* signature);
 
+typedef struct groups_keys_swarm_signer {
+    void* _internals;
+} groups_keys_swarm_signer;
+
+/// API: groups/groups_keys_swarm_signer_new
+///
+/// Constructs a reusable subaccount signing context for a group from a subaccount signing value.
+/// All the request-independent parts of a subaccount signature are computed once, here, making
+/// subsequent signing with `groups_keys_swarm_signer_sign` much cheaper than repeated calls to
+/// `groups_keys_swarm_subaccount_sign`.  The returned object does not reference `conf`, and must be
+/// freed with `groups_keys_swarm_signer_free` when no longer needed.
+///
+/// Inputs:
+/// - `conf` -- the keys config object
+/// - `signing_value` -- the 100-byte subaccount signing value, as produced by an admin's
+///   `swarm_make_subaccount` and provided to this member.
+///
+/// Outputs:
+/// - pointer to the new signer, or NULL if the signer could not be created (in which case an error
+///   is set in `conf`).
+LIBSESSION_EXPORT groups_keys_swarm_signer* groups_keys_swarm_signer_new(
+        config_group_keys* conf, const unsigned char* signing_value);
+
+/// API: groups/groups_keys_swarm_signer_free
+///
+/// Frees a signer created by `groups_keys_swarm_signer_new`.
+///
+/// Inputs:
+/// - `signer` -- the signer to free
+LIBSESSION_EXPORT void groups_keys_swarm_signer_free(groups_keys_swarm_signer* signer);
+
+/// API: groups/groups_keys_swarm_signer_sign
+///
+/// Signs one or more storage server request payloads for subaccount authentication.  The
+/// `subaccount` and `subaccount_sig` values are the same for every payload and so are written only
+/// once; a separate signature is written for each payload.
+///
+/// Inputs:
+/// - `signer` -- the signer
+/// - `msgs` -- array of `count` pointers to the payloads to sign
+/// - `msg_lens` -- array of `count` lengths of the `msgs` payloads
+/// - `count` -- the number of payloads to sign
+/// - `subaccount` -- [out] buffer of *at least* 49 bytes where the null-terminated, base64-encoded
+///   subaccount value will be written (see `groups_keys_swarm_subaccount_sign`).
+/// - `subaccount_sig` -- [out] buffer of *at least* 89 bytes where the null-terminated,
+///   base64-encoded subaccount signature will be written.
+/// - `signatures` -- [out] buffer of *at least* `89*count` bytes; the null-terminated,
+///   base64-encoded signature of `msgs[i]` is written starting at `signatures + 89*i`.
+///
+/// Outputs:
+/// - true if the values were written, false on error.
+LIBSESSION_EXPORT bool groups_keys_swarm_signer_sign(
+        const groups_keys_swarm_signer* signer,
+        const unsigned char* const* msgs,
+        const size_t* msg_lens,
+        size_t count,
+
+        char* subaccount,
+        char* subaccount_sig,
+        char* signatures);
+
+/// API: groups/groups_keys_swarm_signer_sign_binary
+///
+/// Does exactly the same as groups_keys_swarm_signer_sign except that the values are written in
+/// binary without null termination: `subaccount` and `subaccount_sig` must have room for 36 and 64
+/// bytes, respectively, and `signatures` must have room for `64*count` bytes (with the signature of
+/// `msgs[i]` written starting at `signatures + 64*i`).
+///
+/// Inputs:
+/// - see groups_keys_swarm_signer_sign
+///
+/// Outputs:
+/// - true if the values were written, false on error.
+LIBSESSION_EXPORT bool groups_keys_swarm_signer_sign_binary(
+        const groups_keys_swarm_signer* signer,
+        const unsigned char* const* msgs,
+        const size_t* msg_lens,
+        size_t count,
+
+        unsigned char* subaccount,
+        unsigned char* subaccount_sig,
+        unsigned char* signatures);
+
 /// API: groups/groups_keys_swarm_subaccount_token
 ///
 /// Constructs the subaccount token for a session id.  The main use of this is to submit a swarm
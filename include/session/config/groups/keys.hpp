@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <memory>
+#include <shared_mutex>
 #include <unordered_set>
 
 #include "../../config.hpp"
@@ -71,6 +72,16 @@ using namespace std::literals;
 ///   - the decryption key is calculated by the member using `bA' || A' || B`
 /// - A new key and nonce is created from a 56-byte H(M0 || M1 || ... || Mn || g || S,
 ///   key="SessionGroupKeyGen"), where S = H(group_seed, key="SessionGroupKeySeed").
+///
+/// Thread safety: the key list is internally guarded by a reader/writer lock, so any number of
+/// threads may call `decrypt_message`, `encrypt_message` (and the other const methods) while
+/// another thread loads key messages or calls `rekey`.  Note, however, that the methods returning
+/// views into the key data (`group_keys`, `group_enc_key`, `pending_key`, `pending_config`, and
+/// the value returned by `rekey`) cannot be protected this way: those views are invalidated by key
+/// updates, so should only be used from the thread doing the updates (or with external locking).
+/// Updating methods (e.g. `load_key_message`, `rekey`, `load_admin_key`) should not themselves
+/// be called concurrently with each other.  Because of the lock, Keys objects can be neither
+/// copied nor moved.
 
 class Keys : public ConfigSig {
 
@@ -103,6 +114,11 @@ class Keys : public ConfigSig {
 
     bool needs_dump_ = false;
 
+    /// Guards `keys_`, `active_msgs_`, the pending key values, and `needs_dump_`: methods that only
+    /// read these take a shared lock, and methods that modify them take an exclusive lock.  The
+    /// `*_impl` methods and the other private methods expect the caller to hold the lock.
+    mutable std::shared_mutex mutex_;
+
     ConfigMessage::verify_callable verifier_;
     ConfigMessage::sign_callable signer_;
 
@@ -117,8 +133,45 @@ class Keys : public ConfigSig {
     // Loads existing state from a previous dump of keys data
     void load_dump(ustring_view dump);
 
-    // Inserts a key into the correct place in `keys_`.
-    void insert_key(std::string_view message_hash, key_info&& key);
+    // Implementations of group_keys(), group_enc_key(), and make_dump(), without locking.
+    std::vector<ustring_view> group_keys_impl() const;
+    ustring_view group_enc_key_impl() const;
+    ustring make_dump_impl() const;
+
+    // Returns the number of keys at the beginning of `keys_` that have expired and would be
+    // dropped by `remove_expired()`.
+    size_t expired_count() const;
+
+    // Inserts a key into the correct place in `keys_`.  If `prune` is false then expired keys are
+    // not removed (the caller must call `remove_expired()` itself).
+    void insert_key(std::string_view message_hash, key_info&& key, bool prune = true);
+
+    // The keys we were able to decrypt from a key message; if we didn't find any then `max_gen`
+    // is set to the generation the message should be associated with.
+    struct parsed_key_message {
+        sodium_vector<key_info> keys;
+        std::optional<int64_t> max_gen;
+    };
+
+    // Parses and decrypts a key message, throwing on invalid data.  If `verify` is false then the
+    // signature is assumed to have already been verified.
+    parsed_key_message parse_key_message(ustring_view data, int64_t timestamp_ms, bool verify);
+
+    // Applies a parsed key message to our key list (but not to Info/Members).  Returns true if the
+    // message contained keys for us.
+    bool apply_key_message(std::string_view hash, parsed_key_message&& msg, bool prune);
+
+    // Returns the bt-encoded list of all our current keys, as included (encrypted for each member)
+    // in supplemental key messages.
+    std::string supplement_keys() const;
+
+    // Builds and signs a supplemental key message giving `supp_keys` to the given session IDs,
+    // encrypting for the members using up to `threads` threads (0 = hardware concurrency).
+    ustring make_key_supplement(
+            std::string_view supp_keys,
+            std::vector<std::string>::const_iterator sids_begin,
+            std::vector<std::string>::const_iterator sids_end,
+            unsigned threads) const;
 
     // Returned the blinding factor for a given session X25519 pubkey.  This depends on the group's
     // seed and thus is only obtainable by an admin account.
@@ -346,13 +399,42 @@ class Keys : public ConfigSig {
         return key_supplement(std::vector{{std::move(sid)}});
     }
 
+    /// API: groups/Keys::key_supplements
+    ///
+    /// Generates supplemental key messages for a potentially large number of session IDs, such as
+    /// when inviting many members at once.  This works like `key_supplement`, except that the
+    /// members are split across as many messages as needed to keep each message within `max_size`
+    /// bytes, the keys list is only encoded once, and the per-member encryption (which requires an
+    /// X25519 key derivation for each member) of large member lists is done on multiple threads.
+    ///
+    /// Each returned message is independent (a member only needs the one that includes them); all
+    /// of them should be pushed to the swarm.  Only admins can call this.
+    ///
+    /// Inputs:
+    /// - `sids` -- session IDs (in hex) of the members to generate supplemental keys for.
+    /// - `max_size` -- the maximum size of each generated message; defaults to the maximum size
+    ///   accepted by the storage server.
+    /// - `threads` -- the maximum number of threads to use for encryption; 0 (the default) uses
+    ///   the hardware concurrency.  Small member lists are always encrypted on the calling thread.
+    ///
+    /// Outputs:
+    /// - `std::vector<ustring>` containing the messages to be pushed to the swarm (empty if `sids`
+    ///   is empty).  Throws if `max_size` is too small to hold even a single member.
+    std::vector<ustring> key_supplements(
+            const std::vector<std::string>& sids,
+            size_t max_size = MAX_MESSAGE_SIZE,
+            unsigned threads = 0) const;
+
     /// API: groups/current_generation
     ///
     /// Returns the current generation number for the latest keys message.
     ///
     /// Oututs:
     /// - `int` -- latest keys generation number.
-    int current_generation() const { return keys_.empty() ? 0 : keys_.back().generation; }
+    int current_generation() const {
+        std::shared_lock lock{mutex_};
+        return keys_.empty() ? 0 : keys_.back().generation;
+    }
 
     /// API: groups/Keys::swarm_make_subaccount
     ///
@@ -422,6 +504,50 @@ class Keys : public ConfigSig {
     bool swarm_verify_subaccount(
             ustring_view signing_value, bool write = false, bool del = false) const;
 
+    /// API: groups/Keys::swarm_subaccount_request
+    ///
+    /// The subaccount authentication values of a single storage server request, as would be
+    /// produced by `swarm_subaccount_sign` (with `binary` set to true), plus the signed request
+    /// data.  Used for bulk request validation via `swarm_verify_subaccount_requests`.
+    ///
+    /// Members:
+    /// - `subaccount` -- the 36-byte subaccount token (flags || blinded pubkey).
+    /// - `subaccount_sig` -- the 64-byte admin signature of `subaccount`.
+    /// - `msg` -- the signed request data.
+    /// - `signature` -- the 64-byte request signature by the subaccount's blinded pubkey.
+    struct swarm_subaccount_request {
+        ustring_view subaccount;
+        ustring_view subaccount_sig;
+        ustring_view msg;
+        ustring_view signature;
+    };
+
+    /// API: groups/Keys::swarm_verify_subaccount_requests
+    ///
+    /// Verifies the subaccount authentication of many requests to a group swarm at once, such as
+    /// a storage server (or test harness) would need to do: for each request this checks that the
+    /// subaccount token has the required permissions, that it is signed by the group (i.e. issued
+    /// by an admin), and that the request itself is signed by the token's blinded pubkey.
+    ///
+    /// This is considerably faster than verifying requests individually: identical subaccount
+    /// tokens (as are typical when one member makes many requests) have their group signature
+    /// checked only once, and the signatures are verified using batch Ed25519 verification.
+    ///
+    /// Inputs:
+    /// - `group_id` -- the group id/pubkey, in hex, beginning with "03".
+    /// - `requests` -- the requests to verify.
+    /// - `write` -- if true, require that the subaccounts have write permission.
+    /// - `del` -- if true, require that the subaccounts have delete permission.
+    ///
+    /// Outputs:
+    /// - vector of the same length as `requests` containing true for each request that is validly
+    ///   signed (with the required permissions) and false for each that is not.
+    static std::vector<bool> swarm_verify_subaccount_requests(
+            std::string_view group_id,
+            const std::vector<swarm_subaccount_request>& requests,
+            bool write = false,
+            bool del = false);
+
     /// API: groups/Keys::swarm_auth
     ///
     /// This struct containing the storage server authentication values for subaccount
@@ -470,6 +596,108 @@ class Keys : public ConfigSig {
     swarm_auth swarm_subaccount_sign(
             ustring_view msg, ustring_view signing_value, bool binary = false) const;
 
+    /// API: groups/Keys::subaccount_signer
+    ///
+    /// Reusable subaccount signing context.  Everything in a subaccount signature that does not
+    /// depend on the request being signed (the blinded token and its derived private scalar, the
+    /// nonce hash seed, and the base64 encodings of the token and admin signature) is computed once
+    /// on construction, so that subsequent signatures cost only the per-request hashing and
+    /// a single scalar multiplication.  Clients making frequent requests to a group swarm should
+    /// construct one of these per group (via Keys::swarm_subaccount_signer) and keep it around.
+    ///
+    /// Signatures produced are identical to those produced by `Keys::swarm_subaccount_sign`.
+    ///
+    /// The object holds its own copy of the required secret values (it does not reference the Keys
+    /// object that created it), and is safe to use concurrently from multiple threads.
+    class subaccount_signer {
+        std::string token_, token_b64_;
+        std::string sub_sig_, sub_sig_b64_;
+        std::array<unsigned char, 32> kT_;
+        sodium_cleared<std::array<unsigned char, 32>> kt_;
+        // H32(seed, key="SubaccountSeed") || kT, the fixed prefix of the nonce hash input:
+        sodium_cleared<std::array<unsigned char, 64>> r_prefix_;
+
+        void sign_into(ustring_view msg, const unsigned char* r_hash, unsigned char* sig) const;
+        swarm_auth make_auth(bool binary) const;
+
+      public:
+        /// API: groups/Keys::subaccount_signer::subaccount_signer
+        ///
+        /// Constructs a signing context from a user's Ed25519 secret key and a subaccount signing
+        /// value.  Usually you want `Keys::swarm_subaccount_signer` instead, which supplies the
+        /// user's secret key from the Keys object.
+        ///
+        /// Inputs:
+        /// - `user_ed25519_sk` -- the user's 64-byte Ed25519 secret key.
+        /// - `signing_value` -- the 100-byte subaccount signing value, as produced by an admin's
+        ///   `swarm_make_subaccount` and provided to this member.
+        ///
+        /// Throws std::logic_error if either value is the wrong size, or std::runtime_error if the
+        /// blinded key cannot be computed.
+        subaccount_signer(ustring_view user_ed25519_sk, ustring_view signing_value);
+
+        /// API: groups/Keys::subaccount_signer::sign
+        ///
+        /// Signs a single request payload.
+        ///
+        /// Inputs:
+        /// - `msg` -- the data to be signed; see `Keys::swarm_subaccount_sign`.
+        /// - `binary` -- if true return raw values rather than base64-encoded ones.
+        ///
+        /// Outputs:
+        /// - the swarm authentication values for the request; see Keys::swarm_auth.
+        swarm_auth sign(ustring_view msg, bool binary = false) const;
+
+        /// API: groups/Keys::subaccount_signer::sign_multi
+        ///
+        /// Signs multiple request payloads at once, such as for the subrequests of a batched
+        /// storage server request.  The per-request nonce hashes are computed together, which is
+        /// considerably faster than signing each payload separately.
+        ///
+        /// Inputs:
+        /// - `msgs` -- the data values to be signed.
+        /// - `binary` -- if true return raw values rather than base64-encoded ones.
+        ///
+        /// Outputs:
+        /// - vector of swarm authentication values, one per element of `msgs`, in the same order.
+        std::vector<swarm_auth> sign_multi(
+                const std::vector<ustring_view>& msgs, bool binary = false) const;
+
+        /// API: groups/Keys::subaccount_signer::subaccount
+        ///
+        /// Returns the subaccount token value that accompanies each signature made by this signer.
+        ///
+        /// Inputs:
+        /// - `binary` -- if true return the raw 36-byte value rather than the base64-encoded one.
+        const std::string& subaccount(bool binary = false) const {
+            return binary ? token_ : token_b64_;
+        }
+
+        /// API: groups/Keys::subaccount_signer::subaccount_sig
+        ///
+        /// Returns the admin subaccount signature that accompanies each signature made by this
+        /// signer.
+        ///
+        /// Inputs:
+        /// - `binary` -- if true return the raw 64-byte value rather than the base64-encoded one.
+        const std::string& subaccount_sig(bool binary = false) const {
+            return binary ? sub_sig_ : sub_sig_b64_;
+        }
+    };
+
+    /// API: groups/Keys::swarm_subaccount_signer
+    ///
+    /// Constructs a reusable subaccount signing context for this group using this member's keys and
+    /// the given signing value.  See Keys::subaccount_signer.
+    ///
+    /// Inputs:
+    /// - `signing_value` -- the 100-byte subaccount signing value, as produced by an admin's
+    ///   `swarm_make_subaccount` and provided to this member.
+    ///
+    /// Outputs:
+    /// - the signing context.  Throws on invalid input (see `swarm_subaccount_sign`).
+    subaccount_signer swarm_subaccount_signer(ustring_view signing_value) const;
+
     /// API: groups/Keys::swarm_subaccount_token
     ///
     /// Constructs the subaccount token for a session id.  The main use of this is to submit a swarm
@@ -561,6 +789,42 @@ class Keys : public ConfigSig {
             Info& info,
             Members& members);
 
+    /// Historical key message to load via `load_key_messages`.
+    struct key_message {
+        std::string_view hash;
+        ustring_view data;
+        int64_t timestamp_ms;
+    };
+
+    /// API: groups/Keys::load_key_messages
+    ///
+    /// Loads many key messages at once, as is required by a member newly joining an existing
+    /// group (or a client catching up after a long time offline).  The end result is the same as
+    /// calling `load_key_message` on each message (in any order), but this is considerably more
+    /// efficient for more than a few messages:
+    /// - the signatures of all the messages are verified together as a batch;
+    /// - messages are processed from the newest generation to the oldest, and messages whose keys
+    ///   would be immediately expired by the newer keys already found are skipped without being
+    ///   decrypted;
+    /// - expired keys are pruned, and the keys of `info` and `members` are updated, just once at
+    ///   the end.
+    ///
+    /// Unlike `load_key_message`, invalid messages (including ones with bad signatures) do not
+    /// throw: they are skipped, and left out of the returned list of message hashes.
+    ///
+    /// Inputs:
+    /// - `messages` - the key messages (hash, data, and swarm timestamp) to load, in any order.
+    /// - `info` - the given group::Info object's en/decryption key list will be updated to match
+    ///   this object's key list.
+    /// - `members` - the given group::Members object's en/decryption key list will be updated to
+    ///   match this object's key list.
+    ///
+    /// Outputs:
+    /// - the hashes of the messages that were valid (whether or not they contained keys for us, and
+    ///   including messages that were skipped because their keys have expired).
+    std::vector<std::string> load_key_messages(
+            const std::vector<key_message>& messages, Info& info, Members& members);
+
     /// API: groups/Keys::current_hashes
     ///
     /// Returns a set of message hashes of messages that contain currently active decryption keys.
@@ -612,6 +876,20 @@ class Keys : public ConfigSig {
     ///   call to `dump()`.
     bool needs_dump() const;
 
+    /// API: groups/Keys::memory_usage
+    ///
+    /// Returns an estimate of the memory held by this keys object, in the same form as
+    /// `ConfigBase::memory_usage()`: the decryption keys (plus our own and any admin secret keys)
+    /// in `keys`, the hashes of the active key messages in `hashes`, and the buffer of the most
+    /// recent rekey message in `pending` (which is retained after the rekey is confirmed, until
+    /// the next rekey reuses it).  This is cheap enough to call periodically.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `MemoryUsage` -- the estimated memory usage.
+    MemoryUsage memory_usage() const;
+
     /// API: groups/Keys::dump
     ///
     /// Returns a dump of the current state of this keys config that allows the Keys object to be
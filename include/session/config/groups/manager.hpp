@@ -0,0 +1,355 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "../../sodium_array.hpp"
+#include "info.hpp"
+#include "keys.hpp"
+#include "members.hpp"
+
+namespace session::config::groups {
+
+/// The dumps of a group's config objects, as produced by `Info::dump()`, `Members::dump()`, and
+/// `Keys::dump()`.  An empty value means there is no dump for that object (i.e. it should be
+/// constructed from scratch).
+struct group_dumps {
+    ustring info;
+    ustring members;
+    ustring keys;
+
+    /// Returns the combined size of the dumps, in bytes.
+    size_t size() const { return info.size() + members.size() + keys.size(); }
+};
+
+/// The resident config objects of a single group, as handed out by `GroupManager::get()`.
+struct group_state {
+    Info info;
+    Members members;
+    Keys keys;
+
+    group_state(
+            ustring_view user_ed25519_secretkey,
+            ustring_view group_ed25519_pubkey,
+            std::optional<ustring_view> group_ed25519_secretkey,
+            const group_dumps& dumps);
+
+    /// Returns true if any of the three objects has state that has not been dumped yet.
+    bool needs_dump() const;
+
+    /// Returns the combined estimated memory usage of the three objects.
+    size_t memory_usage() const;
+};
+
+/// Holds the `Info`/`Members`/`Keys` objects of all of a user's groups, keeping only recently used
+/// groups resident in memory.  Groups that have not been used recently are "hibernated": they are
+/// dumped and destroyed, leaving only their dump bytes behind, and are transparently restored from
+/// those dumps the next time they are accessed through `get()` or `for_each()`.
+///
+/// Which groups are hibernated is governed by a memory budget: whenever a group is restored, the
+/// least recently used resident groups are hibernated until the estimated memory usage of the
+/// resident groups (see `ConfigBase::memory_usage()`) fits in the budget.  Since the memory usage
+/// of a resident group also grows as it is modified or merged into, callers may also call
+/// `enforce_budget()` periodically, and can hibernate groups explicitly with `hibernate()` or
+/// `hibernate_idle()`.  The group being accessed is never hibernated, so a budget that is too small
+/// for even a single group simply keeps one group resident at a time.
+///
+/// Before hibernating a group with un-dumped changes the dump callback (if set) is invoked with the
+/// group's fresh dumps so that they can be persisted; the dumps themselves include any pending or
+/// unconfirmed pushes, so nothing is lost by hibernating a group in the middle of a push.  Note,
+/// however, that hibernating destroys the group's objects: references returned by `get()` (and
+/// passed to `for_each()` callbacks) are only valid until the next call to a manager method that
+/// may hibernate groups, i.e. any non-const method.
+///
+/// Only the dumped state of the objects survives hibernation: runtime settings such as the
+/// `ConfigBase::logger`, `set_delta_snapshot_interval()`, or `set_lagged_diff_budget()` are not
+/// part of a dump, so are back at their defaults in the restored objects.  Callers using such
+/// settings should apply them from a restore callback (see `set_restore_callback()`), which is
+/// invoked every time a group's objects are constructed.
+///
+/// This class is not thread-safe: callers must serialize access to it (and to the objects it
+/// returns) themselves.
+class GroupManager {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    /// Callback invoked with a group's id and its current dumps before a group with un-dumped
+    /// changes is hibernated.
+    using dump_callback = std::function<void(std::string_view group_id, const group_dumps& dumps)>;
+
+    /// Callback invoked with a group's id and its freshly constructed (or restored) config objects,
+    /// before they are handed out.
+    using restore_callback = std::function<void(std::string_view group_id, group_state& state)>;
+
+    /// API: groups/GroupManager::GroupManager
+    ///
+    /// Constructs an empty group manager.
+    ///
+    /// Inputs:
+    /// - `user_ed25519_secretkey` -- the 64-byte ed25519 secret key of the user, used to construct
+    ///   the groups' `Keys` objects.
+    /// - `memory_budget` -- the maximum estimated memory, in bytes, of the resident groups; 0 (the
+    ///   default) means unlimited, in which case groups are only hibernated on request.
+    GroupManager(ustring_view user_ed25519_secretkey, size_t memory_budget = 0);
+
+    /// API: groups/GroupManager::add
+    ///
+    /// Adds a group to the manager.  The group is not restored (or constructed) until it is first
+    /// accessed, so adding all of a user's groups at startup is cheap.
+    ///
+    /// Inputs:
+    /// - `group_id` -- the group id: 66 hex digits beginning with "03".
+    /// - `group_ed25519_secretkey` -- the 64-byte group secret key, for admins; std::nullopt for
+    ///   regular members.
+    /// - `dumps` -- the previously stored dumps of the group's config objects, if any.
+    ///
+    /// Outputs:
+    /// - `bool` -- true if the group was added, false if a group with this id already exists (in
+    ///   which case nothing is changed).
+    ///
+    /// Throws std::invalid_argument if the group id or secret key are invalid.
+    bool add(
+            std::string_view group_id,
+            std::optional<ustring_view> group_ed25519_secretkey = std::nullopt,
+            group_dumps dumps = {});
+
+    /// API: groups/GroupManager::remove
+    ///
+    /// Removes a group (resident or not) from the manager, without dumping it.
+    ///
+    /// Inputs:
+    /// - `group_id` -- the group id.
+    ///
+    /// Outputs:
+    /// - `bool` -- true if the group was removed, false if it was not known.
+    bool remove(std::string_view group_id);
+
+    /// API: groups/GroupManager::contains
+    ///
+    /// Returns true if a group with the given id has been added.
+    ///
+    /// Inputs:
+    /// - `group_id` -- the group id.
+    ///
+    /// Outputs:
+    /// - `bool` -- true if the group is known (whether or not it is resident).
+    bool contains(std::string_view group_id) const;
+
+    /// API: groups/GroupManager::is_resident
+    ///
+    /// Returns true if the given group's config objects are currently in memory.
+    ///
+    /// Inputs:
+    /// - `group_id` -- the group id.
+    ///
+    /// Outputs:
+    /// - `bool` -- true if the group is known and resident, false otherwise.
+    bool is_resident(std::string_view group_id) const;
+
+    /// API: groups/GroupManager::size
+    ///
+    /// Returns the number of groups in the manager.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `size_t` -- the number of groups, resident or not.
+    size_t size() const { return _groups.size(); }
+
+    /// API: groups/GroupManager::resident_count
+    ///
+    /// Returns the number of groups whose config objects are currently in memory.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `size_t` -- the number of resident groups.
+    size_t resident_count() const;
+
+    /// API: groups/GroupManager::get
+    ///
+    /// Returns the config objects of a group, restoring it from its dumps first if it is
+    /// hibernated (or constructing it, if it has never been accessed), and marks it as most
+    /// recently used.  If the group had to be restored, other groups may be hibernated to get back
+    /// under the memory budget.
+    ///
+    /// Inputs:
+    /// - `group_id` -- the group id.
+    ///
+    /// Outputs:
+    /// - `group_state&` -- the group's config objects; valid until the next non-const call on the
+    ///   manager.
+    ///
+    /// Throws std::out_of_range if the group is not known.
+    group_state& get(std::string_view group_id);
+
+    /// API: groups/GroupManager::for_each
+    ///
+    /// Calls `f(group_id, state)` for every group, in group id order, restoring each group as
+    /// needed.  Since each group is restored in turn, other groups may be hibernated during
+    /// iteration; the `state` reference passed to `f` must not be retained after `f` returns.
+    ///
+    /// Inputs:
+    /// - `f` -- callable invoked as `f(const std::string& group_id, group_state& state)`.
+    template <typename F>
+    void for_each(F&& f) {
+        for (auto& [id, g] : _groups)
+            f(id, access(id, g));
+    }
+
+    /// API: groups/GroupManager::hibernate
+    ///
+    /// Hibernates a group: if it has un-dumped changes the dump callback is invoked with its
+    /// current dumps, then the config objects are destroyed and only the dumps are kept.  Does
+    /// nothing if the group is already hibernated.
+    ///
+    /// Inputs:
+    /// - `group_id` -- the group id.
+    ///
+    /// Outputs:
+    /// - `bool` -- true if the group was resident and has been hibernated, false otherwise.
+    bool hibernate(std::string_view group_id);
+
+    /// API: groups/GroupManager::hibernate_idle
+    ///
+    /// Hibernates every resident group that has not been accessed for at least `idle`.
+    ///
+    /// Inputs:
+    /// - `idle` -- the minimum time since a group's last access for it to be hibernated.
+    /// - `now` -- the current time; this is only intended to be overridden for testing.
+    ///
+    /// Outputs:
+    /// - `size_t` -- the number of groups hibernated.
+    size_t hibernate_idle(clock::duration idle, clock::time_point now = clock::now());
+
+    /// API: groups/GroupManager::enforce_budget
+    ///
+    /// Hibernates the least recently used resident groups until the estimated memory usage of the
+    /// resident groups fits in the memory budget.  This happens automatically whenever a group is
+    /// restored, but not as resident groups grow through edits and merges, so callers should also
+    /// call this periodically (e.g. after processing a batch of incoming messages).
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `size_t` -- the number of groups hibernated.
+    size_t enforce_budget() { return enforce_budget(nullptr); }
+
+    /// API: groups/GroupManager::memory_budget
+    ///
+    /// Returns the memory budget.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `size_t` -- the memory budget, in bytes; 0 means unlimited.
+    size_t memory_budget() const { return _memory_budget; }
+
+    /// API: groups/GroupManager::set_memory_budget
+    ///
+    /// Changes the memory budget, hibernating groups as needed to fit in the new budget.
+    ///
+    /// Inputs:
+    /// - `budget` -- the new memory budget, in bytes; 0 means unlimited.
+    void set_memory_budget(size_t budget);
+
+    /// API: groups/GroupManager::set_dump_callback
+    ///
+    /// Sets (or, if given an empty function, clears) the callback invoked to persist a group's
+    /// dumps before it is hibernated.  Without a callback, un-dumped changes are still kept in the
+    /// manager's copy of the dumps, but the caller must retrieve them with `dumps()` to persist
+    /// them.
+    ///
+    /// Inputs:
+    /// - `callback` -- the callback.
+    void set_dump_callback(dump_callback callback) { _dump_callback = std::move(callback); }
+
+    /// API: groups/GroupManager::set_restore_callback
+    ///
+    /// Sets (or, if given an empty function, clears) the callback invoked whenever a group's
+    /// config objects are constructed, i.e. on first access and every time a hibernated group is
+    /// restored.  This is the place to apply per-object settings that are not saved in dumps, such
+    /// as loggers, delta snapshot intervals, or lagged diff budgets.  If the callback throws, the
+    /// group stays hibernated and the exception propagates to the caller of `get()`/`for_each()`.
+    ///
+    /// Inputs:
+    /// - `callback` -- the callback.
+    void set_restore_callback(restore_callback callback) {
+        _restore_callback = std::move(callback);
+    }
+
+    /// API: groups/GroupManager::dumps
+    ///
+    /// Returns the current dumps of a group, e.g. to persist them.  For a resident group this
+    /// dumps (and so resets the `needs_dump()` flags of) its config objects; for a hibernated
+    /// group it returns the dumps that were kept when it was hibernated.
+    ///
+    /// Inputs:
+    /// - `group_id` -- the group id.
+    ///
+    /// Outputs:
+    /// - `group_dumps` -- the group's dumps.
+    ///
+    /// Throws std::out_of_range if the group is not known.
+    group_dumps dumps(std::string_view group_id);
+
+    /// API: groups/GroupManager::resident_memory
+    ///
+    /// Returns the estimated memory usage of the resident groups' config objects.  This walks the
+    /// data of every resident group, so is not free; see `ConfigBase::memory_usage()`.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `size_t` -- the estimated memory usage, in bytes.
+    size_t resident_memory() const;
+
+    /// API: groups/GroupManager::hibernated_memory
+    ///
+    /// Returns the memory held by the dumps of the hibernated groups.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `size_t` -- the size of the dumps, in bytes.
+    size_t hibernated_memory() const;
+
+  private:
+    struct entry {
+        // The group's ed25519 pubkey, and secret key if we are an admin (empty if not).
+        std::array<unsigned char, 32> pubkey;
+        sodium_array<unsigned char> secretkey;
+        // The dumps to restore from; only meaningful (and cleared) while the group isn't resident.
+        group_dumps dumps;
+        // The resident objects, if resident.
+        std::unique_ptr<group_state> state;
+        // Access counter value and time of the last access.
+        uint64_t last_used = 0;
+        clock::time_point last_access;
+    };
+
+    sodium_array<unsigned char> _user_sk;
+    size_t _memory_budget;
+    dump_callback _dump_callback;
+    restore_callback _restore_callback;
+    std::map<std::string, entry, std::less<>> _groups;
+    uint64_t _access_counter = 0;
+
+    // Restores the group (if needed), marks it as used, and enforces the budget if it was restored.
+    group_state& access(const std::string& group_id, entry& g);
+
+    // Hibernates a resident group.
+    void hibernate(const std::string& group_id, entry& g);
+
+    // Hibernates least recently used groups (other than `keep`) to get back under budget.
+    size_t enforce_budget(const entry* keep);
+};
+
+}  // namespace session::config::groups
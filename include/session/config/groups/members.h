@@ -11,6 +11,21 @@ extern "C" {
 enum groups_members_invite_status { INVITE_SENT = 1, INVITE_FAILED = 2, INVITE_NOT_SENT = 3 };
 enum groups_members_remove_status { REMOVED_MEMBER = 1, REMOVED_MEMBER_AND_MESSAGES = 2 };
 
+// Member statuses that can be counted and queried with `groups_members_status_count()` and
+// `groups_members_with_status()`.  A member can have more than one of these at once.
+typedef enum GROUP_MEMBER_STATUS {
+    GROUP_MEMBER_STATUS_INVITE_PENDING = 0,         // invite not sent, sent, or failed
+    GROUP_MEMBER_STATUS_INVITE_NOT_SENT = 1,        // invited == INVITE_NOT_SENT
+    GROUP_MEMBER_STATUS_INVITE_SENT = 2,            // invited == INVITE_SENT
+    GROUP_MEMBER_STATUS_INVITE_FAILED = 3,          // invited == INVITE_FAILED
+    GROUP_MEMBER_STATUS_PROMOTION_PENDING = 4,      // promotion not sent, sent, or failed
+    GROUP_MEMBER_STATUS_PROMOTION_NOT_SENT = 5,     // admin && promoted == INVITE_NOT_SENT
+    GROUP_MEMBER_STATUS_PROMOTION_SENT = 6,         // admin && promoted == INVITE_SENT
+    GROUP_MEMBER_STATUS_PROMOTION_FAILED = 7,       // admin && promoted == INVITE_FAILED
+    GROUP_MEMBER_STATUS_REMOVED = 8,                // removed (with or without messages)
+    GROUP_MEMBER_STATUS_REMOVED_WITH_MESSAGES = 9,  // removed == REMOVED_MEMBER_AND_MESSAGES
+} GROUP_MEMBER_STATUS;
+
 typedef struct config_group_member {
     char session_id[67];  // in hex; 66 hex chars + null terminator.
 
@@ -137,6 +152,45 @@ LIBSESSION_EXPORT bool groups_members_erase(config_object* conf, const char* ses
 /// - `size_t` -- number of contacts
 LIBSESSION_EXPORT size_t groups_members_size(const config_object* conf);
 
+/// API: groups/groups_members_status_count
+///
+/// Returns the number of group members with the given status (for example, the number of members
+/// with pending invites).  This is answered from a maintained index and does not require loading
+/// all the members.
+///
+/// Inputs:
+/// - `conf` -- [in] Pointer to the config object
+/// - `status` -- [in] the member status to count
+///
+/// Outputs:
+/// - `size_t` -- number of members with the status; 0 if `status` is invalid.
+LIBSESSION_EXPORT size_t
+groups_members_status_count(const config_object* conf, GROUP_MEMBER_STATUS status);
+
+/// API: groups/groups_members_with_status
+///
+/// Loads a page of the group members with the given status into a caller-provided array, in
+/// sorted session ID order (the same order used by the member iterator).  To page through all of
+/// them, call this with increasing `offset` values until fewer than `max` members are returned
+/// (or until reaching the total given by `groups_members_status_count()`).
+///
+/// Inputs:
+/// - `conf` -- [in] Pointer to the config object
+/// - `status` -- [in] the member status to look up
+/// - `offset` -- [in] the number of matching members to skip
+/// - `members` -- [out] array of at least `max` members to fill
+/// - `max` -- [in] the maximum number of members to load into `members`
+///
+/// Outputs:
+/// - `size_t` -- the number of members written into `members`; 0 if there are no (more) matching
+///   members or if `status` is invalid.
+LIBSESSION_EXPORT size_t groups_members_with_status(
+        const config_object* conf,
+        GROUP_MEMBER_STATUS status,
+        size_t offset,
+        config_group_member* members,
+        size_t max);
+
 typedef struct groups_members_iterator {
     void* _internals;
 } groups_members_iterator;
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <limits>
 #include <memory>
 #include <session/config.hpp>
 
+#include "../../fields.hpp"
 #include "../base.hpp"
 #include "../namespaces.hpp"
 #include "../profile_pic.hpp"
@@ -44,6 +47,23 @@ using namespace std::literals;
 constexpr int INVITE_SENT = 1, INVITE_FAILED = 2, INVITE_NOT_SENT = 3;
 constexpr int REMOVED_MEMBER = 1, REMOVED_MEMBER_AND_MESSAGES = 2;
 
+/// Member statuses for which `Members` maintains an index, for use with `Members::status_count()`
+/// and `Members::with_status()`.  Each value corresponds to the `member` method (or status value)
+/// of the same name; a member will often be in more than one of these (e.g. a member with a failed
+/// invite is in both `invite_pending` and `invite_failed`).
+enum class member_status {
+    invite_pending = 0,         // `member::invite_pending()`
+    invite_not_sent = 1,        // `member::invite_not_sent()`
+    invite_sent = 2,            // invite_status == INVITE_SENT
+    invite_failed = 3,          // `member::invite_failed()`
+    promotion_pending = 4,      // `member::promotion_pending()`
+    promotion_not_sent = 5,     // `member::promotion_not_sent()`
+    promotion_sent = 6,         // admin && promotion_status == INVITE_SENT
+    promotion_failed = 7,       // `member::promotion_failed()`
+    removed = 8,                // `member::is_removed()`
+    removed_with_messages = 9,  // `member::should_remove_messages()`
+};
+
 /// Struct containing member details
 struct member {
     static constexpr size_t MAX_NAME_LENGTH = 100;
@@ -457,6 +477,51 @@ class Members : public ConfigBase {
     /// - `size_t` - number of members
     size_t size() const;
 
+    /// API: groups/Members::status_count
+    ///
+    /// Returns the number of members with the given status, such as the number of members with
+    /// pending invites.  This is answered from an index of member statuses that is kept up to date
+    /// by `set()` and `erase()` (and rebuilt when needed after merging), and so does not require
+    /// loading every member.
+    ///
+    /// Inputs:
+    /// - `status` -- the member status to count.
+    ///
+    /// Outputs:
+    /// - `size_t` - the number of members with the given status.
+    size_t status_count(member_status status) const;
+
+    /// API: groups/Members::with_status
+    ///
+    /// Returns a page of the members with the given status, in the same (sorted by session ID)
+    /// order used when iterating.  Only the requested members are loaded, so a large group can be
+    /// displayed one page at a time by calling this with increasing `offset` values, using
+    /// `status_count()` to get the total.
+    ///
+    /// Inputs:
+    /// - `status` -- the member status to look up.
+    /// - `offset` -- the number of matching members to skip.  Defaults to 0.
+    /// - `limit` -- the maximum number of members to return.  Defaults to returning all of them.
+    ///
+    /// Outputs:
+    /// - `std::vector<member>` - the matching members; this will be empty if `offset` is not less
+    ///   than the number of members with the status.
+    std::vector<member> with_status(
+            member_status status,
+            size_t offset = 0,
+            size_t limit = std::numeric_limits<size_t>::max()) const;
+
+    /// API: groups/Members::memory_usage
+    ///
+    /// Same as `ConfigBase::memory_usage()`, but also includes the member status index (see
+    /// `status_count()`) in the `other` value.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `MemoryUsage` -- the estimated memory usage.
+    MemoryUsage memory_usage() const override;
+
     struct iterator;
     /// API: groups/Members::begin
     ///
@@ -491,6 +556,22 @@ class Members : public ConfigBase {
     /// - `iterator` - Returns an iterator for the end of the members
     iterator end() const { return iterator{nullptr}; }
 
+  private:
+    static constexpr size_t STATUS_COUNT = 10;
+
+    // Sorted session IDs of the members with each `member_status`, and the `data_version()` that
+    // the index is current for (nullopt if it has not been built yet).
+    mutable std::array<std::vector<SessionID>, STATUS_COUNT> _status_index;
+    mutable std::optional<uint64_t> _status_index_version;
+
+    // Rebuilds the status index if it isn't current.
+    void build_status_index() const;
+
+    // Updates a single member's entries in the status index; `info` is the member's data dict, or
+    // nullptr if the member has been removed.
+    void update_status_index(const SessionID& id, const dict* info) const;
+
+  public:
     using iterator_category = std::input_iterator_tag;
     using value_type = member;
     using reference = value_type&;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "namespaces.hpp"
+#include "session/identity.hpp"
 #include "session/util.hpp"
 
 namespace session::config::protos {
@@ -23,6 +24,13 @@ namespace session::config::protos {
 ustring wrap_config(
         ustring_view ed25519_sk, ustring_view data, int64_t seqno, config::Namespace ns);
 
+/// API: config/protos::wrap_config
+///
+/// Same as above, but uses the keys of a `SessionIdentity` rather than deriving them from a raw
+/// secret key.
+ustring wrap_config(
+        const SessionIdentity& id, ustring_view data, int64_t seqno, config::Namespace ns);
+
 /// API: config/protos::unwrap_config
 ///
 /// Unwraps a config message from endless layers of protobuf, extra encryption and then more
@@ -42,4 +50,47 @@ ustring wrap_config(
 /// more serious).
 ustring unwrap_config(ustring_view ed25519_sk, ustring_view data, config::Namespace ns);
 
+/// API: config/protos::unwrap_config
+///
+/// Same as above, but takes the already-derived Ed25519 pubkey and X25519 keypair rather than
+/// re-deriving them from the Ed25519 secret key on every call.  This is intended for callers (such
+/// as config objects) that unwrap many messages using the same key.
+///
+/// Inputs:
+/// - `ed25519_pk` -- the 32-byte Ed25519 pubkey of the secret key that wrapped the message
+/// - `x25519_pk` -- the 32-byte X25519 pubkey derived from the Ed25519 pubkey
+/// - `x25519_sk` -- the 32-byte X25519 secret key derived from the Ed25519 secret key
+/// - `data` -- the incoming data that might be protobuf-wrapped
+/// - `ns` -- the namespace of the config data
+///
+/// Outputs:
+///
+/// Same as above.
+ustring unwrap_config(
+        ustring_view ed25519_pk,
+        ustring_view x25519_pk,
+        ustring_view x25519_sk,
+        ustring_view data,
+        config::Namespace ns);
+
+/// API: config/protos::unwrap_config
+///
+/// Same as above, but uses the keys of a `SessionIdentity`.
+ustring unwrap_config(const SessionIdentity& id, ustring_view data, config::Namespace ns);
+
+/// API: config/protos::is_protobuf_wrapped
+///
+/// Cheaply checks whether the given data looks like a protobuf-wrapped config message (as produced
+/// by `wrap_config`) rather than a raw config message.  This only inspects the protobuf framing of
+/// the outer layers (without any allocation or crypto), and so a true return does not guarantee
+/// that `unwrap_config` will succeed, but a false return means that it certainly would not.
+///
+/// Inputs:
+/// - `data` -- the incoming data that might be protobuf-wrapped
+///
+/// Outputs:
+/// - `bool` -- true if the data has protobuf wrapping, false if it should be treated as a raw
+///   config message.  Never throws.
+bool is_protobuf_wrapped(ustring_view data) noexcept;
+
 }  // namespace session::config::protos
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
+#include "base.hpp"
+
+namespace session::config {
+
+/// Advice returned by `PushScheduler::advise()`.
+struct PushAdvice {
+    /// True if the configs in `configs` should be pushed now.
+    bool push_now = false;
+
+    /// If `push_now` is false and there are pending changes, how long the caller should wait
+    /// before calling `advise()` again.  Zero if there is nothing pending (in which case the
+    /// caller only needs to call `advise()` again after making further changes or merging).
+    std::chrono::milliseconds wait{0};
+
+    /// The configs that should be pushed now (empty if `push_now` is false).  This includes every
+    /// config with unpushed changes, not just the ones whose deadline has arrived, so that all of
+    /// an account's pending changes are sent together.
+    std::vector<ConfigBase*> configs;
+};
+
+/// Opt-in helper that coalesces rapid local edits into fewer pushes (and thus fewer seqno
+/// increments, which reduces both bandwidth and merge conflicts with other devices).
+///
+/// Each config with unpushed changes is due to be pushed once no further edits have been made to
+/// it for `debounce`, or once `max_latency` has passed since it first became dirty, whichever
+/// comes first.  Configs that became dirty without any local edits (that is, because a merge
+/// produced a new, merged config that needs to be pushed) are due immediately.  Once any config
+/// is due, every config with unpushed changes is included in the advice so that all of them are
+/// pushed at once.
+///
+/// The scheduler does not get notified of edits; instead it notices them (through
+/// `ConfigBase::edit_count()`) when `advise()` is called, so the caller should call `advise()`
+/// after making changes, after merging, and when the previously advised wait time has elapsed.
+/// Configs that have been pushed but not yet confirmed (i.e. `ConfigState::Waiting`) are
+/// considered to be in flight and are not included; if such a push fails it is up to the caller
+/// to push again.
+///
+/// The scheduler only holds pointers to the configs: they must outlive the scheduler (or be
+/// removed from it before being destroyed).
+class PushScheduler {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    /// API: push_scheduler/PushScheduler::PushScheduler
+    ///
+    /// Constructs a scheduler.
+    ///
+    /// Inputs:
+    /// - `debounce` -- how long to wait after the most recent edit to a config before pushing it.
+    /// - `max_latency` -- the maximum time to defer a push after a config first becomes dirty,
+    ///   even if edits keep being made.  If less than `debounce` then `debounce` is used instead.
+    PushScheduler(
+            std::chrono::milliseconds debounce = std::chrono::milliseconds{1000},
+            std::chrono::milliseconds max_latency = std::chrono::milliseconds{5000});
+
+    /// API: push_scheduler/PushScheduler::add
+    ///
+    /// Adds a config object to be tracked by the scheduler.  Adding an already-added config does
+    /// nothing.
+    ///
+    /// Inputs:
+    /// - `config` -- the config object; must remain valid until removed or until the scheduler is
+    ///   destroyed.
+    void add(ConfigBase& config);
+
+    /// API: push_scheduler/PushScheduler::remove
+    ///
+    /// Stops tracking a config object.
+    ///
+    /// Inputs:
+    /// - `config` -- the config object to remove.
+    ///
+    /// Outputs:
+    /// - `bool` -- true if the config was being tracked, false if not.
+    bool remove(const ConfigBase& config);
+
+    /// API: push_scheduler/PushScheduler::advise
+    ///
+    /// Examines the tracked configs and returns whether (and what) to push now or, if nothing is
+    /// due yet, how long to wait before asking again.
+    ///
+    /// Inputs:
+    /// - `now` -- the current time; this is only intended to be overridden for testing and
+    ///   simulation.
+    ///
+    /// Outputs:
+    /// - `PushAdvice` -- the push advice.
+    PushAdvice advise(clock::time_point now = clock::now());
+
+    /// API: push_scheduler/PushScheduler::debounce
+    ///
+    /// Returns the debounce time given to the constructor.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `std::chrono::milliseconds` -- the debounce time.
+    std::chrono::milliseconds debounce() const { return _debounce; }
+
+    /// API: push_scheduler/PushScheduler::max_latency
+    ///
+    /// Returns the maximum push latency (which is never less than the debounce time).
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `std::chrono::milliseconds` -- the maximum push latency.
+    std::chrono::milliseconds max_latency() const { return _max_latency; }
+
+  private:
+    struct tracked {
+        ConfigBase* config;
+        // The config's edit count when we last looked at it.
+        uint64_t edits;
+        // When we first saw the config dirty, and when we last saw its edit count change (both
+        // unset if the config wasn't dirty when we last looked).
+        std::optional<clock::time_point> dirty_since, last_edit;
+        // Set if the config became dirty without local edits (i.e. from a merge).
+        bool merged;
+    };
+
+    std::chrono::milliseconds _debounce;
+    std::chrono::milliseconds _max_latency;
+    std::vector<tracked> _configs;
+};
+
+}  // namespace session::config
@@ -91,9 +91,6 @@ struct base_group_info {
                        // joining a new closed group (after joining the group info provide the name)
 
     bool invited = false;  // True if this is currently in the invite-but-not-accepted state.
-
-  protected:
-    void load(const dict& info_dict);
 };
 
 /// Struct containing legacy group info (aka "closed groups").
@@ -95,6 +95,32 @@ LIBSESSION_EXPORT bool session_ed25519_verify(
         const unsigned char* msg,
         size_t msg_len);
 
+/// API: crypto/session_ed25519_verify_batch
+///
+/// Verifies a batch of message signatures at once; this is considerably faster than calling
+/// `session_ed25519_verify` on each one when there are more than a handful of signatures.  See
+/// the C++ `verify_batch` for details.
+///
+/// Inputs:
+/// - `sigs` -- [in] array of `count` pointers to 64-byte signatures.
+/// - `pubkeys` -- [in] array of `count` pointers to 32-byte pubkeys.
+/// - `msgs` -- [in] array of `count` pointers to the signed data.
+/// - `msg_lens` -- [in] array of `count` lengths of the `msgs` data.
+/// - `count` -- [in] the number of signatures to verify.
+/// - `valid_out` -- [out] optional pointer to an array of `count` bools which will be set to
+///   whether each signature is valid.  May be NULL if only the number of failures is needed.
+///
+/// Outputs:
+/// - The number of signatures that failed verification (0 if all are valid).  If an error occurs
+///   then `count` is returned and every element of `valid_out` is set to false.
+LIBSESSION_EXPORT size_t session_ed25519_verify_batch(
+        const unsigned char* const* sigs,
+        const unsigned char* const* pubkeys,
+        const unsigned char* const* msgs,
+        const size_t* msg_lens,
+        size_t count,
+        bool* valid_out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 
 #include "types.hpp"
 
@@ -52,4 +53,35 @@ ustring sign(ustring_view ed25519_privkey, ustring_view msg);
 /// - A flag indicating whether the signature is valid
 bool verify(ustring_view sig, ustring_view pubkey, ustring_view msg);
 
+/// API: ed25519/verify_batch
+///
+/// Verifies a batch of message signatures at once, returning the indices of any signatures that
+/// failed to verify.  This is considerably faster than calling `verify` on each signature when
+/// verifying more than a handful of signatures: the signatures are checked together via a single
+/// random linear combination (with shared multi-scalar multiplication, and with signatures from
+/// the same pubkey sharing their pubkey term).  If the combined check fails then the batch is
+/// bisected to locate the signatures that are actually invalid, with the final determination for
+/// each failing signature always made by `verify`.
+///
+/// The result for each signature agrees with `verify` except that an invalid signature whose
+/// verification residual is a non-zero small-order point could be accepted here (with
+/// probability no more than 1/2).  Producing such a signature requires the signer's secret key,
+/// so this does not permit forgeries, but callers that need bit-for-bit agreement with `verify`
+/// on adversarially constructed signatures from a key holder should use `verify` instead.
+///
+/// Inputs:
+/// - `sigs` -- the signatures to verify, 64 bytes each.
+/// - `pubkeys` -- the pubkeys for the signatures, 32 bytes each; must be the same length as
+///   `sigs`.
+/// - `msgs` -- the signed data; must be the same length as `sigs`.
+///
+/// Outputs:
+/// - The (ascending) indices of the signatures that failed verification, including any with a
+///   signature or pubkey of the wrong size.  An empty vector means every signature is valid.
+///   Throws std::invalid_argument if the three inputs are not the same length.
+std::vector<size_t> verify_batch(
+        const std::vector<ustring_view>& sigs,
+        const std::vector<ustring_view>& pubkeys,
+        const std::vector<ustring_view>& msgs);
+
 }  // namespace session::ed25519
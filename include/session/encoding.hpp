@@ -0,0 +1,175 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "types.hpp"
+
+// Hex and base64 encoding/decoding.
+//
+// These produce the same values as the equivalent oxenc functions (lower-case hex; padded,
+// standard-alphabet base64) but are considerably faster on the short values (pubkeys, session IDs,
+// signatures) that cross the API, using SIMD instructions when available (SSSE3/AVX2 on x86,
+// NEON on ARM64).  They are also constant-time with respect to the data being encoded or decoded
+// (but not its length), which makes them suitable for use on secret values.
+
+namespace session::encoding {
+
+/// API: encoding/to_hex
+///
+/// Writes the lower-case hex encoding of `size` bytes from `in` to `out`, which must have room
+/// for `2*size` characters.  (No null terminator is written).
+///
+/// Inputs:
+/// - `in` -- the bytes to encode.
+/// - `size` -- the number of bytes to encode.
+/// - `out` -- the output buffer.
+void to_hex(const unsigned char* in, size_t size, char* out);
+
+/// API: encoding/to_hex
+///
+/// Returns the lower-case hex encoding of the given bytes.
+///
+/// Inputs:
+/// - `data` -- the bytes to encode.
+///
+/// Outputs:
+/// - the hex string, twice the length of `data`.
+std::string to_hex(ustring_view data);
+
+/// API: encoding/to_hex
+///
+/// Same as above, but takes the bytes from a string_view (e.g. for binary values stored in a
+/// std::string).
+inline std::string to_hex(std::string_view data) {
+    return to_hex(ustring_view{reinterpret_cast<const unsigned char*>(data.data()), data.size()});
+}
+
+/// API: encoding/to_prefixed_hex
+///
+/// Returns the hex encoding of a one-byte prefix followed by the given bytes, such as a session ID
+/// ("05" followed by the hex X25519 pubkey) or group ID ("03" followed by the hex Ed25519 pubkey).
+///
+/// Inputs:
+/// - `prefix` -- the prefix byte, e.g. 0x05.
+/// - `data` -- the bytes to encode after the prefix.
+///
+/// Outputs:
+/// - the hex string, `2*(data.size()+1)` characters long.
+std::string to_prefixed_hex(unsigned char prefix, ustring_view data);
+
+/// API: encoding/is_hex
+///
+/// Returns true if the given string is a valid (upper- or lower-case) hex string, that is, it has
+/// an even length and contains only hex digits.
+///
+/// Inputs:
+/// - `hex` -- the string to check.
+///
+/// Outputs:
+/// - true if `hex` is valid hex, false otherwise.
+bool is_hex(std::string_view hex);
+
+/// API: encoding/from_hex
+///
+/// Decodes a hex string into `out`, which must have room for `hex.size()/2` bytes.
+///
+/// Inputs:
+/// - `hex` -- the hex string to decode; must have an even length.
+/// - `out` -- the output buffer.
+///
+/// Outputs:
+/// - true if `hex` was valid and has been decoded; false if `hex` was not a valid hex string (in
+///   which case the contents of `out` are unspecified).
+bool from_hex(std::string_view hex, unsigned char* out);
+
+/// API: encoding/from_hex
+///
+/// Decodes a hex string.
+///
+/// Inputs:
+/// - `hex` -- the hex string to decode.
+///
+/// Outputs:
+/// - the decoded bytes.  Throws std::invalid_argument if `hex` is not a valid hex string.
+ustring from_hex(std::string_view hex);
+
+/// API: encoding/base64_encoded_size
+///
+/// Returns the length of the padded base64 encoding of `size` bytes.
+constexpr size_t base64_encoded_size(size_t size) {
+    return (size + 2) / 3 * 4;
+}
+
+/// API: encoding/base64_decoded_size
+///
+/// Returns the number of bytes that the given (padded or unpadded) base64 string decodes to.  The
+/// result is unspecified if `b64` is not valid base64.
+///
+/// Inputs:
+/// - `b64` -- the base64 string
+///
+/// Outputs:
+/// - the number of decoded bytes.
+size_t base64_decoded_size(std::string_view b64);
+
+/// API: encoding/to_base64
+///
+/// Writes the padded base64 encoding of `size` bytes from `in` to `out`, which must have room for
+/// `base64_encoded_size(size)` characters.  (No null terminator is written).
+///
+/// Inputs:
+/// - `in` -- the bytes to encode.
+/// - `size` -- the number of bytes to encode.
+/// - `out` -- the output buffer.
+void to_base64(const unsigned char* in, size_t size, char* out);
+
+/// API: encoding/to_base64
+///
+/// Returns the padded base64 encoding of the given bytes.
+///
+/// Inputs:
+/// - `data` -- the bytes to encode.
+///
+/// Outputs:
+/// - the base64 string.
+std::string to_base64(ustring_view data);
+
+/// API: encoding/is_base64
+///
+/// Returns true if the given string is valid base64, with or without padding.
+///
+/// Inputs:
+/// - `b64` -- the string to check.
+///
+/// Outputs:
+/// - true if `b64` is valid base64, false otherwise.
+bool is_base64(std::string_view b64);
+
+/// API: encoding/from_base64
+///
+/// Decodes a base64 string (with or without padding) into `out`, which must have room for
+/// `base64_decoded_size(b64)` bytes.  As with oxenc, any unused bits in the final character are
+/// ignored.
+///
+/// Inputs:
+/// - `b64` -- the base64 string to decode.
+/// - `out` -- the output buffer.
+///
+/// Outputs:
+/// - true if `b64` was valid and has been decoded; false if `b64` is not valid base64 (in which
+///   case the contents of `out` are unspecified).
+bool from_base64(std::string_view b64, unsigned char* out);
+
+/// API: encoding/from_base64
+///
+/// Decodes a base64 string (with or without padding).
+///
+/// Inputs:
+/// - `b64` -- the base64 string to decode.
+///
+/// Outputs:
+/// - the decoded bytes.  Throws std::invalid_argument if `b64` is not valid base64.
+ustring from_base64(std::string_view b64);
+
+}  // namespace session::encoding
@@ -3,7 +3,12 @@
 #include <array>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <functional>
 #include <string>
+#include <string_view>
+
+#include "types.hpp"
 
 namespace session {
 
@@ -27,17 +32,68 @@ struct Disappearing {
     std::chrono::seconds timer = 0s;
 };
 
-/// A Session ID: an x25519 pubkey, with a 05 identifying prefix.  On the wire we send just the
-/// 32-byte pubkey value (i.e. not hex, without the prefix).
+/// A Session ID: an x25519 pubkey, with a 05 identifying prefix (or an ed25519 pubkey with a 03
+/// prefix, for a group ID).  On the wire we send just the 32-byte pubkey value (i.e. not hex,
+/// without the prefix).
+///
+/// This is a fixed-size value type: copying, comparing, and hashing it does not allocate, which
+/// makes it considerably cheaper than a 66-character hex string as a map key.  Ordering is by
+/// prefix, then pubkey, which is the same as the ordering of the equivalent lower-case hex strings.
 struct SessionID {
     /// The fixed session netid, 0x05
     static constexpr unsigned char netid = 0x05;
 
     /// The raw x25519 pubkey, as bytes
-    std::array<unsigned char, 32> pubkey;
+    std::array<unsigned char, 32> pubkey{};
+
+    /// The prefix byte: `netid` for a regular session ID, 0x03 for a group ID.
+    unsigned char prefix = netid;
+
+    /// Constructs a zero session ID (i.e. 05 followed by 32 null bytes).
+    SessionID() = default;
+
+    /// Constructs from a 32-byte pubkey and (optional) prefix byte.
+    SessionID(const std::array<unsigned char, 32>& pubkey, unsigned char prefix = netid) :
+            pubkey{pubkey}, prefix{prefix} {}
+
+    /// Constructs from a 66-digit hex string (e.g. "05abcd...").  Throws std::invalid_argument if
+    /// the value is not 66 hex digits.
+    explicit SessionID(std::string_view hex);
+
+    /// Constructs from the 33-byte raw value (prefix + pubkey).  Throws std::invalid_argument if
+    /// the value is not 33 bytes.
+    explicit SessionID(ustring_view raw);
 
     /// Returns the full pubkey in hex, including the netid prefix.
     std::string hex() const;
+
+    /// Returns the 33-byte raw value (prefix + pubkey), as used for config dict keys.
+    std::string raw() const;
+
+    bool operator==(const SessionID& other) const {
+        return prefix == other.prefix && pubkey == other.pubkey;
+    }
+    bool operator!=(const SessionID& other) const { return !(*this == other); }
+    bool operator<(const SessionID& other) const {
+        return prefix < other.prefix || (prefix == other.prefix && pubkey < other.pubkey);
+    }
+    bool operator<=(const SessionID& other) const { return !(other < *this); }
+    bool operator>(const SessionID& other) const { return other < *this; }
+    bool operator>=(const SessionID& other) const { return !(*this < other); }
 };
 
 }  // namespace session
+
+namespace std {
+
+// The pubkey is (effectively) random, so its leading bytes make a perfectly good hash value.
+template <>
+struct hash<session::SessionID> {
+    size_t operator()(const session::SessionID& id) const noexcept {
+        size_t h;
+        std::memcpy(&h, id.pubkey.data(), sizeof(h));
+        return h ^ id.prefix;
+    }
+};
+
+}  // namespace std
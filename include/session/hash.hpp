@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 
 #include "types.hpp"
 
@@ -20,4 +21,33 @@ namespace session::hash {
 /// - a `size` byte hash.
 ustring hash(const size_t size, ustring_view msg, std::optional<ustring_view> key = std::nullopt);
 
+/// API: hash/hash_multi
+///
+/// Computes the BLAKE2b hashes of many independent messages at once, all using the same hash size
+/// and key.  The results are identical to calling `hash` on each message, but this is
+/// considerably faster when hashing many short messages (such as when deriving per-recipient
+/// keys): the key block is only processed once for the whole batch, and on x86 CPUs with AVX2
+/// support messages of similar length are hashed four at a time.
+///
+/// Inputs:
+/// - `out` -- pointer to a buffer of at least `size * msgs.size()` bytes where the hashes will be
+///   written, in the same order as `msgs`.
+/// - `size` -- length of each hash to be generated.
+/// - `msgs` -- the messages to hash.
+/// - `key` -- an optional key to be used for every hash.  Can be omitted or an empty string for
+///   unkeyed hashes.
+void hash_multi(
+        unsigned char* out,
+        size_t size,
+        const std::vector<ustring_view>& msgs,
+        std::optional<ustring_view> key = std::nullopt);
+
+/// API: hash/hash_multi
+///
+/// Same as above, but returns the hashes as a vector of `size`-byte values.
+std::vector<ustring> hash_multi(
+        size_t size,
+        const std::vector<ustring_view>& msgs,
+        std::optional<ustring_view> key = std::nullopt);
+
 }  // namespace session::hash
@@ -0,0 +1,188 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "export.h"
+
+/// Opaque handle holding a Session user's Ed25519 keypair along with the X25519 keypair and session
+/// ID derived from it.  The `session_identity_...` encryption and decryption functions below are
+/// equivalent to the corresponding functions in session_encrypt.h, but use these values rather than
+/// re-deriving them from the raw secret key on every call.
+typedef struct session_identity session_identity;
+
+/// API: identity/session_identity_new
+///
+/// Creates a session identity from an Ed25519 secret key, deriving its other keys.
+///
+/// Inputs:
+/// - `ed25519_privkey` -- [in] the libsodium-style Ed25519 secret key (64 bytes), or its seed (32
+///   bytes).
+/// - `privkey_len` -- [in] the length of `ed25519_privkey`: 32 or 64.
+///
+/// Outputs:
+/// - `session_identity*` -- the new identity, to be freed with `session_identity_free`; NULL if
+///   the key is invalid.
+LIBSESSION_EXPORT session_identity* session_identity_new(
+        const unsigned char* ed25519_privkey, size_t privkey_len);
+
+/// API: identity/session_identity_free
+///
+/// Frees a session identity (zeroing its secret keys).
+///
+/// Inputs:
+/// - `identity` -- [in] the identity to free.
+LIBSESSION_EXPORT void session_identity_free(session_identity* identity);
+
+/// API: identity/session_identity_ed25519_pubkey
+///
+/// Retrieves the Ed25519 pubkey of a session identity.
+///
+/// Inputs:
+/// - `identity` -- [in] the identity.
+/// - `pubkey_out` -- [out] pointer to a buffer of at least 32 bytes where the pubkey is written.
+LIBSESSION_EXPORT void session_identity_ed25519_pubkey(
+        const session_identity* identity, unsigned char* pubkey_out);
+
+/// API: identity/session_identity_x25519_pubkey
+///
+/// Retrieves the X25519 pubkey of a session identity.
+///
+/// Inputs:
+/// - `identity` -- [in] the identity.
+/// - `pubkey_out` -- [out] pointer to a buffer of at least 32 bytes where the pubkey is written.
+LIBSESSION_EXPORT void session_identity_x25519_pubkey(
+        const session_identity* identity, unsigned char* pubkey_out);
+
+/// API: identity/session_identity_session_id
+///
+/// Retrieves the session ID of a session identity.
+///
+/// Inputs:
+/// - `identity` -- [in] the identity.
+/// - `session_id_out` -- [out] pointer to a buffer of at least 67 bytes where the null-terminated,
+///   hex-encoded session ID is written.
+LIBSESSION_EXPORT void session_identity_session_id(
+        const session_identity* identity, char* session_id_out);
+
+/// API: identity/session_identity_encrypt_for_recipient_deterministic
+///
+/// Same as `session_encrypt_for_recipient_deterministic`, but encrypts with the keys of a session
+/// identity.
+///
+/// Inputs:
+/// - `plaintext_in` -- [in] Pointer to a data buffer containing the data to encrypt.
+/// - `plaintext_len` -- [in] Length of `plaintext_in`
+/// - `sender` -- [in] the identity of the sender.
+/// - `recipient_pubkey` -- [in] the x25519 public key of the recipient (32 bytes).
+/// - `ciphertext_out` -- [out] Pointer-pointer to an output buffer; a new buffer is allocated, the
+///   encrypted data written to it, and then the pointer to that buffer is stored here.
+///   This buffer must be `free()`d by the caller when done with it *unless* the function returns
+///   false, in which case the buffer pointer will not be set.
+/// - `ciphertext_len` -- [out] Pointer to a size_t where the length of `ciphertext_out` is stored.
+///   Not touched if the function returns false.
+///
+/// Outputs:
+/// - `bool` -- True if the message was successfully encrypted, false if encryption failed.
+LIBSESSION_EXPORT bool session_identity_encrypt_for_recipient_deterministic(
+        const unsigned char* plaintext_in,
+        size_t plaintext_len,
+        const session_identity* sender,
+        const unsigned char* recipient_pubkey,
+        unsigned char** ciphertext_out,
+        size_t* ciphertext_len);
+
+/// API: identity/session_identity_encrypt_for_blinded_recipient
+///
+/// Same as `session_encrypt_for_blinded_recipient`, but encrypts with the keys of a session
+/// identity.
+///
+/// Inputs:
+/// - `plaintext_in` -- [in] Pointer to a data buffer containing the data to encrypt.
+/// - `plaintext_len` -- [in] Length of `plaintext_in`
+/// - `sender` -- [in] the identity of the sender.
+/// - `open_group_pubkey` -- [in] the public key of the open group server to route the blinded
+///   message through (32 bytes).
+/// - `recipient_blinded_id` -- [in] the blinded id of the recipient including the blinding prefix
+///   (33 bytes).
+/// - `ciphertext_out` -- [out] Pointer-pointer to an output buffer, as above.
+/// - `ciphertext_len` -- [out] Pointer to a size_t where the length of `ciphertext_out` is stored.
+///
+/// Outputs:
+/// - `bool` -- True if the message was successfully encrypted, false if encryption failed.
+LIBSESSION_EXPORT bool session_identity_encrypt_for_blinded_recipient(
+        const unsigned char* plaintext_in,
+        size_t plaintext_len,
+        const session_identity* sender,
+        const unsigned char* open_group_pubkey,
+        const unsigned char* recipient_blinded_id,
+        unsigned char** ciphertext_out,
+        size_t* ciphertext_len);
+
+/// API: identity/session_identity_decrypt_incoming
+///
+/// Same as `session_decrypt_incoming`, but decrypts with the keys of a session identity.
+///
+/// Inputs:
+/// - `ciphertext_in` -- [in] Pointer to a data buffer containing the encrypted data.
+/// - `ciphertext_len` -- [in] Length of `ciphertext_in`
+/// - `recipient` -- [in] the identity of the recipient.
+/// - `session_id_out` -- [out] pointer to a buffer of at least 67 bytes where the null-terminated,
+///   hex-encoded session_id of the message's author will be written if decryption/verification was
+///   successful.
+/// - `plaintext_out` -- [out] Pointer-pointer to an output buffer; a new buffer is allocated, the
+///   decrypted data written to it, and then the pointer to that buffer is stored here.
+///   This buffer must be `free()`d by the caller when done with it *unless* the function returns
+///   false, in which case the buffer pointer will not be set.
+/// - `plaintext_len` -- [out] Pointer to a size_t where the length of `plaintext_out` is stored.
+///   Not touched if the function returns false.
+///
+/// Outputs:
+/// - `bool` -- True if the message was successfully decrypted, false if decryption failed.
+LIBSESSION_EXPORT bool session_identity_decrypt_incoming(
+        const unsigned char* ciphertext_in,
+        size_t ciphertext_len,
+        const session_identity* recipient,
+        char* session_id_out,
+        unsigned char** plaintext_out,
+        size_t* plaintext_len);
+
+/// API: identity/session_identity_decrypt_for_blinded_recipient
+///
+/// Same as `session_decrypt_for_blinded_recipient`, but decrypts with the keys of a session
+/// identity.
+///
+/// Inputs:
+/// - `ciphertext_in` -- [in] Pointer to a data buffer containing the encrypted data.
+/// - `ciphertext_len` -- [in] Length of `ciphertext_in`
+/// - `receiver` -- [in] the identity of the receiver.
+/// - `open_group_pubkey` -- [in] the public key of the open group server (32 bytes).
+/// - `sender_id` -- [in] the blinded id of the sender including the blinding prefix (33 bytes).
+/// - `recipient_id` -- [in] the blinded id of the recipient including the blinding prefix (33
+///   bytes).
+/// - `session_id_out` -- [out] pointer to a buffer of at least 67 bytes where the null-terminated,
+///   hex-encoded session_id of the message's author will be written if decryption/verification was
+///   successful.
+/// - `plaintext_out` -- [out] Pointer-pointer to an output buffer, as above.
+/// - `plaintext_len` -- [out] Pointer to a size_t where the length of `plaintext_out` is stored.
+///
+/// Outputs:
+/// - `bool` -- True if the message was successfully decrypted, false if decryption failed.
+LIBSESSION_EXPORT bool session_identity_decrypt_for_blinded_recipient(
+        const unsigned char* ciphertext_in,
+        size_t ciphertext_len,
+        const session_identity* receiver,
+        const unsigned char* open_group_pubkey,
+        const unsigned char* sender_id,
+        const unsigned char* recipient_id,
+        char* session_id_out,
+        unsigned char** plaintext_out,
+        size_t* plaintext_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+
+#include "sodium_array.hpp"
+#include "types.hpp"
+#include "util.hpp"
+
+namespace session {
+
+/// Holds a Session user's Ed25519 keypair together with the X25519 keypair and session ID derived
+/// from it.  The functions in session_encrypt.hpp (and `config::protos`) that take a raw Ed25519
+/// secret key have to expand a 32-byte seed and convert the keys to X25519 on every call; the
+/// overloads taking a `SessionIdentity` use the values derived here instead, so clients that
+/// encrypt, decrypt, or sign many messages should construct this once and reuse it.
+///
+/// The secret keys are kept in libsodium-allocated memory (guarded, locked, and zeroed when the
+/// object is destroyed).  The object is movable but not copyable.
+class SessionIdentity {
+  public:
+    /// API: identity/SessionIdentity::SessionIdentity
+    ///
+    /// Derives the keys of a Session identity from its Ed25519 secret key.
+    ///
+    /// Inputs:
+    /// - `ed25519_privkey` -- the libsodium-style secret key, 64 bytes.  Can also be passed as a
+    ///   32-byte seed.
+    ///
+    /// Throws std::invalid_argument if the key is not 32 or 64 bytes, or is not a valid key.
+    explicit SessionIdentity(ustring_view ed25519_privkey);
+
+    /// API: identity/SessionIdentity::ed25519_secret
+    ///
+    /// Returns the 64-byte, libsodium-style Ed25519 secret key (the seed followed by the pubkey).
+    ustring_view ed25519_secret() const { return {secrets_.data(), 64}; }
+
+    /// API: identity/SessionIdentity::ed25519_seed
+    ///
+    /// Returns the 32-byte Ed25519 seed.
+    ustring_view ed25519_seed() const { return {secrets_.data(), 32}; }
+
+    /// API: identity/SessionIdentity::ed25519_pubkey
+    ///
+    /// Returns the 32-byte Ed25519 pubkey.
+    ustring_view ed25519_pubkey() const { return {ed_pk_.data(), ed_pk_.size()}; }
+
+    /// API: identity/SessionIdentity::x25519_secret
+    ///
+    /// Returns the 32-byte X25519 secret key converted from the Ed25519 secret key.
+    ustring_view x25519_secret() const { return {secrets_.data() + 64, 32}; }
+
+    /// API: identity/SessionIdentity::x25519_pubkey
+    ///
+    /// Returns the 32-byte X25519 pubkey converted from the Ed25519 pubkey.
+    ustring_view x25519_pubkey() const { return {x_pk_.data(), x_pk_.size()}; }
+
+    /// API: identity/SessionIdentity::session_id
+    ///
+    /// Returns the session ID: "05" followed by the hex X25519 pubkey.
+    const std::string& session_id() const { return session_id_; }
+
+  private:
+    // The Ed25519 secret key (64 bytes) followed by the X25519 secret key (32 bytes)
+    sodium_array<unsigned char> secrets_;
+    uc32 ed_pk_;
+    uc32 x_pk_;
+    std::string session_id_;
+};
+
+}  // namespace session
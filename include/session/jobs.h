@@ -0,0 +1,280 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "config/base.h"
+#include "config/groups/keys.h"
+#include "export.h"
+
+/// Opaque pool of worker threads that runs jobs; see `session_job_pool_new`.
+typedef struct session_job_pool session_job_pool;
+
+/// Opaque handle to a submitted job, used to obtain its status and results.  Must be released with
+/// `session_job_free` when no longer needed.
+typedef struct session_job session_job;
+
+typedef enum SESSION_JOB_STATUS {
+    SESSION_JOB_PENDING = 0,    // The job is queued or running.
+    SESSION_JOB_SUCCEEDED = 1,  // The job finished successfully; its results are available.
+    SESSION_JOB_FAILED = 2,     // The job failed; see `session_job_error`.
+} SESSION_JOB_STATUS;
+
+/// Callback invoked, on a worker thread, when a job finishes.  The job (whose status is no longer
+/// `SESSION_JOB_PENDING` at this point) remains owned by the caller, and is still valid even if
+/// `session_job_free` has already been called on it; its results may be taken from within the
+/// callback.  The callback must not free the job pool, and should return promptly.
+typedef void (*session_job_callback)(session_job* job, void* ctx);
+
+/// API: jobs/session_job_pool_new
+///
+/// Creates a pool of worker threads to run jobs in the background.  Each of the
+/// `session_job_...` submission functions below takes the same arguments as the function it
+/// wraps (minus the outputs), queues the operation on the pool, and returns immediately.
+///
+/// Jobs that use the same config object run one at a time, in the order they were submitted, so
+/// that the object is never modified concurrently; jobs using different objects may run in
+/// parallel.  The caller must not use a config object itself (from any thread) while jobs using
+/// it are queued or running.
+///
+/// All input data is copied when a job is submitted, so input buffers may be freed as soon as the
+/// submission function returns.
+///
+/// Inputs:
+/// - `threads` -- [in] the number of worker threads; 0 to use one per hardware thread.
+///
+/// Outputs:
+/// - `session_job_pool*` -- the new pool, to be freed with `session_job_pool_free`.
+LIBSESSION_EXPORT session_job_pool* session_job_pool_new(size_t threads);
+
+/// API: jobs/session_job_pool_free
+///
+/// Waits for all jobs submitted to the pool to finish, then stops the worker threads and frees
+/// the pool.  Job handles remain valid (and must still be freed) after the pool is freed.  Must
+/// not be called from a job callback.
+///
+/// Inputs:
+/// - `pool` -- [in] the pool to free.
+LIBSESSION_EXPORT void session_job_pool_free(session_job_pool* pool);
+
+/// API: jobs/session_job_config_merge
+///
+/// Submits a `config_merge` job.  When the job succeeds, the list of accepted message hashes can be
+/// obtained with `session_job_take_string_list`.
+///
+/// Inputs:
+/// - `pool` -- [in] the job pool.
+/// - `conf` -- [in] the config object to merge into.
+/// - `msg_hashes`, `configs`, `lengths`, `count` -- [in] the messages to merge, as for
+///   `config_merge`.
+/// - `callback` -- [in] function to invoke when the job finishes; may be NULL.
+/// - `ctx` -- [in] arbitrary pointer passed to `callback`.
+///
+/// Outputs:
+/// - `session_job*` -- the job handle.
+LIBSESSION_EXPORT session_job* session_job_config_merge(
+        session_job_pool* pool,
+        config_object* conf,
+        const char** msg_hashes,
+        const unsigned char** configs,
+        const size_t* lengths,
+        size_t count,
+        session_job_callback callback,
+        void* ctx);
+
+/// API: jobs/session_job_config_push
+///
+/// Submits a `config_push` job.  When the job succeeds, the data to push can be obtained with
+/// `session_job_take_push_data`.
+///
+/// Inputs:
+/// - `pool` -- [in] the job pool.
+/// - `conf` -- [in] the config object to push.
+/// - `callback` -- [in] function to invoke when the job finishes; may be NULL.
+/// - `ctx` -- [in] arbitrary pointer passed to `callback`.
+///
+/// Outputs:
+/// - `session_job*` -- the job handle.
+LIBSESSION_EXPORT session_job* session_job_config_push(
+        session_job_pool* pool,
+        config_object* conf,
+        session_job_callback callback,
+        void* ctx);
+
+/// API: jobs/session_job_groups_keys_rekey
+///
+/// Submits a `groups_keys_rekey` job; the job uses (and is ordered with respect to other jobs
+/// using) all three objects.  When the job succeeds, a copy of the new keys config message can be
+/// obtained with `session_job_take_data`.
+///
+/// Inputs:
+/// - `pool` -- [in] the job pool.
+/// - `conf` -- [in] the group keys object.
+/// - `info` -- [in] the group info object.
+/// - `members` -- [in] the group members object.
+/// - `callback` -- [in] function to invoke when the job finishes; may be NULL.
+/// - `ctx` -- [in] arbitrary pointer passed to `callback`.
+///
+/// Outputs:
+/// - `session_job*` -- the job handle.
+LIBSESSION_EXPORT session_job* session_job_groups_keys_rekey(
+        session_job_pool* pool,
+        config_group_keys* conf,
+        config_object* info,
+        config_object* members,
+        session_job_callback callback,
+        void* ctx);
+
+/// API: jobs/session_job_groups_keys_decrypt_message
+///
+/// Submits a `groups_keys_decrypt_message` job.  When the job succeeds, the sender session ID can
+/// be obtained with `session_job_session_id` and the plaintext with `session_job_take_data`.
+///
+/// Inputs:
+/// - `pool` -- [in] the job pool.
+/// - `conf` -- [in] the group keys object.
+/// - `ciphertext_in` -- [in] the encrypted message.
+/// - `ciphertext_len` -- [in] the length of `ciphertext_in`.
+/// - `callback` -- [in] function to invoke when the job finishes; may be NULL.
+/// - `ctx` -- [in] arbitrary pointer passed to `callback`.
+///
+/// Outputs:
+/// - `session_job*` -- the job handle.
+LIBSESSION_EXPORT session_job* session_job_groups_keys_decrypt_message(
+        session_job_pool* pool,
+        config_group_keys* conf,
+        const unsigned char* ciphertext_in,
+        size_t ciphertext_len,
+        session_job_callback callback,
+        void* ctx);
+
+/// API: jobs/session_job_decrypt_incoming
+///
+/// Submits a `session_decrypt_incoming` job.  This job does not use any config object, and so may
+/// run concurrently with any other job.  When the job succeeds, the sender session ID can be
+/// obtained with `session_job_session_id` and the plaintext with `session_job_take_data`.
+///
+/// Inputs:
+/// - `pool` -- [in] the job pool.
+/// - `ciphertext_in` -- [in] the encrypted message.
+/// - `ciphertext_len` -- [in] the length of `ciphertext_in`.
+/// - `ed25519_privkey` -- [in] the Ed25519 private key of the recipient (64 bytes).
+/// - `callback` -- [in] function to invoke when the job finishes; may be NULL.
+/// - `ctx` -- [in] arbitrary pointer passed to `callback`.
+///
+/// Outputs:
+/// - `session_job*` -- the job handle.
+LIBSESSION_EXPORT session_job* session_job_decrypt_incoming(
+        session_job_pool* pool,
+        const unsigned char* ciphertext_in,
+        size_t ciphertext_len,
+        const unsigned char* ed25519_privkey,
+        session_job_callback callback,
+        void* ctx);
+
+/// API: jobs/session_job_status
+///
+/// Returns the current status of a job without blocking.
+///
+/// Inputs:
+/// - `job` -- [in] the job handle.
+///
+/// Outputs:
+/// - `SESSION_JOB_STATUS` -- the job status.
+LIBSESSION_EXPORT SESSION_JOB_STATUS session_job_status(const session_job* job);
+
+/// API: jobs/session_job_wait
+///
+/// Blocks until a job has finished.  Must not be called from the job's own callback.
+///
+/// Inputs:
+/// - `job` -- [in] the job handle.
+///
+/// Outputs:
+/// - `SESSION_JOB_STATUS` -- the final job status (never `SESSION_JOB_PENDING`).
+LIBSESSION_EXPORT SESSION_JOB_STATUS session_job_wait(session_job* job);
+
+/// API: jobs/session_job_error
+///
+/// Returns the error message of a failed job.  The returned string is owned by the job.
+///
+/// Inputs:
+/// - `job` -- [in] the job handle.
+///
+/// Outputs:
+/// - `const char*` -- the error message; an empty string if the job has not failed (or failed
+///   without a message).
+LIBSESSION_EXPORT const char* session_job_error(const session_job* job);
+
+/// API: jobs/session_job_take_string_list
+///
+/// Takes the string list result (e.g. the accepted hashes of a merge) of a finished job.
+/// Ownership of the result passes to the caller, so this returns NULL if called again.
+///
+/// Inputs:
+/// - `job` -- [in] the job handle.
+///
+/// Outputs:
+/// - `config_string_list*` -- the result, which must be `free()`d by the caller; NULL if the job
+///   has not succeeded, has no such result, or if the result has already been taken.
+LIBSESSION_EXPORT config_string_list* session_job_take_string_list(session_job* job);
+
+/// API: jobs/session_job_take_push_data
+///
+/// Takes the push data result of a finished `session_job_config_push` job.  Ownership of the
+/// result passes to the caller, so this returns NULL if called again.
+///
+/// Inputs:
+/// - `job` -- [in] the job handle.
+///
+/// Outputs:
+/// - `config_push_data*` -- the result, which must be `free()`d by the caller; NULL if the job has
+///   not succeeded, has no such result, or if the result has already been taken.
+LIBSESSION_EXPORT config_push_data* session_job_take_push_data(session_job* job);
+
+/// API: jobs/session_job_take_data
+///
+/// Takes the binary result (a keys config message or decrypted plaintext) of a finished job.
+/// Ownership of the result passes to the caller, so this returns NULL if called again.
+///
+/// Inputs:
+/// - `job` -- [in] the job handle.
+/// - `len` -- [out] pointer to a size_t where the length of the result is stored.  Not touched if
+///   NULL is returned.
+///
+/// Outputs:
+/// - `unsigned char*` -- the result, which must be `free()`d by the caller; NULL if the job has not
+///   succeeded, has no such result, or if the result has already been taken.
+LIBSESSION_EXPORT unsigned char* session_job_take_data(session_job* job, size_t* len);
+
+/// API: jobs/session_job_session_id
+///
+/// Retrieves the sender session ID of a finished decryption job.
+///
+/// Inputs:
+/// - `job` -- [in] the job handle.
+/// - `session_id_out` -- [out] pointer to a buffer of at least 67 bytes where the null-terminated,
+///   hex session ID is written.
+///
+/// Outputs:
+/// - `bool` -- true if the session ID was written, false if the job has not succeeded or is not a
+///   decryption job.
+LIBSESSION_EXPORT bool session_job_session_id(const session_job* job, char* session_id_out);
+
+/// API: jobs/session_job_free
+///
+/// Releases a job handle, along with any results that have not been taken.  A job that is still
+/// pending is not cancelled: it still runs (and invokes its callback), and is freed once it
+/// finishes.
+///
+/// Inputs:
+/// - `job` -- [in] the job handle.
+LIBSESSION_EXPORT void session_job_free(session_job* job);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace session {
+
+/// Pool of worker threads that runs jobs in the background, for clients (mainly those using the C
+/// API) that would otherwise have to manage their own threads to keep expensive operations such as
+/// merging, pushing, and decrypting off of their main thread.
+///
+/// Each job is submitted along with the set of objects that it uses (typically pointers to config
+/// objects).  Jobs that share an object are run one at a time, in the order they were submitted,
+/// so that an object is never used by two jobs at once and sees its operations in submission
+/// order; jobs that do not share any object may run concurrently.  The pool does not, however,
+/// stop other code from using the objects: callers must not access an object themselves while
+/// jobs using it are queued or running.
+class JobPool {
+  public:
+    /// API: jobs/JobPool::JobPool
+    ///
+    /// Constructs a job pool and starts its worker threads.
+    ///
+    /// Inputs:
+    /// - `threads` -- the number of worker threads; if 0 (the default) one thread per hardware
+    ///   thread is started.
+    explicit JobPool(size_t threads = 0);
+
+    /// API: jobs/JobPool::~JobPool
+    ///
+    /// Waits for all submitted jobs to finish, then stops the worker threads.  Must not be called
+    /// from within a job.
+    ~JobPool();
+
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    /// API: jobs/JobPool::submit
+    ///
+    /// Queues a job to be run on a worker thread once every earlier job that uses any of the same
+    /// objects has finished.
+    ///
+    /// Inputs:
+    /// - `objects` -- the objects used by the job; may be empty for a job that can run at any time.
+    ///   The pointers are only used for identification and are never dereferenced.
+    /// - `job` -- the job to run.  Exceptions thrown by the job are caught and ignored, so a job
+    ///   that can fail should report its own errors.
+    void submit(std::vector<const void*> objects, std::function<void()> job);
+
+    /// API: jobs/JobPool::threads
+    ///
+    /// Returns the number of worker threads.
+    ///
+    /// Inputs: None
+    ///
+    /// Outputs:
+    /// - `size_t` -- the number of worker threads.
+    size_t threads() const { return workers_.size(); }
+
+  private:
+    struct queued {
+        std::function<void()> job;
+        std::vector<const void*> objects;
+        // The number of objects for which an earlier job is still queued or running.
+        size_t blocked = 0;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    // Jobs that are ready to run, in submission order.
+    std::deque<std::shared_ptr<queued>> ready_;
+    // For each object in use, the jobs using it in submission order; the first job is the one that
+    // is running (or ready to run, once its other objects free up).
+    std::unordered_map<const void*, std::deque<std::shared_ptr<queued>>> object_queues_;
+    // The number of submitted jobs that have not finished yet.
+    size_t outstanding_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    void worker();
+};
+
+}  // namespace session
@@ -40,6 +40,19 @@ namespace detail {
             bool encrypting,
             std::string_view domain);
 
+    // Computes the `encrypt_multi_key` keys for all of `recipients` at once (hashing them
+    // together, which is much faster than one at a time), writing 32 bytes per recipient into
+    // `keys_out` (which is resized as needed).  Returns the (ascending) indices of any recipients
+    // for which the shared key could not be computed (i.e. invalid pubkeys); the values in
+    // `keys_out` for such recipients are unspecified.
+    std::vector<size_t> encrypt_multi_keys(
+            sodium_vector<unsigned char>& keys_out,
+            const unsigned char* a,
+            const unsigned char* A,
+            const std::vector<ustring_view>& recipients,
+            bool encrypting,
+            std::string_view domain);
+
     void encrypt_multi_impl(
             ustring& out,
             ustring_view message,
@@ -100,7 +113,8 @@ extern const size_t encrypt_multiple_message_overhead;
 /// - `ignore_invalid_recipient` -- if given and true then any recipients that appear to have
 ///   invalid public keys (i.e. the shared key multiplication fails) will be silently ignored (the
 ///   callback will not be called).  If not given (or false) then such a failure for any recipient
-///   will raise an exception.
+///   will raise an exception; all recipient keys are computed before anything is encrypted, so in
+///   such a case the exception is raised before `call` has been invoked for any recipient.
 template <typename F>
 void encrypt_for_multiple(
         const std::vector<ustring_view> messages,
@@ -129,21 +143,23 @@ void encrypt_for_multiple(
     ustring encrypted;
     encrypted.reserve(max_msg_size + encrypt_multiple_message_overhead);
 
-    sodium_cleared<std::array<unsigned char, 32>> key;
+    sodium_vector<unsigned char> keys;
+    auto invalid = detail::encrypt_multi_keys(
+            keys, privkey.data(), pubkey.data(), recipients, true, domain);
+    if (!invalid.empty() && !ignore_invalid_recipient)
+        throw std::invalid_argument{"Unable to compute shared encrypted key: invalid pubkey?"};
+
+    auto next_invalid = invalid.begin();
     auto msg_it = messages.begin();
-    for (const auto& r : recipients) {
+    for (size_t i = 0; i < recipients.size(); i++) {
         const auto& m = *msg_it;
         if (messages.size() > 1)
             ++msg_it;
-        try {
-            detail::encrypt_multi_key(key, privkey.data(), pubkey.data(), r.data(), true, domain);
-        } catch (const std::exception&) {
-            if (ignore_invalid_recipient)
-                continue;
-            else
-                throw;
+        if (next_invalid != invalid.end() && *next_invalid == i) {
+            ++next_invalid;
+            continue;
         }
-        detail::encrypt_multi_impl(encrypted, m, key.data(), nonce.data());
+        detail::encrypt_multi_impl(encrypted, m, keys.data() + 32 * i, nonce.data());
         call(ustring_view{encrypted});
     }
 }
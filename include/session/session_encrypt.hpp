@@ -1,5 +1,6 @@
 #pragma once
 
+#include "identity.hpp"
 #include "types.hpp"
 
 // Helper functions for the "Session Protocol" encryption mechanism.  This is the encryption used
@@ -61,6 +62,20 @@ namespace session {
 ustring encrypt_for_recipient(
         ustring_view ed25519_privkey, ustring_view recipient_pubkey, ustring_view message);
 
+/// API: crypto/encrypt_for_recipient
+///
+/// Same as above, but uses the sender keys from a `SessionIdentity` rather than deriving them from
+/// a raw secret key.
+///
+/// Inputs:
+/// - `sender` -- the identity of the sender.
+/// - `recipient_pubkey`, `message` -- same as above.
+///
+/// Outputs:
+/// Same as above.
+ustring encrypt_for_recipient(
+        const SessionIdentity& sender, ustring_view recipient_pubkey, ustring_view message);
+
 /// API: crypto/encrypt_for_recipient_deterministic
 ///
 /// Performs session protocol encryption, but using a deterministic version of crypto_box_seal.
@@ -80,6 +95,19 @@ ustring encrypt_for_recipient(
 ustring encrypt_for_recipient_deterministic(
         ustring_view ed25519_privkey, ustring_view recipient_pubkey, ustring_view message);
 
+/// API: crypto/encrypt_for_recipient_deterministic
+///
+/// Same as above, but uses the sender keys from a `SessionIdentity`.
+///
+/// Inputs:
+/// - `sender` -- the identity of the sender.
+/// - `recipient_pubkey`, `message` -- same as above.
+///
+/// Outputs:
+/// Same as above.
+ustring encrypt_for_recipient_deterministic(
+        const SessionIdentity& sender, ustring_view recipient_pubkey, ustring_view message);
+
 /// API: crypto/session_encrypt_for_blinded_recipient
 ///
 /// This function attempts to encrypt a message using the SessionBlindingProtocol.
@@ -101,6 +129,22 @@ ustring encrypt_for_blinded_recipient(
         ustring_view recipient_blinded_id,
         ustring_view message);
 
+/// API: crypto/encrypt_for_blinded_recipient
+///
+/// Same as above, but uses the sender keys from a `SessionIdentity`.
+///
+/// Inputs:
+/// - `sender` -- the identity of the sender.
+/// - `server_pk`, `recipient_blinded_id`, `message` -- same as above.
+///
+/// Outputs:
+/// Same as above.
+ustring encrypt_for_blinded_recipient(
+        const SessionIdentity& sender,
+        ustring_view server_pk,
+        ustring_view recipient_blinded_id,
+        ustring_view message);
+
 /// API: crypto/sign_for_recipient
 ///
 /// Performs the signing steps for session protocol encryption.  This is responsible for producing
@@ -127,6 +171,16 @@ ustring encrypt_for_blinded_recipient(
 ustring sign_for_recipient(
         ustring_view ed25519_privkey, ustring_view recipient_pubkey, ustring_view message);
 
+/// API: crypto/sign_for_recipient
+///
+/// Same as above, but uses the sender keys from a `SessionIdentity`.
+///
+/// Inputs:
+/// - `sender` -- the identity of the sender.
+/// - `recipient_pubkey`, `message` -- same as above.
+ustring sign_for_recipient(
+        const SessionIdentity& sender, ustring_view recipient_pubkey, ustring_view message);
+
 /// API: crypto/decrypt_incoming
 ///
 /// Inverse of `encrypt_for_recipient`: this decrypts the message, extracts the sender Ed25519
@@ -144,6 +198,20 @@ ustring sign_for_recipient(
 ///   error.
 std::pair<ustring, ustring> decrypt_incoming(ustring_view ed25519_privkey, ustring_view ciphertext);
 
+/// API: crypto/decrypt_incoming
+///
+/// Same as above, but uses the recipient's already-derived X25519 keys from a `SessionIdentity`
+/// rather than converting the Ed25519 secret key on every call.
+///
+/// Inputs:
+/// - `recipient` -- the identity of the recipient.
+/// - `ciphertext` -- the encrypted data.
+///
+/// Outputs:
+/// Same as above.
+std::pair<ustring, ustring> decrypt_incoming(
+        const SessionIdentity& recipient, ustring_view ciphertext);
+
 /// API: crypto/decrypt_incoming
 ///
 /// Inverse of `encrypt_for_recipient`: this decrypts the message, extracts the sender Ed25519
@@ -181,6 +249,19 @@ std::pair<ustring, ustring> decrypt_incoming(
 std::pair<ustring, std::string> decrypt_incoming_session_id(
         ustring_view ed25519_privkey, ustring_view ciphertext);
 
+/// API: crypto/decrypt_incoming
+///
+/// Same as above, but uses the recipient's already-derived X25519 keys from a `SessionIdentity`.
+///
+/// Inputs:
+/// - `recipient` -- the identity of the recipient.
+/// - `ciphertext` -- the encrypted data.
+///
+/// Outputs:
+/// Same as above.
+std::pair<ustring, std::string> decrypt_incoming_session_id(
+        const SessionIdentity& recipient, ustring_view ciphertext);
+
 /// API: crypto/decrypt_incoming
 ///
 /// Inverse of `encrypt_for_recipient`: this decrypts the message, verifies that the sender Ed25519
@@ -228,6 +309,23 @@ std::pair<ustring, std::string> decrypt_from_blinded_recipient(
         ustring_view recipient_id,
         ustring_view ciphertext);
 
+/// API: crypto/decrypt_from_blinded_recipient
+///
+/// Same as above, but uses the receiver keys from a `SessionIdentity`.
+///
+/// Inputs:
+/// - `receiver` -- the identity of the receiver.
+/// - `server_pk`, `sender_id`, `recipient_id`, `ciphertext` -- same as above.
+///
+/// Outputs:
+/// Same as above.
+std::pair<ustring, std::string> decrypt_from_blinded_recipient(
+        const SessionIdentity& receiver,
+        ustring_view server_pk,
+        ustring_view sender_id,
+        ustring_view recipient_id,
+        ustring_view ciphertext);
+
 /// API: crypto/decrypt_ons_response
 ///
 /// Decrypts the response of an ONS lookup.
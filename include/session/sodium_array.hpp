@@ -4,9 +4,13 @@
 
 namespace session {
 
-// Calls sodium_malloc for secure allocation; throws a std::bad_alloc on allocation failure
+// Allocates secure (locked, guard-paged) memory; throws a std::bad_alloc on allocation failure.
+// Small allocations (4kiB or less) are served from a pool of larger sodium_malloc'ed regions (and
+// so avoid the syscalls of a sodium_malloc per allocation); larger ones call sodium_malloc
+// directly.
 void* sodium_buffer_allocate(size_t size);
-// Frees a pointer constructed with sodium_buffer_allocate.  Does nothing if `p` is nullptr.
+// Frees a pointer constructed with sodium_buffer_allocate, zeroing it first.  Does nothing if `p`
+// is nullptr.
 void sodium_buffer_deallocate(void* p);
 // Calls sodium_memzero to zero a buffer
 void sodium_zero_buffer(void* ptr, size_t size);
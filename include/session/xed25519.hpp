@@ -1,7 +1,11 @@
 #pragma once
 #include <array>
+#include <list>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace session::xed25519 {
 
@@ -35,6 +39,60 @@ std::array<unsigned char, 32> pubkey(ustring_view curve25519_pubkey);
 /// "Softer" version that takes/returns strings of regular chars
 std::string pubkey(std::string_view curve25519_pubkey);
 
+/// Verification context that caches the X25519 -> Ed25519 pubkey conversions (each of which
+/// requires a field inversion) of recently used pubkeys, for callers that repeatedly verify
+/// signatures from the same, relatively small set of senders.  Converted pubkeys are kept in a
+/// bounded LRU cache keyed by X25519 pubkey.  Verification results are identical to the
+/// non-caching `verify`.
+///
+/// Instances are safe to use concurrently from multiple threads.
+class verifier {
+  public:
+    /// Constructs a verifier that caches up to `capacity` converted pubkeys.  A capacity of 0
+    /// disables the cache.
+    explicit verifier(size_t capacity = 256) : capacity_{capacity} {}
+
+    /// Equivalent to the free `pubkey` function, but using (and populating) the cache.
+    std::array<unsigned char, 32> pubkey(ustring_view curve25519_pubkey);
+
+    /// Equivalent to the free `verify` function, but using the cache for the pubkey conversion.
+    [[nodiscard]] bool verify(
+            ustring_view signature /* 64 bytes */,
+            ustring_view curve25519_pubkey /* 32 bytes */,
+            ustring_view msg);
+
+    /// Verifies a batch of signatures at once (see `ed25519::verify_batch`), using the cache
+    /// for the pubkey conversions.  `sigs`, `curve25519_pubkeys`, and `msgs` must have the same
+    /// length (std::invalid_argument is thrown if not).  Returns the (ascending) indices of the
+    /// signatures that failed to verify (including any with a wrong-sized signature or pubkey);
+    /// an empty vector means they are all valid.
+    std::vector<size_t> verify_batch(
+            const std::vector<ustring_view>& sigs,
+            const std::vector<ustring_view>& curve25519_pubkeys,
+            const std::vector<ustring_view>& msgs);
+
+    /// Returns the number of converted pubkeys currently cached.
+    size_t size() const;
+
+    /// Returns the maximum number of converted pubkeys that will be cached.
+    size_t capacity() const { return capacity_; }
+
+    /// Drops all cached pubkeys.
+    void clear();
+
+  private:
+    using pk_t = std::array<unsigned char, 32>;
+    struct key_hash {
+        size_t operator()(const pk_t& k) const;
+    };
+
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    // Most recently used at the front
+    std::list<std::pair<pk_t, pk_t>> lru_;
+    std::unordered_map<pk_t, std::list<std::pair<pk_t, pk_t>>::iterator, key_hash> index_;
+};
+
 /// Utility function that provides a constant-time `if (b) f = g;` implementation for byte arrays.
 template <size_t N>
 void constant_time_conditional_assign(
@@ -1,6 +1,5 @@
 #include "session/blinding.hpp"
 
-#include <oxenc/hex.h>
 #include <sodium/crypto_core_ed25519.h>
 #include <sodium/crypto_generichash_blake2b.h>
 #include <sodium/crypto_scalarmult_ed25519.h>
@@ -10,7 +9,9 @@
 #include <stdexcept>
 
 #include "session/ed25519.hpp"
+#include "session/encoding.hpp"
 #include "session/export.h"
+#include "session/hash.hpp"
 #include "session/platform.h"
 #include "session/platform.hpp"
 #include "session/xed25519.hpp"
@@ -57,6 +58,34 @@ std::array<unsigned char, 32> blind25_factor(ustring_view session_id, ustring_vi
     return k;
 }
 
+std::vector<uc32> blind25_factors(
+        const std::vector<ustring_view>& session_ids, ustring_view server_pk) {
+    assert(server_pk.size() == 32);
+
+    // Each hash input is 05 || session_id || server_pk, as in blind25_factor:
+    std::vector<unsigned char> inputs(65 * session_ids.size());
+    std::vector<ustring_view> to_hash;
+    to_hash.reserve(session_ids.size());
+    for (size_t i = 0; i < session_ids.size(); i++) {
+        auto sid = session_ids[i];
+        assert(sid.size() == 32 || sid.size() == 33);
+        auto* in = inputs.data() + 65 * i;
+        in[0] = sid.size() == 33 ? sid[0] : 0x05;
+        std::memcpy(in + 1, sid.data() + (sid.size() - 32), 32);
+        std::memcpy(in + 33, server_pk.data(), 32);
+        to_hash.emplace_back(in, 65);
+    }
+
+    std::vector<uc64> hashes(session_ids.size());
+    if (!hashes.empty())
+        hash::hash_multi(hashes.front().data(), 64, to_hash);
+
+    std::vector<uc32> factors(session_ids.size());
+    for (size_t i = 0; i < factors.size(); i++)
+        crypto_core_ed25519_scalar_reduce(factors[i].data(), hashes[i].data());
+    return factors;
+}
+
 namespace {
 
     void blind15_id_impl(ustring_view session_id, ustring_view server_pk, unsigned char* out) {
@@ -99,24 +128,24 @@ ustring blind15_id(ustring_view session_id, ustring_view server_pk) {
 }
 
 std::array<std::string, 2> blind15_id(std::string_view session_id, std::string_view server_pk) {
-    if (session_id.size() != 66 || !oxenc::is_hex(session_id))
+    if (session_id.size() != 66 || !encoding::is_hex(session_id))
         throw std::invalid_argument{"blind15_id: session_id must be hex (66 digits)"};
     if (session_id[0] != '0' || session_id[1] != '5')
         throw std::invalid_argument{"blind15_id: session_id must start with 05"};
-    if (server_pk.size() != 64 || !oxenc::is_hex(server_pk))
+    if (server_pk.size() != 64 || !encoding::is_hex(server_pk))
         throw std::invalid_argument{"blind15_id: server_pk must be hex (64 digits)"};
 
     uc33 raw_sid;
-    oxenc::from_hex(session_id.begin(), session_id.end(), raw_sid.begin());
+    encoding::from_hex(session_id, raw_sid.data());
     uc32 raw_server_pk;
-    oxenc::from_hex(server_pk.begin(), server_pk.end(), raw_server_pk.begin());
+    encoding::from_hex(server_pk, raw_server_pk.data());
 
     uc33 blinded;
     blind15_id_impl(to_sv(raw_sid), to_sv(raw_server_pk), blinded.data());
     std::array<std::string, 2> result;
-    result[0] = oxenc::to_hex(blinded.begin(), blinded.end());
+    result[0] = encoding::to_hex({blinded.data(), blinded.size()});
     blinded.back() ^= 0x80;
-    result[1] = oxenc::to_hex(blinded.begin(), blinded.end());
+    result[1] = encoding::to_hex({blinded.data(), blinded.size()});
     return result;
 }
 
@@ -136,22 +165,51 @@ ustring blind25_id(ustring_view session_id, ustring_view server_pk) {
     return result;
 }
 
+std::vector<ustring> blind25_ids(
+        const std::vector<ustring_view>& session_ids, ustring_view server_pk) {
+    for (auto& session_id : session_ids) {
+        if (session_id.size() == 33) {
+            if (session_id[0] != 0x05)
+                throw std::invalid_argument{"blind25_ids: session_id must start with 0x05"};
+        } else if (session_id.size() != 32) {
+            throw std::invalid_argument{"blind25_ids: session_id must be 32 or 33 bytes"};
+        }
+    }
+    if (server_pk.size() != 32)
+        throw std::invalid_argument{"blind25_ids: server_pk must be 32 bytes"};
+
+    auto factors = blind25_factors(session_ids, server_pk);
+
+    std::vector<ustring> result;
+    result.reserve(session_ids.size());
+    for (size_t i = 0; i < session_ids.size(); i++) {
+        auto session_id = session_ids[i];
+        if (session_id.size() == 33)
+            session_id.remove_prefix(1);
+        auto ed_pk = xed25519::pubkey(session_id);
+        auto& out = result.emplace_back(33, 0x25);
+        if (0 != crypto_scalarmult_ed25519_noclamp(out.data() + 1, factors[i].data(), ed_pk.data()))
+            throw std::runtime_error{"Cannot blind: invalid session_id (not on main subgroup)"};
+    }
+    return result;
+}
+
 std::string blind25_id(std::string_view session_id, std::string_view server_pk) {
-    if (session_id.size() != 66 || !oxenc::is_hex(session_id))
+    if (session_id.size() != 66 || !encoding::is_hex(session_id))
         throw std::invalid_argument{"blind25_id: session_id must be hex (66 digits)"};
     if (session_id[0] != '0' || session_id[1] != '5')
         throw std::invalid_argument{"blind25_id: session_id must start with 05"};
-    if (server_pk.size() != 64 || !oxenc::is_hex(server_pk))
+    if (server_pk.size() != 64 || !encoding::is_hex(server_pk))
         throw std::invalid_argument{"blind25_id: server_pk must be hex (64 digits)"};
 
     uc33 raw_sid;
-    oxenc::from_hex(session_id.begin(), session_id.end(), raw_sid.begin());
+    encoding::from_hex(session_id, raw_sid.data());
     uc32 raw_server_pk;
-    oxenc::from_hex(server_pk.begin(), server_pk.end(), raw_server_pk.begin());
+    encoding::from_hex(server_pk, raw_server_pk.data());
 
     uc33 blinded;
     blind25_id_impl(to_sv(raw_sid), to_sv(raw_server_pk), blinded.data());
-    return oxenc::to_hex(blinded.begin(), blinded.end());
+    return encoding::to_hex({blinded.data(), blinded.size()});
 }
 
 ustring blinded15_id_from_ed(ustring_view ed_pubkey, ustring_view server_pk, ustring* session_id) {
@@ -343,8 +401,8 @@ ustring blind25_sign(ustring_view ed25519_sk, std::string_view server_pk_in, ust
     uc32 server_pk;
     if (server_pk_in.size() == 32)
         std::memcpy(server_pk.data(), server_pk_in.data(), 32);
-    else if (server_pk_in.size() == 64 && oxenc::is_hex(server_pk_in))
-        oxenc::from_hex(server_pk_in.begin(), server_pk_in.end(), server_pk.begin());
+    else if (server_pk_in.size() == 64 && encoding::is_hex(server_pk_in))
+        encoding::from_hex(server_pk_in, server_pk.data());
     else
         throw std::invalid_argument{"blind25_sign: Invalid server_pk: expected 32 bytes or 64 hex"};
 
@@ -406,8 +464,8 @@ ustring blind15_sign(ustring_view ed25519_sk, std::string_view server_pk_in, ust
     uc32 server_pk;
     if (server_pk_in.size() == 32)
         std::memcpy(server_pk.data(), server_pk_in.data(), 32);
-    else if (server_pk_in.size() == 64 && oxenc::is_hex(server_pk_in))
-        oxenc::from_hex(server_pk_in.begin(), server_pk_in.end(), server_pk.begin());
+    else if (server_pk_in.size() == 64 && encoding::is_hex(server_pk_in))
+        encoding::from_hex(server_pk_in, server_pk.data());
     else
         throw std::invalid_argument{"blind15_sign: Invalid server_pk: expected 32 bytes or 64 hex"};
 
@@ -476,7 +534,7 @@ ustring blind_version_sign(ustring_view ed25519_sk, Platform platform, uint64_t
 
 bool session_id_matches_blinded_id(
         std::string_view session_id, std::string_view blinded_id, std::string_view server_pk) {
-    if (session_id.size() != 66 || !oxenc::is_hex(session_id))
+    if (session_id.size() != 66 || !encoding::is_hex(session_id))
         throw std::invalid_argument{
                 "session_id_matches_blinded_id: session_id must be hex (66 digits)"};
     if (session_id[0] != '0' || session_id[1] != '5')
@@ -484,7 +542,7 @@ bool session_id_matches_blinded_id(
     if (blinded_id[1] != '5' && (blinded_id[0] != '1' || blinded_id[0] != '2'))
         throw std::invalid_argument{
                 "session_id_matches_blinded_id: blinded_id must start with 15 or 25"};
-    if (server_pk.size() != 64 || !oxenc::is_hex(server_pk))
+    if (server_pk.size() != 64 || !encoding::is_hex(server_pk))
         throw std::invalid_argument{
                 "session_id_matches_blinded_id: server_pk must be hex (64 digits)"};
 
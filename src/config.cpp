@@ -269,8 +269,10 @@ namespace {
     }
 
     void parse_data(set& s, oxenc::bt_list_consumer in);
-    void parse_data(dict& d, oxenc::bt_dict_consumer in, bool top_level = false) {
-        if (!top_level && in.is_finished())
+    // `allow_empty` permits empty (nested) dicts, which are needed for delta message values.
+    void parse_data(
+            dict& d, oxenc::bt_dict_consumer in, bool top_level = false, bool allow_empty = false) {
+        if (!top_level && !allow_empty && in.is_finished())
             throw oxenc::bt_deserialize_invalid{"Data contains an unpruned, empty dict"};
         while (!in.is_finished()) {
             std::string key{in.key()};
@@ -282,7 +284,11 @@ namespace {
                 d.emplace_hint(d.end(), std::move(key), in.consume_integer<int64_t>());
             else if (in.is_dict()) {
                 auto it = d.emplace_hint(d.end(), std::move(key), dict{});
-                parse_data(var::get<dict>(it->second), in.consume_dict_consumer());
+                parse_data(
+                        var::get<dict>(it->second),
+                        in.consume_dict_consumer(),
+                        false,
+                        allow_empty);
             } else if (in.is_list()) {
                 auto it = d.emplace_hint(d.end(), std::move(key), set{});
                 parse_data(var::get<set>(it->second), in.consume_list_consumer());
@@ -348,6 +354,22 @@ namespace {
         return std::string_view{reinterpret_cast<const char*>(hash.data()), hash.size()};
     }
 
+    void serialize_lagged_diffs(
+            oxenc::bt_list_producer&& out,
+            const ConfigMessage::lagged_diffs_t& lagged_diffs,
+            seqno_t seqno,
+            int lag) {
+        for (auto& [seqno_hash, lag_data] : lagged_diffs) {
+            const auto& [lag_seqno, lag_hash] = seqno_hash;
+            if (lag_seqno <= seqno - lag || lag_seqno >= seqno)
+                continue;
+            auto l = out.append_list();
+            l.append(lag_seqno);
+            l.append(view(lag_hash));
+            l.append_bt(lag_data);
+        }
+    }
+
     hash_t& hash_msg(hash_t& into, ustring_view serialized) {
         crypto_generichash_blake2b(
                 into.data(), into.size(), serialized.data(), serialized.size(), nullptr, 0);
@@ -427,8 +449,111 @@ namespace {
             }
         }
     }
+
+    /// Copies the values from `data` that are needed to apply `diff` into `out`: assigned scalars,
+    /// and the full value of changed sets.  Changed dicts are included (possibly empty) whenever
+    /// `data` still has a dict there, so that applying the diff only updates keys inside the dict
+    /// rather than removing the whole thing.
+    void delta_values(dict& out, const oxenc::bt_dict& diff, const dict& data) {
+        for (const auto& [k, v] : diff) {
+            auto it = data.find(k);
+            if (it == data.end())
+                continue;
+            if (auto* subdiff = std::get_if<oxenc::bt_dict>(&v)) {
+                if (auto* subdata = std::get_if<dict>(&it->second)) {
+                    auto& sub = out[k];
+                    sub = dict{};
+                    delta_values(var::get<dict>(sub), *subdiff, *subdata);
+                }
+            } else if (std::holds_alternative<oxenc::bt_list>(v)) {
+                if (std::holds_alternative<set>(it->second))
+                    out.emplace(k, it->second);
+            } else if (get_bt_str(v) == ""sv && std::holds_alternative<scalar>(it->second)) {
+                out.emplace(k, it->second);
+            }
+        }
+    }
+
+    /// Removes changes from `older` that are completely overwritten when `newer` is applied after
+    /// it: that is, any change at a key where `newer` has a scalar ("" or "-") change, which sets
+    /// or removes the value regardless of what was there before.  Nested dict changes are
+    /// collapsed recursively, but are otherwise left in place (even if emptied) as a dict change
+    /// also affects the dict itself (e.g. replacing a non-dict value).
+    void collapse_diff(oxenc::bt_dict& older, const oxenc::bt_dict& newer) {
+        for (const auto& [k, v] : newer) {
+            auto it = older.find(k);
+            if (it == older.end())
+                continue;
+            if (get_bt_str(v))
+                older.erase(it);
+            else if (auto* newer_sub = std::get_if<oxenc::bt_dict>(&v))
+                if (auto* older_sub = std::get_if<oxenc::bt_dict>(&it->second))
+                    collapse_diff(*older_sub, *newer_sub);
+        }
+    }
+
+    // A parsed, but not yet applied, delta config message.
+    struct delta_message {
+        size_t index;  // Index of the message in the input configs
+        seqno_t seqno;
+        seqno_hash_t base;
+        hash_t hash;  // Hash of the full message that the delta should produce
+        dict values;
+        oxenc::bt_dict diff;
+    };
+
+    void load_hash(hash_t& hash, std::string_view h) {
+        if (h.size() != hash.size())
+            throw config_parse_error{"Invalid delta config message: hash must be 32 bytes"};
+        std::memcpy(hash.data(), h.data(), hash.size());
+    }
+
+    delta_message parse_delta(ustring_view serialized, size_t index) {
+        delta_message d{index};
+        oxenc::bt_dict_consumer dict{from_unsigned_sv(serialized)};
+        try {
+            if (auto [k, v] = dict.next_integer<int64_t>(); k == "#")
+                d.seqno = v;
+            else
+                throw config_parse_error{"Invalid config: first key must be \"#\""};
+            if (auto [k, values] = dict.next_dict_consumer(); k == "%")
+                parse_data(d.values, std::move(values), /*top_level=*/true, /*allow_empty=*/true);
+            else
+                throw config_parse_error{"Invalid delta config: \"%\" values dict not found"};
+            if (!dict.skip_until("="))
+                throw config_parse_error{"Invalid delta config: \"=\" diff not found"};
+            d.diff = load_diff(dict.consume_dict_consumer());
+            if (!dict.skip_until(">"))
+                throw config_parse_error{"Invalid delta config: \">\" base not found"};
+            auto base = dict.consume_list_consumer();
+            d.base.first = base.consume_integer<int64_t>();
+            load_hash(d.base.second, base.consume_string_view());
+            load_hash(d.hash, base.consume_string_view());
+            if (!base.is_finished())
+                throw config_parse_error{"Invalid delta config: expected 3 base elements"};
+            if (dict.skip_until("~"))
+                throw config_parse_error{"Invalid delta config: delta messages cannot be signed"};
+        } catch (const oxenc::bt_deserialize_invalid& err) {
+            throw config_parse_error{"Failed to parse delta config: "s + err.what()};
+        }
+        if (d.seqno != d.base.first + 1)
+            throw config_parse_error{"Invalid delta config: seqno does not follow base seqno"};
+        return d;
+    }
 }  // namespace
 
+bool is_delta_message(ustring_view serialized) {
+    try {
+        oxenc::bt_dict_consumer dict{from_unsigned_sv(serialized)};
+        if (dict.is_finished() || dict.key() != "#")
+            return false;
+        dict.skip_value();
+        return !dict.is_finished() && dict.key() == "%";
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
 void verify_config_sig(
         oxenc::bt_dict_consumer dict,
         ustring_view config_msg,
@@ -460,6 +585,35 @@ bool MutableConfigMessage::prune() {
     return prune_(data_).second;
 }
 
+void ConfigMessage::add_memory_usage(MemoryUsage& usage) const {
+    usage.data += heap_usage(data_) + heap_usage(unknown_);
+    usage.diffs += heap_usage(diff_) +
+                   lagged_diffs_.size() * (TREE_NODE_OVERHEAD + sizeof(lagged_diffs_t::value_type));
+    for (const auto& [seqno_hash, diff] : lagged_diffs_)
+        usage.diffs += heap_usage(diff);
+    usage.other += sizeof(ConfigMessage) + delta_chain_.capacity() * sizeof(int);
+}
+
+void MutableConfigMessage::add_memory_usage(MemoryUsage& usage) const {
+    ConfigMessage::add_memory_usage(usage);
+    usage.pending += heap_usage(orig_data_);
+    usage.other += sizeof(MutableConfigMessage) - sizeof(ConfigMessage);
+}
+
+size_t ConfigMessage::lagged_diffs_bytes() const {
+    oxenc::bt_dict_producer d{};
+    serialize_lagged_diffs(d.append_list("<"), lagged_diffs_, seqno(), lag);
+    return d.view().size() - 7;  // Subtract the `d1:<l` ... `ee` wrapping
+}
+
+size_t MutableConfigMessage::collapse_lagged_diffs() {
+    auto before = lagged_diffs_bytes();
+    for (auto it = lagged_diffs_.begin(); it != lagged_diffs_.end(); ++it)
+        for (auto newer = std::next(it); newer != lagged_diffs_.end(); ++newer)
+            collapse_diff(it->second, newer->second);
+    return before - lagged_diffs_bytes();
+}
+
 // Called immediately after being copy-constructed from the source object to do the required
 // modifications to increment it.
 void MutableConfigMessage::increment_impl() {
@@ -483,6 +637,8 @@ void MutableConfigMessage::increment_impl() {
         lags.erase(rit.base());
     }
 
+    delta_base_ = seqno_hash_;
+
     // Append the source config's diff to the new object
     lagged_diffs_.emplace_hint(lagged_diffs_.end(), seqno_hash_, std::move(diff_));
     seqno_hash_.first++;
@@ -534,6 +690,9 @@ ConfigMessage::ConfigMessage(
         bool trust_signature) :
         verifier{std::move(verifier_)}, signer{std::move(signer_)}, lag{lag} {
 
+    if (is_delta_message(serialized))
+        throw missing_delta_base{"Delta config messages cannot be loaded without their base"};
+
     oxenc::bt_dict_consumer dict{from_unsigned_sv(serialized)};
 
     try {
@@ -573,11 +732,21 @@ ConfigMessage::ConfigMessage(
         verifier{std::move(verifier_)}, signer{std::move(signer_)}, lag{lag} {
 
     std::vector<std::pair<ConfigMessage, bool>> configs;  // [[config, redundant], ...]
+    std::vector<int> indices;  // The index in `serialized_confs` of each element of `configs`
+    std::vector<delta_message> deltas;
     for (size_t i = 0; i < serialized_confs.size(); i++) {
         const auto& data = serialized_confs[i];
         try {
+            if (is_delta_message(data)) {
+                if (verifier || signer)
+                    throw config_error{
+                            "Delta config messages are not supported for signed configs"};
+                deltas.push_back(parse_delta(data, i));
+                continue;
+            }
             ConfigMessage m{data, verifier, signer, lag};
             configs.emplace_back(std::move(m), false);
+            indices.push_back(i);
         } catch (const config_error& e) {
             if (error_handler)
                 error_handler(i, e);
@@ -585,6 +754,47 @@ ConfigMessage::ConfigMessage(
             continue;
         }
     }
+
+    // Reconstruct full messages from any delta messages whose base we have.  A delta's base can
+    // itself be a delta, so we keep going until we stop finding bases.
+    for (bool progress = true; progress && !deltas.empty();) {
+        progress = false;
+        for (auto it = deltas.begin(); it != deltas.end();) {
+            auto base_it = std::find_if(configs.begin(), configs.end(), [&](const auto& c) {
+                return c.first.seqno_hash_ == it->base;
+            });
+            if (base_it == configs.end()) {
+                ++it;
+                continue;
+            }
+            const auto& base = base_it->first;
+            try {
+                MutableConfigMessage m{base, increment_seqno};
+                apply_diff(m.data_, it->diff, it->values);
+                prune_(m.data_);
+                if (m.hash() != it->hash)
+                    throw config_error{
+                            "Delta config message did not reproduce the expected full message"};
+                ConfigMessage full{std::move(m)};
+                full.delta_chain_ = base.delta_chain_;
+                full.delta_chain_.push_back(indices[std::distance(configs.begin(), base_it)]);
+                configs.emplace_back(std::move(full), false);
+                indices.push_back(it->index);
+            } catch (const config_error& e) {
+                if (error_handler)
+                    error_handler(it->index, e);
+            }
+            it = deltas.erase(it);
+            progress = true;
+        }
+    }
+    for (const auto& d : deltas)
+        if (error_handler)
+            error_handler(
+                    d.index,
+                    missing_delta_base{
+                            "Delta config message base (seqno " + std::to_string(d.base.first) +
+                            ") is not available"});
     if (configs.empty())
         throw config_error{"Config initialization failed: no valid config messages given"};
 
@@ -622,7 +832,7 @@ ConfigMessage::ConfigMessage(
         for (int i = 0; i < configs.size(); i++) {
             if (!configs[i].second) {
                 *this = std::move(configs[i].first);
-                unmerged_ = i;
+                unmerged_ = indices[i];
                 return;
             }
         }
@@ -643,7 +853,7 @@ ConfigMessage::ConfigMessage(
                     return a.first.seqno_hash_ < b.first.seqno_hash_;
                 });
         *this = std::move(best_it->first);
-        unmerged_ = std::distance(configs.begin(), best_it);
+        unmerged_ = indices[std::distance(configs.begin(), best_it)];
         return;
     }
 
@@ -735,7 +945,25 @@ ustring ConfigMessage::serialize(bool enable_signing) {
             enable_signing);
 }
 
+void ConfigMessage::serialize_view(
+        const std::function<void(ustring_view)>& f, bool enable_signing) {
+    serialize_impl(
+            diff(),  // implicitly prunes (if actually a mutable instance)
+            f,
+            enable_signing);
+}
+
 ustring ConfigMessage::serialize_impl(const oxenc::bt_dict& curr_diff, bool enable_signing) {
+    ustring result;
+    serialize_impl(
+            curr_diff, [&result](ustring_view data) { result = data; }, enable_signing);
+    return result;
+}
+
+void ConfigMessage::serialize_impl(
+        const oxenc::bt_dict& curr_diff,
+        const std::function<void(ustring_view)>& f,
+        bool enable_signing) {
     oxenc::bt_dict_producer outer{};
 
     outer.append("#", seqno());
@@ -746,18 +974,7 @@ ustring ConfigMessage::serialize_impl(const oxenc::bt_dict& curr_diff, bool enab
 
     unknown_it = append_unknown(outer, unknown_it, unknown_.end(), "<");
 
-    {
-        auto lags = outer.append_list("<");
-        for (auto& [seqno_hash, lag_data] : lagged_diffs_) {
-            const auto& [lag_seqno, lag_hash] = seqno_hash;
-            if (lag_seqno <= seqno() - lag || lag_seqno >= seqno())
-                continue;
-            auto lag = lags.append_list();
-            lag.append(lag_seqno);
-            lag.append(view(lag_hash));
-            lag.append_bt(lag_data);
-        }
-    }
+    serialize_lagged_diffs(outer.append_list("<"), lagged_diffs_, seqno(), lag);
 
     unknown_it = append_unknown(outer, unknown_it, unknown_.end(), "=");
 
@@ -783,7 +1000,31 @@ ustring ConfigMessage::serialize_impl(const oxenc::bt_dict& curr_diff, bool enab
             return sig;
         });
     }
-    return ustring{to_unsigned_sv(outer.view())};
+    f(to_unsigned_sv(outer.view()));
+}
+
+void MutableConfigMessage::serialize_delta(const std::function<void(ustring_view)>& f) {
+    if (!delta_base_)
+        throw std::logic_error{"Cannot serialize a delta config message without a delta base"};
+    if (signer || verifier)
+        throw std::logic_error{"Cannot serialize a delta config message for a signed config"};
+
+    const auto& full_hash = hash();  // Also prunes and updates diff_
+
+    dict values;
+    delta_values(values, diff_, data_);
+
+    oxenc::bt_dict_producer outer{};
+    outer.append("#", seqno());
+    serialize_data(outer.append_dict("%"), values);
+    outer.append_bt("=", diff_);
+    {
+        auto base = outer.append_list(">");
+        base.append(delta_base_->first);
+        base.append(view(delta_base_->second));
+        base.append(view(full_hash));
+    }
+    f(to_unsigned_sv(outer.view()));
 }
 
 const hash_t& MutableConfigMessage::hash() {
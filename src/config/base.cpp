@@ -5,9 +5,12 @@
 #include <oxenc/hex.h>
 #include <sodium/core.h>
 #include <sodium/crypto_generichash_blake2b.h>
+#include <sodium/crypto_scalarmult.h>
 #include <sodium/crypto_sign_ed25519.h>
 #include <sodium/utils.h>
 
+#include <algorithm>
+#include <numeric>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -27,6 +30,11 @@ void ConfigBase::set_state(ConfigState s) {
     if (s == ConfigState::Dirty && is_readonly())
         throw std::runtime_error{"Unable to make changes to a read-only config object"};
 
+    if (s == ConfigState::Dirty)
+        _delta_base_hash = _state == ConfigState::Clean ? _curr_hash : ""s;
+    else if (s == ConfigState::Clean)
+        _delta_base_hash.clear();
+
     if (_state == ConfigState::Clean && !_curr_hash.empty()) {
         _old_hashes.insert(std::move(_curr_hash));
         _curr_hash.clear();
@@ -36,9 +44,21 @@ void ConfigBase::set_state(ConfigState s) {
 }
 
 MutableConfigMessage& ConfigBase::dirty() {
+    _edit_count++;
+    _data_version++;
     if (_state != ConfigState::Dirty) {
         set_state(ConfigState::Dirty);
-        _config = std::make_unique<MutableConfigMessage>(*_config, increment_seqno);
+        auto mut = std::make_unique<MutableConfigMessage>(*_config, increment_seqno);
+        if (_lagged_diff_budget > 0 && mut->lagged_diffs_bytes() > _lagged_diff_budget) {
+            auto saved = mut->collapse_lagged_diffs();
+            log(LogLevel::debug,
+                "Collapsed lagged diffs over budget: saved " + std::to_string(saved) + " bytes");
+            // A delta recipient rebuilds the full message by incrementing the base message without
+            // collapsing anything, so its hash wouldn't match ours: push a full message instead.
+            if (saved > 0)
+                _delta_base_hash.clear();
+        }
+        _config = std::move(mut);
     } else {
         _needs_dump = true;
     }
@@ -64,32 +84,133 @@ std::vector<std::string> ConfigBase::merge(
     return merge(config_views);
 }
 
+const sodium_array<unsigned char>& ConfigBase::unwrap_keys() {
+    assert(!_keys.empty());
+    const auto& seed = _keys.front();
+    if (_unwrap_keys.size() == 128 && sodium_memcmp(_unwrap_keys.data(), seed.data(), 32) == 0)
+        return _unwrap_keys;
+
+    _unwrap_keys.reset(128);
+    auto* k = _unwrap_keys.data();
+    std::memcpy(k, seed.data(), 32);
+    cleared_uc64 ed_sk;
+    crypto_sign_ed25519_seed_keypair(k + 32, ed_sk.data(), seed.data());
+    crypto_sign_ed25519_sk_to_curve25519(k + 96, ed_sk.data());
+    crypto_scalarmult_base(k + 64, k + 96);
+    return _unwrap_keys;
+}
+
+void ConfigBase::remember_merged(const std::vector<std::string>& hashes) {
+    for (const auto& h : hashes) {
+        if (h.empty() || !_seen_hashes.insert(h).second)
+            continue;
+        _seen_hashes_order.push_back(h);
+        if (_seen_hashes_order.size() > SEEN_HASHES_MAX) {
+            _seen_hashes.erase(_seen_hashes_order.front());
+            _seen_hashes_order.pop_front();
+        }
+    }
+}
+
 std::vector<std::string> ConfigBase::merge(
         const std::vector<std::pair<std::string, ustring_view>>& configs) {
+    // Messages that we have already merged (or that we pushed ourselves) can't change anything, so
+    // we skip them entirely, but still report them as successfully parsed.  As with a full merge,
+    // such messages are obsolete unless they are our current message.
+    //
+    // The exception is when we are missing the base of a delta message: the caller is then
+    // re-fetching everything so that we can rebuild the base, which is quite likely a message we
+    // have already seen, so in that case we merge everything we are given.
+    std::vector<bool> is_seen(configs.size(), false);
+    size_t seen = 0;
+    if (!_needs_full_message) {
+        for (size_t i = 0; i < configs.size(); i++) {
+            const auto& hash = configs[i].first;
+            if (!hash.empty() && (hash == _curr_hash || _seen_hashes.count(hash))) {
+                is_seen[i] = true;
+                seen++;
+            }
+        }
+    }
+
+    if (seen == 0) {
+        auto good = merge_unseen(configs);
+        remember_merged(good);
+        return good;
+    }
+
+    log(LogLevel::debug,
+        "skipping " + std::to_string(seen) + " of " + std::to_string(configs.size()) +
+                " incoming messages that have already been merged");
+
+    std::vector<std::pair<std::string, ustring_view>> unseen;
+    unseen.reserve(configs.size() - seen);
+    for (size_t i = 0; i < configs.size(); i++) {
+        if (!is_seen[i])
+            unseen.push_back(configs[i]);
+        else if (configs[i].first != _curr_hash)
+            _old_hashes.insert(configs[i].first);
+    }
+
+    std::vector<std::string> good;
+    if (!unseen.empty())
+        good = merge_unseen(unseen);
+    else
+        _needs_full_message = false;
+
+    if (_needs_full_message && seen > 0) {
+        // One of the new messages is a delta whose base might be one of the messages we skipped,
+        // so try again with everything:
+        log(LogLevel::debug, "delta base missing; merging again including already-seen messages");
+        good = merge_unseen(configs);
+        remember_merged(good);
+        return good;
+    }
+
+    // Rebuild the result, in input order, from the skipped messages plus the merged ones:
+    std::unordered_set<std::string_view> good_set{good.begin(), good.end()};
+    std::vector<std::string> result;
+    result.reserve(seen + good.size());
+    for (size_t i = 0; i < configs.size(); i++)
+        if (is_seen[i] || good_set.count(configs[i].first))
+            result.push_back(configs[i].first);
+    remember_merged(good);
+    return result;
+}
+
+std::vector<std::string> ConfigBase::merge_unseen(
+        const std::vector<std::pair<std::string, ustring_view>>& configs) {
     if (accepts_protobuf() && !_keys.empty()) {
         std::list<ustring> keep_alive;
         std::vector<std::pair<std::string, ustring_view>> parsed;
         parsed.reserve(configs.size());
 
+        auto unwrap = [this](ustring_view data) {
+            auto* k = unwrap_keys().data();
+            return protos::unwrap_config(
+                    {k + 32, 32}, {k + 64, 32}, {k + 96, 32}, data, storage_namespace());
+        };
+
         for (auto& [h, c] : configs) {
+            // Most messages are raw (i.e. not protobuf-wrapped), which we can detect without
+            // attempting (and failing) the expensive unwrapping:
+            if (!protos::is_protobuf_wrapped(c)) {
+                parsed.emplace_back(h, c);
+                continue;
+            }
             try {
-                auto unwrapped = protos::unwrap_config(
-                        ustring_view{_keys.front().data(), _keys.front().size()},
-                        c,
-                        storage_namespace());
+                auto unwrapped = unwrap(c);
 
                 // There was a release of one of the clients which resulted in double-wrapped
                 // config messages so we now need to try to double-unwrap in order to better
                 // support multi-device for users running those old versions
-                try {
-                    auto unwrapped2 = protos::unwrap_config(
-                            ustring_view{_keys.front().data(), _keys.front().size()},
-                            unwrapped,
-                            storage_namespace());
-                    parsed.emplace_back(h, keep_alive.emplace_back(std::move(unwrapped2)));
-                } catch (...) {
-                    parsed.emplace_back(h, keep_alive.emplace_back(std::move(unwrapped)));
+                if (protos::is_protobuf_wrapped(unwrapped)) {
+                    try {
+                        unwrapped = unwrap(unwrapped);
+                    } catch (...) {
+                    }
                 }
+                parsed.emplace_back(h, keep_alive.emplace_back(std::move(unwrapped)));
             } catch (...) {
                 parsed.emplace_back(h, c);
             }
@@ -138,20 +259,37 @@ std::vector<std::string> ConfigBase::_merge(
     //   - element 2 is the numeric sequence number of the message, starting from 0.
     //   - element 3 is the total number of messages in the sequence.
     //   - element 4 is a chunk of the data.
-    for (size_t ci = 0; ci < configs.size(); ci++) {
-        auto& [hash, conf] = configs[ci];
-        bool decrypted = false;
-        for (size_t i = 0; !decrypted && i < _keys.size(); i++) {
-            try {
-                plaintexts.emplace_back(hash, decrypt(conf, key(i), encryption_domain()));
-                decrypted = true;
-            } catch (const decrypt_error&) {
+
+    // We try each key in turn against all the messages that haven't yet been decrypted, so that
+    // the decryption keys for the messages can be derived together.
+    std::vector<std::optional<ustring>> decrypted(configs.size());
+    std::vector<size_t> undecrypted(configs.size());
+    std::iota(undecrypted.begin(), undecrypted.end(), 0);
+    for (size_t i = 0; !undecrypted.empty() && i < _keys.size(); i++) {
+        std::vector<ustring_view> confs;
+        confs.reserve(undecrypted.size());
+        for (auto ci : undecrypted)
+            confs.push_back(configs[ci].second);
+        auto results = decrypt_multi(confs, key(i), encryption_domain());
+
+        std::vector<size_t> still_undecrypted;
+        for (size_t j = 0; j < results.size(); j++) {
+            auto ci = undecrypted[j];
+            if (results[j]) {
+                decrypted[ci] = std::move(results[j]);
+            } else {
                 log(LogLevel::debug,
                     "Failed to decrypt message " + std::to_string(ci) + " using key " +
                             std::to_string(i));
+                still_undecrypted.push_back(ci);
             }
         }
-        if (!decrypted)
+        undecrypted = std::move(still_undecrypted);
+    }
+    for (size_t ci = 0; ci < configs.size(); ci++) {
+        if (decrypted[ci])
+            plaintexts.emplace_back(configs[ci].first, std::move(*decrypted[ci]));
+        else
             log(LogLevel::warning, "Failed to decrypt message " + std::to_string(ci));
     }
     log(LogLevel::debug,
@@ -199,6 +337,7 @@ std::vector<std::string> ConfigBase::_merge(
     }
 
     std::set<size_t> bad_confs;
+    bool missing_base = false;
 
     auto new_conf = make_config_message(
             _state == ConfigState::Dirty,
@@ -210,6 +349,8 @@ std::vector<std::string> ConfigBase::_merge(
                 log(LogLevel::warning, e.what());
                 assert(i > 0);  // i == 0 means we can't deserialize our own serialization
                 bad_confs.insert(i);
+                if (dynamic_cast<const missing_delta_base*>(&e))
+                    missing_base = true;
             });
 
     // All the given config msgs are stale except for:
@@ -217,6 +358,8 @@ std::vector<std::string> ConfigBase::_merge(
     //   might be our current config, or might be one single one of the new incoming messages).
     // - confs that failed to parse (we can't understand them, so leave them behind as they may be
     //   some future message).
+    _needs_full_message = missing_base;
+
     int superconf = new_conf->unmerged_index();  // -1 if we had to merge
     for (int i = 0; i < all_hashes.size(); i++) {
         if (i != superconf && !bad_confs.count(i) && !all_hashes[i].empty())
@@ -234,6 +377,7 @@ std::vector<std::string> ConfigBase::_merge(
             } else {
                 _config = std::move(new_conf);
             }
+            _data_version++;
             set_state(ConfigState::Dirty);
         } else if (
                 _state == ConfigState::Dirty && new_conf->unmerged_index() == 0 &&
@@ -244,7 +388,26 @@ std::vector<std::string> ConfigBase::_merge(
             // seqno increment.
             /* do nothing */
         } else {
+            // If the new config was reconstructed from a delta message then we have to keep the
+            // messages it depends on (which may include our current config and the chain it
+            // depends on); anything else in our current delta chain is now obsolete.
+            std::vector<std::string> chain;
+            for (int i : new_conf->delta_chain()) {
+                if (i == 0 && !mine.empty()) {
+                    chain = _delta_chain;
+                    if (!_curr_hash.empty())
+                        chain.push_back(_curr_hash);
+                } else {
+                    chain.emplace_back(all_hashes[i]);
+                }
+            }
+            for (auto& h : _delta_chain)
+                if (std::find(chain.begin(), chain.end(), h) == chain.end())
+                    _old_hashes.insert(std::move(h));
+            _delta_chain = std::move(chain);
+
             _config = std::move(new_conf);
+            _data_version++;
             assert(((old_seqno == 0 && mine.empty()) || _config->unmerged_index() >= 1) &&
                    _config->unmerged_index() < all_hashes.size());
             set_state(ConfigState::Clean);
@@ -267,8 +430,10 @@ std::vector<std::string> ConfigBase::_merge(
 
 std::vector<std::string> ConfigBase::current_hashes() const {
     std::vector<std::string> hashes;
-    if (!_curr_hash.empty())
+    if (!_curr_hash.empty()) {
+        hashes = _delta_chain;
         hashes.push_back(_curr_hash);
+    }
     return hashes;
 }
 
@@ -276,16 +441,25 @@ bool ConfigBase::needs_push() const {
     return !is_clean();
 }
 
-// Tries to compresses the message; if the compressed version (including the 'z' prefix tag) is
-// smaller than the source message then we modify `msg` to contain the 'z'-prefixed compressed
-// message, otherwise we leave it as-is.
-void compress_message(ustring& msg, int level) {
+// Tries to compress the message into the reusable compression buffer; if the compressed version
+// (including the 'z' prefix tag) is smaller than the source message then we return a view of the
+// 'z'-prefixed compressed message (valid until the next compression on this thread), otherwise we
+// return `msg` itself.
+static ustring_view compress_view(ustring_view msg, int level) {
     if (!level)
-        return;
+        return msg;
     // "z" is our zstd compression marker prefix byte
-    ustring compressed = zstd_compress(msg, level, to_unsigned_sv("z"sv));
-    if (compressed.size() < msg.size())
-        msg = std::move(compressed);
+    if (auto compressed = zstd_compress_scratch(msg, level, to_unsigned_sv("z"sv));
+        compressed.size() < msg.size())
+        return compressed;
+    return msg;
+}
+
+// Same as `compress_view`, but replaces `msg` with the compressed message if it is smaller,
+// otherwise leaves it as-is.
+void compress_message(ustring& msg, int level) {
+    if (auto compressed = compress_view(msg, level); compressed.data() != msg.data())
+        msg = compressed;
 }
 
 std::tuple<seqno_t, ustring, std::vector<std::string>> ConfigBase::push() {
@@ -294,14 +468,37 @@ std::tuple<seqno_t, ustring, std::vector<std::string>> ConfigBase::push() {
 
     auto s = _config->seqno();
 
-    std::tuple<seqno_t, ustring, std::vector<std::string>> ret{s, _config->serialize(), {}};
+    std::tuple<seqno_t, ustring, std::vector<std::string>> ret{s, ustring{}, {}};
 
     auto& [seqno, msg, obs] = ret;
-    if (auto lvl = compression_level())
-        compress_message(msg, *lvl);
 
-    pad_message(msg);  // Prefix pad with nulls
-    encrypt_inplace(msg, key(), encryption_domain());
+    // Push a delta rather than the full config if delta pushes are enabled, the current config
+    // was incremented from a known, pushed message, and the delta chain isn't already too long.
+    MutableConfigMessage* delta = nullptr;
+    if (_delta_snapshot_interval > 1 && !_delta_base_hash.empty() && !_needs_full_message &&
+        !is_clean()) {
+        auto* mut = dynamic_cast<MutableConfigMessage*>(_config.get());
+        bool base_in_chain = !_delta_chain.empty() && _delta_chain.back() == _delta_base_hash;
+        if (mut && mut->delta_base() && !mut->signer && !mut->verifier &&
+            _delta_chain.size() + (base_in_chain ? 0 : 1) <
+                    static_cast<size_t>(_delta_snapshot_interval))
+            delta = mut;
+    }
+
+    auto lvl = compression_level();
+    size_t serialized_size = 0;
+    auto write = [&](ustring_view data) {
+        serialized_size = data.size();
+        // Compress into a reusable buffer (if compressing and it helps), then write directly into
+        // a single, final-sized buffer that is prefix-padded with nulls and encrypted in place.
+        if (lvl)
+            data = compress_view(data, *lvl);
+        msg = encrypt_padded(data, key(), encryption_domain());
+    };
+    if (delta)
+        delta->serialize_delta(write);
+    else
+        _config->serialize_view(write);
 
     if (accepts_protobuf() && !_keys.empty())
         msg = protos::wrap_config(
@@ -310,20 +507,56 @@ std::tuple<seqno_t, ustring, std::vector<std::string>> ConfigBase::push() {
                 s,
                 storage_namespace());
 
+    _last_push_size = {serialized_size, delta ? 0 : _config->lagged_diffs_bytes(), msg.size()};
+    log(LogLevel::debug,
+        "Pushing seqno " + std::to_string(s) + ": " + std::to_string(serialized_size) +
+                " bytes serialized (" + std::to_string(_last_push_size.lagged_diffs) +
+                " bytes of lagged diffs), " + std::to_string(msg.size()) + " bytes pushed");
+
     if (msg.size() > MAX_MESSAGE_SIZE)
         throw std::length_error{"Config data is too large"};
 
+    if (delta) {
+        if (_delta_chain.empty() || _delta_chain.back() != _delta_base_hash)
+            _delta_chain.push_back(_delta_base_hash);
+    } else if (is_dirty()) {
+        // A new full message replaces everything in the delta chain
+        for (auto& h : _delta_chain)
+            _old_hashes.insert(std::move(h));
+        _delta_chain.clear();
+    }
+
     if (is_dirty())
         set_state(ConfigState::Waiting);
 
     if (!is_readonly())
         for (auto& old : _old_hashes)
-            obs.push_back(std::move(old));
+            if (std::find(_delta_chain.begin(), _delta_chain.end(), old) == _delta_chain.end())
+                obs.push_back(std::move(old));
     _old_hashes.clear();
 
     return ret;
 }
 
+MemoryUsage ConfigBase::memory_usage() const {
+    MemoryUsage usage;
+    _config->add_memory_usage(usage);
+
+    usage.hashes += heap_usage(_curr_hash) + heap_usage(_delta_base_hash) +
+                    heap_usage(_old_hashes) + heap_usage(_seen_hashes) +
+                    _delta_chain.capacity() * sizeof(std::string) +
+                    _seen_hashes_order.size() * sizeof(std::string);
+    for (const auto& h : _delta_chain)
+        usage.hashes += heap_usage(h);
+    for (const auto& h : _seen_hashes_order)
+        usage.hashes += heap_usage(h);
+
+    usage.keys += _keys.capacity() * sizeof(Key) + _unwrap_keys.size() + _sign_sk.size();
+
+    usage.other += sizeof(ConfigBase);
+    return usage;
+}
+
 void ConfigBase::confirm_pushed(seqno_t seqno, std::string msg_hash) {
     // Make sure seqno hasn't changed; if it has then that means we set some other data *after* the
     // caller got the last data to push, and so we don't care about this confirmation.
@@ -350,10 +583,17 @@ ustring ConfigBase::make_dump() const {
     oxenc::bt_dict_producer d;
     d.append("!", static_cast<int>(_state));
     d.append("$", data_sv);
+
+    if (!_delta_chain.empty())
+        d.append_list("%").append(_delta_chain.begin(), _delta_chain.end());
+
     d.append("(", _curr_hash);
 
     d.append_list(")").append(_old_hashes.begin(), _old_hashes.end());
 
+    if (!_seen_hashes_order.empty())
+        d.append_list("*").append(_seen_hashes_order.begin(), _seen_hashes_order.end());
+
     if (auto extra = extra_data(); !extra.empty())
         d.append_bt("+", std::move(extra));
 
@@ -417,6 +657,10 @@ void ConfigBase::init_from_dump(std::string_view dump) {
                 config_lags(),
                 /*trust_signature=*/true);
 
+    if (d.skip_until("%"))
+        for (auto chain = d.consume_list_consumer(); !chain.is_finished();)
+            _delta_chain.push_back(chain.consume_string());
+
     if (d.skip_until("(")) {
         _curr_hash = d.consume_string();
         if (!d.skip_until(")"))
@@ -425,6 +669,13 @@ void ConfigBase::init_from_dump(std::string_view dump) {
             _old_hashes.insert(old.consume_string());
     }
 
+    if (d.skip_until("*")) {
+        std::vector<std::string> seen;
+        for (auto l = d.consume_list_consumer(); !l.is_finished();)
+            seen.push_back(l.consume_string());
+        remember_merged(seen);
+    }
+
     if (d.skip_until("+"))
         if (auto extra = d.consume_dict(); !extra.empty())
             load_extra_data(std::move(extra));
@@ -652,6 +903,34 @@ LIBSESSION_EXPORT bool config_needs_push(const config_object* conf) {
     return unbox(conf)->needs_push();
 }
 
+LIBSESSION_EXPORT void config_set_delta_snapshot_interval(config_object* conf, int interval) {
+    unbox(conf)->set_delta_snapshot_interval(interval);
+}
+
+LIBSESSION_EXPORT bool config_needs_full_message(const config_object* conf) {
+    return unbox(conf)->needs_full_message();
+}
+
+LIBSESSION_EXPORT void config_set_lagged_diff_budget(config_object* conf, size_t bytes) {
+    unbox(conf)->set_lagged_diff_budget(bytes);
+}
+
+LIBSESSION_EXPORT void config_last_push_size(
+        const config_object* conf, size_t* serialized, size_t* lagged_diffs, size_t* pushed) {
+    const auto& size = unbox(conf)->last_push_size();
+    if (serialized)
+        *serialized = size.serialized;
+    if (lagged_diffs)
+        *lagged_diffs = size.lagged_diffs;
+    if (pushed)
+        *pushed = size.pushed;
+}
+
+LIBSESSION_EXPORT void config_get_memory_usage(
+        const config_object* conf, config_memory_usage* usage) {
+    copy_memory_usage(unbox(conf)->memory_usage(), *usage);
+}
+
 LIBSESSION_EXPORT config_push_data* config_push(config_object* conf) {
     auto& config = *unbox(conf);
     auto [seqno, data, obs] = config.push();
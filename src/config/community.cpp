@@ -1,7 +1,5 @@
 #include "session/config/community.hpp"
 
-#include <oxenc/hex.h>
-
 #include <charconv>
 #include <optional>
 #include <session/types.hpp>
@@ -13,6 +11,7 @@
 #include "oxenc/base32z.h"
 #include "oxenc/base64.h"
 #include "session/config/community.h"
+#include "session/encoding.hpp"
 #include "session/export.h"
 #include "session/util.hpp"
 
@@ -56,7 +55,7 @@ void community::set_pubkey(std::string_view pubkey) {
 
 std::string community::pubkey_hex() const {
     const auto& pk = pubkey();
-    return oxenc::to_hex(pk.begin(), pk.end());
+    return encoding::to_hex(pk);
 }
 
 std::string community::pubkey_b32z() const {
@@ -66,7 +65,7 @@ std::string community::pubkey_b32z() const {
 
 std::string community::pubkey_b64() const {
     const auto& pk = pubkey();
-    return oxenc::to_base64(pk.begin(), pk.end());
+    return encoding::to_base64(pk);
 }
 
 void community::set_room(std::string_view room) {
@@ -84,7 +83,7 @@ std::string community::full_url(
     url += '/';
     url += room;
     url += qs_pubkey;
-    url += oxenc::to_hex(pubkey);
+    url += encoding::to_hex(pubkey);
     return url;
 }
 
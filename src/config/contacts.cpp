@@ -1,6 +1,5 @@
 #include "session/config/contacts.hpp"
 
-#include <oxenc/hex.h>
 #include <sodium/crypto_generichash_blake2b.h>
 
 #include <variant>
@@ -8,6 +7,7 @@
 #include "internal.hpp"
 #include "session/config/contacts.h"
 #include "session/config/error.h"
+#include "session/encoding.hpp"
 #include "session/export.h"
 #include "session/types.hpp"
 #include "session/util.hpp"
@@ -32,7 +32,7 @@ static_assert(CONVO_NOTIFY_DISABLED == static_cast<int>(notify_mode::disabled));
 static_assert(CONVO_NOTIFY_MENTIONS_ONLY == static_cast<int>(notify_mode::mentions_only));
 
 LIBSESSION_C_API bool session_id_is_valid(const char* session_id) {
-    return std::strlen(session_id) == 66 && oxenc::is_hex(session_id, session_id + 66);
+    return std::strlen(session_id) == 66 && session::encoding::is_hex({session_id, 66});
 }
 
 contact_info::contact_info(std::string sid) : session_id{std::move(sid)} {
@@ -71,54 +71,71 @@ LIBSESSION_C_API int contacts_init(
 }
 
 void contact_info::load(const dict& info_dict) {
-    name = maybe_string(info_dict, "n").value_or("");
-    nickname = maybe_string(info_dict, "N").value_or("");
-
-    auto url = maybe_string(info_dict, "p");
-    auto key = maybe_ustring(info_dict, "q");
-    if (url && key && !url->empty() && key->size() == 32) {
-        profile_picture.url = std::move(*url);
-        profile_picture.key = std::move(*key);
-    } else {
-        profile_picture.clear();
-    }
-
-    approved = maybe_int(info_dict, "a").value_or(0);
-    approved_me = maybe_int(info_dict, "A").value_or(0);
-    blocked = maybe_int(info_dict, "b").value_or(0);
-
-    priority = maybe_int(info_dict, "+").value_or(0);
-
-    int notify = maybe_int(info_dict, "@").value_or(0);
-    if (notify >= 0 && notify <= 3) {
-        notifications = static_cast<notify_mode>(notify);
-        if (notifications == notify_mode::mentions_only)
-            notifications = notify_mode::all;
-    } else {
-        notifications = notify_mode::defaulted;
-    }
-    mute_until = maybe_int(info_dict, "!").value_or(0);
-
-    int exp_mode_ = maybe_int(info_dict, "e").value_or(0);
-    if (exp_mode_ >= static_cast<int>(expiration_mode::none) &&
-        exp_mode_ <= static_cast<int>(expiration_mode::after_read))
-        exp_mode = static_cast<expiration_mode>(exp_mode_);
-    else
-        exp_mode = expiration_mode::none;
-
-    if (exp_mode == expiration_mode::none)
-        exp_timer = 0s;
-    else {
-        int secs = maybe_int(info_dict, "E").value_or(0);
-        if (secs <= 0) {
-            exp_mode = expiration_mode::none;
-            exp_timer = 0s;
-        } else {
-            exp_timer = std::chrono::seconds{secs};
-        }
-    }
-
-    created = maybe_int(info_dict, "j").value_or(0);
+    static constexpr entry_field<contact_info> fields[] = {
+            {"!", [](contact_info& c, const dict_value* v) { c.mute_until = field_int(v); }},
+            {"+", [](contact_info& c, const dict_value* v) { c.priority = field_int(v); }},
+            {"@",
+             [](contact_info& c, const dict_value* v) {
+                 auto notify = field_int(v);
+                 if (notify >= 0 && notify <= 3) {
+                     c.notifications = static_cast<notify_mode>(notify);
+                     if (c.notifications == notify_mode::mentions_only)
+                         c.notifications = notify_mode::all;
+                 } else {
+                     c.notifications = notify_mode::defaulted;
+                 }
+             }},
+            {"A", [](contact_info& c, const dict_value* v) { c.approved_me = field_int(v); }},
+            // Validated together with the mode ("e") below:
+            {"E",
+             [](contact_info& c, const dict_value* v) {
+                 c.exp_timer = std::chrono::seconds{field_int(v)};
+             }},
+            {"N",
+             [](contact_info& c, const dict_value* v) {
+                 auto* n = field_str(v);
+                 c.nickname = n ? *n : "";
+             }},
+            {"a", [](contact_info& c, const dict_value* v) { c.approved = field_int(v); }},
+            {"b", [](contact_info& c, const dict_value* v) { c.blocked = field_int(v); }},
+            {"e",
+             [](contact_info& c, const dict_value* v) {
+                 auto mode = field_int(v);
+                 if (mode >= static_cast<int>(expiration_mode::none) &&
+                     mode <= static_cast<int>(expiration_mode::after_read) &&
+                     c.exp_timer > 0s) {
+                     c.exp_mode = static_cast<expiration_mode>(mode);
+                 } else {
+                     c.exp_mode = expiration_mode::none;
+                 }
+                 if (c.exp_mode == expiration_mode::none)
+                     c.exp_timer = 0s;
+             }},
+            {"j", [](contact_info& c, const dict_value* v) { c.created = field_int(v); }},
+            {"n",
+             [](contact_info& c, const dict_value* v) {
+                 auto* n = field_str(v);
+                 c.name = n ? *n : "";
+             }},
+            // Validated together with the key ("q") below:
+            {"p",
+             [](contact_info& c, const dict_value* v) {
+                 auto* url = field_str(v);
+                 c.profile_picture.url = url ? *url : "";
+             }},
+            {"q",
+             [](contact_info& c, const dict_value* v) {
+                 auto* key = field_str(v);
+                 if (key && key->size() == 32 && !c.profile_picture.url.empty())
+                     c.profile_picture.key.assign(
+                             reinterpret_cast<const unsigned char*>(key->data()), key->size());
+                 else
+                     c.profile_picture.clear();
+             }},
+    };
+    static_assert(fields_sorted(fields));
+
+    load_fields(*this, info_dict, fields);
 }
 
 void contact_info::into(contacts_contact& c) const {
@@ -350,7 +367,7 @@ void Contacts::iterator::_load_info() {
     while (_it != _contacts->end()) {
         if (_it->first.size() == 33) {
             if (auto* info_dict = std::get_if<dict>(&_it->second)) {
-                _val = std::make_shared<contact_info>(oxenc::to_hex(_it->first));
+                _val = std::make_shared<contact_info>(encoding::to_hex(_it->first));
                 _val->load(*info_dict);
                 return;
             }
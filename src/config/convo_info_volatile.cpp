@@ -2,7 +2,6 @@
 
 #include <oxenc/base32z.h>
 #include <oxenc/base64.h>
-#include <oxenc/hex.h>
 #include <oxenc/variant.h>
 #include <sodium/crypto_generichash_blake2b.h>
 
@@ -14,6 +13,7 @@
 #include "internal.hpp"
 #include "session/config/convo_info_volatile.h"
 #include "session/config/error.h"
+#include "session/encoding.hpp"
 #include "session/export.h"
 #include "session/types.hpp"
 #include "session/util.hpp"
@@ -85,8 +85,13 @@ namespace convo {
     }
 
     void base::load(const dict& info_dict) {
-        last_read = maybe_int(info_dict, "r").value_or(0);
-        unread = (bool)maybe_int(info_dict, "u").value_or(0);
+        static constexpr entry_field<base> fields[] = {
+                {"r", [](base& c, const dict_value* v) { c.last_read = field_int(v); }},
+                {"u", [](base& c, const dict_value* v) { c.unread = field_int(v); }},
+        };
+        static_assert(fields_sorted(fields));
+
+        load_fields(*this, info_dict, fields);
     }
 
 }  // namespace convo
@@ -412,7 +417,7 @@ class val_loader {
 
             if (k.size() == 33 && k[0] == prefix) {
                 if (auto* info_dict = std::get_if<dict>(&v)) {
-                    val = std::make_shared<convo::any>(ConvoType{oxenc::to_hex(k)});
+                    val = std::make_shared<convo::any>(ConvoType{encoding::to_hex(k)});
                     std::get<ConvoType>(*val).load(*info_dict);
                     return true;
                 }
@@ -6,8 +6,11 @@
 
 #include <array>
 #include <cassert>
+#include <cstring>
 
 #include "session/export.h"
+#include "session/hash.hpp"
+#include "session/sodium_array.hpp"
 
 using namespace std::literals;
 
@@ -30,12 +33,29 @@ static constexpr size_t DOMAIN_MAX_SIZE = 24;
 static constexpr auto NONCE_KEY_PREFIX = "libsessionutil-config-encrypted-"sv;
 static_assert(NONCE_KEY_PREFIX.size() + DOMAIN_MAX_SIZE < crypto_generichash_blake2b_KEYBYTES_MAX);
 
-static std::array<unsigned char, crypto_aead_xchacha20poly1305_ietf_KEYBYTES> make_encrypt_key(
-        ustring_view key_base, uint64_t message_size, std::string_view domain) {
+static void check_key_args(ustring_view key_base, std::string_view domain) {
     if (key_base.size() != 32)
         throw std::invalid_argument{"encrypt called with key_base != 32 bytes"};
     if (domain.size() < 1 || domain.size() > DOMAIN_MAX_SIZE)
         throw std::invalid_argument{"encrypt called with domain size not in [1, 24]"};
+}
+
+// Maximum size of the value hashed to produce an encryption key
+static constexpr size_t KEY_HASH_INPUT_MAX = 32 + 8 + DOMAIN_MAX_SIZE;
+
+// Writes the value that gets hashed to produce the encryption key (key_base || size || domain)
+// into `out`, which must have room for KEY_HASH_INPUT_MAX bytes.  Returns the length.
+static size_t encrypt_key_hash_input(
+        unsigned char* out, ustring_view key_base, uint64_t message_size, std::string_view domain) {
+    std::memcpy(out, key_base.data(), key_base.size());
+    oxenc::write_host_as_big(message_size, out + key_base.size());
+    std::memcpy(out + key_base.size() + 8, domain.data(), domain.size());
+    return key_base.size() + 8 + domain.size();
+}
+
+static std::array<unsigned char, crypto_aead_xchacha20poly1305_ietf_KEYBYTES> make_encrypt_key(
+        ustring_view key_base, uint64_t message_size, std::string_view domain) {
+    check_key_args(key_base, domain);
 
     // We hash the key because we're using a deterministic nonce: the `key_base` value is expected
     // to be a long-term value for which nonce reuse (via hash collision) would be bad: by
@@ -43,14 +63,9 @@ static std::array<unsigned char, crypto_aead_xchacha20poly1305_ietf_KEYBYTES> ma
     // nonce reuse concern so that you would not only have to hash collide but also have it happen
     // on messages of identical sizes and identical domain.
     std::array<unsigned char, crypto_aead_xchacha20poly1305_ietf_KEYBYTES> key{0};
-    crypto_generichash_blake2b_state state;
-    crypto_generichash_blake2b_init(&state, nullptr, 0, key.size());
-    crypto_generichash_blake2b_update(&state, key_base.data(), key_base.size());
-    oxenc::host_to_big_inplace(message_size);
-    crypto_generichash_blake2b_update(
-            &state, reinterpret_cast<const unsigned char*>(&message_size), sizeof(message_size));
-    crypto_generichash_blake2b_update(&state, to_unsigned(domain.data()), domain.size());
-    crypto_generichash_blake2b_final(&state, key.data(), key.size());
+    sodium_cleared<std::array<unsigned char, KEY_HASH_INPUT_MAX>> input;
+    auto len = encrypt_key_hash_input(input.data(), key_base, message_size, domain);
+    crypto_generichash_blake2b(key.data(), key.size(), input.data(), len, nullptr, 0);
     return key;
 }
 
@@ -63,8 +78,15 @@ ustring encrypt(ustring_view message, ustring_view key_base, std::string_view do
     encrypt_inplace(msg, key_base, domain);
     return msg;
 }
-void encrypt_inplace(ustring& message, ustring_view key_base, std::string_view domain) {
-    auto key = make_encrypt_key(key_base, message.size(), domain);
+// Encrypts the `plaintext_len` bytes at `message` in place, writing the encrypted data followed by
+// the nonce; `message` must have room for an additional ENCRYPT_DATA_OVERHEAD bytes beyond the
+// plaintext.
+static void encrypt_buffer(
+        unsigned char* message,
+        size_t plaintext_len,
+        ustring_view key_base,
+        std::string_view domain) {
+    auto key = make_encrypt_key(key_base, plaintext_len, domain);
 
     std::string nonce_key{NONCE_KEY_PREFIX};
     nonce_key += domain;
@@ -73,21 +95,16 @@ void encrypt_inplace(ustring& message, ustring_view key_base, std::string_view d
     crypto_generichash_blake2b(
             nonce.data(),
             nonce.size(),
-            message.data(),
-            message.size(),
+            message,
+            plaintext_len,
             to_unsigned(nonce_key.data()),
             nonce_key.size());
 
-    size_t plaintext_len = message.size();
-    message.resize(
-            plaintext_len + crypto_aead_xchacha20poly1305_ietf_ABYTES +
-            crypto_aead_xchacha20poly1305_ietf_NPUBBYTES);
-
     unsigned long long outlen = 0;
     crypto_aead_xchacha20poly1305_ietf_encrypt(
-            message.data(),
+            message,
             &outlen,
-            message.data(),
+            message,
             plaintext_len,
             nullptr,
             0,
@@ -95,8 +112,27 @@ void encrypt_inplace(ustring& message, ustring_view key_base, std::string_view d
             nonce.data(),
             key.data());
 
-    assert(outlen == message.size() - crypto_aead_xchacha20poly1305_ietf_NPUBBYTES);
-    std::memcpy(message.data() + outlen, nonce.data(), nonce.size());
+    assert(outlen == plaintext_len + crypto_aead_xchacha20poly1305_ietf_ABYTES);
+    std::memcpy(message + outlen, nonce.data(), nonce.size());
+}
+
+void encrypt_inplace(ustring& message, ustring_view key_base, std::string_view domain) {
+    check_key_args(key_base, domain);
+    size_t plaintext_len = message.size();
+    message.resize(
+            plaintext_len + crypto_aead_xchacha20poly1305_ietf_ABYTES +
+            crypto_aead_xchacha20poly1305_ietf_NPUBBYTES);
+    encrypt_buffer(message.data(), plaintext_len, key_base, domain);
+}
+
+ustring encrypt_padded(ustring_view data, ustring_view key_base, std::string_view domain) {
+    check_key_args(key_base, domain);
+    size_t padded = padded_size(data.size());
+    // The (null) prefix padding comes from the zero-initialization:
+    ustring message(padded + ENCRYPT_DATA_OVERHEAD, 0);
+    std::memcpy(message.data() + padded - data.size(), data.data(), data.size());
+    encrypt_buffer(message.data(), padded, key_base, domain);
+    return message;
 }
 
 static_assert(
@@ -135,6 +171,57 @@ void decrypt_inplace(ustring& ciphertext, ustring_view key_base, std::string_vie
     ciphertext.resize(mlen_wrote);
 }
 
+std::vector<std::optional<ustring>> decrypt_multi(
+        const std::vector<ustring_view>& ciphertexts,
+        ustring_view key_base,
+        std::string_view domain) {
+    check_key_args(key_base, domain);
+
+    constexpr size_t OVERHEAD = crypto_aead_xchacha20poly1305_ietf_ABYTES +
+                                crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+
+    std::vector<std::optional<ustring>> result(ciphertexts.size());
+
+    // Derive all the keys at once (for the ciphertexts long enough to be possibly valid):
+    std::vector<size_t> indices;
+    std::vector<ustring_view> to_hash;
+    sodium_vector<unsigned char> inputs(KEY_HASH_INPUT_MAX * ciphertexts.size());
+    for (size_t i = 0; i < ciphertexts.size(); i++) {
+        if (ciphertexts[i].size() < OVERHEAD)
+            continue;
+        auto* in = inputs.data() + KEY_HASH_INPUT_MAX * i;
+        auto len = encrypt_key_hash_input(in, key_base, ciphertexts[i].size() - OVERHEAD, domain);
+        indices.push_back(i);
+        to_hash.emplace_back(in, len);
+    }
+    sodium_vector<unsigned char> keys(crypto_aead_xchacha20poly1305_ietf_KEYBYTES * to_hash.size());
+    hash::hash_multi(keys.data(), crypto_aead_xchacha20poly1305_ietf_KEYBYTES, to_hash);
+
+    for (size_t k = 0; k < indices.size(); k++) {
+        auto ciphertext = ciphertexts[indices[k]];
+        auto nonce = ciphertext.substr(
+                ciphertext.size() - crypto_aead_xchacha20poly1305_ietf_NPUBBYTES);
+        auto& plain = result[indices[k]].emplace();
+        plain.resize(ciphertext.size() - OVERHEAD);
+        unsigned long long mlen_wrote = 0;
+        if (0 != crypto_aead_xchacha20poly1305_ietf_decrypt(
+                         plain.data(),
+                         &mlen_wrote,
+                         nullptr,
+                         ciphertext.data(),
+                         ciphertext.size() - crypto_aead_xchacha20poly1305_ietf_NPUBBYTES,
+                         nullptr,
+                         0,
+                         nonce.data(),
+                         keys.data() + crypto_aead_xchacha20poly1305_ietf_KEYBYTES * k))
+            result[indices[k]].reset();
+        else
+            assert(mlen_wrote == plain.size());
+    }
+
+    return result;
+}
+
 void pad_message(ustring& data, size_t overhead) {
     size_t target_size = padded_size(data.size(), overhead);
     if (target_size > data.size())
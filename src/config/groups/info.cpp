@@ -1,6 +1,5 @@
 #include "session/config/groups/info.hpp"
 
-#include <oxenc/hex.h>
 #include <sodium/crypto_generichash_blake2b.h>
 
 #include <variant>
@@ -8,6 +7,7 @@
 #include "../internal.hpp"
 #include "session/config/error.h"
 #include "session/config/groups/info.h"
+#include "session/encoding.hpp"
 #include "session/export.h"
 #include "session/types.hpp"
 #include "session/util.hpp"
@@ -21,7 +21,7 @@ Info::Info(
         std::optional<ustring_view> ed25519_secretkey,
         std::optional<ustring_view> dumped) :
         ConfigBase{dumped, ed25519_pubkey, ed25519_secretkey},
-        id{"03" + oxenc::to_hex(ed25519_pubkey.begin(), ed25519_pubkey.end())} {}
+        id{encoding::to_prefixed_hex(0x03, ed25519_pubkey)} {}
 
 std::optional<std::string_view> Info::get_name() const {
     if (auto* s = data["n"].string(); s && !s->empty())
@@ -12,15 +12,24 @@
 #include <sodium/randombytes.h>
 #include <sodium/utils.h>
 
+#include <algorithm>
 #include <chrono>
+#include <exception>
 #include <iterator>
+#include <mutex>
+#include <shared_mutex>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "../internal.hpp"
 #include "session/config/groups/info.hpp"
 #include "session/config/groups/keys.h"
 #include "session/config/groups/members.hpp"
+#include "session/ed25519.hpp"
+#include "session/encoding.hpp"
+#include "session/hash.hpp"
 #include "session/multi_encrypt.hpp"
 #include "session/xed25519.hpp"
 
@@ -56,24 +65,44 @@ Keys::Keys(
 
     if (dumped) {
         load_dump(*dumped);
-        auto key_list = group_keys();
+        auto key_list = group_keys_impl();
         members.replace_keys(key_list, /*dirty=*/false);
         info.replace_keys(key_list, /*dirty=*/false);
     }
 }
 
 bool Keys::needs_dump() const {
+    std::shared_lock lock{mutex_};
     return needs_dump_;
 }
 
+MemoryUsage Keys::memory_usage() const {
+    std::shared_lock lock{mutex_};
+    MemoryUsage usage;
+    usage.keys = keys_.capacity() * sizeof(key_info) + user_ed25519_sk.size() + _sign_sk.size();
+    usage.hashes =
+            active_msgs_.size() * (TREE_NODE_OVERHEAD + sizeof(decltype(active_msgs_)::value_type));
+    for (const auto& [gen, hashes] : active_msgs_)
+        usage.hashes += heap_usage(hashes);
+    usage.pending = pending_key_config_.capacity();
+    usage.other = sizeof(Keys);
+    return usage;
+}
+
 ustring Keys::dump() {
-    auto dumped = make_dump();
+    std::unique_lock lock{mutex_};
+    auto dumped = make_dump_impl();
 
     needs_dump_ = false;
     return dumped;
 }
 
 ustring Keys::make_dump() const {
+    std::shared_lock lock{mutex_};
+    return make_dump_impl();
+}
+
+ustring Keys::make_dump_impl() const {
     oxenc::bt_dict_producer d;
     {
         auto active = d.append_list("active");
@@ -182,12 +211,18 @@ void Keys::load_dump(ustring_view dump) {
 }
 
 size_t Keys::size() const {
+    std::shared_lock lock{mutex_};
     return keys_.size() + !pending_key_config_.empty();
 }
 
 std::vector<ustring_view> Keys::group_keys() const {
+    std::shared_lock lock{mutex_};
+    return group_keys_impl();
+}
+
+std::vector<ustring_view> Keys::group_keys_impl() const {
     std::vector<ustring_view> ret;
-    ret.reserve(size());
+    ret.reserve(keys_.size() + !pending_key_config_.empty());
 
     if (!pending_key_config_.empty())
         ret.emplace_back(pending_key_.data(), 32);
@@ -199,6 +234,11 @@ std::vector<ustring_view> Keys::group_keys() const {
 }
 
 ustring_view Keys::group_enc_key() const {
+    std::shared_lock lock{mutex_};
+    return group_enc_key_impl();
+}
+
+ustring_view Keys::group_enc_key_impl() const {
     if (!pending_key_config_.empty())
         return {pending_key_.data(), 32};
     if (keys_.empty())
@@ -209,6 +249,7 @@ ustring_view Keys::group_enc_key() const {
 }
 
 void Keys::load_admin_key(ustring_view seed, Info& info, Members& members) {
+    std::unique_lock lock{mutex_};
     if (admin())
         return;
 
@@ -256,6 +297,8 @@ ustring_view Keys::rekey(Info& info, Members& members) {
         throw std::logic_error{
                 "Unable to issue a new group encryption key without the main group keys"};
 
+    std::unique_lock lock{mutex_};
+
     // For members we calculate the outer encryption key as H(aB || A || B).  But because we only
     // have `B` (the session id) as an x25519 pubkey, we do this in x25519 space, which means we
     // have to use the x25519 conversion of a/A rather than the group's ed25519 pubkey.
@@ -402,7 +445,7 @@ ustring_view Keys::rekey(Info& info, Members& members) {
     pending_key_config_.resize(conf.size());
     std::memcpy(pending_key_config_.data(), conf.data(), conf.size());
 
-    auto new_key_list = group_keys();
+    auto new_key_list = group_keys_impl();
     // We want to dirty the member/info lists so that they get re-encrypted and re-pushed with the
     // new key:
     members.replace_keys(new_key_list, /*dirty=*/true);
@@ -420,15 +463,26 @@ ustring Keys::sign(ustring_view data) const {
     return sig;
 }
 
-ustring Keys::key_supplement(const std::vector<std::string>& sids) const {
-    if (!admin())
-        throw std::logic_error{
-                "Unable to issue supplemental group encryption keys without the main group keys"};
-
-    if (keys_.empty())
-        throw std::logic_error{
-                "Unable to create supplemental keys: this object has no keys at all"};
+std::string Keys::supplement_keys() const {
+    oxenc::bt_list_producer supp;
+    for (auto& ki : keys_) {
+        auto d = supp.append_dict();
+        d.append("g", ki.generation);
+        d.append("k", from_unsigned_sv(ki.key));
+        d.append(
+                "t",
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                        ki.timestamp.time_since_epoch())
+                        .count());
+    }
+    return std::move(supp).str();
+}
 
+ustring Keys::make_key_supplement(
+        std::string_view supp_keys,
+        std::vector<std::string>::const_iterator sids_begin,
+        std::vector<std::string>::const_iterator sids_end,
+        unsigned threads) const {
     // For members we calculate the outer encryption key as H(aB || A || B).  But because we only
     // have `B` (the session id) as an x25519 pubkey, we do this in x25519 space, which means we
     // have to use the x25519 conversion of a/A rather than the group's ed25519 pubkey.
@@ -453,22 +507,6 @@ ustring Keys::key_supplement(const std::vector<std::string>& sids) const {
     // - H2(.) = 32-byte BLAKE2b keyed hash of the sodium group secret key seed (just the 32 byte,
     //           not the full 64 byte with the pubkey in the second half), key "SessionGroupKeySeed"
 
-    std::string supp_keys;
-    {
-        oxenc::bt_list_producer supp;
-        for (auto& ki : keys_) {
-            auto d = supp.append_dict();
-            d.append("g", ki.generation);
-            d.append("k", from_unsigned_sv(ki.key));
-            d.append(
-                    "t",
-                    std::chrono::duration_cast<std::chrono::milliseconds>(
-                            ki.timestamp.time_since_epoch())
-                            .count());
-        }
-        supp_keys = std::move(supp).str();
-    }
-
     std::array<unsigned char, 24> h1;
 
     crypto_generichash_blake2b_state st;
@@ -476,8 +514,8 @@ ustring Keys::key_supplement(const std::vector<std::string>& sids) const {
     crypto_generichash_blake2b_init(
             &st, enc_key_hash_key.data(), enc_key_hash_key.size(), h1.size());
 
-    for (const auto& sid : sids)
-        crypto_generichash_blake2b_update(&st, to_unsigned(sid.data()), sid.size());
+    for (auto it = sids_begin; it != sids_end; ++it)
+        crypto_generichash_blake2b_update(&st, to_unsigned(it->data()), it->size());
 
     crypto_generichash_blake2b_update(&st, to_unsigned(supp_keys.data()), supp_keys.size());
 
@@ -494,33 +532,77 @@ ustring Keys::key_supplement(const std::vector<std::string>& sids) const {
 
     {
         auto list = d.append_list("+");
-        std::vector<unsigned char> encrypted;
-        encrypted.resize(supp_keys.size() + crypto_aead_xchacha20poly1305_ietf_ABYTES);
-
-        size_t member_count = 0;
 
         std::vector<std::array<unsigned char, 32>> member_xpk_raw;
         std::vector<ustring_view> member_xpks;
-        member_xpk_raw.reserve(sids.size());
-        member_xpks.reserve(sids.size());
-        for (const auto& sid : sids) {
-            member_xpk_raw.push_back(session_id_pk(sid));
+        const auto count = static_cast<size_t>(std::distance(sids_begin, sids_end));
+        member_xpk_raw.reserve(count);
+        member_xpks.reserve(count);
+        for (auto it = sids_begin; it != sids_end; ++it) {
+            member_xpk_raw.push_back(session_id_pk(*it));
             member_xpks.emplace_back(member_xpk_raw.back().data(), member_xpk_raw.back().size());
         }
 
-        encrypt_for_multiple(
-                supp_keys,
-                member_xpks,
-                nonce,
-                to_sv(group_xsk),
-                to_sv(group_xpk),
-                enc_key_member_hash_key,
-                [&](ustring_view encrypted) {
-                    list.append(encrypted);
-                    member_count++;
-                },
-                true  // ignore invalid
-        );
+        // The per-member key derivation (an X25519 multiplication for each member) dominates the
+        // cost here, so for large member lists we split the members into contiguous slices that
+        // get encrypted in parallel; since each member's value is independent of the others the
+        // result is identical to encrypting them all on one thread.
+        constexpr size_t MIN_PER_THREAD = 32;
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        const size_t slices =
+                std::max<size_t>(1, std::min<size_t>(threads, count / MIN_PER_THREAD));
+
+        std::vector<std::vector<ustring>> encrypted(slices);
+        auto encrypt_slice = [&](size_t i) {
+            auto begin = member_xpks.begin() + count * i / slices;
+            auto end = member_xpks.begin() + count * (i + 1) / slices;
+            auto& out = encrypted[i];
+            out.reserve(end - begin);
+            encrypt_for_multiple(
+                    supp_keys,
+                    std::vector<ustring_view>(begin, end),
+                    nonce,
+                    to_sv(group_xsk),
+                    to_sv(group_xpk),
+                    enc_key_member_hash_key,
+                    [&out](ustring_view enc) { out.emplace_back(enc); },
+                    true  // ignore invalid
+            );
+        };
+
+        if (slices == 1) {
+            encrypt_slice(0);
+        } else {
+            std::vector<std::exception_ptr> errors(slices);
+            std::vector<std::thread> workers;
+            workers.reserve(slices - 1);
+            for (size_t i = 1; i < slices; i++)
+                workers.emplace_back([&, i] {
+                    try {
+                        encrypt_slice(i);
+                    } catch (...) {
+                        errors[i] = std::current_exception();
+                    }
+                });
+            try {
+                encrypt_slice(0);
+            } catch (...) {
+                errors[0] = std::current_exception();
+            }
+            for (auto& w : workers)
+                w.join();
+            for (auto& e : errors)
+                if (e)
+                    std::rethrow_exception(e);
+        }
+
+        size_t member_count = 0;
+        for (auto& slice : encrypted) {
+            for (auto& enc : slice)
+                list.append(ustring_view{enc});
+            member_count += slice.size();
+        }
 
         if (member_count == 0)
             throw std::runtime_error{
@@ -536,6 +618,65 @@ ustring Keys::key_supplement(const std::vector<std::string>& sids) const {
     return ustring{to_unsigned_sv(d.view())};
 }
 
+ustring Keys::key_supplement(const std::vector<std::string>& sids) const {
+    if (!admin())
+        throw std::logic_error{
+                "Unable to issue supplemental group encryption keys without the main group keys"};
+
+    std::shared_lock lock{mutex_};
+    if (keys_.empty())
+        throw std::logic_error{
+                "Unable to create supplemental keys: this object has no keys at all"};
+
+    return make_key_supplement(supplement_keys(), sids.begin(), sids.end(), 1);
+}
+
+std::vector<ustring> Keys::key_supplements(
+        const std::vector<std::string>& sids, size_t max_size, unsigned threads) const {
+    if (!admin())
+        throw std::logic_error{
+                "Unable to issue supplemental group encryption keys without the main group keys"};
+
+    std::shared_lock lock{mutex_};
+    if (keys_.empty())
+        throw std::logic_error{
+                "Unable to create supplemental keys: this object has no keys at all"};
+
+    std::vector<ustring> messages;
+    if (sids.empty())
+        return messages;
+
+    // The keys list is the same for every member (and every message), so only encode it once.
+    auto supp_keys = supplement_keys();
+
+    // Work out how many members fit into a message of `max_size`: each member adds one encrypted
+    // copy of the keys list; the rest of the message is fixed size:
+    //     d
+    //       1:# 24:(nonce)
+    //       1:+ l (members...) e
+    //       1:G i(gen)e
+    //       1:~ 64:(sig)
+    //     e
+    const size_t enc_size = supp_keys.size() + crypto_aead_xchacha20poly1305_ietf_ABYTES;
+    const size_t member_size = std::to_string(enc_size).size() + 1 + enc_size;
+    const size_t overhead = 1 + (3 + 3 + 24) + (3 + 2) +
+                            (3 + 2 + std::to_string(keys_.back().generation).size()) +
+                            (3 + 3 + 64) + 1;
+    if (max_size < overhead + member_size)
+        throw std::invalid_argument{
+                "Unable to create supplemental keys: the keys for a single member do not fit in "
+                "the maximum message size"};
+    const size_t per_message = (max_size - overhead) / member_size;
+
+    messages.reserve((sids.size() + per_message - 1) / per_message);
+    for (auto it = sids.begin(); it != sids.end();) {
+        auto end = it + std::min<size_t>(per_message, sids.end() - it);
+        messages.push_back(make_key_supplement(supp_keys, it, end, threads));
+        it = end;
+    }
+    return messages;
+}
+
 // Blinding factor for subaccounts: H(sessionid || groupid) mod L, where H is 64-byte blake2b, using
 // a hash key derived from the group's seed.
 std::array<unsigned char, 32> Keys::subaccount_blind_factor(
@@ -570,6 +711,24 @@ namespace {
         return SUBACC_FLAG_READ | (write ? SUBACC_FLAG_WRITE : 0) | (del ? SUBACC_FLAG_DEL : 0);
     }
 
+    // Returns true if the 4-byte subaccount prefix (network prefix, flags, 2 reserved bytes) is
+    // acceptable for a group (03-prefixed) subaccount with the given permission requirements.
+    bool subacc_prefix_ok(ustring_view prefix, bool write, bool del) {
+        if (prefix[0] != 0x03 && !(prefix[1] & SUBACC_FLAG_ANY_PREFIX))
+            return false;  // require either 03 prefix match, or the "any prefix" flag
+
+        if (!(prefix[1] & SUBACC_FLAG_READ))
+            return false;  // missing the read flag
+
+        if (write && !(prefix[1] & SUBACC_FLAG_WRITE))
+            return false;  // we require write, but it isn't set
+
+        if (del && !(prefix[1] & SUBACC_FLAG_DEL))
+            return false;  // we require delete, but it isn't set
+
+        return true;
+    }
+
 }  // namespace
 
 ustring Keys::swarm_make_subaccount(std::string_view session_id, bool write, bool del) const {
@@ -655,49 +814,56 @@ ustring Keys::swarm_subaccount_token(std::string_view session_id, bool write, bo
 
 Keys::swarm_auth Keys::swarm_subaccount_sign(
         ustring_view msg, ustring_view sign_val, bool binary) const {
-    if (sign_val.size() != 100)
-        throw std::logic_error{"Invalid signing value: size is wrong"};
+    return swarm_subaccount_signer(sign_val).sign(msg, binary);
+}
 
+Keys::subaccount_signer Keys::swarm_subaccount_signer(ustring_view sign_val) const {
     if (!_sign_pk)
         throw std::logic_error{"Unable to verify: group pubkey is not set (!?)"};
 
-    Keys::swarm_auth result;
-    auto& [token, sub_sig, sig] = result;
+    return subaccount_signer{
+            ustring_view{user_ed25519_sk.data(), user_ed25519_sk.size()}, sign_val};
+}
+
+Keys::subaccount_signer::subaccount_signer(ustring_view user_ed_sk, ustring_view sign_val) {
+    if (sign_val.size() != 100)
+        throw std::logic_error{"Invalid signing value: size is wrong"};
+    if (user_ed_sk.size() != 64)
+        throw std::logic_error{"Invalid user Ed25519 secret key: size is wrong"};
 
-    // (see above for variable/crypto notation)
+    // (see Keys::swarm_make_subaccount for variable/crypto notation)
 
     ustring_view k = sign_val.substr(4, 32);
 
-    // our token is the first 4 bytes of `sign_val` (flags, etc.), followed by kT which we have to
-    // compute:
-    token.resize(36);
-    std::memcpy(token.data(), sign_val.data(), 4);
-
     // T = |S|, i.e. we have to clear the sign bit from our pubkey
     std::array<unsigned char, 32> T;
-    crypto_sign_ed25519_sk_to_pk(T.data(), user_ed25519_sk.data());
+    crypto_sign_ed25519_sk_to_pk(T.data(), user_ed_sk.data());
     bool neg = T[31] & 0x80;
     T[31] &= 0x7f;
-    if (0 != crypto_scalarmult_ed25519_noclamp(to_unsigned(token.data() + 4), k.data(), T.data()))
+    if (0 != crypto_scalarmult_ed25519_noclamp(kT_.data(), k.data(), T.data()))
         throw std::runtime_error{"scalarmult failed: perhaps an invalid session id or seed?"};
 
-    // token is now set: flags || kT
-    ustring_view kT{to_unsigned(token.data() + 4), 32};
+    // our token is the first 4 bytes of `sign_val` (flags, etc.), followed by kT:
+    token_.resize(36);
+    std::memcpy(token_.data(), sign_val.data(), 4);
+    std::memcpy(token_.data() + 4, kT_.data(), 32);
 
     // sub_sig is just the admin's signature, sitting at the end of sign_val (after 4f || k):
-    sub_sig = from_unsigned_sv(sign_val.substr(36));
+    sub_sig_ = from_unsigned_sv(sign_val.substr(36));
+
+    token_b64_ = encoding::to_base64(to_unsigned_sv(token_));
+    sub_sig_b64_ = encoding::to_base64(to_unsigned_sv(sub_sig_));
 
     // Our signing private scalar is kt, where t = ±s according to whether we had to negate S to
     // make T
-    std::array<unsigned char, 32> s, s_neg;
-    crypto_sign_ed25519_sk_to_curve25519(s.data(), user_ed25519_sk.data());
+    sodium_cleared<std::array<unsigned char, 32>> s, s_neg;
+    crypto_sign_ed25519_sk_to_curve25519(s.data(), user_ed_sk.data());
     crypto_core_ed25519_scalar_negate(s_neg.data(), s.data());
     xed25519::constant_time_conditional_assign(s, s_neg, neg);
 
     auto& t = s;
 
-    std::array<unsigned char, 32> kt;
-    crypto_core_ed25519_scalar_mul(kt.data(), k.data(), t.data());
+    crypto_core_ed25519_scalar_mul(kt_.data(), k.data(), t.data());
 
     // We now have kt, kT, our privkey/public.  (Note that kt is a scalar, not a seed).
 
@@ -720,33 +886,31 @@ Keys::swarm_auth Keys::swarm_subaccount_sign(
     //     S = r + H(R || kT || M) kt    (mod L)
     //
     // (using the standard Ed25519 SHA-512 here for H)
+    //
+    // Everything up to the M in the r hash is fixed, so we precompute it here:
 
     constexpr auto seed_hash_key = "SubaccountSeed"sv;
-    constexpr auto r_hash_key = "SubaccountSig"sv;
-    std::array<unsigned char, 32> hseed;
     crypto_generichash_blake2b(
-            hseed.data(),
-            hseed.size(),
-            user_ed25519_sk.data(),
+            r_prefix_.data(),
+            32,
+            user_ed_sk.data(),
             32,
             to_unsigned(seed_hash_key.data()),
             seed_hash_key.size());
+    std::memcpy(r_prefix_.data() + 32, kT_.data(), 32);
+}
 
-    std::array<unsigned char, 64> tmp;
-    crypto_generichash_blake2b_state st;
-    crypto_generichash_blake2b_init(
-            &st, to_unsigned(r_hash_key.data()), r_hash_key.size(), tmp.size());
-    crypto_generichash_blake2b_update(&st, hseed.data(), hseed.size());
-    crypto_generichash_blake2b_update(&st, kT.data(), kT.size());
-    crypto_generichash_blake2b_update(&st, msg.data(), msg.size());
-    crypto_generichash_blake2b_final(&st, tmp.data(), tmp.size());
+static constexpr auto SUBACCOUNT_R_HASH_KEY = "SubaccountSig"sv;
 
-    std::array<unsigned char, 32> r;
-    crypto_core_ed25519_scalar_reduce(r.data(), tmp.data());
+// Completes a signature given the (unreduced, 64-byte) r hash value for `msg`, writing R || S into
+// `sig`.
+void Keys::subaccount_signer::sign_into(
+        ustring_view msg, const unsigned char* r_hash, unsigned char* sig) const {
+    sodium_cleared<std::array<unsigned char, 32>> r;
+    crypto_core_ed25519_scalar_reduce(r.data(), r_hash);
 
-    sig.resize(64);
-    unsigned char* R = to_unsigned(sig.data());
-    unsigned char* S = to_unsigned(sig.data() + 32);
+    unsigned char* R = sig;
+    unsigned char* S = sig + 32;
     // R = rB
     crypto_scalarmult_ed25519_base_noclamp(R, r.data());
 
@@ -754,22 +918,79 @@ Keys::swarm_auth Keys::swarm_subaccount_sign(
     crypto_hash_sha512_state shast;
     crypto_hash_sha512_init(&shast);
     crypto_hash_sha512_update(&shast, R, 32);
-    crypto_hash_sha512_update(&shast, kT.data(), kT.size());  // A = pubkey, that is, kT
+    crypto_hash_sha512_update(&shast, kT_.data(), kT_.size());  // A = pubkey, that is, kT
     crypto_hash_sha512_update(&shast, msg.data(), msg.size());
     std::array<unsigned char, 64> hram;
     crypto_hash_sha512_final(&shast, hram.data());      // S = H(R||A||M)
     crypto_core_ed25519_scalar_reduce(S, hram.data());  // S %= L
-    crypto_core_ed25519_scalar_mul(S, S, kt.data());    // S *= a
+    crypto_core_ed25519_scalar_mul(S, S, kt_.data());   // S *= a
     crypto_core_ed25519_scalar_add(S, S, r.data());     // S += r
 
     // sig is now set to the desired R || S, with S = r + H(R || A || M)a (all mod L)
+}
+
+Keys::swarm_auth Keys::subaccount_signer::make_auth(bool binary) const {
+    swarm_auth result;
+    result.subaccount = binary ? token_ : token_b64_;
+    result.subaccount_sig = binary ? sub_sig_ : sub_sig_b64_;
+    return result;
+}
+
+Keys::swarm_auth Keys::subaccount_signer::sign(ustring_view msg, bool binary) const {
+    sodium_cleared<std::array<unsigned char, 64>> r_hash;
+    crypto_generichash_blake2b_state st;
+    crypto_generichash_blake2b_init(
+            &st,
+            to_unsigned(SUBACCOUNT_R_HASH_KEY.data()),
+            SUBACCOUNT_R_HASH_KEY.size(),
+            r_hash.size());
+    crypto_generichash_blake2b_update(&st, r_prefix_.data(), r_prefix_.size());
+    crypto_generichash_blake2b_update(&st, msg.data(), msg.size());
+    crypto_generichash_blake2b_final(&st, r_hash.data(), r_hash.size());
+    sodium_memzero(&st, sizeof(st));
+
+    auto result = make_auth(binary);
+    std::array<unsigned char, 64> sig;
+    sign_into(msg, r_hash.data(), sig.data());
+    result.signature = binary ? std::string{from_unsigned_sv(sig)}
+                              : encoding::to_base64({sig.data(), sig.size()});
+    return result;
+}
 
-    if (!binary) {
-        token = oxenc::to_base64(token);
-        sub_sig = oxenc::to_base64(sub_sig);
-        sig = oxenc::to_base64(sig);
+std::vector<Keys::swarm_auth> Keys::subaccount_signer::sign_multi(
+        const std::vector<ustring_view>& msgs, bool binary) const {
+    std::vector<swarm_auth> result;
+    if (msgs.empty())
+        return result;
+    result.reserve(msgs.size());
+
+    // Build all the `prefix || M` nonce hash inputs in one buffer so that we can compute the nonce
+    // hashes all at once:
+    size_t total = 0;
+    for (auto& m : msgs)
+        total += r_prefix_.size() + m.size();
+    sodium_vector<unsigned char> inputs(total);
+    std::vector<ustring_view> to_hash;
+    to_hash.reserve(msgs.size());
+    auto* in = inputs.data();
+    for (auto& m : msgs) {
+        std::memcpy(in, r_prefix_.data(), r_prefix_.size());
+        if (!m.empty())
+            std::memcpy(in + r_prefix_.size(), m.data(), m.size());
+        to_hash.emplace_back(in, r_prefix_.size() + m.size());
+        in += r_prefix_.size() + m.size();
     }
 
+    sodium_vector<unsigned char> r_hashes(64 * msgs.size());
+    hash::hash_multi(r_hashes.data(), 64, to_hash, to_unsigned_sv(SUBACCOUNT_R_HASH_KEY));
+
+    std::array<unsigned char, 64> sig;
+    for (size_t i = 0; i < msgs.size(); i++) {
+        auto& auth = result.emplace_back(make_auth(binary));
+        sign_into(msgs[i], r_hashes.data() + 64 * i, sig.data());
+        auth.signature = binary ? std::string{from_unsigned_sv(sig)}
+                                : encoding::to_base64({sig.data(), sig.size()});
+    }
     return result;
 }
 
@@ -777,7 +998,7 @@ bool Keys::swarm_verify_subaccount(ustring_view sign_val, bool write, bool del)
     if (!_sign_pk)
         return false;
     return swarm_verify_subaccount(
-            "03" + oxenc::to_hex(_sign_pk->begin(), _sign_pk->end()),
+            encoding::to_prefixed_hex(0x03, {_sign_pk->data(), _sign_pk->size()}),
             ustring_view{user_ed25519_sk.data(), user_ed25519_sk.size()},
             sign_val,
             write,
@@ -795,18 +1016,8 @@ bool Keys::swarm_verify_subaccount(
     if (sign_val.size() != 100)
         return false;
 
-    ustring_view prefix = sign_val.substr(0, 4);
-    if (prefix[0] != 0x03 && !(prefix[1] & SUBACC_FLAG_ANY_PREFIX))
-        return false;  // require either 03 prefix match, or the "any prefix" flag
-
-    if (!(prefix[1] & SUBACC_FLAG_READ))
-        return false;  // missing the read flag
-
-    if (write && !(prefix[1] & SUBACC_FLAG_WRITE))
-        return false;  // we require write, but it isn't set
-                       //
-    if (del && !(prefix[1] & SUBACC_FLAG_DEL))
-        return false;  // we require delete, but it isn't set
+    if (!subacc_prefix_ok(sign_val.substr(0, 4), write, del))
+        return false;
 
     ustring_view k = sign_val.substr(4, 32);
     ustring_view sig = sign_val.substr(36);
@@ -831,13 +1042,85 @@ bool Keys::swarm_verify_subaccount(
                         sig.data(), to_verify.data(), to_verify.size(), group_pk.data());
 }
 
+std::vector<bool> Keys::swarm_verify_subaccount_requests(
+        std::string_view group_id,
+        const std::vector<swarm_subaccount_request>& requests,
+        bool write,
+        bool del) {
+    auto group_pk = session_id_pk(group_id, "03");
+    const ustring_view group_pk_sv{group_pk.data(), group_pk.size()};
+
+    std::vector<bool> valid(requests.size(), false);
+
+    // Collect the distinct (token, admin signature) pairs; typically a handful of members each
+    // make many requests, so there are usually far fewer of these than requests.
+    std::unordered_map<std::string, size_t> token_index;
+    std::vector<ustring_view> token_sigs, tokens;
+    std::vector<size_t> candidates, candidate_token;
+    candidates.reserve(requests.size());
+    candidate_token.reserve(requests.size());
+    std::string key;
+    for (size_t i = 0; i < requests.size(); i++) {
+        auto& r = requests[i];
+        if (r.subaccount.size() != 36 || r.subaccount_sig.size() != 64 || r.signature.size() != 64)
+            continue;
+        if (!subacc_prefix_ok(r.subaccount.substr(0, 4), write, del))
+            continue;
+
+        key.assign(from_unsigned_sv(r.subaccount));
+        key += from_unsigned_sv(r.subaccount_sig);
+        auto [it, inserted] = token_index.try_emplace(key, tokens.size());
+        if (inserted) {
+            tokens.push_back(r.subaccount);
+            token_sigs.push_back(r.subaccount_sig);
+        }
+        candidates.push_back(i);
+        candidate_token.push_back(it->second);
+    }
+    if (candidates.empty())
+        return valid;
+
+    // Verify the group signature on each distinct token:
+    std::vector<bool> token_ok(tokens.size(), true);
+    {
+        std::vector<ustring_view> group_pks(tokens.size(), group_pk_sv);
+        for (auto bad : ed25519::verify_batch(token_sigs, group_pks, tokens))
+            token_ok[bad] = false;
+    }
+
+    // Then verify the request signatures (for requests with a valid token) using the blinded
+    // pubkey kT contained in the token:
+    std::vector<ustring_view> sigs, pubkeys, msgs;
+    std::vector<size_t> checking;
+    sigs.reserve(candidates.size());
+    pubkeys.reserve(candidates.size());
+    msgs.reserve(candidates.size());
+    checking.reserve(candidates.size());
+    for (size_t c = 0; c < candidates.size(); c++) {
+        if (!token_ok[candidate_token[c]])
+            continue;
+        auto& r = requests[candidates[c]];
+        sigs.push_back(r.signature);
+        pubkeys.push_back(r.subaccount.substr(4));
+        msgs.push_back(r.msg);
+        checking.push_back(candidates[c]);
+    }
+    for (auto i : checking)
+        valid[i] = true;
+    for (auto bad : ed25519::verify_batch(sigs, pubkeys, msgs))
+        valid[checking[bad]] = false;
+
+    return valid;
+}
+
 std::optional<ustring_view> Keys::pending_config() const {
+    std::shared_lock lock{mutex_};
     if (pending_key_config_.empty())
         return std::nullopt;
     return ustring_view{pending_key_config_.data(), pending_key_config_.size()};
 }
 
-void Keys::insert_key(std::string_view msg_hash, key_info&& new_key) {
+void Keys::insert_key(std::string_view msg_hash, key_info&& new_key, bool prune) {
     // Find all keys with the same generation and see if our key is in there (that is: we are
     // deliberately ignoring timestamp so that we don't add the same key with slight timestamp
     // variations).
@@ -861,7 +1144,8 @@ void Keys::insert_key(std::string_view msg_hash, key_info&& new_key) {
 
     active_msgs_[new_key.generation].emplace(msg_hash);
     keys_.insert(it, std::move(new_key));
-    remove_expired();
+    if (prune)
+        remove_expired();
     needs_dump_ = true;
 }
 
@@ -905,12 +1189,8 @@ namespace {
     }
 }  // namespace
 
-bool Keys::load_key_message(
-        std::string_view hash,
-        ustring_view data,
-        int64_t timestamp_ms,
-        Info& info,
-        Members& members) {
+Keys::parsed_key_message Keys::parse_key_message(
+        ustring_view data, int64_t timestamp_ms, bool verify) {
 
     oxenc::bt_dict_consumer d{from_unsigned_sv(data)};
 
@@ -1090,7 +1370,13 @@ bool Keys::load_key_message(
         }
     }
 
-    verify_config_sig(d, data, verifier_);
+    verify_config_sig(d, data, verify ? verifier_ : nullptr);
+
+    return {std::move(new_keys), max_gen};
+}
+
+bool Keys::apply_key_message(std::string_view hash, parsed_key_message&& msg, bool prune) {
+    auto& new_keys = msg.keys;
 
     // If this is our pending config or this has a later generation than our pending config then
     // drop our pending status.
@@ -1102,34 +1388,149 @@ bool Keys::load_key_message(
 
     if (!new_keys.empty()) {
         for (auto& k : new_keys)
-            insert_key(hash, std::move(k));
-
-        auto new_key_list = group_keys();
-        members.replace_keys(new_key_list, /*dirty=*/false);
-        info.replace_keys(new_key_list, /*dirty=*/false);
+            insert_key(hash, std::move(k), prune);
         return true;
-    } else if (max_gen) {
-        active_msgs_[*max_gen].emplace(hash);
-        remove_expired();
+    } else if (msg.max_gen) {
+        active_msgs_[*msg.max_gen].emplace(hash);
+        if (prune)
+            remove_expired();
         needs_dump_ = true;
     }
 
     return false;
 }
 
+bool Keys::load_key_message(
+        std::string_view hash,
+        ustring_view data,
+        int64_t timestamp_ms,
+        Info& info,
+        Members& members) {
+
+    // Parsing and decrypting the message only reads our keys, so do that with just a shared lock
+    // to avoid blocking decryption for longer than necessary.
+    parsed_key_message parsed;
+    {
+        std::shared_lock lock{mutex_};
+        parsed = parse_key_message(data, timestamp_ms, true);
+    }
+
+    std::unique_lock lock{mutex_};
+    if (!apply_key_message(hash, std::move(parsed), true))
+        return false;
+
+    auto new_key_list = group_keys_impl();
+    members.replace_keys(new_key_list, /*dirty=*/false);
+    info.replace_keys(new_key_list, /*dirty=*/false);
+    return true;
+}
+
+std::vector<std::string> Keys::load_key_messages(
+        const std::vector<key_message>& messages, Info& info, Members& members) {
+
+    if (!_sign_pk || !verifier_)
+        throw std::logic_error{"Group pubkey is not set; unable to load config message"};
+
+    // Pull out the (unencrypted) generation and the signature of each message so that we can
+    // order the messages and verify all the signatures in a single batch.  Anything we can't even
+    // get that far with is invalid.
+    struct pending {
+        size_t index;
+        int64_t generation;
+    };
+    std::vector<pending> loading;
+    std::vector<ustring_view> sigs, signed_data;
+    loading.reserve(messages.size());
+    sigs.reserve(messages.size());
+    signed_data.reserve(messages.size());
+    for (size_t i = 0; i < messages.size(); i++) {
+        try {
+            oxenc::bt_dict_consumer d{from_unsigned_sv(messages[i].data)};
+            if (!d.skip_until("G"))
+                continue;
+            auto gen = d.consume_integer<int64_t>();
+            if (!d.skip_until("~"))
+                continue;
+            ustring_view to_verify, sig;
+            d.consume_signature([&](ustring_view to_verify_, ustring_view sig_) {
+                to_verify = to_verify_;
+                sig = sig_;
+            });
+            loading.push_back({i, gen});
+            signed_data.push_back(to_verify);
+            sigs.push_back(sig);
+        } catch (const std::exception&) {
+            // Malformed; skip it
+        }
+    }
+
+    {
+        std::vector<ustring_view> pubkeys(sigs.size(), ustring_view{_sign_pk->data(), 32});
+        auto bad = ed25519::verify_batch(sigs, pubkeys, signed_data);
+        for (auto it = bad.rbegin(); it != bad.rend(); ++it)
+            loading.erase(loading.begin() + *it);
+    }
+
+    // Newest generation first: once we have keys that expire some older generation we don't need
+    // to bother decrypting any messages for that generation (or older).
+    std::stable_sort(loading.begin(), loading.end(), [](const pending& a, const pending& b) {
+        return a.generation > b.generation;
+    });
+
+    std::unique_lock lock{mutex_};
+
+    std::vector<std::string> good;
+    good.reserve(loading.size());
+    bool found_keys = false;
+    std::optional<int64_t> expired_before;
+    for (auto& [i, gen] : loading) {
+        auto& m = messages[i];
+        if (expired_before && gen < *expired_before) {
+            good.emplace_back(m.hash);
+            continue;
+        }
+        try {
+            if (apply_key_message(m.hash, parse_key_message(m.data, m.timestamp_ms, false), false))
+                found_keys = true;
+        } catch (const std::exception&) {
+            continue;
+        }
+        good.emplace_back(m.hash);
+
+        // If the first key we would keep is old enough to expire whatever comes before it (which
+        // is always the case if there are expired keys) then any older generation is expired too.
+        if (!keys_.empty()) {
+            auto n = expired_count();
+            if (n > 0 || keys_.front().timestamp + KEY_EXPIRY < keys_.back().timestamp)
+                expired_before = keys_[n].generation;
+        }
+    }
+
+    remove_expired();
+
+    if (found_keys) {
+        auto new_key_list = group_keys_impl();
+        members.replace_keys(new_key_list, /*dirty=*/false);
+        info.replace_keys(new_key_list, /*dirty=*/false);
+    }
+
+    return good;
+}
+
 std::unordered_set<std::string> Keys::current_hashes() const {
+    std::shared_lock lock{mutex_};
     std::unordered_set<std::string> hashes;
     for (const auto& [g, hash] : active_msgs_)
         hashes.insert(hash.begin(), hash.end());
     return hashes;
 }
 
-void Keys::remove_expired() {
-    if (keys_.size() >= 2) {
-        // When we're done, this will point at the first element we want to keep (i.e. we want to
-        // remove everything in `[ begin(), lapsed_end )`).
-        auto lapsed_end = keys_.begin();
+size_t Keys::expired_count() const {
+    // When we're done, this will point at the first element we want to keep (i.e. we want to
+    // remove everything in `[ begin(), lapsed_end )`).
+    auto lapsed_end = keys_.begin();
 
+    if (keys_.size() >= 2) {
         for (auto it = keys_.begin(); it != keys_.end();) {
             // Advance `it` if the next element is an alternate key (with a later timestamp) from
             // the same generation.  When we finish this little loop, `it` is the last element of
@@ -1156,11 +1557,15 @@ void Keys::remove_expired() {
                 break;
             it = it2;
         }
-
-        if (lapsed_end != keys_.begin())
-            keys_.erase(keys_.begin(), lapsed_end);
     }
 
+    return std::distance(keys_.begin(), lapsed_end);
+}
+
+void Keys::remove_expired() {
+    if (auto n = expired_count(); n > 0)
+        keys_.erase(keys_.begin(), keys_.begin() + n);
+
     // Drop any active message hashes for generations we are no longer keeping around
     if (!keys_.empty())
         active_msgs_.erase(
@@ -1173,6 +1578,7 @@ void Keys::remove_expired() {
 }
 
 bool Keys::needs_rekey() const {
+    std::shared_lock lock{mutex_};
     if (!admin() || keys_.size() < 2)
         return false;
 
@@ -1184,6 +1590,7 @@ bool Keys::needs_rekey() const {
 }
 
 std::optional<ustring_view> Keys::pending_key() const {
+    std::shared_lock lock{mutex_};
     if (!pending_key_config_.empty())
         return ustring_view{pending_key_.data(), pending_key_.size()};
     return std::nullopt;
@@ -1195,15 +1602,12 @@ static constexpr size_t ENCRYPT_OVERHEAD =
 ustring Keys::encrypt_message(ustring_view plaintext, bool compress, size_t padding) const {
     if (plaintext.size() > MAX_PLAINTEXT_MESSAGE_SIZE)
         throw std::runtime_error{"Cannot encrypt plaintext: message size is too large"};
-    ustring _compressed;
     if (compress) {
-        _compressed = zstd_compress(plaintext);
-        if (_compressed.size() < plaintext.size())
-            plaintext = _compressed;
-        else {
-            _compressed.clear();
+        auto compressed = zstd_compress_scratch(plaintext);
+        if (compressed.size() < plaintext.size())
+            plaintext = compressed;
+        else
             compress = false;
-        }
     }
 
     oxenc::bt_dict_producer dict{};
@@ -1239,6 +1643,7 @@ ustring Keys::encrypt_message(ustring_view plaintext, bool compress, size_t padd
     ciphertext.resize(ENCRYPT_OVERHEAD + encoded.size());
     randombytes_buf(ciphertext.data(), crypto_aead_xchacha20poly1305_ietf_NPUBBYTES);
     ustring_view nonce{ciphertext.data(), crypto_aead_xchacha20poly1305_ietf_NPUBBYTES};
+    std::shared_lock lock{mutex_};
     if (0 != crypto_aead_xchacha20poly1305_ietf_encrypt(
                      ciphertext.data() + crypto_aead_xchacha20poly1305_ietf_NPUBBYTES,
                      nullptr,
@@ -1248,7 +1653,7 @@ ustring Keys::encrypt_message(ustring_view plaintext, bool compress, size_t padd
                      0,
                      nullptr,
                      nonce.data(),
-                     group_enc_key().data()))
+                     group_enc_key_impl().data()))
         throw std::runtime_error{"Encryption failed"};
 
     return ciphertext;
@@ -1268,14 +1673,17 @@ std::pair<std::string, ustring> Keys::decrypt_message(ustring_view ciphertext) c
     // Decrypt, using all the possible keys, starting with a pending one (if we have one)
     //
     bool decrypt_success = false;
-    if (auto pending = pending_key();
-        pending && try_decrypting(plain.data(), ciphertext, nonce, *pending)) {
-        decrypt_success = true;
-    } else {
-        for (auto& k : keys_) {
-            if (try_decrypting(plain.data(), ciphertext, nonce, k.key)) {
-                decrypt_success = true;
-                break;
+    {
+        std::shared_lock lock{mutex_};
+        if (!pending_key_config_.empty() &&
+            try_decrypting(plain.data(), ciphertext, nonce, pending_key_)) {
+            decrypt_success = true;
+        } else {
+            for (auto& k : keys_) {
+                if (try_decrypting(plain.data(), ciphertext, nonce, k.key)) {
+                    decrypt_success = true;
+                    break;
+                }
             }
         }
     }
@@ -1318,9 +1726,7 @@ std::pair<std::string, ustring> Keys::decrypt_message(ustring_view ciphertext) c
 
     std::pair<std::string, ustring> result;
     auto& [session_id, data] = result;
-    session_id.reserve(66);
-    session_id += "05";
-    oxenc::to_hex(x_pk.begin(), x_pk.end(), std::back_inserter(session_id));
+    session_id = encoding::to_prefixed_hex(0x05, {x_pk.data(), x_pk.size()});
 
     ustring_view raw_data;
     if (dict.skip_until("d")) {
@@ -1380,9 +1786,14 @@ const groups::Keys& unbox(const config_group_keys* conf) {
     return *static_cast<const groups::Keys*>(conf->internals);
 }
 
+// Keys can be used from multiple threads at once, so errors from concurrent C calls have to be
+// serialized to avoid racing on the shared error buffer.
+std::mutex error_mutex;
+
 void set_error(config_group_keys* conf, std::string_view e) {
     if (e.size() > 255)
         e.remove_suffix(e.size() - 255);
+    std::lock_guard lock{error_mutex};
     std::memcpy(conf->_error_buf, e.data(), e.size());
     conf->_error_buf[e.size()] = 0;
     conf->last_error = conf->_error_buf;
@@ -1529,6 +1940,29 @@ LIBSESSION_C_API bool groups_keys_load_message(
     return true;
 }
 
+LIBSESSION_C_API config_string_list* groups_keys_load_messages(
+        config_group_keys* conf,
+        const char** msg_hashes,
+        const unsigned char** msgs,
+        const size_t* lengths,
+        const int64_t* timestamps_ms,
+        size_t count,
+        config_object* info,
+        config_object* members) {
+    assert(info && members);
+    std::vector<groups::Keys::key_message> messages;
+    messages.reserve(count);
+    for (size_t i = 0; i < count; i++)
+        messages.push_back({msg_hashes[i], ustring_view{msgs[i], lengths[i]}, timestamps_ms[i]});
+    try {
+        return make_string_list(unbox(conf).load_key_messages(
+                messages, *unbox<groups::Info>(info), *unbox<groups::Members>(members)));
+    } catch (const std::exception& e) {
+        set_error(conf, e.what());
+        return nullptr;
+    }
+}
+
 LIBSESSION_C_API config_string_list* groups_keys_current_hashes(const config_group_keys* conf) {
     return make_string_list(unbox(conf).current_hashes());
 }
@@ -1541,6 +1975,11 @@ LIBSESSION_C_API bool groups_keys_needs_dump(const config_group_keys* conf) {
     return unbox(conf).needs_dump();
 }
 
+LIBSESSION_C_API void groups_keys_memory_usage(
+        const config_group_keys* conf, config_memory_usage* usage) {
+    copy_memory_usage(unbox(conf).memory_usage(), *usage);
+}
+
 LIBSESSION_C_API void groups_keys_dump(
         config_group_keys* conf, unsigned char** out, size_t* outlen) {
     assert(out && outlen);
@@ -1671,6 +2110,40 @@ LIBSESSION_C_API bool groups_keys_swarm_verify_subaccount(
             ustring_view{signing_value, 100});
 }
 
+LIBSESSION_C_API size_t groups_keys_swarm_verify_subaccount_requests(
+        const char* group_id,
+        const unsigned char* const* subaccounts,
+        const unsigned char* const* subaccount_sigs,
+        const unsigned char* const* msgs,
+        const size_t* msg_lens,
+        const unsigned char* const* signatures,
+        size_t count,
+        bool write,
+        bool del,
+        bool* valid) {
+    assert(group_id && (count == 0 || (subaccounts && subaccount_sigs && msgs && msg_lens &&
+                                       signatures && valid)));
+    std::fill(valid, valid + count, false);
+    try {
+        std::vector<groups::Keys::swarm_subaccount_request> reqs;
+        reqs.reserve(count);
+        for (size_t i = 0; i < count; i++)
+            reqs.push_back(
+                    {ustring_view{subaccounts[i], 36},
+                     ustring_view{subaccount_sigs[i], 64},
+                     ustring_view{msgs[i], msg_lens[i]},
+                     ustring_view{signatures[i], 64}});
+        auto results = groups::Keys::swarm_verify_subaccount_requests(group_id, reqs, write, del);
+        size_t good = 0;
+        for (size_t i = 0; i < count; i++)
+            if ((valid[i] = results[i]))
+                good++;
+        return good;
+    } catch (...) {
+        return 0;
+    }
+}
+
 LIBSESSION_C_API bool groups_keys_swarm_subaccount_sign(
         config_group_keys* conf,
         const unsigned char* msg,
@@ -1723,6 +2196,100 @@ LIBSESSION_C_API bool groups_keys_swarm_subaccount_sign_binary(
     }
 }
 
+LIBSESSION_C_API groups_keys_swarm_signer* groups_keys_swarm_signer_new(
+        config_group_keys* conf, const unsigned char* signing_value) {
+    assert(signing_value);
+    try {
+        auto signer = std::make_unique<groups::Keys::subaccount_signer>(
+                unbox(conf).swarm_subaccount_signer(ustring_view{signing_value, 100}));
+        auto* s = new groups_keys_swarm_signer{};
+        s->_internals = signer.release();
+        return s;
+    } catch (const std::exception& e) {
+        set_error(conf, e.what());
+        return nullptr;
+    }
+}
+
+LIBSESSION_C_API void groups_keys_swarm_signer_free(groups_keys_swarm_signer* signer) {
+    if (!signer)
+        return;
+    delete static_cast<groups::Keys::subaccount_signer*>(signer->_internals);
+    delete signer;
+}
+
+namespace {
+
+std::vector<groups::Keys::swarm_auth> signer_sign(
+        const groups_keys_swarm_signer* signer,
+        const unsigned char* const* msgs,
+        const size_t* msg_lens,
+        size_t count,
+        bool binary) {
+    std::vector<ustring_view> views;
+    views.reserve(count);
+    for (size_t i = 0; i < count; i++)
+        views.emplace_back(msgs[i], msg_lens[i]);
+    return static_cast<const groups::Keys::subaccount_signer*>(signer->_internals)
+            ->sign_multi(views, binary);
+}
+
+}  // namespace
+
+LIBSESSION_C_API bool groups_keys_swarm_signer_sign(
+        const groups_keys_swarm_signer* signer,
+        const unsigned char* const* msgs,
+        const size_t* msg_lens,
+        size_t count,
+
+        char* subaccount,
+        char* subaccount_sig,
+        char* signatures) {
+    assert(signer && (count == 0 || (msgs && msg_lens && signatures)) && subaccount &&
+           subaccount_sig);
+    try {
+        auto& s = *static_cast<const groups::Keys::subaccount_signer*>(signer->_internals);
+        auto auths = signer_sign(signer, msgs, msg_lens, count, false);
+        assert(s.subaccount().size() == 48);
+        assert(s.subaccount_sig().size() == 88);
+        std::memcpy(subaccount, s.subaccount().c_str(), s.subaccount().size() + 1);
+        std::memcpy(subaccount_sig, s.subaccount_sig().c_str(), s.subaccount_sig().size() + 1);
+        for (size_t i = 0; i < auths.size(); i++) {
+            assert(auths[i].signature.size() == 88);
+            std::memcpy(signatures + 89 * i, auths[i].signature.c_str(), 89);
+        }
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+LIBSESSION_C_API bool groups_keys_swarm_signer_sign_binary(
+        const groups_keys_swarm_signer* signer,
+        const unsigned char* const* msgs,
+        const size_t* msg_lens,
+        size_t count,
+
+        unsigned char* subaccount,
+        unsigned char* subaccount_sig,
+        unsigned char* signatures) {
+    assert(signer && (count == 0 || (msgs && msg_lens && signatures)) && subaccount &&
+           subaccount_sig);
+    try {
+        auto& s = *static_cast<const groups::Keys::subaccount_signer*>(signer->_internals);
+        auto auths = signer_sign(signer, msgs, msg_lens, count, true);
+        std::memcpy(subaccount, s.subaccount(true).data(), 36);
+        std::memcpy(subaccount_sig, s.subaccount_sig(true).data(), 64);
+        for (size_t i = 0; i < auths.size(); i++) {
+            assert(auths[i].signature.size() == 64);
+            std::memcpy(signatures + 64 * i, auths[i].signature.data(), 64);
+        }
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
 LIBSESSION_C_API bool groups_keys_swarm_subaccount_token_flags(
         config_group_keys* conf,
         const char* session_id,
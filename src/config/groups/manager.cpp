@@ -0,0 +1,221 @@
+#include "session/config/groups/manager.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "../internal.hpp"
+
+namespace session::config::groups {
+
+namespace {
+
+    std::optional<ustring_view> maybe_dump(const ustring& dump) {
+        if (dump.empty())
+            return std::nullopt;
+        return ustring_view{dump};
+    }
+
+}  // namespace
+
+group_state::group_state(
+        ustring_view user_ed25519_secretkey,
+        ustring_view group_ed25519_pubkey,
+        std::optional<ustring_view> group_ed25519_secretkey,
+        const group_dumps& dumps) :
+        info{group_ed25519_pubkey, group_ed25519_secretkey, maybe_dump(dumps.info)},
+        members{group_ed25519_pubkey, group_ed25519_secretkey, maybe_dump(dumps.members)},
+        keys{user_ed25519_secretkey,
+             group_ed25519_pubkey,
+             group_ed25519_secretkey,
+             maybe_dump(dumps.keys),
+             info,
+             members} {}
+
+bool group_state::needs_dump() const {
+    return info.needs_dump() || members.needs_dump() || keys.needs_dump();
+}
+
+size_t group_state::memory_usage() const {
+    return info.memory_usage().total() + members.memory_usage().total() +
+           keys.memory_usage().total();
+}
+
+GroupManager::GroupManager(ustring_view user_ed25519_secretkey, size_t memory_budget) :
+        _memory_budget{memory_budget} {
+    if (user_ed25519_secretkey.size() != 64)
+        throw std::invalid_argument{"Invalid GroupManager construction: invalid user secret key"};
+    _user_sk.load(user_ed25519_secretkey.data(), 64);
+}
+
+bool GroupManager::add(
+        std::string_view group_id,
+        std::optional<ustring_view> group_ed25519_secretkey,
+        group_dumps dumps) {
+    auto pubkey = session_id_pk(group_id, "03");
+    if (group_ed25519_secretkey && group_ed25519_secretkey->size() != 64)
+        throw std::invalid_argument{"Invalid group secret key: expected 64 bytes"};
+
+    auto [it, added] = _groups.try_emplace(std::string{group_id});
+    if (!added)
+        return false;
+    auto& g = it->second;
+    g.pubkey = pubkey;
+    if (group_ed25519_secretkey)
+        g.secretkey.load(group_ed25519_secretkey->data(), 64);
+    g.dumps = std::move(dumps);
+    return true;
+}
+
+bool GroupManager::remove(std::string_view group_id) {
+    auto it = _groups.find(group_id);
+    if (it == _groups.end())
+        return false;
+    _groups.erase(it);
+    return true;
+}
+
+bool GroupManager::contains(std::string_view group_id) const {
+    return _groups.count(group_id);
+}
+
+bool GroupManager::is_resident(std::string_view group_id) const {
+    auto it = _groups.find(group_id);
+    return it != _groups.end() && it->second.state;
+}
+
+size_t GroupManager::resident_count() const {
+    return std::count_if(_groups.begin(), _groups.end(), [](const auto& g) {
+        return g.second.state != nullptr;
+    });
+}
+
+group_state& GroupManager::get(std::string_view group_id) {
+    auto it = _groups.find(group_id);
+    if (it == _groups.end())
+        throw std::out_of_range{"Unknown group " + std::string{group_id}};
+    return access(it->first, it->second);
+}
+
+group_state& GroupManager::access(const std::string& group_id, entry& g) {
+    g.last_used = ++_access_counter;
+    g.last_access = clock::now();
+    if (g.state)
+        return *g.state;
+
+    std::optional<ustring_view> sk;
+    if (g.secretkey)
+        sk.emplace(g.secretkey.data(), g.secretkey.size());
+    auto state = std::make_unique<group_state>(
+            ustring_view{_user_sk.data(), _user_sk.size()},
+            ustring_view{g.pubkey.data(), g.pubkey.size()},
+            sk,
+            g.dumps);
+    if (_restore_callback)
+        _restore_callback(group_id, *state);
+    g.state = std::move(state);
+    // The dumps are stale as soon as the restored objects get modified, so don't keep them around;
+    // we'll make fresh ones when the group is next hibernated.
+    g.dumps = {};
+
+    enforce_budget(&g);
+    return *g.state;
+}
+
+bool GroupManager::hibernate(std::string_view group_id) {
+    auto it = _groups.find(group_id);
+    if (it == _groups.end() || !it->second.state)
+        return false;
+    hibernate(it->first, it->second);
+    return true;
+}
+
+void GroupManager::hibernate(const std::string& group_id, entry& g) {
+    auto& s = *g.state;
+    bool needs_dump = s.needs_dump();
+    g.dumps.info = s.info.make_dump();
+    g.dumps.members = s.members.make_dump();
+    g.dumps.keys = s.keys.make_dump();
+    if (needs_dump && _dump_callback)
+        _dump_callback(group_id, g.dumps);
+    g.state.reset();
+}
+
+size_t GroupManager::hibernate_idle(clock::duration idle, clock::time_point now) {
+    size_t count = 0;
+    for (auto& [id, g] : _groups) {
+        if (g.state && now - g.last_access >= idle) {
+            hibernate(id, g);
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t GroupManager::enforce_budget(const entry* keep) {
+    if (!_memory_budget)
+        return 0;
+
+    struct resident {
+        const std::string* id;
+        entry* g;
+        size_t usage;
+    };
+    std::vector<resident> residents;
+    size_t total = 0;
+    for (auto& [id, g] : _groups) {
+        if (!g.state)
+            continue;
+        auto& r = residents.emplace_back(resident{&id, &g, g.state->memory_usage()});
+        total += r.usage;
+    }
+    if (total <= _memory_budget)
+        return 0;
+
+    std::sort(residents.begin(), residents.end(), [](const resident& a, const resident& b) {
+        return a.g->last_used < b.g->last_used;
+    });
+    size_t count = 0;
+    for (auto& r : residents) {
+        if (total <= _memory_budget)
+            break;
+        if (r.g == keep)
+            continue;
+        hibernate(*r.id, *r.g);
+        total -= r.usage;
+        count++;
+    }
+    return count;
+}
+
+void GroupManager::set_memory_budget(size_t budget) {
+    _memory_budget = budget;
+    enforce_budget(nullptr);
+}
+
+group_dumps GroupManager::dumps(std::string_view group_id) {
+    auto it = _groups.find(group_id);
+    if (it == _groups.end())
+        throw std::out_of_range{"Unknown group " + std::string{group_id}};
+    auto& g = it->second;
+    if (!g.state)
+        return g.dumps;
+    return {g.state->info.dump(), g.state->members.dump(), g.state->keys.dump()};
+}
+
+size_t GroupManager::resident_memory() const {
+    size_t total = 0;
+    for (auto& [id, g] : _groups)
+        if (g.state)
+            total += g.state->memory_usage();
+    return total;
+}
+
+size_t GroupManager::hibernated_memory() const {
+    size_t total = 0;
+    for (auto& [id, g] : _groups)
+        if (!g.state)
+            total += g.dumps.size();
+    return total;
+}
+
+}  // namespace session::config::groups
@@ -1,12 +1,52 @@
 #include "session/config/groups/members.hpp"
 
-#include <oxenc/hex.h>
+#include <algorithm>
 
 #include "../internal.hpp"
 #include "session/config/groups/members.h"
+#include "session/encoding.hpp"
 
 namespace session::config::groups {
 
+namespace {
+
+    // Returns the index in `_status_index` of a member_status, throwing if invalid.
+    size_t status_index(member_status status) {
+        auto i = static_cast<size_t>(status);
+        if (i > static_cast<size_t>(member_status::removed_with_messages))
+            throw std::invalid_argument{"Invalid member status"};
+        return i;
+    }
+
+    // Returns a bitmask (with bits indexed by member_status values) of the statuses of the member
+    // with the given info dict.  This must agree with the values that `member::load` produces,
+    // but avoids having to construct a member.
+    uint16_t status_mask(const dict& info) {
+        bool admin = maybe_int(info, "A").value_or(0);
+        auto invite = admin ? 0 : maybe_int(info, "I").value_or(0);
+        auto promotion = admin ? maybe_int(info, "P").value_or(0) : 0;
+        auto removed = maybe_int(info, "R").value_or(0);
+
+        uint16_t mask = 0;
+        auto flag = [&mask](member_status s, bool on) {
+            if (on)
+                mask |= 1 << static_cast<int>(s);
+        };
+        flag(member_status::invite_pending, invite > 0);
+        flag(member_status::invite_not_sent, invite == INVITE_NOT_SENT);
+        flag(member_status::invite_sent, invite == INVITE_SENT);
+        flag(member_status::invite_failed, invite == INVITE_FAILED);
+        flag(member_status::promotion_pending, promotion > 0);
+        flag(member_status::promotion_not_sent, promotion == INVITE_NOT_SENT);
+        flag(member_status::promotion_sent, promotion == INVITE_SENT);
+        flag(member_status::promotion_failed, promotion == INVITE_FAILED);
+        flag(member_status::removed, removed > 0);
+        flag(member_status::removed_with_messages, removed == REMOVED_MEMBER_AND_MESSAGES);
+        return mask;
+    }
+
+}  // namespace
+
 Members::Members(
         ustring_view ed25519_pubkey,
         std::optional<ustring_view> ed25519_secretkey,
@@ -35,6 +75,7 @@ member Members::get_or_construct(std::string_view pubkey_hex) const {
 void Members::set(const member& mem) {
 
     std::string pk = session_id_to_bytes(mem.session_id);
+    bool indexed = _status_index_version == data_version();
     auto info = data["m"][pk];
 
     // Always set the name, even if empty, to keep the dict from getting pruned if there are no
@@ -53,25 +94,121 @@ void Members::set(const member& mem) {
     set_positive_int(info["I"], mem.admin ? 0 : mem.invite_status);
     set_flag(info["s"], mem.supplement);
     set_positive_int(info["R"], mem.removed_status);
+
+    if (indexed) {
+        update_status_index(SessionID{to_unsigned_sv(pk)}, info.dict());
+        _status_index_version = data_version();
+    }
 }
 
-void member::load(const dict& info_dict) {
-    name = maybe_string(info_dict, "n").value_or("");
+void Members::build_status_index() const {
+    if (_status_index_version == data_version())
+        return;
+
+    for (auto& ids : _status_index)
+        ids.clear();
+    if (auto* members = data["m"].dict()) {
+        // The dict is sorted, so each index ends up sorted as well:
+        for (const auto& [pk, val] : *members) {
+            auto* info = std::get_if<dict>(&val);
+            if (pk.size() != 33 || !info)
+                continue;
+            auto mask = status_mask(*info);
+            for (size_t i = 0; i < STATUS_COUNT; i++)
+                if (mask & (1 << i))
+                    _status_index[i].emplace_back(to_unsigned_sv(pk));
+        }
+    }
+    _status_index_version = data_version();
+}
 
-    auto url = maybe_string(info_dict, "p");
-    auto key = maybe_ustring(info_dict, "q");
-    if (url && key && !url->empty() && key->size() == 32) {
-        profile_picture.url = std::move(*url);
-        profile_picture.key = std::move(*key);
-    } else {
-        profile_picture.clear();
+void Members::update_status_index(const SessionID& id, const dict* info) const {
+    auto mask = info ? status_mask(*info) : 0;
+    for (size_t i = 0; i < STATUS_COUNT; i++) {
+        auto& ids = _status_index[i];
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        bool present = it != ids.end() && *it == id;
+        if (mask & (1 << i)) {
+            if (!present)
+                ids.insert(it, id);
+        } else if (present) {
+            ids.erase(it);
+        }
+    }
+}
+
+size_t Members::status_count(member_status status) const {
+    auto i = status_index(status);
+    build_status_index();
+    return _status_index[i].size();
+}
+
+std::vector<member> Members::with_status(
+        member_status status, size_t offset, size_t limit) const {
+    auto i = status_index(status);
+    build_status_index();
+
+    std::vector<member> result;
+    const auto& ids = _status_index[i];
+    if (offset >= ids.size())
+        return result;
+    auto end = offset + std::min(limit, ids.size() - offset);
+    result.reserve(end - offset);
+    auto* members = data["m"].dict();
+    for (size_t j = offset; j < end; j++) {
+        auto& m = result.emplace_back(ids[j].hex());
+        m.load(*std::get_if<dict>(&members->at(ids[j].raw())));
     }
+    return result;
+}
 
-    admin = maybe_int(info_dict, "A").value_or(0);
-    invite_status = admin ? 0 : maybe_int(info_dict, "I").value_or(0);
-    promotion_status = maybe_int(info_dict, "P").value_or(0);
-    removed_status = maybe_int(info_dict, "R").value_or(0);
-    supplement = invite_pending() && !promoted() ? maybe_int(info_dict, "s").value_or(0) : 0;
+MemoryUsage Members::memory_usage() const {
+    auto usage = ConfigBase::memory_usage();
+    usage.other += sizeof(Members) - sizeof(ConfigBase);
+    for (const auto& ids : _status_index)
+        usage.other += ids.capacity() * sizeof(SessionID);
+    return usage;
+}
+
+void member::load(const dict& info_dict) {
+    // Note that the invite status and supplement flag depend on the admin and promotion fields,
+    // which have smaller keys and so are always loaded first.
+    static constexpr entry_field<member> fields[] = {
+            {"A", [](member& m, const dict_value* v) { m.admin = field_int(v); }},
+            {"I",
+             [](member& m, const dict_value* v) {
+                 m.invite_status = m.admin ? 0 : field_int(v);
+             }},
+            {"P", [](member& m, const dict_value* v) { m.promotion_status = field_int(v); }},
+            {"R", [](member& m, const dict_value* v) { m.removed_status = field_int(v); }},
+            {"n",
+             [](member& m, const dict_value* v) {
+                 auto* n = field_str(v);
+                 m.name = n ? *n : "";
+             }},
+            // Validated together with the key ("q") below:
+            {"p",
+             [](member& m, const dict_value* v) {
+                 auto* url = field_str(v);
+                 m.profile_picture.url = url ? *url : "";
+             }},
+            {"q",
+             [](member& m, const dict_value* v) {
+                 auto* key = field_str(v);
+                 if (key && key->size() == 32 && !m.profile_picture.url.empty())
+                     m.profile_picture.key.assign(
+                             reinterpret_cast<const unsigned char*>(key->data()), key->size());
+                 else
+                     m.profile_picture.clear();
+             }},
+            {"s",
+             [](member& m, const dict_value* v) {
+                 m.supplement = m.invite_pending() && !m.promoted() ? field_int(v) : 0;
+             }},
+    };
+    static_assert(fields_sorted(fields));
+
+    load_fields(*this, info_dict, fields);
 }
 
 /// Load _val from the current iterator position; if it is invalid, skip to the next key until we
@@ -80,7 +217,7 @@ void Members::iterator::_load_info() {
     while (_it != _members->end()) {
         if (_it->first.size() == 33) {
             if (auto* info_dict = std::get_if<dict>(&_it->second)) {
-                _val = std::make_shared<member>(oxenc::to_hex(_it->first));
+                _val = std::make_shared<member>(encoding::to_hex(_it->first));
                 _val->load(*info_dict);
                 return;
             }
@@ -116,9 +253,14 @@ Members::iterator& Members::iterator::operator++() {
 
 bool Members::erase(std::string_view session_id) {
     std::string pk = session_id_to_bytes(session_id);
+    bool indexed = _status_index_version == data_version();
     auto info = data["m"][pk];
     bool ret = info.exists();
     info.erase();
+    if (indexed) {
+        update_status_index(SessionID{to_unsigned_sv(pk)}, nullptr);
+        _status_index_version = data_version();
+    }
     return ret;
 }
 
@@ -189,6 +331,29 @@ void member::set_name_truncated(std::string n) {
 using namespace session;
 using namespace session::config;
 
+// Check for agreement between the C and C++ member statuses
+using groups::member_status;
+static_assert(
+        GROUP_MEMBER_STATUS_INVITE_PENDING == static_cast<int>(member_status::invite_pending));
+static_assert(
+        GROUP_MEMBER_STATUS_INVITE_NOT_SENT == static_cast<int>(member_status::invite_not_sent));
+static_assert(GROUP_MEMBER_STATUS_INVITE_SENT == static_cast<int>(member_status::invite_sent));
+static_assert(GROUP_MEMBER_STATUS_INVITE_FAILED == static_cast<int>(member_status::invite_failed));
+static_assert(
+        GROUP_MEMBER_STATUS_PROMOTION_PENDING ==
+        static_cast<int>(member_status::promotion_pending));
+static_assert(
+        GROUP_MEMBER_STATUS_PROMOTION_NOT_SENT ==
+        static_cast<int>(member_status::promotion_not_sent));
+static_assert(
+        GROUP_MEMBER_STATUS_PROMOTION_SENT == static_cast<int>(member_status::promotion_sent));
+static_assert(
+        GROUP_MEMBER_STATUS_PROMOTION_FAILED == static_cast<int>(member_status::promotion_failed));
+static_assert(GROUP_MEMBER_STATUS_REMOVED == static_cast<int>(member_status::removed));
+static_assert(
+        GROUP_MEMBER_STATUS_REMOVED_WITH_MESSAGES ==
+        static_cast<int>(member_status::removed_with_messages));
+
 LIBSESSION_C_API int groups_members_init(
         config_object** conf,
         const unsigned char* ed25519_pubkey,
@@ -244,6 +409,33 @@ LIBSESSION_C_API size_t groups_members_size(const config_object* conf) {
     return unbox<groups::Members>(conf)->size();
 }
 
+LIBSESSION_C_API size_t
+groups_members_status_count(const config_object* conf, GROUP_MEMBER_STATUS status) {
+    try {
+        return unbox<groups::Members>(conf)->status_count(
+                static_cast<groups::member_status>(status));
+    } catch (...) {
+        return 0;
+    }
+}
+
+LIBSESSION_C_API size_t groups_members_with_status(
+        const config_object* conf,
+        GROUP_MEMBER_STATUS status,
+        size_t offset,
+        config_group_member* members,
+        size_t max) {
+    try {
+        auto page = unbox<groups::Members>(conf)->with_status(
+                static_cast<groups::member_status>(status), offset, max);
+        for (size_t i = 0; i < page.size(); i++)
+            page[i].into(members[i]);
+        return page.size();
+    } catch (...) {
+        return 0;
+    }
+}
+
 LIBSESSION_C_API groups_members_iterator* groups_members_iterator_new(const config_object* conf) {
     auto* it = new groups_members_iterator{};
     it->_internals = new groups::Members::iterator{unbox<groups::Members>(conf)->begin()};
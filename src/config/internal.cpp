@@ -1,18 +1,20 @@
 #include "internal.hpp"
 
 #include <oxenc/base32z.h>
-#include <oxenc/base64.h>
 #include <oxenc/bt_value_producer.h>
-#include <oxenc/hex.h>
 #include <zstd.h>
 
+#include <cstring>
 #include <iterator>
+#include <memory>
 #include <optional>
 
+#include "session/encoding.hpp"
+
 namespace session::config {
 
 void check_session_id(std::string_view session_id, std::string_view prefix) {
-    if (!(session_id.size() == 64 + prefix.size() && oxenc::is_hex(session_id) &&
+    if (!(session_id.size() == 64 + prefix.size() && encoding::is_hex(session_id) &&
           session_id.substr(0, prefix.size()) == prefix))
         throw std::invalid_argument{
                 "Invalid session ID: expected 66 hex digits starting with " + std::string{prefix} +
@@ -21,36 +23,40 @@ void check_session_id(std::string_view session_id, std::string_view prefix) {
 
 std::string session_id_to_bytes(std::string_view session_id, std::string_view prefix) {
     check_session_id(session_id, prefix);
-    return oxenc::from_hex(session_id);
+    std::string bytes;
+    bytes.resize(session_id.size() / 2);
+    encoding::from_hex(session_id, reinterpret_cast<unsigned char*>(bytes.data()));
+    return bytes;
 }
 
 std::array<unsigned char, 32> session_id_pk(std::string_view session_id, std::string_view prefix) {
     check_session_id(session_id, prefix);
     std::array<unsigned char, 32> pk;
     session_id.remove_prefix(2);
-    oxenc::from_hex(session_id.begin(), session_id.end(), pk.begin());
+    encoding::from_hex(session_id, pk.data());
     return pk;
 }
 
 void check_encoded_pubkey(std::string_view pk) {
-    if (!((pk.size() == 64 && oxenc::is_hex(pk)) ||
-          ((pk.size() == 43 || (pk.size() == 44 && pk.back() == '=')) && oxenc::is_base64(pk)) ||
-          (pk.size() == 52 && oxenc::is_base32z(pk))))
-        throw std::invalid_argument{"Invalid encoded pubkey: expected hex, base32z or base64"};
+    (void)decode_pubkey(pk);
 }
 
 ustring decode_pubkey(std::string_view pk) {
     session::ustring pubkey;
-    pubkey.reserve(32);
-    if (pk.size() == 64 && oxenc::is_hex(pk))
-        oxenc::from_hex(pk.begin(), pk.end(), std::back_inserter(pubkey));
-    else if ((pk.size() == 43 || (pk.size() == 44 && pk.back() == '=')) && oxenc::is_base64(pk))
-        oxenc::from_base64(pk.begin(), pk.end(), std::back_inserter(pubkey));
-    else if (pk.size() == 52 && oxenc::is_base32z(pk))
+    if (pk.size() == 64) {
+        pubkey.resize(32);
+        if (encoding::from_hex(pk, pubkey.data()))
+            return pubkey;
+    } else if (pk.size() == 43 || (pk.size() == 44 && pk.back() == '=')) {
+        pubkey.resize(encoding::base64_decoded_size(pk));
+        if (encoding::from_base64(pk, pubkey.data()))
+            return pubkey;
+    } else if (pk.size() == 52 && oxenc::is_base32z(pk)) {
+        pubkey.reserve(32);
         oxenc::from_base32z(pk.begin(), pk.end(), std::back_inserter(pubkey));
-    else
-        throw std::invalid_argument{"Invalid encoded pubkey: expected hex, base32z or base64"};
-    return pubkey;
+        return pubkey;
+    }
+    throw std::invalid_argument{"Invalid encoded pubkey: expected hex, base32z or base64"};
 }
 
 void make_lc(std::string& s) {
@@ -100,6 +106,71 @@ std::optional<ustring> maybe_ustring(const session::config::dict& d, const char*
     return result;
 }
 
+size_t heap_usage(const std::string& s) {
+    // Strings that fit in the small string buffer don't allocate:
+    static const size_t sso_capacity = std::string{}.capacity();
+    return s.capacity() > sso_capacity ? s.capacity() + 1 : 0;
+}
+
+static size_t heap_usage(const scalar& s) {
+    auto* str = std::get_if<std::string>(&s);
+    return str ? heap_usage(*str) : 0;
+}
+
+size_t heap_usage(const set& s) {
+    size_t total = s.size() * (TREE_NODE_OVERHEAD + sizeof(scalar));
+    for (const auto& v : s)
+        total += heap_usage(v);
+    return total;
+}
+
+size_t heap_usage(const dict& d) {
+    size_t total = d.size() * (TREE_NODE_OVERHEAD + sizeof(dict::value_type));
+    for (const auto& [k, v] : d) {
+        total += heap_usage(k);
+        if (auto* sub = std::get_if<dict>(&v))
+            total += heap_usage(*sub);
+        else if (auto* s = std::get_if<set>(&v))
+            total += heap_usage(*s);
+        else if (auto* sc = std::get_if<scalar>(&v))
+            total += heap_usage(*sc);
+    }
+    return total;
+}
+
+static size_t heap_usage(const oxenc::bt_value& v) {
+    if (auto* s = std::get_if<std::string>(&v))
+        return heap_usage(*s);
+    if (auto* l = std::get_if<oxenc::bt_list>(&v))
+        return heap_usage(*l);
+    if (auto* d = std::get_if<oxenc::bt_dict>(&v))
+        return heap_usage(*d);
+    return 0;
+}
+
+size_t heap_usage(const oxenc::bt_dict& d) {
+    size_t total = d.size() * (TREE_NODE_OVERHEAD + sizeof(oxenc::bt_dict::value_type));
+    for (const auto& [k, v] : d)
+        total += heap_usage(k) + heap_usage(v);
+    return total;
+}
+
+size_t heap_usage(const oxenc::bt_list& l) {
+    size_t total = l.size() * (LIST_NODE_OVERHEAD + sizeof(oxenc::bt_value));
+    for (const auto& v : l)
+        total += heap_usage(v);
+    return total;
+}
+
+size_t heap_usage(const std::unordered_set<std::string>& s) {
+    // An empty set with a single bucket doesn't allocate a bucket array:
+    size_t total = (s.bucket_count() > 1 ? s.bucket_count() * sizeof(void*) : 0) +
+                   s.size() * (HASH_NODE_OVERHEAD + sizeof(std::string));
+    for (const auto& v : s)
+        total += heap_usage(v);
+    return total;
+}
+
 void set_flag(ConfigBase::DictFieldProxy&& field, bool val) {
     if (val)
         field = 1;
@@ -179,8 +250,12 @@ namespace {
     struct zstd_decomp_freer {
         void operator()(ZSTD_DStream* z) const { ZSTD_freeDStream(z); }
     };
+    struct zstd_comp_freer {
+        void operator()(ZSTD_CCtx* z) const { ZSTD_freeCCtx(z); }
+    };
 
     using zstd_decomp_ptr = std::unique_ptr<ZSTD_DStream, zstd_decomp_freer>;
+    using zstd_comp_ptr = std::unique_ptr<ZSTD_CCtx, zstd_comp_freer>;
 }  // namespace
 
 ustring zstd_compress(ustring_view data, int level, ustring_view prefix) {
@@ -204,6 +279,28 @@ ustring zstd_compress(ustring_view data, int level, ustring_view prefix) {
     return compressed;
 }
 
+ustring_view zstd_compress_scratch(ustring_view data, int level, ustring_view prefix) {
+    thread_local zstd_comp_ptr cctx{ZSTD_createCCtx()};
+    thread_local ustring buf;
+
+    size_t needed = prefix.size() + ZSTD_compressBound(data.size());
+    if (buf.size() < needed)
+        buf.resize(needed);
+    if (!prefix.empty())
+        std::memcpy(buf.data(), prefix.data(), prefix.size());
+    auto size = ZSTD_compressCCtx(
+            cctx.get(),
+            buf.data() + prefix.size(),
+            buf.size() - prefix.size(),
+            data.data(),
+            data.size(),
+            level);
+    if (ZSTD_isError(size))
+        throw std::runtime_error{"Compression failed: " + std::string{ZSTD_getErrorName(size)}};
+
+    return {buf.data(), prefix.size() + size};
+}
+
 std::optional<ustring> zstd_decompress(ustring_view data, size_t max_size) {
     zstd_decomp_ptr z_decompressor{ZSTD_createDStream()};
     auto* zds = z_decompressor.get();
@@ -6,6 +6,7 @@
 #include <memory>
 #include <string_view>
 #include <type_traits>
+#include <unordered_set>
 
 #include "session/config/base.h"
 #include "session/config/base.hpp"
@@ -165,6 +166,58 @@ std::optional<ustring> maybe_ustring(const session::config::dict& d, const char*
 // string view is only valid as long as the dict stays unchanged.
 std::optional<std::string_view> maybe_sv(const session::config::dict& d, const char* key);
 
+/// A field of a config entry type `T` for use with `load_fields()`: the dict key of the field, and
+/// a function that loads the field's value into a `T`.  The function is called with nullptr if the
+/// key is not present in the dict, so that it can reset the field to its default.
+template <typename T>
+struct entry_field {
+    std::string_view key;
+    void (*load)(T& entry, const dict_value* value);
+};
+
+/// Returns true if the given fields are in strictly increasing key order, as required by
+/// `load_fields()`.  Intended to be used in a static_assert on each field table.
+template <typename T, size_t N>
+constexpr bool fields_sorted(const entry_field<T> (&fields)[N]) {
+    for (size_t i = 1; i < N; i++)
+        if (!(fields[i - 1].key < fields[i].key))
+            return false;
+    return true;
+}
+
+/// Loads a config entry from its dict by walking the (sorted) dict and the (sorted) field table
+/// together, calling each field's load function once, rather than doing a separate dict lookup for
+/// each field.  Fields are loaded in key order, so a field's load function can depend on fields
+/// with smaller keys having already been loaded.  Dict keys without a field are ignored.
+template <typename T, size_t N>
+void load_fields(T& entry, const dict& d, const entry_field<T> (&fields)[N]) {
+    auto it = d.begin();
+    for (const auto& f : fields) {
+        while (it != d.end() && it->first < f.key)
+            ++it;
+        f.load(entry, it != d.end() && it->first == f.key ? &it->second : nullptr);
+    }
+}
+
+/// Helpers for `entry_field` load functions: these return the integer, string, or set value of a
+/// field, returning the fallback (or nullptr) if the field is missing or of a different type.
+inline int64_t field_int(const dict_value* v, int64_t fallback = 0) {
+    if (v)
+        if (auto* sc = std::get_if<scalar>(v))
+            if (auto* i = std::get_if<int64_t>(sc))
+                return *i;
+    return fallback;
+}
+inline const std::string* field_str(const dict_value* v) {
+    if (v)
+        if (auto* sc = std::get_if<scalar>(v))
+            return std::get_if<std::string>(sc);
+    return nullptr;
+}
+inline const config::set* field_set(const dict_value* v) {
+    return v ? std::get_if<config::set>(v) : nullptr;
+}
+
 /// Sets a value to 1 if true, removes it if false.
 void set_flag(ConfigBase::DictFieldProxy&& field, bool val);
 
@@ -209,10 +262,42 @@ void load_unknowns(
         std::string_view previous,
         std::string_view until);
 
+/// Approximate per-node overheads of std::map/std::set (a red-black tree node: colour plus three
+/// pointers), std::list (two pointers) and std::unordered_set (next pointer plus cached hash), for
+/// `memory_usage()` estimates.
+inline constexpr size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+inline constexpr size_t LIST_NODE_OVERHEAD = 2 * sizeof(void*);
+inline constexpr size_t HASH_NODE_OVERHEAD = 2 * sizeof(void*);
+
+/// Estimates the heap memory held by a value for `memory_usage()`.  This includes everything the
+/// value owns (buffers, container nodes, and nested values) but not `sizeof` the value itself.
+size_t heap_usage(const std::string& s);
+size_t heap_usage(const dict& d);
+size_t heap_usage(const set& s);
+size_t heap_usage(const oxenc::bt_dict& d);
+size_t heap_usage(const oxenc::bt_list& l);
+size_t heap_usage(const std::unordered_set<std::string>& s);
+
+/// Copies a memory usage estimate into the C API struct.
+inline void copy_memory_usage(const MemoryUsage& from, config_memory_usage& to) {
+    to.data = from.data;
+    to.diffs = from.diffs;
+    to.pending = from.pending;
+    to.hashes = from.hashes;
+    to.keys = from.keys;
+    to.other = from.other;
+    to.total = from.total();
+}
+
 /// ZSTD-compresses a value.  `prefix` can be prepended on the returned value, if needed.  Throws on
 /// serious error.
 ustring zstd_compress(ustring_view data, int level = 1, ustring_view prefix = {});
 
+/// Same as `zstd_compress`, but compresses into a reusable, thread-local buffer using a reusable
+/// compression context, so that repeated calls do not allocate.  The returned view is only valid
+/// until the next call to this function from the same thread.
+ustring_view zstd_compress_scratch(ustring_view data, int level = 1, ustring_view prefix = {});
+
 /// ZSTD-decompresses a value.  Returns nullopt if decompression fails.  If max_size is non-zero
 /// then this returns nullopt if the decompressed size would exceed that limit.
 std::optional<ustring> zstd_decompress(ustring_view data, size_t max_size = 0);
@@ -1,14 +1,20 @@
 #include "session/config/protos.hpp"
 
+#include <sodium/crypto_box.h>
 #include <sodium/crypto_scalarmult.h>
 #include <sodium/crypto_sign_ed25519.h>
 
 #include <array>
+#include <cassert>
+#include <cstring>
+#include <optional>
 #include <stdexcept>
+#include <type_traits>
 
 #include "SessionProtos.pb.h"
 #include "WebSocketResources.pb.h"
 #include "session/session_encrypt.hpp"
+#include "session/sodium_array.hpp"
 
 namespace session::config::protos {
 
@@ -30,38 +36,201 @@ namespace {
         }
     }
 
-}  // namespace
+    // Minimal protobuf wire format reading, used to dig through the wrapping layers without doing a
+    // full (allocating and copying) protobuf parse of each layer.
+    bool read_varint(ustring_view& in, uint64_t& val) {
+        val = 0;
+        for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+            auto b = in.front();
+            in.remove_prefix(1);
+            val |= uint64_t{b & 0x7fu} << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
 
-ustring wrap_config(
-        ustring_view ed25519_sk, ustring_view data, int64_t seqno, config::Namespace t) {
-    std::array<unsigned char, 64> tmp_sk;
-    if (ed25519_sk.size() == 32) {
-        std::array<unsigned char, 32> ignore_pk;
-        crypto_sign_ed25519_seed_keypair(ignore_pk.data(), tmp_sk.data(), ed25519_sk.data());
-        ed25519_sk = {tmp_sk.data(), 64};
-    } else if (ed25519_sk.size() != 64)
-        throw std::invalid_argument{
-                "Error: ed25519_sk is not the expected 64-byte Ed25519 secret key"};
+    // Walks the top-level fields of a serialized protobuf message, calling `f(field, value)` for
+    // each varint field and `f(field, bytes)` for each length-delimited field (fixed-size fields
+    // are skipped).  Returns false if the data is not a well-formed protobuf message, i.e. if it
+    // contains an invalid tag or wire type, or if any field runs past the end of the data.
+    template <typename Func>
+    bool for_each_field(ustring_view in, Func&& f) {
+        while (!in.empty()) {
+            uint64_t key;
+            if (!read_varint(in, key) || (key >> 3) == 0)
+                return false;
+            uint64_t field = key >> 3;
+            uint64_t value;
+            switch (key & 0b111) {
+                case 0:  // varint
+                    if (!read_varint(in, value))
+                        return false;
+                    f(field, value);
+                    break;
+                case 1:  // fixed64
+                    if (in.size() < 8)
+                        return false;
+                    in.remove_prefix(8);
+                    break;
+                case 2:  // length-delimited
+                    if (!read_varint(in, value) || value > in.size())
+                        return false;
+                    f(field, in.substr(0, value));
+                    in.remove_prefix(value);
+                    break;
+                case 5:  // fixed32
+                    if (in.size() < 4)
+                        return false;
+                    in.remove_prefix(4);
+                    break;
+                default: return false;
+            }
+        }
+        return true;
+    }
 
-    std::array<unsigned char, 32> my_xpk;
-    if (0 != crypto_sign_ed25519_pk_to_curve25519(my_xpk.data(), ed25519_sk.data() + 32))
-        throw std::invalid_argument{
-                "Failed to convert Ed25519 pubkey to X25519; invalid secret key?"};
+    // Extracts the length-delimited field `field` from a protobuf message, if the message is
+    // well-formed and contains it.  (If repeated, the last one wins, as with protobuf parsing).
+    std::optional<ustring_view> find_bytes_field(ustring_view in, uint64_t field) {
+        std::optional<ustring_view> found;
+        bool ok = for_each_field(in, [&](uint64_t f, auto val) {
+            if constexpr (std::is_same_v<decltype(val), ustring_view>)
+                if (f == field)
+                    found = val;
+        });
+        if (!ok)
+            found.reset();
+        return found;
+    }
+
+    // Protobuf wire types that we use
+    constexpr unsigned char WIRE_VARINT = 0, WIRE_LEN = 2;
 
+    // Returns a (single byte) protobuf field tag; all the fields we write have field numbers < 16.
+    constexpr unsigned char tag(unsigned char field, unsigned char wire_type) {
+        return field << 3 | wire_type;
+    }
+
+    size_t varint_size(uint64_t v) {
+        size_t size = 1;
+        for (; v >= 0x80; v >>= 7)
+            size++;
+        return size;
+    }
+
+    void append_varint(ustring& out, uint64_t v) {
+        for (; v >= 0x80; v >>= 7)
+            out += static_cast<unsigned char>(v | 0x80);
+        out += static_cast<unsigned char>(v);
+    }
+
+    // Appends the tag and length of a length-delimited field; the caller appends the value.
+    void append_len_field(ustring& out, unsigned char field, size_t len) {
+        out += tag(field, WIRE_LEN);
+        append_varint(out, len);
+    }
+
+    // Size of a length-delimited field with a value of the given length
+    size_t len_field_size(size_t len) {
+        return 1 + varint_size(len) + len;
+    }
+
+    // Digs through the WebSocketMessage -> WebSocketRequestMessage -> Envelope layers of a wrapped
+    // config message to find the (encrypted) Envelope content, without parsing into protobuf
+    // objects or copying anything.  Returns nullptr on success (and sets `content`), or an error
+    // string describing why the data is not a valid wrapped message.
+    const char* find_envelope_content(ustring_view data, ustring_view& content) {
+        bool is_request = false;
+        std::optional<ustring_view> request;
+        bool ok = for_each_field(data, [&](uint64_t f, auto val) {
+            if constexpr (std::is_same_v<decltype(val), ustring_view>) {
+                if (f == 2)
+                    request = val;
+            } else if (f == 1)
+                is_request = val == WebSocketProtos::WebSocketMessage_Type_REQUEST;
+        });
+        if (!ok)
+            return "Failed to parse WebSocketMessage";
+        if (!is_request || !request)
+            return "Error: received invalid WebSocketRequest";
+
+        auto body = find_bytes_field(*request, 3);
+        if (!body)
+            return "Failed to parse WebSocketRequest";
+
+        // Envelope has required `type` (1) and `timestamp` (5) fields, plus the content (8) we want
+        bool has_type = false, has_timestamp = false;
+        std::optional<ustring_view> env_content;
+        ok = for_each_field(*body, [&](uint64_t f, auto val) {
+            if constexpr (std::is_same_v<decltype(val), ustring_view>) {
+                if (f == 8)
+                    env_content = val;
+            } else if (f == 1)
+                has_type = true;
+            else if (f == 5)
+                has_timestamp = true;
+        });
+        if (!ok || !has_type || !has_timestamp || !env_content)
+            return "Failed to parse Envelope";
+
+        content = *env_content;
+        return nullptr;
+    }
+
+    void load_ed25519_sk(ustring_view& ed25519_sk, cleared_uc64& tmp_sk) {
+        if (ed25519_sk.size() == 32) {
+            std::array<unsigned char, 32> ignore_pk;
+            crypto_sign_ed25519_seed_keypair(ignore_pk.data(), tmp_sk.data(), ed25519_sk.data());
+            ed25519_sk = {tmp_sk.data(), 64};
+        } else if (ed25519_sk.size() != 64)
+            throw std::invalid_argument{
+                    "Error: ed25519_sk is not the expected 64-byte Ed25519 secret key"};
+    }
+
+}  // namespace
+
+bool is_protobuf_wrapped(ustring_view data) noexcept {
+    // The encrypted content must be at least large enough to hold the sealed box overhead, sender
+    // pubkey and signature.
+    ustring_view content;
+    return !find_envelope_content(data, content) &&
+           content.size() >= crypto_box_SEALBYTES + 32 + 64;
+}
+
+// Does the actual wrapping, given the 64-byte Ed25519 secret key and the X25519 pubkey derived from
+// it.
+static ustring wrap_config(
+        ustring_view ed25519_sk,
+        ustring_view my_xpk,
+        ustring_view data,
+        int64_t seqno,
+        config::Namespace t) {
     if (static_cast<int16_t>(t) > 5)
         throw std::invalid_argument{"Error: received invalid outgoing SharedConfigMessage type"};
 
-    // Wrap in a SharedConfigMessage inside a Content
-    SessionProtos::Content config{};
-    auto& shconf = *config.mutable_sharedconfigmessage();
-    shconf.set_kind(encode_namespace(t));
-    shconf.set_seqno(seqno);
-    *shconf.mutable_data() = from_unsigned_sv(data);
+    // Wrap in a SharedConfigMessage inside a Content.  These (and the other wrapping layers below)
+    // are trivial, fixed-layout messages so rather than building (and copying the data into) each
+    // layer as a protobuf object we write the protobuf encoding directly, in the same field order
+    // that protobuf itself would use.
+    const uint64_t kind = encode_namespace(t);
+    const size_t shconf_size = 1 + varint_size(kind) + 1 +
+                               varint_size(static_cast<uint64_t>(seqno)) +
+                               len_field_size(data.size());
 
     // Then we serialize that, pad it, and encrypt it.  Copying this relevant comment from the
     // Session codebase (the comment itself git blames to Signal):
     // NOTE: This is dumb.
-    auto shared_conf = config.SerializeAsString();
+    ustring shared_conf;
+    shared_conf.reserve(len_field_size(shconf_size) + 1);
+    append_len_field(shared_conf, 11, shconf_size);  // Content.sharedConfigMessage
+    shared_conf += tag(1, WIRE_VARINT);              // SharedConfigMessage.kind
+    append_varint(shared_conf, kind);
+    shared_conf += tag(2, WIRE_VARINT);  // SharedConfigMessage.seqno
+    append_varint(shared_conf, static_cast<uint64_t>(seqno));
+    append_len_field(shared_conf, 3, data.size());  // SharedConfigMessage.data
+    shared_conf += data;
+
     // Okay now let's talk about padding.  Remember, though:
     // NOTE: This is dumb.
     // Okay so to be more specific, padding adds a 0x80 byte followed by any number (including 0) of
@@ -70,24 +239,15 @@ ustring wrap_config(
     // padded length we want, mathematically, is ⌈(x+1)/160⌉ * 160.  With integer division,
     // ceil(a/b) is (a+b-1)/b, so for a=x+1 we get: (x+1+b-1)/b*b = (x+b)/b*b = (x/b + 1)*b.
     //
-#if 0
-    const size_t unpadded_size = shared_conf.size();
-    const size_t padded_size = (unpadded_size / 160 + 1) * 160;
-    assert(padded_size > shared_conf.size());
-    shared_conf.resize(padded_size);
-    shared_conf[unpadded_size] = 0x80;
-#else
     // But this is all moot for a config message which is *already* padded to a multiple of 256, so
     // just tack on the 0x80 and no 0x00s rather than making it bigger still.
-    shared_conf += '\x80';
-#endif
+    shared_conf += 0x80;
 
     // Now we encrypt using the session protocol encryption, but with sender == recipient ==
     // ourself.  This is unnecessary because the inner content is already encrypted with a value
     // derived from our private key, but old Session clients expect this.
     // NOTE: This is dumb.
-    auto enc_shared_conf = encrypt_for_recipient_deterministic(
-            ed25519_sk, {my_xpk.data(), my_xpk.size()}, to_unsigned_sv(shared_conf));
+    auto enc_shared_conf = encrypt_for_recipient_deterministic(ed25519_sk, my_xpk, shared_conf);
 
     // This is the point in session client code where this value got base64-encoded, passed to
     // another function, which then base64-decoded that value to put into the envelope.  We're going
@@ -95,58 +255,98 @@ ustring wrap_config(
     // enc_shared_conf = oxenc::from_base64(oxenc::to_base64(enc_shared_conf));
     // NOTE: This is dumb.
 
-    // Now we just keep on trucking with more protobuf:
-    auto envelope = SessionProtos::Envelope();
-    *envelope.mutable_content() = from_unsigned_sv(enc_shared_conf);
-    envelope.set_timestamp(1);  // Old session clients with their own unwrapping require this > 0
-    envelope.set_type(SessionProtos::Envelope_Type::Envelope_Type_SESSION_MESSAGE);
+    // Now we just keep on trucking with more protobuf: an Envelope with type (1), timestamp (5)
+    // and content (8).  Old session clients with their own unwrapping require timestamp > 0.
+    const auto envelope_type =
+            static_cast<uint64_t>(SessionProtos::Envelope_Type::Envelope_Type_SESSION_MESSAGE);
+    const size_t envelope_size =
+            1 + varint_size(envelope_type) + 2 + len_field_size(enc_shared_conf.size());
 
     // And more protobuf (even though this no one cares about anything other than the body in this
-    // one):
+    // one): a WebSocketRequestMessage with empty verb (1) and path (2), the envelope as body (3),
+    // and requestId (4) of 0.
     // NOTE: This is dumb.
-    auto webreq = WebSocketProtos::WebSocketRequestMessage();
-    webreq.set_verb("");
-    webreq.set_path("");
-    webreq.set_requestid(0);
-    *webreq.mutable_body() = envelope.SerializeAsString();
+    const size_t webreq_size = 2 + 2 + len_field_size(envelope_size) + 2;
 
     // And then yet more protobuf (even though this no one cares about anything other than the body
-    // in this one, again):
+    // in this one, again): a WebSocketMessage with type (1) REQUEST and the request (2).
     // NOTE: This is dumb.
-    auto msg = WebSocketProtos::WebSocketMessage();
-    msg.set_type(WebSocketProtos::WebSocketMessage_Type_REQUEST);
-    *msg.mutable_request() = webreq;
+    const auto msg_type = static_cast<uint64_t>(WebSocketProtos::WebSocketMessage_Type_REQUEST);
+
+    // Now write all of that, from the outside in, so that the encrypted payload gets copied just
+    // once:
+    ustring msg;
+    msg.reserve(1 + varint_size(msg_type) + len_field_size(webreq_size));
+    msg += tag(1, WIRE_VARINT);  // WebSocketMessage.type
+    append_varint(msg, msg_type);
+    append_len_field(msg, 2, webreq_size);  // WebSocketMessage.request
+    append_len_field(msg, 1, 0);            // WebSocketRequestMessage.verb
+    append_len_field(msg, 2, 0);            // WebSocketRequestMessage.path
+    append_len_field(msg, 3, envelope_size);  // WebSocketRequestMessage.body
+    msg += tag(1, WIRE_VARINT);               // Envelope.type
+    append_varint(msg, envelope_type);
+    msg += tag(5, WIRE_VARINT);  // Envelope.timestamp
+    append_varint(msg, 1);
+    append_len_field(msg, 8, enc_shared_conf.size());  // Envelope.content
+    msg += enc_shared_conf;
+    msg += tag(4, WIRE_VARINT);  // WebSocketRequestMessage.requestId
+    append_varint(msg, 0);
+
+    assert(msg.size() == 1 + varint_size(msg_type) + len_field_size(webreq_size));
+    return msg;
+}
+
+ustring wrap_config(
+        ustring_view ed25519_sk, ustring_view data, int64_t seqno, config::Namespace t) {
+    cleared_uc64 tmp_sk;
+    load_ed25519_sk(ed25519_sk, tmp_sk);
+
+    std::array<unsigned char, 32> my_xpk;
+    if (0 != crypto_sign_ed25519_pk_to_curve25519(my_xpk.data(), ed25519_sk.data() + 32))
+        throw std::invalid_argument{
+                "Failed to convert Ed25519 pubkey to X25519; invalid secret key?"};
 
-    return ustring{to_unsigned_sv(msg.SerializeAsString())};
+    return wrap_config(ed25519_sk, {my_xpk.data(), my_xpk.size()}, data, seqno, t);
+}
+
+ustring wrap_config(
+        const SessionIdentity& id, ustring_view data, int64_t seqno, config::Namespace t) {
+    return wrap_config(id.ed25519_secret(), id.x25519_pubkey(), data, seqno, t);
 }
 
 ustring unwrap_config(ustring_view ed25519_sk, ustring_view data, config::Namespace ns) {
-    // Hurray, we get to undo everything from the above!
+    cleared_uc64 tmp_sk;
+    load_ed25519_sk(ed25519_sk, tmp_sk);
 
-    std::array<unsigned char, 64> tmp_sk;
-    if (ed25519_sk.size() == 32) {
-        std::array<unsigned char, 32> ignore_pk;
-        crypto_sign_ed25519_seed_keypair(ignore_pk.data(), tmp_sk.data(), ed25519_sk.data());
-        ed25519_sk = {tmp_sk.data(), 64};
-    } else if (ed25519_sk.size() != 64)
-        throw std::invalid_argument{
-                "Error: ed25519_sk is not the expected 64-byte Ed25519 secret key"};
-    auto ed25519_pk = ed25519_sk.substr(32);
+    cleared_uc32 x_sec;
+    uc32 x_pub;
+    crypto_sign_ed25519_sk_to_curve25519(x_sec.data(), ed25519_sk.data());
+    crypto_scalarmult_base(x_pub.data(), x_sec.data());
 
-    WebSocketProtos::WebSocketMessage req{};
+    return unwrap_config(
+            ed25519_sk.substr(32), {x_pub.data(), 32}, {x_sec.data(), 32}, data, ns);
+}
+
+ustring unwrap_config(const SessionIdentity& id, ustring_view data, config::Namespace ns) {
+    return unwrap_config(id.ed25519_pubkey(), id.x25519_pubkey(), id.x25519_secret(), data, ns);
+}
 
-    if (!req.ParseFromArray(data.data(), data.size()))
-        throw std::runtime_error{"Failed to parse WebSocketMessage"};
+ustring unwrap_config(
+        ustring_view ed25519_pk,
+        ustring_view x25519_pk,
+        ustring_view x25519_sk,
+        ustring_view data,
+        config::Namespace ns) {
+    // Hurray, we get to undo everything from the above!
 
-    const auto& msg_type = req.type();
-    if (req.type() != WebSocketProtos::WebSocketMessage_Type_REQUEST)
-        throw std::runtime_error{"Error: received invalid WebSocketRequest"};
+    if (ed25519_pk.size() != 32 || x25519_pk.size() != 32 || x25519_sk.size() != 32)
+        throw std::invalid_argument{"Error: unwrap_config requires 32-byte pubkeys and secret key"};
 
-    SessionProtos::Envelope envelope{};
-    if (!envelope.ParseFromString(req.request().body()))
-        throw std::runtime_error{"Failed to parse Envelope"};
+    ustring_view enc_content;
+    if (auto* err = find_envelope_content(data, enc_content))
+        throw std::runtime_error{err};
 
-    auto [content, sender] = decrypt_incoming(ed25519_sk, to_unsigned_sv(envelope.content()));
+    auto [content, sender] = decrypt_incoming(x25519_pk, x25519_sk, enc_content);
     if (sender != ed25519_pk)
         throw std::runtime_error{"Incoming config data was not from us; ignoring"};
 
@@ -162,18 +362,37 @@ ustring unwrap_config(ustring_view ed25519_sk, ustring_view data, config::Namesp
     else
         throw std::runtime_error{"Incoming config data has invalid padding"};
 
-    SessionProtos::Content config{};
-    if (!config.ParseFromArray(content.data(), content.size()))
+    auto shconf = find_bytes_field(content, 11);  // Content.sharedConfigMessage
+    if (!shconf) {
+        if (for_each_field(content, [](auto&&...) {}))
+            throw std::runtime_error{"Content is missing a SharedConfigMessage"};
         throw std::runtime_error{"Failed to parse SharedConfig"};
+    }
 
-    if (!config.has_sharedconfigmessage())
-        throw std::runtime_error{"Content is missing a SharedConfigMessage"};
-    auto& shconf = config.sharedconfigmessage();
-    if (shconf.kind() != encode_namespace(ns))
+    // SharedConfigMessage has required kind (1), seqno (2), and data (3) fields:
+    std::optional<uint64_t> kind;
+    bool has_seqno = false;
+    std::optional<ustring_view> conf_data;
+    bool ok = for_each_field(*shconf, [&](uint64_t f, auto val) {
+        if constexpr (std::is_same_v<decltype(val), ustring_view>) {
+            if (f == 3)
+                conf_data = val;
+        } else if (f == 1)
+            kind = val;
+        else if (f == 2)
+            has_seqno = true;
+    });
+    if (!ok || !kind || !has_seqno || !conf_data)
+        throw std::runtime_error{"Failed to parse SharedConfig"};
+    if (*kind != static_cast<uint64_t>(encode_namespace(ns)))
         throw std::runtime_error{"SharedConfig has wrong kind for config namespace"};
 
-    // if ParseFromString fails, we have a raw (not protobuf encoded) message
-    return ustring{to_unsigned_sv(shconf.data())};
+    // Shift the config data down to the beginning of the decrypted buffer rather than copying it
+    // into a new one:
+    auto size = conf_data->size();
+    std::memmove(content.data(), conf_data->data(), size);
+    content.resize(size);
+    return std::move(content);
 }
 
 }  // namespace session::config::protos
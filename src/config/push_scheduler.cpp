@@ -0,0 +1,84 @@
+#include "session/config/push_scheduler.hpp"
+
+#include <algorithm>
+
+namespace session::config {
+
+using namespace std::literals;
+
+PushScheduler::PushScheduler(
+        std::chrono::milliseconds debounce, std::chrono::milliseconds max_latency) :
+        _debounce{std::max(debounce, 0ms)}, _max_latency{std::max(max_latency, _debounce)} {}
+
+void PushScheduler::add(ConfigBase& config) {
+    for (auto& t : _configs)
+        if (t.config == &config)
+            return;
+    _configs.push_back({&config, config.edit_count(), std::nullopt, std::nullopt, false});
+}
+
+bool PushScheduler::remove(const ConfigBase& config) {
+    auto it = std::find_if(_configs.begin(), _configs.end(), [&](const tracked& t) {
+        return t.config == &config;
+    });
+    if (it == _configs.end())
+        return false;
+    _configs.erase(it);
+    return true;
+}
+
+PushAdvice PushScheduler::advise(clock::time_point now) {
+    PushAdvice advice;
+    std::optional<clock::time_point> next_due;
+
+    for (auto& t : _configs) {
+        auto& conf = *t.config;
+        auto edits = conf.edit_count();
+        if (!conf.is_dirty()) {
+            t.dirty_since.reset();
+            t.last_edit.reset();
+            t.merged = false;
+            t.edits = edits;
+            continue;
+        }
+
+        if (!t.dirty_since) {
+            t.dirty_since = now;
+            // If it became dirty without any edits we've seen then the change came from a merge
+            // (or from before we started tracking it), and so shouldn't be deferred.
+            t.merged = edits == t.edits;
+        }
+        if (edits != t.edits)
+            t.last_edit = now;
+        t.edits = edits;
+
+        auto due = t.merged || !t.last_edit
+                         ? now
+                         : std::min(*t.last_edit + _debounce, *t.dirty_since + _max_latency);
+        if (!next_due || due < *next_due)
+            next_due = due;
+        advice.configs.push_back(&conf);
+    }
+
+    if (!next_due) {
+        // Nothing pending
+    } else if (*next_due <= now) {
+        advice.push_now = true;
+        // We assume the caller pushes what we tell them to; if they don't then any config still
+        // dirty without further edits will be considered due again as soon as we next see it.
+        for (auto& t : _configs) {
+            if (t.dirty_since) {
+                t.dirty_since.reset();
+                t.last_edit.reset();
+                t.merged = false;
+            }
+        }
+    } else {
+        advice.configs.clear();
+        advice.wait = std::chrono::ceil<std::chrono::milliseconds>(*next_due - now);
+    }
+
+    return advice;
+}
+
+}  // namespace session::config
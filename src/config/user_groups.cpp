@@ -2,7 +2,6 @@
 
 #include <oxenc/base32z.h>
 #include <oxenc/base64.h>
-#include <oxenc/hex.h>
 #include <oxenc/variant.h>
 #include <sodium/crypto_generichash_blake2b.h>
 #include <sodium/crypto_sign.h>
@@ -15,6 +14,7 @@
 #include "internal.hpp"
 #include "session/config/error.h"
 #include "session/config/user_groups.h"
+#include "session/encoding.hpp"
 #include "session/export.h"
 #include "session/types.hpp"
 #include "session/util.hpp"
@@ -127,55 +127,95 @@ void legacy_group_info::into(ugroups_legacy_group_info& c) && {
     static_cast<ugroups_internals*>(c._internal)->members = std::move(members_);
 }
 
-void base_group_info::load(const dict& info_dict) {
-    priority = maybe_int(info_dict, "+").value_or(0);
-    joined_at = std::max<int64_t>(0, maybe_int(info_dict, "j").value_or(0));
-
-    int notify = maybe_int(info_dict, "@").value_or(0);
+// Field load functions for the fields shared by all the group types, for use in the field tables
+// of the individual group types.
+template <typename T>
+static void load_mute_until(T& g, const dict_value* v) {
+    g.mute_until = field_int(v);
+}
+template <typename T>
+static void load_priority(T& g, const dict_value* v) {
+    g.priority = field_int(v);
+}
+template <typename T>
+static void load_notifications(T& g, const dict_value* v) {
+    auto notify = field_int(v);
     if (notify >= 0 && notify <= 3)
-        notifications = static_cast<notify_mode>(notify);
+        g.notifications = static_cast<notify_mode>(notify);
     else
-        notifications = notify_mode::defaulted;
-
-    mute_until = maybe_int(info_dict, "!").value_or(0);
-
-    invited = maybe_int(info_dict, "i").value_or(0);
+        g.notifications = notify_mode::defaulted;
+}
+template <typename T>
+static void load_invited(T& g, const dict_value* v) {
+    g.invited = field_int(v);
+}
+template <typename T>
+static void load_joined_at(T& g, const dict_value* v) {
+    g.joined_at = std::max<int64_t>(0, field_int(v));
+}
+template <typename T>
+static void load_name(T& g, const dict_value* v) {
+    auto* n = field_str(v);
+    g.name = n ? *n : "";
 }
 
 void legacy_group_info::load(const dict& info_dict) {
-    base_group_info::load(info_dict);
-
-    if (auto n = maybe_string(info_dict, "n"))
-        name = std::move(*n);
-    else
-        name.clear();
-
-    auto enc_pub = maybe_ustring(info_dict, "k");
-    auto enc_sec = maybe_ustring(info_dict, "K");
-    if (enc_pub && enc_sec && enc_pub->size() == 32 && enc_sec->size() == 32) {
-        enc_pubkey = std::move(*enc_pub);
-        enc_seckey = std::move(*enc_sec);
-    } else {
-        enc_pubkey.clear();
-        enc_seckey.clear();
-    }
-    if (auto secs = maybe_int(info_dict, "E").value_or(0); secs > 0)
-        disappearing_timer = std::chrono::seconds{secs};
-    else
-        disappearing_timer = 0s;
-
-    members_.clear();
-    if (auto* members = maybe_set(info_dict, "m"))
-        for (const auto& field : *members)
-            if (auto* s = std::get_if<std::string>(&field))
-                if (s->size() == 33 && (*s)[0] == 0x05)
-                    members_.emplace_hint(members_.end(), oxenc::to_hex(*s), false);
-
-    if (auto* members = maybe_set(info_dict, "a"))
-        for (const auto& field : *members)
-            if (auto* s = std::get_if<std::string>(&field))
-                if (s->size() == 33 && (*s)[0] == 0x05)
-                    members_.emplace(oxenc::to_hex(*s), true);
+    static constexpr entry_field<legacy_group_info> fields[] = {
+            {"!", load_mute_until<legacy_group_info>},
+            {"+", load_priority<legacy_group_info>},
+            {"@", load_notifications<legacy_group_info>},
+            {"E",
+             [](legacy_group_info& g, const dict_value* v) {
+                 auto secs = field_int(v);
+                 g.disappearing_timer = secs > 0 ? std::chrono::seconds{secs} : 0s;
+             }},
+            // Validated together with the pubkey ("k") below:
+            {"K",
+             [](legacy_group_info& g, const dict_value* v) {
+                 if (auto* sec = field_str(v))
+                     g.enc_seckey.assign(
+                             reinterpret_cast<const unsigned char*>(sec->data()), sec->size());
+                 else
+                     g.enc_seckey.clear();
+             }},
+            // Admins; this comes before the non-admin members ("m") so it also resets the member
+            // list.  If a session ID is somehow in both then it is treated as a non-admin.
+            {"a",
+             [](legacy_group_info& g, const dict_value* v) {
+                 g.members_.clear();
+                 if (auto* admins = field_set(v))
+                     for (const auto& field : *admins)
+                         if (auto* s = std::get_if<std::string>(&field))
+                             if (s->size() == 33 && (*s)[0] == 0x05)
+                                 g.members_.emplace_hint(
+                                         g.members_.end(), encoding::to_hex(*s), true);
+             }},
+            {"i", load_invited<legacy_group_info>},
+            {"j", load_joined_at<legacy_group_info>},
+            {"k",
+             [](legacy_group_info& g, const dict_value* v) {
+                 auto* pub = field_str(v);
+                 if (pub && pub->size() == 32 && g.enc_seckey.size() == 32) {
+                     g.enc_pubkey.assign(
+                             reinterpret_cast<const unsigned char*>(pub->data()), pub->size());
+                 } else {
+                     g.enc_pubkey.clear();
+                     g.enc_seckey.clear();
+                 }
+             }},
+            {"m",
+             [](legacy_group_info& g, const dict_value* v) {
+                 if (auto* members = field_set(v))
+                     for (const auto& field : *members)
+                         if (auto* s = std::get_if<std::string>(&field))
+                             if (s->size() == 33 && (*s)[0] == 0x05)
+                                 g.members_.insert_or_assign(encoding::to_hex(*s), false);
+             }},
+            {"n", load_name<legacy_group_info>},
+    };
+    static_assert(fields_sorted(fields));
+
+    load_fields(*this, info_dict, fields);
 }
 
 std::pair<size_t, size_t> legacy_group_info::counts() const {
@@ -226,23 +266,38 @@ void group_info::into(ugroups_group_info& c) const {
 }
 
 void group_info::load(const dict& info_dict) {
-    base_group_info::load(info_dict);
-
-    if (auto n = maybe_string(info_dict, "n"))
-        name = std::move(*n);
-    else
-        name.clear();
-
-    if (auto seed = maybe_ustring(info_dict, "K"); seed && seed->size() == 32) {
-        std::array<unsigned char, 33> pk;
-        pk[0] = 0x03;
-        secretkey.resize(64);
-        crypto_sign_seed_keypair(pk.data() + 1, secretkey.data(), seed->data());
-        if (id != oxenc::to_hex(pk.begin(), pk.end()))
-            secretkey.clear();
-    }
-    if (auto sig = maybe_ustring(info_dict, "s"); sig && sig->size() == 100)
-        auth_data = std::move(*sig);
+    static constexpr entry_field<group_info> fields[] = {
+            {"!", load_mute_until<group_info>},
+            {"+", load_priority<group_info>},
+            {"@", load_notifications<group_info>},
+            {"K",
+             [](group_info& g, const dict_value* v) {
+                 auto* seed = field_str(v);
+                 if (!seed || seed->size() != 32)
+                     return;
+                 std::array<unsigned char, 33> pk;
+                 pk[0] = 0x03;
+                 g.secretkey.resize(64);
+                 crypto_sign_seed_keypair(
+                         pk.data() + 1,
+                         g.secretkey.data(),
+                         reinterpret_cast<const unsigned char*>(seed->data()));
+                 if (g.id != encoding::to_hex({pk.data(), pk.size()}))
+                     g.secretkey.clear();
+             }},
+            {"i", load_invited<group_info>},
+            {"j", load_joined_at<group_info>},
+            {"n", load_name<group_info>},
+            {"s",
+             [](group_info& g, const dict_value* v) {
+                 if (auto* sig = field_str(v); sig && sig->size() == 100)
+                     g.auth_data.assign(
+                             reinterpret_cast<const unsigned char*>(sig->data()), sig->size());
+             }},
+    };
+    static_assert(fields_sorted(fields));
+
+    load_fields(*this, info_dict, fields);
 }
 
 void group_info::setKicked() {
@@ -255,10 +310,21 @@ bool group_info::kicked() const {
 }
 
 void community_info::load(const dict& info_dict) {
-    base_group_info::load(info_dict);
-
-    if (auto n = maybe_string(info_dict, "n"))
-        set_room(std::move(*n));
+    static constexpr entry_field<community_info> fields[] = {
+            {"!", load_mute_until<community_info>},
+            {"+", load_priority<community_info>},
+            {"@", load_notifications<community_info>},
+            {"i", load_invited<community_info>},
+            {"j", load_joined_at<community_info>},
+            {"n",
+             [](community_info& g, const dict_value* v) {
+                 if (auto* n = field_str(v))
+                     g.set_room(*n);
+             }},
+    };
+    static_assert(fields_sorted(fields));
+
+    load_fields(*this, info_dict, fields);
 }
 
 UserGroups::UserGroups(ustring_view ed25519_secretkey, std::optional<ustring_view> dumped) :
@@ -365,12 +431,7 @@ group_info UserGroups::create_group() const {
     ustring sk;
     sk.resize(64);
     crypto_sign_keypair(pk.data(), sk.data());
-    std::string pk_hex;
-    pk_hex.reserve(66);
-    pk_hex += "03";
-    oxenc::to_hex(pk.begin(), pk.end(), std::back_inserter(pk_hex));
-
-    group_info gr{std::move(pk_hex)};
+    group_info gr{encoding::to_prefixed_hex(0x03, {pk.data(), pk.size()})};
     gr.secretkey = std::move(sk);
     return gr;
 }
@@ -405,8 +466,7 @@ void UserGroups::set(const legacy_group_info& g) {
 
     config::set members, admins;
     for (const auto& [member, admin] : g.members_) {
-        assert(oxenc::is_hex(member));
-        (admin ? admins : members).emplace(oxenc::from_hex(member));
+        (admin ? admins : members).emplace(session_id_to_bytes(member));
     }
     info["m"] = std::move(members);
     info["a"] = std::move(admins);
@@ -548,7 +608,7 @@ bool UserGroups::iterator::check_it() {
 
         if (k.size() == 33 && k[0] == prefix) {
             if (auto* info_dict = std::get_if<dict>(&v)) {
-                _val = std::make_shared<any_group_info>(GroupInfo{oxenc::to_hex(k)});
+                _val = std::make_shared<any_group_info>(GroupInfo{encoding::to_hex(k)});
                 std::get<GroupInfo>(*_val).load(*info_dict);
                 return true;
             }
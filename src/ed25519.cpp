@@ -1,8 +1,15 @@
 #include "session/ed25519.hpp"
 
+#include <sodium/crypto_core_ed25519.h>
+#include <sodium/crypto_hash_sha512.h>
+#include <sodium/crypto_internal_fe25519.h>
 #include <sodium/crypto_sign.h>
 #include <sodium/crypto_sign_ed25519.h>
+#include <sodium/randombytes.h>
 
+#include <algorithm>
+#include <cstring>
+#include <map>
 #include <stdexcept>
 
 #include "session/export.h"
@@ -80,6 +87,459 @@ bool verify(ustring_view sig, ustring_view pubkey, ustring_view msg) {
             crypto_sign_ed25519_verify_detached(sig.data(), msg.data(), msg.size(), pubkey.data()));
 }
 
+namespace {
+
+    // Variable-time Edwards point arithmetic (in the extended coordinates and with the formulas
+    // used by libsodium's ref10 implementation) built on the field operations exported by
+    // libsodium-internal, used for batch verification.  Nothing here touches secret data.
+
+    struct fe {
+        fe25519 v;
+    };
+
+    fe fe_add(const fe& a, const fe& b) {
+        fe r;
+        crypto_internal_fe25519_add(r.v, a.v, b.v);
+        return r;
+    }
+    fe fe_sub(const fe& a, const fe& b) {
+        fe r;
+        crypto_internal_fe25519_sub(r.v, a.v, b.v);
+        return r;
+    }
+    fe fe_mul(const fe& a, const fe& b) {
+        fe r;
+        crypto_internal_fe25519_mul(r.v, a.v, b.v);
+        return r;
+    }
+    fe fe_sq(const fe& a) {
+        return fe_mul(a, a);
+    }
+    fe fe_sqn(fe a, int n) {
+        while (n-- > 0)
+            a = fe_sq(a);
+        return a;
+    }
+    fe fe_from(const unsigned char* s) {
+        fe r;
+        crypto_internal_fe25519_frombytes(r.v, s);
+        return r;
+    }
+    fe fe_one() {
+        fe r;
+        crypto_internal_fe25519_1(r.v);
+        return r;
+    }
+    fe fe_zero() {
+        auto one = fe_one();
+        return fe_sub(one, one);
+    }
+    fe fe_neg(const fe& a) {
+        return fe_sub(fe_zero(), a);
+    }
+    std::array<unsigned char, 32> fe_bytes(const fe& a) {
+        std::array<unsigned char, 32> s;
+        crypto_internal_fe25519_tobytes(s.data(), a.v);
+        return s;
+    }
+    bool fe_iszero(const fe& a) {
+        auto s = fe_bytes(a);
+        unsigned char c = 0;
+        for (auto b : s)
+            c |= b;
+        return c == 0;
+    }
+    bool fe_isnegative(const fe& a) {
+        return fe_bytes(a)[0] & 1;
+    }
+
+    // a^((p-5)/8) = a^(2^252 - 3)
+    fe fe_pow22523(const fe& z) {
+        fe t0 = fe_sq(z);
+        fe t1 = fe_mul(z, fe_sqn(t0, 2));
+        t0 = fe_mul(t0, t1);
+        t0 = fe_mul(t1, fe_sq(t0));          // 2^5 - 1
+        t0 = fe_mul(fe_sqn(t0, 5), t0);      // 2^10 - 1
+        t1 = fe_mul(fe_sqn(t0, 10), t0);     // 2^20 - 1
+        t1 = fe_mul(fe_sqn(t1, 20), t1);     // 2^40 - 1
+        t0 = fe_mul(fe_sqn(t1, 10), t0);     // 2^50 - 1
+        t1 = fe_mul(fe_sqn(t0, 50), t0);     // 2^100 - 1
+        t1 = fe_mul(fe_sqn(t1, 100), t1);    // 2^200 - 1
+        t0 = fe_mul(fe_sqn(t1, 50), t0);     // 2^250 - 1
+        return fe_mul(fe_sqn(t0, 2), z);     // 2^252 - 3
+    }
+
+    struct curve_constants {
+        fe d, d2, sqrtm1;
+        curve_constants() {
+            // -121665/121666, and sqrt(-1), little-endian
+            constexpr unsigned char d_bytes[32] = {
+                    0xa3, 0x78, 0x59, 0x13, 0xca, 0x4d, 0xeb, 0x75, 0xab, 0xd8, 0x41,
+                    0x41, 0x4d, 0x0a, 0x70, 0x00, 0x98, 0xe8, 0x79, 0x77, 0x79, 0x40,
+                    0xc7, 0x8c, 0x73, 0xfe, 0x6f, 0x2b, 0xee, 0x6c, 0x03, 0x52};
+            constexpr unsigned char sqrtm1_bytes[32] = {
+                    0xb0, 0xa0, 0x0e, 0x4a, 0x27, 0x1b, 0xee, 0xc4, 0x78, 0xe4, 0x2f,
+                    0xad, 0x06, 0x18, 0x43, 0x2f, 0xa7, 0xd7, 0xfb, 0x3d, 0x99, 0x00,
+                    0x4d, 0x2b, 0x0b, 0xdf, 0xc1, 0x4f, 0x80, 0x24, 0x83, 0x2b};
+            d = fe_from(d_bytes);
+            d2 = fe_add(d, d);
+            sqrtm1 = fe_from(sqrtm1_bytes);
+        }
+    };
+
+    const curve_constants& constants() {
+        static const curve_constants c;
+        return c;
+    }
+
+    struct ge_p2 {
+        fe X, Y, Z;
+    };
+    struct ge_p3 {
+        fe X, Y, Z, T;
+    };
+    struct ge_p1p1 {
+        fe X, Y, Z, T;
+    };
+    struct ge_cached {
+        fe YplusX, YminusX, Z, T2d;
+    };
+
+    ge_p3 p1p1_to_p3(const ge_p1p1& p) {
+        return {fe_mul(p.X, p.T), fe_mul(p.Y, p.Z), fe_mul(p.Z, p.T), fe_mul(p.X, p.Y)};
+    }
+    ge_p2 p3_to_p2(const ge_p3& p) {
+        return {p.X, p.Y, p.Z};
+    }
+    ge_cached p3_to_cached(const ge_p3& p) {
+        return {fe_add(p.Y, p.X), fe_sub(p.Y, p.X), p.Z, fe_mul(p.T, constants().d2)};
+    }
+
+    ge_p1p1 ge_dbl(const ge_p2& p) {
+        ge_p1p1 r;
+        r.X = fe_sq(p.X);
+        r.Z = fe_sq(p.Y);
+        auto zz = fe_sq(p.Z);
+        r.T = fe_add(zz, zz);
+        auto t0 = fe_sq(fe_add(p.X, p.Y));
+        r.Y = fe_add(r.Z, r.X);
+        r.Z = fe_sub(r.Z, r.X);
+        r.X = fe_sub(t0, r.Y);
+        r.T = fe_sub(r.T, r.Z);
+        return r;
+    }
+
+    // p + q if `negate` is false, p - q if true.
+    ge_p1p1 ge_add(const ge_p3& p, const ge_cached& q, bool negate = false) {
+        ge_p1p1 r;
+        r.X = fe_add(p.Y, p.X);
+        r.Y = fe_sub(p.Y, p.X);
+        r.Z = fe_mul(r.X, negate ? q.YminusX : q.YplusX);
+        r.Y = fe_mul(r.Y, negate ? q.YplusX : q.YminusX);
+        r.T = fe_mul(q.T2d, p.T);
+        r.X = fe_mul(p.Z, q.Z);
+        auto t0 = fe_add(r.X, r.X);
+        r.X = fe_sub(r.Z, r.Y);
+        r.Y = fe_add(r.Z, r.Y);
+        if (negate) {
+            r.Z = fe_sub(t0, r.T);
+            r.T = fe_add(t0, r.T);
+        } else {
+            r.Z = fe_add(t0, r.T);
+            r.T = fe_sub(t0, r.T);
+        }
+        return r;
+    }
+
+    ge_p3 ge_identity() {
+        return {fe_zero(), fe_one(), fe_one(), fe_zero()};
+    }
+
+    bool ge_is_identity(const ge_p3& p) {
+        return fe_iszero(p.X) && fe_iszero(fe_sub(p.Y, p.Z));
+    }
+
+    bool ge_has_small_order(const ge_p3& p) {
+        auto q = p1p1_to_p3(ge_dbl(p3_to_p2(p)));
+        q = p1p1_to_p3(ge_dbl(p3_to_p2(q)));
+        q = p1p1_to_p3(ge_dbl(p3_to_p2(q)));
+        return ge_is_identity(q);
+    }
+
+    // True if the encoded y coordinate (ignoring the sign bit) is less than p = 2^255 - 19.
+    bool ge_is_canonical(const unsigned char* s) {
+        if ((s[31] & 0x7f) != 0x7f)
+            return true;
+        for (int i = 30; i > 0; i--)
+            if (s[i] != 0xff)
+                return true;
+        return s[0] < 0xed;
+    }
+
+    // Decodes a point, negating it if `negate` is set.  Returns false if the encoding is not a
+    // point on the curve.
+    bool ge_frombytes(ge_p3& h, const unsigned char* s, bool negate) {
+        const auto& c = constants();
+        h.Y = fe_from(s);
+        h.Z = fe_one();
+        auto u = fe_sq(h.Y);
+        auto v = fe_mul(u, c.d);
+        u = fe_sub(u, h.Z);  // y^2 - 1
+        v = fe_add(v, h.Z);  // dy^2 + 1
+
+        auto v3 = fe_mul(fe_sq(v), v);
+        h.X = fe_mul(fe_mul(fe_sq(v3), v), u);  // uv^7
+        h.X = fe_pow22523(h.X);
+        h.X = fe_mul(fe_mul(h.X, v3), u);  // uv^3 (uv^7)^((p-5)/8)
+
+        auto vxx = fe_mul(fe_sq(h.X), v);
+        if (!fe_iszero(fe_sub(vxx, u))) {
+            if (!fe_iszero(fe_add(vxx, u)))
+                return false;
+            h.X = fe_mul(h.X, c.sqrtm1);
+        }
+        if (fe_isnegative(h.X) != ((s[31] >> 7) != negate))
+            h.X = fe_neg(h.X);
+        h.T = fe_mul(h.X, h.Y);
+        return true;
+    }
+
+    const ge_p3& ge_base() {
+        static const ge_p3 B = [] {
+            constexpr unsigned char b[32] = {
+                    0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+                    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+                    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66};
+            ge_p3 p;
+            ge_frombytes(p, b, false);
+            return p;
+        }();
+        return B;
+    }
+
+    // True if the scalar is fully reduced (i.e. less than the group order L).
+    bool sc_is_canonical(const unsigned char* s) {
+        constexpr unsigned char L[32] = {
+                0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7,
+                0xa2, 0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10};
+        for (int i = 31; i >= 0; i--)
+            if (s[i] != L[i])
+                return s[i] < L[i];
+        return false;
+    }
+
+    using scalar = std::array<unsigned char, 32>;
+
+    // One term of a multi-scalar multiplication: the point's odd multiples P, 3P, ..., 15P and the
+    // scalar recoded into signed sliding window digits (each 0 or odd in [-15, 15]).
+    struct msm_term {
+        std::array<ge_cached, 8> table;
+        std::array<signed char, 256> digits;
+        int top = -1;  // Index of the highest non-zero digit, -1 if the scalar is zero
+
+        msm_term(const ge_p3& p, const scalar& s) {
+            recode(s);
+            table[0] = p3_to_cached(p);
+            auto p2 = p1p1_to_p3(ge_dbl(p3_to_p2(p)));
+            for (size_t k = 1; k < table.size(); k++)
+                table[k] = p3_to_cached(p1p1_to_p3(ge_add(p2, table[k - 1])));
+        }
+
+      private:
+        // Same recoding as libsodium's (ref10) slide_vartime; requires s < 2^255.
+        void recode(const scalar& s) {
+            for (int i = 0; i < 256; i++)
+                digits[i] = 1 & (s[i >> 3] >> (i & 7));
+            for (int i = 0; i < 256; i++) {
+                if (!digits[i])
+                    continue;
+                for (int b = 1; b <= 6 && i + b < 256; b++) {
+                    if (!digits[i + b])
+                        continue;
+                    int ribs = digits[i + b] << b;
+                    if (digits[i] + ribs <= 15) {
+                        digits[i] += ribs;
+                        digits[i + b] = 0;
+                    } else if (digits[i] - ribs >= -15) {
+                        digits[i] -= ribs;
+                        for (int k = i + b; k < 256; k++) {
+                            if (!digits[k]) {
+                                digits[k] = 1;
+                                break;
+                            }
+                            digits[k] = 0;
+                        }
+                    } else
+                        break;
+                }
+            }
+            for (int i = 255; i >= 0; i--)
+                if (digits[i]) {
+                    top = i;
+                    break;
+                }
+        }
+    };
+
+    // Computes sum([s_i]P_i) via interleaved (Straus) sliding window multiplication and returns
+    // whether the result is the identity.
+    bool msm_is_identity(const std::vector<msm_term>& terms) {
+        int top = -1;
+        for (auto& t : terms)
+            top = std::max(top, t.top);
+        auto acc = ge_identity();
+        for (int i = top; i >= 0; i--) {
+            acc = p1p1_to_p3(ge_dbl(p3_to_p2(acc)));
+            for (auto& t : terms)
+                if (auto d = t.digits[i]; d > 0)
+                    acc = p1p1_to_p3(ge_add(acc, t.table[d / 2]));
+                else if (d < 0)
+                    acc = p1p1_to_p3(ge_add(acc, t.table[-d / 2], true));
+        }
+        return ge_is_identity(acc);
+    }
+
+    // A signature that has passed the encoding checks, ready to be included in a batch.
+    struct batch_sig {
+        size_t index;
+        ge_p3 neg_R;
+        const unsigned char* pubkey;
+        const unsigned char* s;
+        scalar h;
+    };
+
+    // Checks the given signatures together: with random 128-bit z_i, checks that
+    //
+    //     [sum z_i s_i] B + sum [z_i](-R_i) + sum [z_i h_i](-A_i) == 0
+    //
+    // where the pubkey terms of signatures with the same pubkey are combined into a single term.
+    bool batch_equation_holds(
+            std::vector<batch_sig>::const_iterator begin,
+            std::vector<batch_sig>::const_iterator end,
+            const std::map<std::array<unsigned char, 32>, ge_p3>& neg_pubkeys) {
+        std::vector<msm_term> terms;
+        terms.reserve(static_cast<size_t>(end - begin) + neg_pubkeys.size() + 1);
+
+        scalar b_scalar{};
+        std::map<std::array<unsigned char, 32>, scalar> pk_scalars;
+        for (auto sig_it = begin; sig_it != end; ++sig_it) {
+            auto& sig = *sig_it;
+            scalar z{}, zx;
+            randombytes_buf(z.data(), 16);
+            terms.emplace_back(sig.neg_R, z);
+
+            crypto_core_ed25519_scalar_mul(zx.data(), z.data(), sig.s);
+            crypto_core_ed25519_scalar_add(b_scalar.data(), b_scalar.data(), zx.data());
+
+            crypto_core_ed25519_scalar_mul(zx.data(), z.data(), sig.h.data());
+            std::array<unsigned char, 32> pk;
+            std::memcpy(pk.data(), sig.pubkey, 32);
+            auto& pk_scalar = pk_scalars[pk];
+            crypto_core_ed25519_scalar_add(pk_scalar.data(), pk_scalar.data(), zx.data());
+        }
+        for (auto& [pk, s] : pk_scalars)
+            terms.emplace_back(neg_pubkeys.at(pk), s);
+        terms.emplace_back(ge_base(), b_scalar);
+
+        return msm_is_identity(terms);
+    }
+
+    // Below this many signatures we just verify individually.
+    constexpr size_t MIN_BATCH = 4;
+
+    // Appends the indices of the invalid signatures in [begin, end) to `failed`, bisecting when
+    // the combined check fails.
+    void find_invalid(
+            std::vector<batch_sig>::const_iterator begin,
+            std::vector<batch_sig>::const_iterator end,
+            const std::map<std::array<unsigned char, 32>, ge_p3>& neg_pubkeys,
+            const std::vector<ustring_view>& sigs,
+            const std::vector<ustring_view>& msgs,
+            std::vector<size_t>& failed) {
+        auto n = static_cast<size_t>(end - begin);
+        if (n < MIN_BATCH) {
+            for (auto it = begin; it != end; ++it)
+                if (0 != crypto_sign_ed25519_verify_detached(
+                                 sigs[it->index].data(),
+                                 msgs[it->index].data(),
+                                 msgs[it->index].size(),
+                                 it->pubkey))
+                    failed.push_back(it->index);
+            return;
+        }
+        if (batch_equation_holds(begin, end, neg_pubkeys))
+            return;
+        auto mid = begin + n / 2;
+        find_invalid(begin, mid, neg_pubkeys, sigs, msgs, failed);
+        find_invalid(mid, end, neg_pubkeys, sigs, msgs, failed);
+    }
+
+}  // namespace
+
+std::vector<size_t> verify_batch(
+        const std::vector<ustring_view>& sigs,
+        const std::vector<ustring_view>& pubkeys,
+        const std::vector<ustring_view>& msgs) {
+    if (sigs.size() != pubkeys.size() || sigs.size() != msgs.size())
+        throw std::invalid_argument{
+                "Invalid verify_batch arguments: sigs, pubkeys, and msgs must be the same size"};
+
+    std::vector<size_t> failed;
+    std::vector<batch_sig> batch;
+    batch.reserve(sigs.size());
+    std::map<std::array<unsigned char, 32>, ge_p3> neg_pubkeys;
+
+    // First apply the same encoding checks that libsodium's verification applies (a canonical s;
+    // a canonical, non-small-order pubkey; and a non-small-order R, which must also be canonical
+    // since libsodium compares it byte-for-byte against a canonical encoding).
+    for (size_t i = 0; i < sigs.size(); i++) {
+        auto& sig = sigs[i];
+        auto& pk = pubkeys[i];
+        if (sig.size() != 64 || pk.size() != 32 || !sc_is_canonical(sig.data() + 32) ||
+            !ge_is_canonical(sig.data()) || !ge_is_canonical(pk.data())) {
+            failed.push_back(i);
+            continue;
+        }
+
+        std::array<unsigned char, 32> pk_arr;
+        std::memcpy(pk_arr.data(), pk.data(), 32);
+        auto it = neg_pubkeys.find(pk_arr);
+        if (it == neg_pubkeys.end()) {
+            ge_p3 A;
+            if (!ge_frombytes(A, pk.data(), true) || ge_has_small_order(A)) {
+                failed.push_back(i);
+                continue;
+            }
+            it = neg_pubkeys.emplace(pk_arr, A).first;
+        }
+
+        auto& b = batch.emplace_back();
+        b.index = i;
+        b.pubkey = pk.data();
+        b.s = sig.data() + 32;
+        if (!ge_frombytes(b.neg_R, sig.data(), true) || ge_has_small_order(b.neg_R)) {
+            batch.pop_back();
+            failed.push_back(i);
+            continue;
+        }
+
+        std::array<unsigned char, 64> hash;
+        crypto_hash_sha512_state st;
+        crypto_hash_sha512_init(&st);
+        crypto_hash_sha512_update(&st, sig.data(), 32);
+        crypto_hash_sha512_update(&st, pk.data(), 32);
+        crypto_hash_sha512_update(&st, msgs[i].data(), msgs[i].size());
+        crypto_hash_sha512_final(&st, hash.data());
+        crypto_core_ed25519_scalar_reduce(b.h.data(), hash.data());
+    }
+
+    find_invalid(batch.begin(), batch.end(), neg_pubkeys, sigs, msgs, failed);
+
+    std::sort(failed.begin(), failed.end());
+    return failed;
+}
+
 }  // namespace session::ed25519
 
 using namespace session;
@@ -146,3 +606,34 @@ LIBSESSION_C_API bool session_ed25519_verify(
     return session::ed25519::verify(
             ustring_view{sig, 64}, ustring_view{pubkey, 32}, ustring_view{msg, msg_len});
 }
+
+LIBSESSION_C_API size_t session_ed25519_verify_batch(
+        const unsigned char* const* sigs,
+        const unsigned char* const* pubkeys,
+        const unsigned char* const* msgs,
+        const size_t* msg_lens,
+        size_t count,
+        bool* valid_out) {
+    try {
+        std::vector<ustring_view> s, pk, m;
+        s.reserve(count);
+        pk.reserve(count);
+        m.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            s.emplace_back(sigs[i], 64);
+            pk.emplace_back(pubkeys[i], 32);
+            m.emplace_back(msgs[i], msg_lens[i]);
+        }
+        auto failed = session::ed25519::verify_batch(s, pk, m);
+        if (valid_out) {
+            std::fill(valid_out, valid_out + count, true);
+            for (auto i : failed)
+                valid_out[i] = false;
+        }
+        return failed.size();
+    } catch (...) {
+        if (valid_out)
+            std::fill(valid_out, valid_out + count, false);
+        return count;
+    }
+}
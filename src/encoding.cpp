@@ -0,0 +1,596 @@
+#include "session/encoding.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SESSION_ENCODING_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define SESSION_ENCODING_NEON
+#include <arm_neon.h>
+#endif
+
+namespace session::encoding {
+
+namespace {
+
+    // Scalar implementations.  These avoid data-dependent branches and table lookups so that the
+    // timing doesn't depend on the values being encoded/decoded.  The helper masks are computed on
+    // unsigned values small enough (< 2^8) that `(k - x) >> 31` is 1 exactly when x > k.
+
+    // 1 if x > k, 0 otherwise
+    constexpr unsigned gt(unsigned x, unsigned k) {
+        return (k - x) >> 31;
+    }
+    // 1 if lo <= x <= hi, 0 otherwise
+    constexpr unsigned in_range(unsigned x, unsigned lo, unsigned hi) {
+        return gt(x, lo - 1) & (gt(x, hi) ^ 1);
+    }
+
+    constexpr char hex_digit(unsigned n) {
+        return static_cast<char>(n + '0' + gt(n, 9) * ('a' - '0' - 10));
+    }
+
+    // Returns the value of a hex digit; sets the low bit of `bad` if `c` is not a hex digit.
+    constexpr unsigned hex_value(unsigned char c, unsigned& bad) {
+        unsigned lower = c | 0x20;
+        unsigned is_digit = in_range(c, '0', '9');
+        unsigned is_alpha = in_range(lower, 'a', 'f');
+        bad |= (is_digit | is_alpha) ^ 1;
+        return (-is_digit & (c - '0')) | (-is_alpha & (lower - 'a' + 10));
+    }
+
+    constexpr char b64_char(unsigned x) {
+        // 'A'+x for [0,25], then shifted into 'a'.., '0'.., '+', '/' ranges:
+        return static_cast<char>(
+                'A' + x + gt(x, 25) * 6 - gt(x, 51) * 75 - gt(x, 61) * 15 + gt(x, 62) * 3);
+    }
+
+    // Returns the 6-bit value of a base64 character; sets the low bit of `bad` if `c` is not a
+    // base64 character.
+    constexpr unsigned b64_value(unsigned char c, unsigned& bad) {
+        unsigned upper = in_range(c, 'A', 'Z'), lower = in_range(c, 'a', 'z'),
+                 digit = in_range(c, '0', '9'), plus = in_range(c, '+', '+'),
+                 slash = in_range(c, '/', '/');
+        bad |= (upper | lower | digit | plus | slash) ^ 1;
+        return (-upper & (c - 'A')) | (-lower & (c - 'a' + 26)) | (-digit & (c - '0' + 52)) |
+               (-plus & 62) | (-slash & 63);
+    }
+
+    void to_hex_scalar(const unsigned char* in, size_t size, char* out) {
+        for (size_t i = 0; i < size; i++) {
+            *out++ = hex_digit(in[i] >> 4);
+            *out++ = hex_digit(in[i] & 0x0f);
+        }
+    }
+
+    // Returns non-zero if any of the input is invalid
+    unsigned from_hex_scalar(const char* in, size_t size, unsigned char* out) {
+        unsigned bad = 0;
+        for (size_t i = 0; i < size; i++) {
+            unsigned hi = hex_value(in[2 * i], bad);
+            unsigned lo = hex_value(in[2 * i + 1], bad);
+            out[i] = static_cast<unsigned char>(hi << 4 | lo);
+        }
+        return bad;
+    }
+
+    // Encodes complete 3-byte groups, returning the number of input bytes consumed.
+    size_t to_base64_scalar(const unsigned char* in, size_t size, char* out) {
+        size_t i = 0;
+        for (; i + 3 <= size; i += 3) {
+            uint32_t v = uint32_t{in[i]} << 16 | uint32_t{in[i + 1]} << 8 | in[i + 2];
+            *out++ = b64_char(v >> 18);
+            *out++ = b64_char(v >> 12 & 0x3f);
+            *out++ = b64_char(v >> 6 & 0x3f);
+            *out++ = b64_char(v & 0x3f);
+        }
+        return i;
+    }
+
+    // Decodes `size` characters, which must be complete 4-character groups.  Returns non-zero if
+    // any input is invalid.
+    unsigned from_base64_scalar(const char* in, size_t size, unsigned char* out) {
+        unsigned bad = 0;
+        for (size_t i = 0; i + 4 <= size; i += 4) {
+            uint32_t v = b64_value(in[i], bad) << 18 | b64_value(in[i + 1], bad) << 12 |
+                         b64_value(in[i + 2], bad) << 6 | b64_value(in[i + 3], bad);
+            *out++ = static_cast<unsigned char>(v >> 16);
+            *out++ = static_cast<unsigned char>(v >> 8);
+            *out++ = static_cast<unsigned char>(v);
+        }
+        return bad;
+    }
+
+#ifdef SESSION_ENCODING_X86
+
+    bool have_ssse3() {
+        static const bool ssse3 = __builtin_cpu_supports("ssse3");
+        return ssse3;
+    }
+    bool have_avx2() {
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        return avx2;
+    }
+
+    // Each of the SIMD functions below processes as many complete blocks as it can from the
+    // beginning of the input and returns the number of input bytes/characters consumed, leaving
+    // the rest for the next (narrower or scalar) implementation.  The decoders accumulate an
+    // invalid-input flag rather than returning early.
+
+    __attribute__((target("ssse3"))) size_t to_hex_ssse3(
+            const unsigned char* in, size_t size, char* out) {
+        const __m128i lut = _mm_setr_epi8(
+                '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+        const __m128i mask = _mm_set1_epi8(0x0f);
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+            __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(out + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2"))) size_t to_hex_avx2(
+            const unsigned char* in, size_t size, char* out) {
+        const __m256i lut = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+                '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'));
+        const __m256i mask = _mm256_set1_epi8(0x0f);
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+            __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+            // unpack works within 128-bit lanes, so we have to put the lanes back in order:
+            __m256i a = _mm256_unpacklo_epi8(hi, lo), b = _mm256_unpackhi_epi8(hi, lo);
+            _mm256_storeu_si256(
+                    reinterpret_cast<__m256i*>(out + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256(
+                    reinterpret_cast<__m256i*>(out + 2 * i + 32),
+                    _mm256_permute2x128_si256(a, b, 0x31));
+        }
+        return i;
+    }
+
+    // Converts 16 hex characters into 16 nibble values, or-ing 0xff into `bad` for any invalid
+    // characters.
+    __attribute__((target("ssse3"))) inline __m128i hex_nibbles_ssse3(__m128i c, __m128i& bad) {
+        __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+        __m128i is_digit = _mm_and_si128(
+                _mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), c));
+        __m128i is_alpha = _mm_and_si128(
+                _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower));
+        bad = _mm_or_si128(
+                bad, _mm_cmpeq_epi8(_mm_or_si128(is_digit, is_alpha), _mm_setzero_si128()));
+        return _mm_or_si128(
+                _mm_and_si128(is_digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+                _mm_and_si128(is_alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+    }
+
+    // `size` is the number of output bytes (i.e. half the number of hex characters).
+    __attribute__((target("ssse3"))) size_t from_hex_ssse3(
+            const char* in, size_t size, unsigned char* out, unsigned& bad_out) {
+        // Multiplying (hi, lo) nibble pairs by (16, 1) and adding combines them into one byte:
+        const __m128i combine = _mm_set1_epi16(0x0110);
+        __m128i bad = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            __m128i a = hex_nibbles_ssse3(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i)), bad);
+            __m128i b = hex_nibbles_ssse3(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i + 16)), bad);
+            _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(out + i),
+                    _mm_packus_epi16(
+                            _mm_maddubs_epi16(a, combine), _mm_maddubs_epi16(b, combine)));
+        }
+        bad_out |= _mm_movemask_epi8(bad) != 0;
+        return i;
+    }
+
+    __attribute__((target("avx2"))) inline __m256i hex_nibbles_avx2(__m256i c, __m256i& bad) {
+        __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+        __m256i is_digit = _mm256_and_si256(
+                _mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+        __m256i is_alpha = _mm256_and_si256(
+                _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+        bad = _mm256_or_si256(
+                bad,
+                _mm256_cmpeq_epi8(_mm256_or_si256(is_digit, is_alpha), _mm256_setzero_si256()));
+        return _mm256_or_si256(
+                _mm256_and_si256(is_digit, _mm256_sub_epi8(c, _mm256_set1_epi8('0'))),
+                _mm256_and_si256(is_alpha, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))));
+    }
+
+    __attribute__((target("avx2"))) size_t from_hex_avx2(
+            const char* in, size_t size, unsigned char* out, unsigned& bad_out) {
+        const __m256i combine = _mm256_set1_epi16(0x0110);
+        __m256i bad = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            __m256i a = hex_nibbles_avx2(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * i)), bad);
+            __m256i b = hex_nibbles_avx2(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * i + 32)), bad);
+            // pack works within 128-bit lanes, giving a0 b0 a1 b1 (in 64-bit pieces); reorder to
+            // a0 a1 b0 b1:
+            __m256i packed = _mm256_packus_epi16(
+                    _mm256_maddubs_epi16(a, combine), _mm256_maddubs_epi16(b, combine));
+            _mm256_storeu_si256(
+                    reinterpret_cast<__m256i*>(out + i),
+                    _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+        bad_out |= _mm256_movemask_epi8(bad) != 0;
+        return i;
+    }
+
+    // Base64 encoding of 12 bytes (read from a 16-byte load) into 16 characters.  This uses the
+    // approach described by Wojciech Muła and Daniel Lemire: shuffle the input so that each 32-bit
+    // lane holds the 3 bytes it needs, use multiplies to shift the four 6-bit fields into separate
+    // bytes, then convert the 6-bit values to ASCII by adding a per-range offset.
+    __attribute__((target("ssse3"))) size_t to_base64_ssse3(
+            const unsigned char* in, size_t size, char* out) {
+        const __m128i spread =
+                _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+        const __m128i offsets = _mm_setr_epi8(
+                'a' - 26,
+                '0' - 52,
+                '0' - 52,
+                '0' - 52,
+                '0' - 52,
+                '0' - 52,
+                '0' - 52,
+                '0' - 52,
+                '0' - 52,
+                '0' - 52,
+                '0' - 52,
+                '+' - 62,
+                '/' - 63,
+                'A',
+                0,
+                0);
+        size_t i = 0, o = 0;
+        for (; i + 16 <= size; i += 12, o += 16) {
+            __m128i v = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), spread);
+            __m128i t0 = _mm_mulhi_epu16(
+                    _mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+            __m128i t1 = _mm_mullo_epi16(
+                    _mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+            __m128i idx = _mm_or_si128(t0, t1);
+
+            // Map [0,25] -> 13, [26,51] -> 0, [52,61] -> [1,10], 62 -> 11, 63 -> 12, then look up
+            // the offset to add for each:
+            __m128i range = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+            range = _mm_or_si128(
+                    range,
+                    _mm_and_si128(
+                            _mm_cmpgt_epi8(_mm_set1_epi8(26), idx), _mm_set1_epi8(13)));
+            _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(out + o),
+                    _mm_add_epi8(idx, _mm_shuffle_epi8(offsets, range)));
+        }
+        return i;
+    }
+
+    // Base64 decoding (also per Muła and Lemire): the high and low nibbles of each character index
+    // two bitmask tables whose AND is non-zero for invalid characters; the high nibble (adjusted
+    // for '/', which shares a high nibble with '+') then selects the offset that converts the
+    // character to its 6-bit value, and multiply-adds pack the 6-bit values together.
+    //
+    // The tables are duplicated across both lanes for the AVX2 version.
+    constexpr char B64_LUT_LO[16] = {
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A};
+    constexpr char B64_LUT_HI[16] = {
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10};
+    constexpr char B64_LUT_ROLL[16] = {0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0};
+
+    __attribute__((target("ssse3"))) size_t from_base64_ssse3(
+            const char* in, size_t size, unsigned char* out, unsigned& bad_out) {
+        const __m128i lut_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(B64_LUT_LO));
+        const __m128i lut_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(B64_LUT_HI));
+        const __m128i lut_roll = _mm_loadu_si128(reinterpret_cast<const __m128i*>(B64_LUT_ROLL));
+        const __m128i mask = _mm_set1_epi8(0x0f);
+        const __m128i gather =
+                _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        __m128i bad = _mm_setzero_si128();
+        alignas(16) unsigned char buf[16];
+        size_t i = 0, o = 0;
+        for (; i + 16 <= size; i += 16, o += 12) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i hi_nib = _mm_and_si128(_mm_srli_epi32(v, 4), mask);
+            __m128i lo_nib = _mm_and_si128(v, mask);
+            bad = _mm_or_si128(
+                    bad,
+                    _mm_and_si128(
+                            _mm_shuffle_epi8(lut_lo, lo_nib), _mm_shuffle_epi8(lut_hi, hi_nib)));
+            __m128i is_slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+            v = _mm_add_epi8(v, _mm_shuffle_epi8(lut_roll, _mm_add_epi8(is_slash, hi_nib)));
+
+            // Merge pairs of 6-bit values into 12 bits, then pairs of those into 24:
+            v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+            v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+            _mm_store_si128(reinterpret_cast<__m128i*>(buf), _mm_shuffle_epi8(v, gather));
+            std::memcpy(out + o, buf, 12);
+        }
+        bad_out |= _mm_movemask_epi8(_mm_cmpeq_epi8(bad, _mm_setzero_si128())) != 0xffff;
+        return i;
+    }
+
+    __attribute__((target("avx2"))) size_t from_base64_avx2(
+            const char* in, size_t size, unsigned char* out, unsigned& bad_out) {
+        const __m256i lut_lo = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(B64_LUT_LO)));
+        const __m256i lut_hi = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(B64_LUT_HI)));
+        const __m256i lut_roll = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(B64_LUT_ROLL)));
+        const __m256i mask = _mm256_set1_epi8(0x0f);
+        const __m256i gather = _mm256_broadcastsi128_si256(
+                _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        __m256i bad = _mm256_setzero_si256();
+        alignas(32) unsigned char buf[32];
+        size_t i = 0, o = 0;
+        for (; i + 32 <= size; i += 32, o += 24) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i hi_nib = _mm256_and_si256(_mm256_srli_epi32(v, 4), mask);
+            __m256i lo_nib = _mm256_and_si256(v, mask);
+            bad = _mm256_or_si256(
+                    bad,
+                    _mm256_and_si256(
+                            _mm256_shuffle_epi8(lut_lo, lo_nib),
+                            _mm256_shuffle_epi8(lut_hi, hi_nib)));
+            __m256i is_slash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'));
+            v = _mm256_add_epi8(
+                    v, _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(is_slash, hi_nib)));
+
+            v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+            v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+            v = _mm256_shuffle_epi8(v, gather);
+            // Each lane now has 12 bytes of output followed by 4 junk bytes; squeeze out the junk:
+            v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(buf), v);
+            std::memcpy(out + o, buf, 24);
+        }
+        bad_out |= !_mm256_testz_si256(bad, bad);
+        return i;
+    }
+
+#endif
+
+#ifdef SESSION_ENCODING_NEON
+
+    size_t to_hex_neon(const unsigned char* in, size_t size, char* out) {
+        static constexpr uint8_t digits[16] = {
+                '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+        const uint8x16_t lut = vld1q_u8(digits);
+        const uint8x16_t mask = vdupq_n_u8(0x0f);
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            uint8x16_t v = vld1q_u8(in + i);
+            uint8x16x2_t chars;
+            chars.val[0] = vqtbl1q_u8(lut, vshrq_n_u8(v, 4));
+            chars.val[1] = vqtbl1q_u8(lut, vandq_u8(v, mask));
+            vst2q_u8(reinterpret_cast<uint8_t*>(out + 2 * i), chars);  // interleaves hi/lo
+        }
+        return i;
+    }
+
+    inline uint8x16_t hex_nibbles_neon(uint8x16_t c, uint8x16_t& bad) {
+        uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+        uint8x16_t alpha = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+        uint8x16_t is_digit = vcltq_u8(digit, vdupq_n_u8(10));
+        uint8x16_t is_alpha = vcltq_u8(alpha, vdupq_n_u8(6));
+        bad = vorrq_u8(bad, vmvnq_u8(vorrq_u8(is_digit, is_alpha)));
+        return vorrq_u8(
+                vandq_u8(is_digit, digit), vandq_u8(is_alpha, vaddq_u8(alpha, vdupq_n_u8(10))));
+    }
+
+    size_t from_hex_neon(const char* in, size_t size, unsigned char* out, unsigned& bad_out) {
+        uint8x16_t bad = vdupq_n_u8(0);
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            // De-interleaves into the high nibble chars and the low nibble chars:
+            uint8x16x2_t chars = vld2q_u8(reinterpret_cast<const uint8_t*>(in + 2 * i));
+            uint8x16_t hi = hex_nibbles_neon(chars.val[0], bad);
+            uint8x16_t lo = hex_nibbles_neon(chars.val[1], bad);
+            vst1q_u8(out + i, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+        }
+        bad_out |= vmaxvq_u8(bad) != 0;
+        return i;
+    }
+
+#endif
+
+    // Returns the length of `b64` without padding, or std::string_view::npos if the padding or
+    // length is invalid.
+    size_t base64_unpadded_size(std::string_view b64) {
+        size_t n = b64.size();
+        if (n >= 1 && b64[n - 1] == '=') {
+            if (n % 4 != 0)
+                return std::string_view::npos;
+            n--;
+            if (b64[n - 1] == '=')
+                n--;
+        }
+        if (n % 4 == 1)
+            return std::string_view::npos;
+        return n;
+    }
+
+}  // namespace
+
+void to_hex(const unsigned char* in, size_t size, char* out) {
+    size_t done = 0;
+#if defined(SESSION_ENCODING_X86)
+    if (have_avx2())
+        done = to_hex_avx2(in, size, out);
+    if (have_ssse3())
+        done += to_hex_ssse3(in + done, size - done, out + 2 * done);
+#elif defined(SESSION_ENCODING_NEON)
+    done = to_hex_neon(in, size, out);
+#endif
+    to_hex_scalar(in + done, size - done, out + 2 * done);
+}
+
+std::string to_hex(ustring_view data) {
+    std::string hex;
+    hex.resize(2 * data.size());
+    to_hex(data.data(), data.size(), hex.data());
+    return hex;
+}
+
+std::string to_prefixed_hex(unsigned char prefix, ustring_view data) {
+    std::string hex;
+    hex.resize(2 * (data.size() + 1));
+    to_hex_scalar(&prefix, 1, hex.data());
+    to_hex(data.data(), data.size(), hex.data() + 2);
+    return hex;
+}
+
+bool from_hex(std::string_view hex, unsigned char* out) {
+    if (hex.size() % 2 != 0)
+        return false;
+    const char* in = hex.data();
+    size_t size = hex.size() / 2, done = 0;
+    unsigned bad = 0;
+#if defined(SESSION_ENCODING_X86)
+    if (have_avx2())
+        done = from_hex_avx2(in, size, out, bad);
+    if (have_ssse3())
+        done += from_hex_ssse3(in + 2 * done, size - done, out + done, bad);
+#elif defined(SESSION_ENCODING_NEON)
+    done = from_hex_neon(in, size, out, bad);
+#endif
+    bad |= from_hex_scalar(in + 2 * done, size - done, out + done);
+    return !bad;
+}
+
+bool is_hex(std::string_view hex) {
+    // Decoding is fast enough (and this is only called on short values) that we just decode into
+    // a scratch buffer in chunks rather than maintaining separate validation code.
+    if (hex.size() % 2 != 0)
+        return false;
+    unsigned char buf[256];
+    bool good = true;
+    for (size_t i = 0; i < hex.size(); i += 2 * sizeof(buf))
+        good &= from_hex(hex.substr(i, 2 * sizeof(buf)), buf);
+    return good;
+}
+
+ustring from_hex(std::string_view hex) {
+    ustring out;
+    out.resize(hex.size() / 2);
+    if (!from_hex(hex, out.data()))
+        throw std::invalid_argument{"Invalid hex string"};
+    return out;
+}
+
+size_t base64_decoded_size(std::string_view b64) {
+    size_t n = base64_unpadded_size(b64);
+    if (n == std::string_view::npos)
+        return 0;
+    return n / 4 * 3 + (n % 4 == 0 ? 0 : n % 4 - 1);
+}
+
+void to_base64(const unsigned char* in, size_t size, char* out) {
+    size_t done = 0;
+#ifdef SESSION_ENCODING_X86
+    if (have_ssse3())
+        done = to_base64_ssse3(in, size, out);
+#endif
+    done += to_base64_scalar(in + done, size - done, out + done / 3 * 4);
+    out += done / 3 * 4;
+
+    // Final partial group, with padding:
+    if (size_t left = size - done) {
+        uint32_t v = uint32_t{in[done]} << 16 | (left == 2 ? uint32_t{in[done + 1]} << 8 : 0);
+        *out++ = b64_char(v >> 18);
+        *out++ = b64_char(v >> 12 & 0x3f);
+        *out++ = left == 2 ? b64_char(v >> 6 & 0x3f) : '=';
+        *out++ = '=';
+    }
+}
+
+std::string to_base64(ustring_view data) {
+    std::string b64;
+    b64.resize(base64_encoded_size(data.size()));
+    to_base64(data.data(), data.size(), b64.data());
+    return b64;
+}
+
+namespace {
+
+    // Decodes `size` characters of unpadded base64 (i.e. with any padding already removed).
+    // Returns non-zero if any of the input is invalid.
+    unsigned from_base64_unpadded(const char* in, size_t size, unsigned char* out) {
+        size_t done = 0;
+        unsigned bad = 0;
+#if defined(SESSION_ENCODING_X86)
+        if (have_avx2())
+            done = from_base64_avx2(in, size, out, bad);
+        if (have_ssse3())
+            done += from_base64_ssse3(in + done, size - done, out + done / 4 * 3, bad);
+#endif
+        size_t full = (size - done) / 4 * 4;
+        bad |= from_base64_scalar(in + done, full, out + done / 4 * 3);
+        out += (done + full) / 4 * 3;
+        done += full;
+
+        // Final partial group of 2 or 3 characters (i.e. 1 or 2 bytes):
+        if (size_t left = size - done) {
+            uint32_t v = b64_value(in[done], bad) << 18 | b64_value(in[done + 1], bad) << 12 |
+                         (left == 3 ? b64_value(in[done + 2], bad) << 6 : 0);
+            *out++ = static_cast<unsigned char>(v >> 16);
+            if (left == 3)
+                *out++ = static_cast<unsigned char>(v >> 8);
+        }
+        return bad;
+    }
+
+}  // namespace
+
+bool from_base64(std::string_view b64, unsigned char* out) {
+    size_t size = base64_unpadded_size(b64);
+    if (size == std::string_view::npos)
+        return false;
+    return !from_base64_unpadded(b64.data(), size, out);
+}
+
+bool is_base64(std::string_view b64) {
+    size_t size = base64_unpadded_size(b64);
+    if (size == std::string_view::npos)
+        return false;
+    // As with is_hex, we just decode (in chunks of complete 4-character groups) and discard.
+    constexpr size_t CHUNK = 256;
+    unsigned char buf[CHUNK / 4 * 3];
+    unsigned bad = 0;
+    for (size_t i = 0; i < size; i += CHUNK)
+        bad |= from_base64_unpadded(b64.data() + i, std::min(CHUNK, size - i), buf);
+    return !bad;
+}
+
+ustring from_base64(std::string_view b64) {
+    ustring out;
+    if (base64_unpadded_size(b64) == std::string_view::npos)
+        throw std::invalid_argument{"Invalid base64 string"};
+    out.resize(base64_decoded_size(b64));
+    if (!from_base64(b64, out.data()))
+        throw std::invalid_argument{"Invalid base64 string"};
+    return out;
+}
+
+}  // namespace session::encoding
@@ -1,17 +1,34 @@
 #include "session/fields.hpp"
 
-#include <oxenc/hex.h>
+#include <stdexcept>
 
-#include <iterator>
+#include "session/encoding.hpp"
 
 namespace session {
 
+SessionID::SessionID(std::string_view hex) {
+    if (hex.size() != 66 || !encoding::from_hex(hex.substr(0, 2), &prefix) ||
+        !encoding::from_hex(hex.substr(2), pubkey.data()))
+        throw std::invalid_argument{"Invalid session ID: expected 66 hex digits"};
+}
+
+SessionID::SessionID(ustring_view raw) {
+    if (raw.size() != 33)
+        throw std::invalid_argument{"Invalid session ID: expected 33 bytes"};
+    prefix = raw[0];
+    std::memcpy(pubkey.data(), raw.data() + 1, 32);
+}
+
 std::string SessionID::hex() const {
-    std::string id;
-    id.reserve(33);
-    id.push_back(static_cast<char>(netid));
-    oxenc::to_hex(pubkey.begin(), pubkey.end(), std::back_inserter(id));
-    return id;
+    return encoding::to_prefixed_hex(prefix, {pubkey.data(), pubkey.size()});
+}
+
+std::string SessionID::raw() const {
+    std::string result;
+    result.reserve(33);
+    result += static_cast<char>(prefix);
+    result.append(reinterpret_cast<const char*>(pubkey.data()), pubkey.size());
+    return result;
 }
 
 }  // namespace session
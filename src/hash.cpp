@@ -1,10 +1,21 @@
 #include "session/hash.hpp"
 
 #include <sodium/crypto_generichash_blake2b.h>
+#include <sodium/utils.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
 
 #include "session/export.h"
 #include "session/util.hpp"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SESSION_HASH_AVX2
+#include <immintrin.h>
+#endif
+
 namespace session::hash {
 
 ustring hash(const size_t size, ustring_view msg, std::optional<ustring_view> key) {
@@ -27,6 +38,334 @@ ustring hash(const size_t size, ustring_view msg, std::optional<ustring_view> ke
     return result;
 }
 
+namespace {
+
+    // Self-contained BLAKE2b (RFC 7693) used for hashing many short messages at once.  The
+    // single-message `hash` above goes through libsodium; this exists so that we can process the
+    // (identical) key block of a batch only once, and hash several messages in parallel SIMD
+    // lanes.
+
+    constexpr size_t BLOCK = 128;
+
+    constexpr std::array<uint64_t, 8> IV = {
+            0x6a09e667f3bcc908ULL,
+            0xbb67ae8584caa73bULL,
+            0x3c6ef372fe94f82bULL,
+            0xa54ff53a5f1d36f1ULL,
+            0x510e527fade682d1ULL,
+            0x9b05688c2b3e6c1fULL,
+            0x1f83d9abfb41bd6bULL,
+            0x5be0cd19137e2179ULL};
+
+    constexpr unsigned char SIGMA[12][16] = {
+            {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+            {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+            {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+            {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+            {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+            {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+            {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+            {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+            {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+            {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+            {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+            {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3}};
+
+    uint64_t load64(const unsigned char* p) {
+        uint64_t x = 0;
+        for (int i = 7; i >= 0; i--)
+            x = (x << 8) | p[i];
+        return x;
+    }
+
+    constexpr uint64_t rotr(uint64_t x, int n) {
+        return (x >> n) | (x << (64 - n));
+    }
+
+    void compress(uint64_t h[8], const unsigned char* block, uint64_t t, bool last) {
+        uint64_t m[16], v[16];
+        for (int i = 0; i < 16; i++)
+            m[i] = load64(block + 8 * i);
+        for (int i = 0; i < 8; i++) {
+            v[i] = h[i];
+            v[i + 8] = IV[i];
+        }
+        v[12] ^= t;
+        if (last)
+            v[14] = ~v[14];
+
+        auto G = [&v](int a, int b, int c, int d, uint64_t x, uint64_t y) {
+            v[a] = v[a] + v[b] + x;
+            v[d] = rotr(v[d] ^ v[a], 32);
+            v[c] = v[c] + v[d];
+            v[b] = rotr(v[b] ^ v[c], 24);
+            v[a] = v[a] + v[b] + y;
+            v[d] = rotr(v[d] ^ v[a], 16);
+            v[c] = v[c] + v[d];
+            v[b] = rotr(v[b] ^ v[c], 63);
+        };
+        for (const auto& s : SIGMA) {
+            G(0, 4, 8, 12, m[s[0]], m[s[1]]);
+            G(1, 5, 9, 13, m[s[2]], m[s[3]]);
+            G(2, 6, 10, 14, m[s[4]], m[s[5]]);
+            G(3, 7, 11, 15, m[s[6]], m[s[7]]);
+            G(0, 5, 10, 15, m[s[8]], m[s[9]]);
+            G(1, 6, 11, 12, m[s[10]], m[s[11]]);
+            G(2, 7, 8, 13, m[s[12]], m[s[13]]);
+            G(3, 4, 9, 14, m[s[14]], m[s[15]]);
+        }
+        for (int i = 0; i < 8; i++)
+            h[i] ^= v[i] ^ v[i + 8];
+
+        sodium_memzero(m, sizeof(m));
+        sodium_memzero(v, sizeof(v));
+    }
+
+    void store_hash(unsigned char* out, size_t size, const uint64_t h[8]) {
+        for (size_t i = 0; i < size; i++)
+            out[i] = static_cast<unsigned char>(h[i / 8] >> (8 * (i % 8)));
+    }
+
+    // The state shared by every message in a batch: the initial chaining value and, for a keyed
+    // hash, the chaining value and byte counter after processing the key block.
+    struct batch_prefix {
+        std::array<uint64_t, 8> h0;
+        std::array<uint64_t, 8> h;
+        uint64_t t = 0;
+        bool keyed;
+        std::array<unsigned char, BLOCK> key_block{};
+
+        batch_prefix(size_t size, ustring_view key) : keyed{!key.empty()} {
+            for (int i = 0; i < 8; i++)
+                h0[i] = IV[i];
+            h0[0] ^= 0x01010000 ^ (key.size() << 8) ^ size;
+            h = h0;
+            if (keyed) {
+                std::memcpy(key_block.data(), key.data(), key.size());
+                compress(h.data(), key_block.data(), BLOCK, false);
+                t = BLOCK;
+            }
+        }
+        ~batch_prefix() {
+            sodium_memzero(h.data(), sizeof(h));
+            sodium_memzero(key_block.data(), key_block.size());
+        }
+
+        // Hashes a keyed, empty message: for these the key block itself is the final block, so
+        // the post-key state can't be used.
+        void hash_empty_keyed(unsigned char* out, size_t size) const {
+            auto hk = h0;
+            compress(hk.data(), key_block.data(), BLOCK, true);
+            store_hash(out, size, hk.data());
+            sodium_memzero(hk.data(), sizeof(hk));
+        }
+    };
+
+    size_t num_blocks(size_t len) {
+        return len == 0 ? 1 : (len + BLOCK - 1) / BLOCK;
+    }
+
+    // Returns a pointer to the `j`th (of `nblocks`) block of `msg`, copying it into `buf` (with
+    // zero padding) if it is a partial final block.
+    const unsigned char* message_block(
+            ustring_view msg, size_t j, size_t nblocks, unsigned char* buf) {
+        if (j + 1 < nblocks || (msg.size() > 0 && msg.size() % BLOCK == 0))
+            return msg.data() + j * BLOCK;
+        size_t rem = msg.size() - j * BLOCK;
+        std::memset(buf, 0, BLOCK);
+        if (rem)
+            std::memcpy(buf, msg.data() + j * BLOCK, rem);
+        return buf;
+    }
+
+    void hash_one(const batch_prefix& p, size_t size, ustring_view msg, unsigned char* out) {
+        std::array<uint64_t, 8> h = p.h;
+        std::array<unsigned char, BLOCK> buf;
+        const size_t nblocks = num_blocks(msg.size());
+        for (size_t j = 0; j < nblocks; j++) {
+            bool last = j + 1 == nblocks;
+            uint64_t t = p.t + (last ? msg.size() : (j + 1) * BLOCK);
+            compress(h.data(), message_block(msg, j, nblocks, buf.data()), t, last);
+        }
+        store_hash(out, size, h.data());
+        sodium_memzero(h.data(), sizeof(h));
+        sodium_memzero(buf.data(), buf.size());
+    }
+
+#ifdef SESSION_HASH_AVX2
+
+    bool have_avx2() {
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        return avx2;
+    }
+
+    // The BLAKE2b G function applied to four independent states at once.
+    __attribute__((target("avx2"))) inline void G4(
+            __m256i* v,
+            int a,
+            int b,
+            int c,
+            int d,
+            __m256i x,
+            __m256i y,
+            __m256i rot24,
+            __m256i rot16) {
+        v[a] = _mm256_add_epi64(_mm256_add_epi64(v[a], v[b]), x);
+        v[d] = _mm256_shuffle_epi32(_mm256_xor_si256(v[d], v[a]), _MM_SHUFFLE(2, 3, 0, 1));
+        v[c] = _mm256_add_epi64(v[c], v[d]);
+        v[b] = _mm256_shuffle_epi8(_mm256_xor_si256(v[b], v[c]), rot24);
+        v[a] = _mm256_add_epi64(_mm256_add_epi64(v[a], v[b]), y);
+        v[d] = _mm256_shuffle_epi8(_mm256_xor_si256(v[d], v[a]), rot16);
+        v[c] = _mm256_add_epi64(v[c], v[d]);
+        auto r63 = _mm256_xor_si256(v[b], v[c]);
+        v[b] = _mm256_or_si256(_mm256_srli_epi64(r63, 63), _mm256_add_epi64(r63, r63));
+    }
+
+    // Hashes four messages, each consisting of the same number of blocks, in parallel: each
+    // 256-bit register holds the same state word for each of the four messages.
+    __attribute__((target("avx2"))) void hash_four(
+            const batch_prefix& p, size_t size, const ustring_view* msgs, unsigned char** outs) {
+        const __m256i rot24 = _mm256_setr_epi8(
+                3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+        const __m256i rot16 = _mm256_setr_epi8(
+                2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+
+        __m256i h[8];
+        for (int i = 0; i < 8; i++)
+            h[i] = _mm256_set1_epi64x(static_cast<long long>(p.h[i]));
+
+        std::array<std::array<unsigned char, BLOCK>, 4> bufs;
+        const size_t nblocks = num_blocks(msgs[0].size());
+        for (size_t j = 0; j < nblocks; j++) {
+            const bool last = j + 1 == nblocks;
+            const unsigned char* b[4];
+            uint64_t t[4];
+            for (int l = 0; l < 4; l++) {
+                b[l] = message_block(msgs[l], j, nblocks, bufs[l].data());
+                t[l] = p.t + (last ? msgs[l].size() : (j + 1) * BLOCK);
+            }
+
+            __m256i m[16], v[16];
+            for (int i = 0; i < 16; i++)
+                m[i] = _mm256_set_epi64x(
+                        static_cast<long long>(load64(b[3] + 8 * i)),
+                        static_cast<long long>(load64(b[2] + 8 * i)),
+                        static_cast<long long>(load64(b[1] + 8 * i)),
+                        static_cast<long long>(load64(b[0] + 8 * i)));
+            for (int i = 0; i < 8; i++) {
+                v[i] = h[i];
+                v[i + 8] = _mm256_set1_epi64x(static_cast<long long>(IV[i]));
+            }
+            v[12] = _mm256_xor_si256(
+                    v[12],
+                    _mm256_set_epi64x(
+                            static_cast<long long>(t[3]),
+                            static_cast<long long>(t[2]),
+                            static_cast<long long>(t[1]),
+                            static_cast<long long>(t[0])));
+            if (last)
+                v[14] = _mm256_xor_si256(v[14], _mm256_set1_epi64x(-1));
+
+            for (const auto& s : SIGMA) {
+                G4(v, 0, 4, 8, 12, m[s[0]], m[s[1]], rot24, rot16);
+                G4(v, 1, 5, 9, 13, m[s[2]], m[s[3]], rot24, rot16);
+                G4(v, 2, 6, 10, 14, m[s[4]], m[s[5]], rot24, rot16);
+                G4(v, 3, 7, 11, 15, m[s[6]], m[s[7]], rot24, rot16);
+                G4(v, 0, 5, 10, 15, m[s[8]], m[s[9]], rot24, rot16);
+                G4(v, 1, 6, 11, 12, m[s[10]], m[s[11]], rot24, rot16);
+                G4(v, 2, 7, 8, 13, m[s[12]], m[s[13]], rot24, rot16);
+                G4(v, 3, 4, 9, 14, m[s[14]], m[s[15]], rot24, rot16);
+            }
+            for (int i = 0; i < 8; i++)
+                h[i] = _mm256_xor_si256(h[i], _mm256_xor_si256(v[i], v[i + 8]));
+        }
+
+        alignas(32) uint64_t words[8][4];
+        for (int i = 0; i < 8; i++)
+            _mm256_store_si256(reinterpret_cast<__m256i*>(words[i]), h[i]);
+        for (int l = 0; l < 4; l++) {
+            uint64_t hl[8];
+            for (int i = 0; i < 8; i++)
+                hl[i] = words[i][l];
+            store_hash(outs[l], size, hl);
+            sodium_memzero(hl, sizeof(hl));
+        }
+        sodium_memzero(words, sizeof(words));
+        sodium_memzero(bufs.data(), sizeof(bufs));
+    }
+
+#endif
+
+}  // namespace
+
+void hash_multi(
+        unsigned char* out,
+        size_t size,
+        const std::vector<ustring_view>& msgs,
+        std::optional<ustring_view> key) {
+    if (size < crypto_generichash_blake2b_BYTES_MIN || size > crypto_generichash_blake2b_BYTES_MAX)
+        throw std::invalid_argument{"Invalid size: expected between 16 and 64 bytes (inclusive)"};
+
+    if (key && key->size() > crypto_generichash_blake2b_BYTES_MAX)
+        throw std::invalid_argument{"Invalid key: expected less than 65 bytes"};
+
+    batch_prefix prefix{size, key.value_or(ustring_view{})};
+
+    // Messages ordered by block count, as only messages with the same number of blocks can share
+    // SIMD lanes:
+    std::vector<size_t> order;
+    order.reserve(msgs.size());
+    for (size_t i = 0; i < msgs.size(); i++) {
+        if (prefix.keyed && msgs[i].empty())
+            prefix.hash_empty_keyed(out + i * size, size);
+        else
+            order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&msgs](size_t a, size_t b) {
+        return num_blocks(msgs[a].size()) < num_blocks(msgs[b].size());
+    });
+
+    size_t o = 0;
+#ifdef SESSION_HASH_AVX2
+    if (have_avx2()) {
+        while (o + 4 <= order.size()) {
+            auto nb = num_blocks(msgs[order[o]].size());
+            if (num_blocks(msgs[order[o + 3]].size()) != nb) {
+                // Not enough messages of this block count to fill the lanes, so do it one at a
+                // time:
+                hash_one(prefix, size, msgs[order[o]], out + order[o] * size);
+                o++;
+                continue;
+            }
+            ustring_view lane_msgs[4];
+            unsigned char* lane_outs[4];
+            for (int l = 0; l < 4; l++) {
+                lane_msgs[l] = msgs[order[o + l]];
+                lane_outs[l] = out + order[o + l] * size;
+            }
+            hash_four(prefix, size, lane_msgs, lane_outs);
+            o += 4;
+        }
+    }
+#endif
+    for (; o < order.size(); o++)
+        hash_one(prefix, size, msgs[order[o]], out + order[o] * size);
+}
+
+std::vector<ustring> hash_multi(
+        size_t size, const std::vector<ustring_view>& msgs, std::optional<ustring_view> key) {
+    ustring all;
+    all.resize(size * msgs.size());
+    hash_multi(all.data(), size, msgs, key);
+    std::vector<ustring> result;
+    result.reserve(msgs.size());
+    for (size_t i = 0; i < msgs.size(); i++)
+        result.emplace_back(all.data() + i * size, size);
+    return result;
+}
+
 }  // namespace session::hash
 
 using session::ustring;
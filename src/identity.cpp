@@ -0,0 +1,169 @@
+#include "session/identity.hpp"
+
+#include <sodium/core.h>
+#include <sodium/crypto_sign_ed25519.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "session/encoding.hpp"
+#include "session/export.h"
+#include "session/identity.h"
+#include "session/session_encrypt.hpp"
+
+namespace session {
+
+SessionIdentity::SessionIdentity(ustring_view ed25519_privkey) {
+    if (sodium_init() == -1)
+        throw std::runtime_error{"libsodium initialization failed!"};
+
+    if (ed25519_privkey.size() != 32 && ed25519_privkey.size() != 64)
+        throw std::invalid_argument{"Invalid ed25519_privkey: expected 32 or 64 bytes"};
+
+    secrets_.reset(64 + 32);
+    if (ed25519_privkey.size() == 32) {
+        crypto_sign_ed25519_seed_keypair(ed_pk_.data(), secrets_.data(), ed25519_privkey.data());
+    } else {
+        std::memcpy(secrets_.data(), ed25519_privkey.data(), 64);
+        std::memcpy(ed_pk_.data(), ed25519_privkey.data() + 32, 32);
+    }
+
+    if (0 != crypto_sign_ed25519_pk_to_curve25519(x_pk_.data(), ed_pk_.data()))
+        throw std::invalid_argument{
+                "Invalid ed25519_privkey: pubkey cannot be converted to X25519"};
+    crypto_sign_ed25519_sk_to_curve25519(secrets_.data() + 64, secrets_.data());
+
+    session_id_ = encoding::to_prefixed_hex(0x05, {x_pk_.data(), x_pk_.size()});
+}
+
+}  // namespace session
+
+using namespace session;
+
+struct session_identity : SessionIdentity {
+    using SessionIdentity::SessionIdentity;
+};
+
+LIBSESSION_C_API session_identity* session_identity_new(
+        const unsigned char* ed25519_privkey, size_t privkey_len) {
+    try {
+        return new session_identity{ustring_view{ed25519_privkey, privkey_len}};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+LIBSESSION_C_API void session_identity_free(session_identity* identity) {
+    delete identity;
+}
+
+LIBSESSION_C_API void session_identity_ed25519_pubkey(
+        const session_identity* identity, unsigned char* pubkey_out) {
+    std::memcpy(pubkey_out, identity->ed25519_pubkey().data(), 32);
+}
+
+LIBSESSION_C_API void session_identity_x25519_pubkey(
+        const session_identity* identity, unsigned char* pubkey_out) {
+    std::memcpy(pubkey_out, identity->x25519_pubkey().data(), 32);
+}
+
+LIBSESSION_C_API void session_identity_session_id(
+        const session_identity* identity, char* session_id_out) {
+    auto& sid = identity->session_id();
+    std::memcpy(session_id_out, sid.c_str(), sid.size() + 1);
+}
+
+namespace {
+
+unsigned char* malloc_copy(ustring_view data, size_t* len) {
+    auto* out = static_cast<unsigned char*>(std::malloc(data.size()));
+    std::memcpy(out, data.data(), data.size());
+    *len = data.size();
+    return out;
+}
+
+}  // namespace
+
+LIBSESSION_C_API bool session_identity_encrypt_for_recipient_deterministic(
+        const unsigned char* plaintext_in,
+        size_t plaintext_len,
+        const session_identity* sender,
+        const unsigned char* recipient_pubkey,
+        unsigned char** ciphertext_out,
+        size_t* ciphertext_len) {
+    try {
+        auto ciphertext = encrypt_for_recipient_deterministic(
+                *sender,
+                ustring_view{recipient_pubkey, 32},
+                ustring_view{plaintext_in, plaintext_len});
+        *ciphertext_out = malloc_copy(ciphertext, ciphertext_len);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+LIBSESSION_C_API bool session_identity_encrypt_for_blinded_recipient(
+        const unsigned char* plaintext_in,
+        size_t plaintext_len,
+        const session_identity* sender,
+        const unsigned char* open_group_pubkey,
+        const unsigned char* recipient_blinded_id,
+        unsigned char** ciphertext_out,
+        size_t* ciphertext_len) {
+    try {
+        auto ciphertext = encrypt_for_blinded_recipient(
+                *sender,
+                ustring_view{open_group_pubkey, 32},
+                ustring_view{recipient_blinded_id, 33},
+                ustring_view{plaintext_in, plaintext_len});
+        *ciphertext_out = malloc_copy(ciphertext, ciphertext_len);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+LIBSESSION_C_API bool session_identity_decrypt_incoming(
+        const unsigned char* ciphertext_in,
+        size_t ciphertext_len,
+        const session_identity* recipient,
+        char* session_id_out,
+        unsigned char** plaintext_out,
+        size_t* plaintext_len) {
+    try {
+        auto [plaintext, session_id] = decrypt_incoming_session_id(
+                *recipient, ustring_view{ciphertext_in, ciphertext_len});
+        std::memcpy(session_id_out, session_id.c_str(), session_id.size() + 1);
+        *plaintext_out = malloc_copy(plaintext, plaintext_len);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+LIBSESSION_C_API bool session_identity_decrypt_for_blinded_recipient(
+        const unsigned char* ciphertext_in,
+        size_t ciphertext_len,
+        const session_identity* receiver,
+        const unsigned char* open_group_pubkey,
+        const unsigned char* sender_id,
+        const unsigned char* recipient_id,
+        char* session_id_out,
+        unsigned char** plaintext_out,
+        size_t* plaintext_len) {
+    try {
+        auto [plaintext, session_id] = decrypt_from_blinded_recipient(
+                *receiver,
+                ustring_view{open_group_pubkey, 32},
+                ustring_view{sender_id, 33},
+                ustring_view{recipient_id, 33},
+                ustring_view{ciphertext_in, ciphertext_len});
+        std::memcpy(session_id_out, session_id.c_str(), session_id.size() + 1);
+        *plaintext_out = malloc_copy(plaintext, plaintext_len);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
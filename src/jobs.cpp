@@ -0,0 +1,383 @@
+#include "session/jobs.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "session/export.h"
+#include "session/jobs.h"
+#include "session/session_encrypt.hpp"
+#include "session/sodium_array.hpp"
+#include "session/types.hpp"
+
+namespace session {
+
+JobPool::JobPool(size_t threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; i++)
+        workers_.emplace_back([this] { worker(); });
+}
+
+JobPool::~JobPool() {
+    {
+        std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& w : workers_)
+        w.join();
+}
+
+void JobPool::submit(std::vector<const void*> objects, std::function<void()> job) {
+    std::sort(objects.begin(), objects.end());
+    objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+
+    auto q = std::make_shared<queued>();
+    q->job = std::move(job);
+    q->objects = std::move(objects);
+    {
+        std::lock_guard lock{mutex_};
+        for (auto* obj : q->objects) {
+            auto& oq = object_queues_[obj];
+            if (!oq.empty())
+                q->blocked++;
+            oq.push_back(q);
+        }
+        outstanding_++;
+        if (q->blocked)
+            return;
+        ready_.push_back(std::move(q));
+    }
+    cv_.notify_one();
+}
+
+void JobPool::worker() {
+    std::unique_lock lock{mutex_};
+    while (true) {
+        cv_.wait(lock, [this] { return !ready_.empty() || (stopping_ && outstanding_ == 0); });
+        if (ready_.empty())
+            return;
+
+        auto q = std::move(ready_.front());
+        ready_.pop_front();
+        lock.unlock();
+        try {
+            q->job();
+        } catch (...) {
+        }
+        q->job = nullptr;
+        lock.lock();
+
+        // Pass each of the job's objects on to the next job waiting for it, if any; jobs that are
+        // no longer waiting on any object become ready.
+        size_t newly_ready = 0;
+        for (auto* obj : q->objects) {
+            auto it = object_queues_.find(obj);
+            auto& oq = it->second;
+            oq.pop_front();
+            if (oq.empty()) {
+                object_queues_.erase(it);
+            } else if (--oq.front()->blocked == 0) {
+                ready_.push_back(oq.front());
+                newly_ready++;
+            }
+        }
+        --outstanding_;
+        if (newly_ready > 1 || (stopping_ && outstanding_ == 0))
+            cv_.notify_all();
+        else if (newly_ready)
+            cv_.notify_one();
+    }
+}
+
+}  // namespace session
+
+using namespace session;
+
+struct session_job_pool : JobPool {
+    using JobPool::JobPool;
+};
+
+struct session_job {
+    session_job_callback callback;
+    void* ctx;
+
+    // One reference for the caller's handle and one for the pool, until the job finishes.
+    std::atomic<int> refs{2};
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<SESSION_JOB_STATUS> status{SESSION_JOB_PENDING};
+
+    // Results; these are only written before `status` is changed, after which they may only be
+    // taken (with `mutex` held).
+    std::string error;
+    config_string_list* string_list = nullptr;
+    config_push_data* push_data = nullptr;
+    unsigned char* data = nullptr;
+    size_t data_len = 0;
+    std::optional<std::array<char, 67>> session_id;
+
+    session_job(session_job_callback callback, void* ctx) : callback{callback}, ctx{ctx} {}
+
+    ~session_job() {
+        std::free(string_list);
+        std::free(push_data);
+        std::free(data);
+    }
+
+    void release() {
+        if (--refs == 0)
+            delete this;
+    }
+
+    void finish(bool success) {
+        {
+            std::lock_guard lock{mutex};
+            status = success ? SESSION_JOB_SUCCEEDED : SESSION_JOB_FAILED;
+        }
+        cv.notify_all();
+        if (callback)
+            callback(this, ctx);
+        release();
+    }
+
+    void set_data(ustring_view d) {
+        data = static_cast<unsigned char*>(std::malloc(d.size()));
+        std::memcpy(data, d.data(), d.size());
+        data_len = d.size();
+    }
+
+    void set_session_id(std::string_view sid) {
+        auto& out = session_id.emplace();
+        std::memcpy(out.data(), sid.data(), std::min(sid.size(), out.size() - 1));
+        out[std::min(sid.size(), out.size() - 1)] = '\0';
+    }
+};
+
+namespace {
+
+// Queues a job on the pool; `run` is invoked with the job on a worker thread, and stores the job
+// results and returns true on success, or stores an error (or throws) and returns false on failure.
+// The job is always finished, whatever `run` throws, so that its callback and waiters never hang.
+template <typename F>
+session_job* submit(
+        session_job_pool* pool,
+        std::vector<const void*> objects,
+        session_job_callback callback,
+        void* ctx,
+        F run) {
+    auto* job = new session_job{callback, ctx};
+    pool->submit(std::move(objects), [job, run = std::move(run)] {
+        bool success = false;
+        try {
+            success = run(*job);
+        } catch (const std::exception& e) {
+            job->error = e.what();
+        } catch (...) {
+            job->error = "Unknown error";
+        }
+        job->finish(success);
+    });
+    return job;
+}
+
+template <typename Conf>
+void copy_last_error(session_job& job, const Conf* conf) {
+    if (conf->last_error)
+        job.error = conf->last_error;
+}
+
+}  // namespace
+
+extern "C" {
+
+LIBSESSION_C_API session_job_pool* session_job_pool_new(size_t threads) {
+    try {
+        return new session_job_pool{threads};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+LIBSESSION_C_API void session_job_pool_free(session_job_pool* pool) {
+    delete pool;
+}
+
+LIBSESSION_C_API session_job* session_job_config_merge(
+        session_job_pool* pool,
+        config_object* conf,
+        const char** msg_hashes,
+        const unsigned char** configs,
+        const size_t* lengths,
+        size_t count,
+        session_job_callback callback,
+        void* ctx) {
+    std::vector<std::string> hashes;
+    std::vector<ustring> msgs;
+    hashes.reserve(count);
+    msgs.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        hashes.emplace_back(msg_hashes[i]);
+        msgs.emplace_back(configs[i], lengths[i]);
+    }
+    return submit(
+            pool,
+            {conf},
+            callback,
+            ctx,
+            [conf, hashes = std::move(hashes), msgs = std::move(msgs)](session_job& job) {
+                std::vector<const char*> hash_ptrs;
+                std::vector<const unsigned char*> msg_ptrs;
+                std::vector<size_t> msg_lens;
+                for (size_t i = 0; i < hashes.size(); i++) {
+                    hash_ptrs.push_back(hashes[i].c_str());
+                    msg_ptrs.push_back(msgs[i].data());
+                    msg_lens.push_back(msgs[i].size());
+                }
+                job.string_list = config_merge(
+                        conf, hash_ptrs.data(), msg_ptrs.data(), msg_lens.data(), hashes.size());
+                return true;
+            });
+}
+
+LIBSESSION_C_API session_job* session_job_config_push(
+        session_job_pool* pool,
+        config_object* conf,
+        session_job_callback callback,
+        void* ctx) {
+    return submit(pool, {conf}, callback, ctx, [conf](session_job& job) {
+        job.push_data = config_push(conf);
+        return true;
+    });
+}
+
+LIBSESSION_C_API session_job* session_job_groups_keys_rekey(
+        session_job_pool* pool,
+        config_group_keys* conf,
+        config_object* info,
+        config_object* members,
+        session_job_callback callback,
+        void* ctx) {
+    return submit(
+            pool, {conf, info, members}, callback, ctx, [conf, info, members](session_job& job) {
+                const unsigned char* out;
+                size_t outlen;
+                if (!groups_keys_rekey(conf, info, members, &out, &outlen)) {
+                    copy_last_error(job, conf);
+                    return false;
+                }
+                job.set_data({out, outlen});
+                return true;
+            });
+}
+
+LIBSESSION_C_API session_job* session_job_groups_keys_decrypt_message(
+        session_job_pool* pool,
+        config_group_keys* conf,
+        const unsigned char* ciphertext_in,
+        size_t ciphertext_len,
+        session_job_callback callback,
+        void* ctx) {
+    return submit(
+            pool,
+            {conf},
+            callback,
+            ctx,
+            [conf, ciphertext = ustring{ciphertext_in, ciphertext_len}](session_job& job) {
+                char session_id[67];
+                if (!groups_keys_decrypt_message(
+                            conf,
+                            ciphertext.data(),
+                            ciphertext.size(),
+                            session_id,
+                            &job.data,
+                            &job.data_len)) {
+                    copy_last_error(job, conf);
+                    return false;
+                }
+                job.set_session_id(session_id);
+                return true;
+            });
+}
+
+LIBSESSION_C_API session_job* session_job_decrypt_incoming(
+        session_job_pool* pool,
+        const unsigned char* ciphertext_in,
+        size_t ciphertext_len,
+        const unsigned char* ed25519_privkey,
+        session_job_callback callback,
+        void* ctx) {
+    auto privkey = std::make_shared<cleared_uc64>();
+    std::memcpy(privkey->data(), ed25519_privkey, privkey->size());
+    return submit(
+            pool,
+            {},
+            callback,
+            ctx,
+            [privkey, ciphertext = ustring{ciphertext_in, ciphertext_len}](session_job& job) {
+                auto [plaintext, session_id] = decrypt_incoming_session_id(
+                        ustring_view{privkey->data(), privkey->size()}, ciphertext);
+                job.set_data(plaintext);
+                job.set_session_id(session_id);
+                return true;
+            });
+}
+
+LIBSESSION_C_API SESSION_JOB_STATUS session_job_status(const session_job* job) {
+    return job->status;
+}
+
+LIBSESSION_C_API SESSION_JOB_STATUS session_job_wait(session_job* job) {
+    std::unique_lock lock{job->mutex};
+    job->cv.wait(lock, [job] { return job->status != SESSION_JOB_PENDING; });
+    return job->status;
+}
+
+LIBSESSION_C_API const char* session_job_error(const session_job* job) {
+    if (job->status != SESSION_JOB_FAILED)
+        return "";
+    return job->error.c_str();
+}
+
+LIBSESSION_C_API config_string_list* session_job_take_string_list(session_job* job) {
+    std::lock_guard lock{job->mutex};
+    if (job->status != SESSION_JOB_SUCCEEDED)
+        return nullptr;
+    return std::exchange(job->string_list, nullptr);
+}
+
+LIBSESSION_C_API config_push_data* session_job_take_push_data(session_job* job) {
+    std::lock_guard lock{job->mutex};
+    if (job->status != SESSION_JOB_SUCCEEDED)
+        return nullptr;
+    return std::exchange(job->push_data, nullptr);
+}
+
+LIBSESSION_C_API unsigned char* session_job_take_data(session_job* job, size_t* len) {
+    std::lock_guard lock{job->mutex};
+    if (job->status != SESSION_JOB_SUCCEEDED || !job->data)
+        return nullptr;
+    *len = job->data_len;
+    return std::exchange(job->data, nullptr);
+}
+
+LIBSESSION_C_API bool session_job_session_id(const session_job* job, char* session_id_out) {
+    if (job->status != SESSION_JOB_SUCCEEDED || !job->session_id)
+        return false;
+    std::memcpy(session_id_out, job->session_id->data(), job->session_id->size());
+    return true;
+}
+
+LIBSESSION_C_API void session_job_free(session_job* job) {
+    job->release();
+}
+
+}  // extern "C"
@@ -8,6 +8,8 @@
 #include <sodium/crypto_sign_ed25519.h>
 #include <sodium/randombytes.h>
 
+#include <cstring>
+#include <session/hash.hpp>
 #include <session/multi_encrypt.hpp>
 #include <stdexcept>
 
@@ -51,6 +53,40 @@ namespace detail {
         crypto_generichash_blake2b_final(&st, key.data(), 32);
     }
 
+    std::vector<size_t> encrypt_multi_keys(
+            sodium_vector<unsigned char>& keys_out,
+            const unsigned char* a,
+            const unsigned char* A,
+            const std::vector<ustring_view>& recipients,
+            bool encrypting,
+            std::string_view domain) {
+
+        std::vector<size_t> invalid;
+        // Each hash input is the same aB || S || R as in `encrypt_multi_key`:
+        sodium_vector<unsigned char> inputs(96 * recipients.size());
+        std::vector<ustring_view> to_hash;
+        to_hash.reserve(recipients.size());
+        for (size_t i = 0; i < recipients.size(); i++) {
+            auto* in = inputs.data() + 96 * i;
+            const auto* B = recipients[i].data();
+            if (0 != crypto_scalarmult_curve25519(in, a, B))
+                invalid.push_back(i);
+            std::memcpy(in + 32, encrypting ? A : B, 32);
+            std::memcpy(in + 64, encrypting ? B : A, 32);
+            to_hash.emplace_back(in, 96);
+        }
+
+        keys_out.resize(32 * recipients.size());
+        hash::hash_multi(
+                keys_out.data(),
+                32,
+                to_hash,
+                ustring_view{
+                        reinterpret_cast<const unsigned char*>(domain.data()),
+                        std::min<size_t>(domain.size(), crypto_generichash_blake2b_KEYBYTES_MAX)});
+        return invalid;
+    }
+
     void encrypt_multi_impl(
             ustring& out, ustring_view msg, const unsigned char* key, const unsigned char* nonce) {
 
@@ -1,25 +1,25 @@
 #include "session/onionreq/key_types.hpp"
 
 #include <oxenc/base32z.h>
-#include <oxenc/base64.h>
-#include <oxenc/hex.h>
 #include <sodium.h>
 
 #include <cstring>
 #include <type_traits>
 
+#include "session/encoding.hpp"
+
 namespace session::onionreq {
 
 namespace detail {
 
     void load_from_hex(void* buffer, size_t length, std::string_view hex) {
-        if (!oxenc::is_hex(hex))
+        if (!encoding::is_hex(hex))
             throw std::runtime_error{"Hex key data is invalid: data is not hex"};
         if (hex.size() != 2 * length)
             throw std::runtime_error{
                     "Hex key data is invalid: expected " + std::to_string(length) +
                     " hex digits, received " + std::to_string(hex.size())};
-        oxenc::from_hex(hex.begin(), hex.end(), reinterpret_cast<unsigned char*>(buffer));
+        encoding::from_hex(hex, static_cast<unsigned char*>(buffer));
     }
 
     void load_from_bytes(void* buffer, size_t length, std::string_view bytes) {
@@ -60,12 +60,12 @@ static T parse_pubkey(std::string_view pubkey_in) {
     static_assert(pk.size() == 32);
     if (pubkey_in.size() == 32)
         detail::load_from_bytes(pk.data(), 32, pubkey_in);
-    else if (pubkey_in.size() == 64 && oxenc::is_hex(pubkey_in))
-        oxenc::from_hex(pubkey_in.begin(), pubkey_in.end(), pk.begin());
+    else if (pubkey_in.size() == 64 && encoding::is_hex(pubkey_in))
+        encoding::from_hex(pubkey_in, pk.data());
     else if (
             (pubkey_in.size() == 43 || (pubkey_in.size() == 44 && pubkey_in.back() == '=')) &&
-            oxenc::is_base64(pubkey_in))
-        oxenc::from_base64(pubkey_in.begin(), pubkey_in.end(), pk.begin());
+            encoding::is_base64(pubkey_in))
+        encoding::from_base64(pubkey_in, pk.data());
     else if (pubkey_in.size() == 52 && oxenc::is_base32z(pubkey_in))
         oxenc::from_base32z(pubkey_in.begin(), pubkey_in.end(), pk.begin());
 
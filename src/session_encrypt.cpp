@@ -1,6 +1,5 @@
 #include "session/session_encrypt.hpp"
 
-#include <oxenc/hex.h>
 #include <session/session_encrypt.h>
 #include <sodium/crypto_aead_xchacha20poly1305.h>
 #include <sodium/crypto_box.h>
@@ -17,6 +16,7 @@
 #include <stdexcept>
 
 #include "session/blinding.hpp"
+#include "session/encoding.hpp"
 #include "session/sodium_array.hpp"
 
 using namespace std::literals;
@@ -64,6 +64,11 @@ ustring sign_for_recipient(
     return buf;
 }
 
+ustring sign_for_recipient(
+        const SessionIdentity& sender, ustring_view recipient_pubkey, ustring_view message) {
+    return sign_for_recipient(sender.ed25519_secret(), recipient_pubkey, message);
+}
+
 static const ustring_view BOX_HASHKEY = to_unsigned_sv("SessionBoxEphemeralHashKey"sv);
 
 ustring encrypt_for_recipient(
@@ -84,6 +89,11 @@ ustring encrypt_for_recipient(
     return result;
 }
 
+ustring encrypt_for_recipient(
+        const SessionIdentity& sender, ustring_view recipient_pubkey, ustring_view message) {
+    return encrypt_for_recipient(sender.ed25519_secret(), recipient_pubkey, message);
+}
+
 ustring encrypt_for_recipient_deterministic(
         ustring_view ed25519_privkey, ustring_view recipient_pubkey, ustring_view message) {
 
@@ -136,6 +146,11 @@ ustring encrypt_for_recipient_deterministic(
     return result;
 }
 
+ustring encrypt_for_recipient_deterministic(
+        const SessionIdentity& sender, ustring_view recipient_pubkey, ustring_view message) {
+    return encrypt_for_recipient_deterministic(sender.ed25519_secret(), recipient_pubkey, message);
+}
+
 // Calculate the shared encryption key, sending from blinded sender kS (k = S's blinding factor) to
 // blinded receiver jR (j = R's blinding factor).
 //
@@ -305,44 +320,43 @@ ustring encrypt_for_blinded_recipient(
     return ciphertext;
 }
 
-std::pair<ustring, std::string> decrypt_incoming_session_id(
-        ustring_view ed25519_privkey, ustring_view ciphertext) {
-    auto [buf, sender_ed_pk] = decrypt_incoming(ed25519_privkey, ciphertext);
+ustring encrypt_for_blinded_recipient(
+        const SessionIdentity& sender,
+        ustring_view server_pk,
+        ustring_view recipient_blinded_id,
+        ustring_view message) {
+    return encrypt_for_blinded_recipient(
+            sender.ed25519_secret(), server_pk, recipient_blinded_id, message);
+}
 
-    // Convert the sender_ed_pk to the sender's session ID
+// Converts a sender's Ed25519 pubkey (as extracted from a decrypted message) to its session ID.
+static std::string sender_session_id(ustring_view sender_ed_pk) {
     std::array<unsigned char, 32> sender_x_pk;
 
     if (0 != crypto_sign_ed25519_pk_to_curve25519(sender_x_pk.data(), sender_ed_pk.data()))
         throw std::runtime_error{"Sender ed25519 pubkey to x25519 pubkey conversion failed"};
 
-    // Everything is good, so just drop A and Y off the message and prepend the '05' prefix to
-    // the sender session ID
-    std::string sender_session_id;
-    sender_session_id.reserve(66);
-    sender_session_id += "05";
-    oxenc::to_hex(sender_x_pk.begin(), sender_x_pk.end(), std::back_inserter(sender_session_id));
+    return encoding::to_prefixed_hex(0x05, {sender_x_pk.data(), sender_x_pk.size()});
+}
 
-    return {buf, sender_session_id};
+std::pair<ustring, std::string> decrypt_incoming_session_id(
+        ustring_view ed25519_privkey, ustring_view ciphertext) {
+    auto [buf, sender_ed_pk] = decrypt_incoming(ed25519_privkey, ciphertext);
+
+    return {buf, sender_session_id(sender_ed_pk)};
 }
 
 std::pair<ustring, std::string> decrypt_incoming_session_id(
         ustring_view x25519_pubkey, ustring_view x25519_seckey, ustring_view ciphertext) {
     auto [buf, sender_ed_pk] = decrypt_incoming(x25519_pubkey, x25519_seckey, ciphertext);
 
-    // Convert the sender_ed_pk to the sender's session ID
-    std::array<unsigned char, 32> sender_x_pk;
-
-    if (0 != crypto_sign_ed25519_pk_to_curve25519(sender_x_pk.data(), sender_ed_pk.data()))
-        throw std::runtime_error{"Sender ed25519 pubkey to x25519 pubkey conversion failed"};
-
-    // Everything is good, so just drop A and Y off the message and prepend the '05' prefix to
-    // the sender session ID
-    std::string sender_session_id;
-    sender_session_id.reserve(66);
-    sender_session_id += "05";
-    oxenc::to_hex(sender_x_pk.begin(), sender_x_pk.end(), std::back_inserter(sender_session_id));
+    return {buf, sender_session_id(sender_ed_pk)};
+}
 
-    return {buf, sender_session_id};
+std::pair<ustring, std::string> decrypt_incoming_session_id(
+        const SessionIdentity& recipient, ustring_view ciphertext) {
+    auto [buf, sender_ed_pk] = decrypt_incoming(recipient, ciphertext);
+    return {buf, sender_session_id(sender_ed_pk)};
 }
 
 std::pair<ustring, ustring> decrypt_incoming(
@@ -401,6 +415,11 @@ std::pair<ustring, ustring> decrypt_incoming(
     return result;
 }
 
+std::pair<ustring, ustring> decrypt_incoming(
+        const SessionIdentity& recipient, ustring_view ciphertext) {
+    return decrypt_incoming(recipient.x25519_pubkey(), recipient.x25519_secret(), ciphertext);
+}
+
 std::pair<ustring, std::string> decrypt_from_blinded_recipient(
         ustring_view ed25519_privkey,
         ustring_view server_pk,
@@ -500,13 +519,21 @@ std::pair<ustring, std::string> decrypt_from_blinded_recipient(
     // Everything is good, so just drop the sender_ed_pk off the message and prepend the '05' prefix
     // to the sender session ID
     buf.resize(buf.size() - 32);
-    sender_session_id.reserve(66);
-    sender_session_id += "05";
-    oxenc::to_hex(sender_x_pk.begin(), sender_x_pk.end(), std::back_inserter(sender_session_id));
+    sender_session_id = encoding::to_prefixed_hex(0x05, {sender_x_pk.data(), sender_x_pk.size()});
 
     return result;
 }
 
+std::pair<ustring, std::string> decrypt_from_blinded_recipient(
+        const SessionIdentity& receiver,
+        ustring_view server_pk,
+        ustring_view sender_id,
+        ustring_view recipient_id,
+        ustring_view ciphertext) {
+    return decrypt_from_blinded_recipient(
+            receiver.ed25519_secret(), server_pk, sender_id, recipient_id, ciphertext);
+}
+
 std::string decrypt_ons_response(
         std::string_view lowercase_name, ustring_view ciphertext, ustring_view nonce) {
     if (ciphertext.size() < crypto_aead_xchacha20poly1305_ietf_ABYTES)
@@ -550,7 +577,7 @@ std::string decrypt_ons_response(
     if (buf_len != 33)
         throw std::runtime_error{"Invalid decrypted value: expected to be 33 bytes"};
 
-    std::string session_id = oxenc::to_hex(buf.begin(), buf.end());
+    std::string session_id = encoding::to_hex(buf);
     return session_id;
 }
 
@@ -1,17 +1,137 @@
 #include <sodium/utils.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <mutex>
 #include <session/sodium_array.hpp>
+#include <vector>
 
 namespace session {
 
+namespace {
+
+    // Small secure allocations are carved out of larger sodium_malloc'ed regions rather than being
+    // individually sodium_malloc'ed: each sodium_malloc call costs an mmap plus several
+    // mprotect/mlock syscalls (for its guard pages) which, for small, frequently reallocated
+    // buffers (such as a growing sodium_vector or temporary key storage), is far more expensive
+    // than the allocation itself.  The regions are still guard-paged and locked (since they come
+    // from sodium_malloc); the tradeoff is that individual slots within a region are not separated
+    // from each other by guard pages.
+    //
+    // Each region serves a single, power-of-two slot size.  Freed slots are zeroed and kept on a
+    // per-size free list for reuse; regions are never returned to the system.
+
+    constexpr size_t MIN_SLOT_SHIFT = 4;   // 16 bytes
+    constexpr size_t MAX_SLOT_SHIFT = 12;  // 4kiB
+    constexpr size_t NUM_SLOT_SIZES = MAX_SLOT_SHIFT - MIN_SLOT_SHIFT + 1;
+    constexpr size_t MAX_SLOT_SIZE = size_t{1} << MAX_SLOT_SHIFT;
+    // A multiple of the page size, so that sodium_malloc gives us a page-aligned region:
+    constexpr size_t REGION_SIZE = 64 * 1024;
+
+    struct free_slot {
+        free_slot* next;
+    };
+
+    struct region {
+        unsigned char* begin;
+        unsigned char* end;
+        size_t slot_size;
+    };
+
+    class secure_pool {
+        std::mutex mutex_;
+        // Sorted by address so that we can find the region (if any) a pointer belongs to.
+        std::vector<region> regions_;
+        std::array<free_slot*, NUM_SLOT_SIZES> free_{};
+
+        static bool before_region(const unsigned char* p, const region& r) { return p < r.begin; }
+
+        static size_t slot_index(size_t size) {
+            size_t i = 0;
+            while ((size_t{1} << (MIN_SLOT_SHIFT + i)) < size)
+                i++;
+            return i;
+        }
+
+        // Allocates a new region for slot index `i` and threads its slots onto the free list.
+        // Must be called with the mutex held.
+        void add_region(size_t i) {
+            auto* mem = static_cast<unsigned char*>(sodium_malloc(REGION_SIZE));
+            if (!mem)
+                throw std::bad_alloc{};
+            const size_t slot_size = size_t{1} << (MIN_SLOT_SHIFT + i);
+            regions_.insert(
+                    std::upper_bound(regions_.begin(), regions_.end(), mem, before_region),
+                    region{mem, mem + REGION_SIZE, slot_size});
+
+            sodium_memzero(mem, REGION_SIZE);
+            for (size_t offset = REGION_SIZE; offset > 0;) {
+                offset -= slot_size;
+                auto* slot = reinterpret_cast<free_slot*>(mem + offset);
+                slot->next = free_[i];
+                free_[i] = slot;
+            }
+        }
+
+        // Returns the region containing `p`, or nullptr if `p` isn't from the pool.  Must be called
+        // with the mutex held.
+        const region* find_region(const void* p) const {
+            auto* up = static_cast<const unsigned char*>(p);
+            auto it = std::upper_bound(regions_.begin(), regions_.end(), up, before_region);
+            if (it == regions_.begin())
+                return nullptr;
+            --it;
+            return up < it->end ? &*it : nullptr;
+        }
+
+      public:
+        void* allocate(size_t size) {
+            const auto i = slot_index(size);
+            std::lock_guard lock{mutex_};
+            if (!free_[i])
+                add_region(i);
+            auto* slot = free_[i];
+            free_[i] = slot->next;
+            slot->next = nullptr;  // Re-zero the only part of the slot that wasn't zero
+            return slot;
+        }
+
+        // Returns true and releases `p` if `p` came from the pool; returns false (and does
+        // nothing) if it did not.
+        bool deallocate(void* p) {
+            std::lock_guard lock{mutex_};
+            auto* r = find_region(p);
+            if (!r)
+                return false;
+            auto i = slot_index(r->slot_size);
+            sodium_memzero(p, r->slot_size);
+            auto* slot = static_cast<free_slot*>(p);
+            slot->next = free_[i];
+            free_[i] = slot;
+            return true;
+        }
+    };
+
+    secure_pool& pool() {
+        // Intentionally leaked so that secure buffers held in other static objects can still be
+        // freed during static destruction.
+        static auto* p = new secure_pool{};
+        return *p;
+    }
+
+}  // namespace
+
 void* sodium_buffer_allocate(size_t length) {
+    if (length > 0 && length <= MAX_SLOT_SIZE)
+        return pool().allocate(length);
     if (auto* p = sodium_malloc(length))
         return p;
     throw std::bad_alloc{};
 }
 
 void sodium_buffer_deallocate(void* p) {
-    if (p)
+    if (p && !pool().deallocate(p))
         sodium_free(p);
 }
 
@@ -11,6 +11,7 @@
 #include <cstring>
 #include <stdexcept>
 
+#include "session/ed25519.hpp"
 #include "session/export.h"
 #include "session/util.hpp"
 
@@ -150,6 +151,77 @@ std::string pubkey(std::string_view curve25519_pubkey) {
     return std::string{reinterpret_cast<const char*>(ed_pk.data()), ed_pk.size()};
 }
 
+size_t verifier::key_hash::operator()(const pk_t& k) const {
+    // The keys are curve points, so their bytes are already uniformly distributed:
+    size_t h;
+    std::memcpy(&h, k.data(), sizeof(h));
+    return h;
+}
+
+std::array<unsigned char, 32> verifier::pubkey(ustring_view curve25519_pubkey) {
+    if (curve25519_pubkey.size() != 32)
+        throw std::invalid_argument{"Invalid curve25519_pubkey: expected 32 bytes"};
+    if (capacity_ == 0)
+        return xed25519::pubkey(curve25519_pubkey);
+
+    pk_t x;
+    std::memcpy(x.data(), curve25519_pubkey.data(), x.size());
+
+    std::lock_guard lock{mutex_};
+    if (auto it = index_.find(x); it != index_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+    }
+
+    auto ed = xed25519::pubkey(curve25519_pubkey);
+    if (lru_.size() >= capacity_) {
+        // Reuse the least recently used node for the new entry
+        index_.erase(lru_.back().first);
+        lru_.splice(lru_.begin(), lru_, std::prev(lru_.end()));
+        lru_.front() = {x, ed};
+    } else {
+        lru_.emplace_front(x, ed);
+    }
+    index_.emplace(x, lru_.begin());
+    return ed;
+}
+
+bool verifier::verify(ustring_view signature, ustring_view curve25519_pubkey, ustring_view msg) {
+    assert(signature.size() == crypto_sign_ed25519_BYTES);
+    assert(curve25519_pubkey.size() == 32);
+    auto ed_pubkey = pubkey(curve25519_pubkey);
+    return 0 == crypto_sign_ed25519_verify_detached(
+                        signature.data(), msg.data(), msg.size(), ed_pubkey.data());
+}
+
+std::vector<size_t> verifier::verify_batch(
+        const std::vector<ustring_view>& sigs,
+        const std::vector<ustring_view>& curve25519_pubkeys,
+        const std::vector<ustring_view>& msgs) {
+    std::vector<pk_t> ed_pubkeys;
+    ed_pubkeys.reserve(curve25519_pubkeys.size());
+    std::vector<ustring_view> ed_views;
+    ed_views.reserve(curve25519_pubkeys.size());
+    for (auto& x : curve25519_pubkeys) {
+        if (x.size() == 32)
+            ed_views.emplace_back(ed_pubkeys.emplace_back(pubkey(x)).data(), 32);
+        else
+            ed_views.push_back(x);  // Passed through so that it fails as a wrong-size pubkey
+    }
+    return ed25519::verify_batch(sigs, ed_views, msgs);
+}
+
+size_t verifier::size() const {
+    std::lock_guard lock{mutex_};
+    return lru_.size();
+}
+
+void verifier::clear() {
+    std::lock_guard lock{mutex_};
+    index_.clear();
+    lru_.clear();
+}
+
 }  // namespace session::xed25519
 
 using session::xed25519::ustring_view;
@@ -77,6 +77,33 @@ TEST_CASE("Communities 25xxx-blinded pubkey derivation", "[blinding25][pubkey]")
           "253b991dcbba44cfdb45d5b38880d95cff723309e3ece6fd01415ad5fa1dccc7ac");
 }
 
+TEST_CASE("Communities 25xxx-blinded pubkey batch derivation", "[blinding25][pubkey]") {
+    REQUIRE(sodium_init() >= 0);
+
+    ustring sid1, sid2;
+    oxenc::from_hex(session_id1.begin(), session_id1.end(), std::back_inserter(sid1));
+    oxenc::from_hex(session_id2.begin(), session_id2.end(), std::back_inserter(sid2));
+    auto server_pk = "abcdef0123456789abcdef0123456789abcdef0123456789abcdef0123456789"_hexbytes;
+
+    std::vector<ustring_view> sids{sid1, sid2, ustring_view{sid1}.substr(1), sid2, sid1};
+    auto ids = blind25_ids(sids, server_pk);
+    REQUIRE(ids.size() == sids.size());
+    for (size_t i = 0; i < sids.size(); i++)
+        CHECK(ids[i] == blind25_id(sids[i], server_pk));
+    CHECK(oxenc::to_hex(ids[0]) ==
+          "253b991dcbba44cfdb45d5b38880d95cff723309e3ece6fd01415ad5fa1dccc7ac");
+    CHECK(oxenc::to_hex(ids[1]) ==
+          "25a69cc6884530bf8498d22892e563716c4742f2845a7eb608de2aecbe7b6b5996");
+
+    auto factors = blind25_factors(sids, server_pk);
+    for (size_t i = 0; i < sids.size(); i++)
+        CHECK(factors[i] == blind25_factor(sids[i], server_pk));
+
+    CHECK(blind25_ids({}, server_pk).empty());
+    sids.push_back(ustring_view{sid1}.substr(2));
+    CHECK_THROWS(blind25_ids(sids, server_pk));
+}
+
 TEST_CASE("Communities 25xxx-blinded signing", "[blinding25][sign]") {
 
     std::array server_pks = {
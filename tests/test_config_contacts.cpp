@@ -3,9 +3,14 @@
 #include <session/config/contacts.h>
 #include <sodium/crypto_sign_ed25519.h>
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <session/config/contacts.hpp>
+#include <session/fields.hpp>
+#include <algorithm>
+#include <map>
 #include <string_view>
+#include <unordered_set>
 
 #include "utils.hpp"
 
@@ -247,6 +252,38 @@ TEST_CASE("Contacts", "[config][contacts]") {
           "9012345🎂");
 }
 
+TEST_CASE("SessionID", "[session_id]") {
+    constexpr auto id1_hex = "050000000000000000000000000000000000000000000000000000000000000000"sv;
+    constexpr auto id2_hex = "051111111111111111111111111111111111111111111111111111111111111111"sv;
+    constexpr auto gid_hex = "030303030303030303030303030303030303030303030303030303030303030303"sv;
+    session::SessionID id1{id1_hex}, id2{id2_hex}, gid{gid_hex};
+
+    CHECK(id1.prefix == session::SessionID::netid);
+    CHECK(gid.prefix == 0x03);
+    CHECK(id1.hex() == id1_hex);
+    CHECK(id2.hex() == id2_hex);
+    CHECK(gid.hex() == gid_hex);
+    CHECK(session::SessionID{}.hex() == id1_hex);
+    CHECK(session::SessionID{id2.pubkey} == id2);
+    CHECK(session::SessionID{gid.pubkey, 0x03} == gid);
+    CHECK(session::SessionID{ustring_view{"03"_hexbytes + ustring(32, 0x03)}} == gid);
+    CHECK(id1 < id2);
+    CHECK(id1 != id2);
+    CHECK(gid < id1);
+    CHECK_THROWS_AS(session::SessionID{"05abc"sv}, std::invalid_argument);
+    CHECK_THROWS_AS(
+            (session::SessionID{ustring_view{id1.pubkey.data(), 32}}), std::invalid_argument);
+
+    std::unordered_set<session::SessionID> ids{id1, id2, session::SessionID{id1_hex}};
+    CHECK(ids.size() == 2);
+    // Ordering must agree with the ordering of the hex strings:
+    std::map<session::SessionID, int> ordered{{id2, 2}, {id1, 1}, {gid, 0}};
+    std::vector<std::string> hexes;
+    for (auto& [id, _] : ordered)
+        hexes.push_back(id.hex());
+    CHECK(std::is_sorted(hexes.begin(), hexes.end()));
+}
+
 TEST_CASE("Contacts (C API)", "[config][contacts][c]") {
     const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
     std::array<unsigned char, 32> ed_pk, curve_pk;
@@ -449,6 +486,104 @@ TEST_CASE("huge contacts compression", "[config][compression][contacts]") {
     CHECK(dump.size() > 1'320'000);
 }
 
+TEST_CASE("Contacts iteration benchmark", "[config][contacts][!benchmark]") {
+    const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
+    session::config::Contacts contacts{ustring_view{seed}, std::nullopt};
+
+    for (uint16_t i = 0; i < 10000; i++) {
+        char buf[2];
+        oxenc::write_host_as_big(i, buf);
+        std::string session_id = "05000000000000000000000000000000000000000000000000000000000000";
+        session_id += oxenc::to_hex(buf, buf + 2);
+
+        auto c = contacts.get_or_construct(session_id);
+        c.set_name("Contact " + std::to_string(i));
+        if (i % 2)
+            c.set_nickname("Nick " + std::to_string(i));
+        c.profile_picture.url = "http://example.com/" + std::to_string(i);
+        c.profile_picture.key =
+                "abcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcd"_hexbytes;
+        c.approved = true;
+        c.approved_me = i % 3;
+        c.priority = i % 5;
+        c.notifications = session::config::notify_mode::disabled;
+        c.mute_until = created_ts + i;
+        c.exp_mode = session::config::expiration_mode::after_send;
+        c.exp_timer = 1h;
+        c.created = created_ts;
+        contacts.set(c);
+    }
+    REQUIRE(contacts.size() == 10000);
+
+    BENCHMARK("iterate 10k contacts") {
+        size_t approved = 0;
+        for (const auto& c : contacts)
+            approved += c.approved_me;
+        return approved;
+    };
+}
+
+TEST_CASE("Config memory usage", "[config][contacts][memory]") {
+    const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
+    session::config::Contacts contacts{ustring_view{seed}, std::nullopt};
+
+    auto empty = contacts.memory_usage();
+    CHECK(empty.data == 0);
+    CHECK(empty.diffs == 0);
+    CHECK(empty.pending == 0);
+    CHECK(empty.hashes == 0);
+    CHECK(empty.keys >= 32);
+    CHECK(empty.other > 0);
+    CHECK(empty.total() ==
+          empty.data + empty.diffs + empty.pending + empty.hashes + empty.keys + empty.other);
+
+    auto sid = [](int i) {
+        char buf[2];
+        oxenc::write_host_as_big(static_cast<uint16_t>(i), buf);
+        return "05000000000000000000000000000000000000000000000000000000000000" +
+               oxenc::to_hex(buf, buf + 2);
+    };
+    for (int i = 0; i < 100; i++) {
+        auto c = contacts.get_or_construct(sid(i));
+        c.set_name("Contact " + std::to_string(i));
+        contacts.set(c);
+    }
+
+    auto added = contacts.memory_usage();
+    CHECK(added.data > 100 * 33);
+    CHECK(added.total() > empty.total() + 100 * 33);
+
+    auto [seqno, msg, obs] = contacts.push();
+    contacts.confirm_pushed(seqno, std::string(64, 'a'));
+    auto pushed = contacts.memory_usage();
+    CHECK(pushed.data == added.data);
+    CHECK(pushed.hashes > 64);
+
+    // Editing again keeps a snapshot of the data (to diff against), carries along the previous
+    // diff as a lagged diff, and keeps the now-obsolete hash until the next push:
+    auto c = contacts.get_or_construct(sid(0));
+    c.set_nickname("Zero");
+    contacts.set(c);
+    auto edited = contacts.memory_usage();
+    CHECK(edited.pending >= pushed.data / 2);
+    CHECK(edited.diffs > 100 * 33);
+    CHECK(edited.hashes >= pushed.hashes);
+
+    // C API:
+    std::array<unsigned char, 32> ed_pk;
+    std::array<unsigned char, 64> ed_sk;
+    crypto_sign_ed25519_seed_keypair(ed_pk.data(), ed_sk.data(), seed.data());
+    config_object* conf;
+    REQUIRE(0 == contacts_init(&conf, ed_sk.data(), NULL, 0, NULL));
+    config_memory_usage cusage;
+    config_get_memory_usage(conf, &cusage);
+    CHECK(cusage.data == 0);
+    CHECK(cusage.keys >= 32);
+    CHECK(cusage.total == cusage.data + cusage.diffs + cusage.pending + cusage.hashes +
+                                  cusage.keys + cusage.other);
+    config_free(conf);
+}
+
 TEST_CASE("needs_dump bug", "[config][needs_dump]") {
 
     const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
@@ -482,3 +617,217 @@ TEST_CASE("needs_dump bug", "[config][needs_dump]") {
     contacts.set(c);
     CHECK(contacts.needs_dump());
 }
+
+TEST_CASE("merge skips already-merged messages", "[config][merge][seen]") {
+    const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
+
+    session::config::Contacts c1{ustring_view{seed}, std::nullopt};
+    c1.set_name("050000000000000000000000000000000000000000000000000000000000000000"sv, "alfonso");
+    auto [seqno, data, obs] = c1.push();
+    c1.confirm_pushed(seqno, "fakehash1");
+
+    c1.set_name("051111111111111111111111111111111111111111111111111111111111111111"sv, "barney");
+    auto [seqno2, data2, obs2] = c1.push();
+    c1.confirm_pushed(seqno2, "fakehash2");
+
+    session::config::Contacts c2{ustring_view{seed}, std::nullopt};
+    using merge_list = std::vector<std::pair<std::string, ustring_view>>;
+    CHECK(c2.merge(merge_list{{"fakehash1", data}}) == std::vector{{"fakehash1"s}});
+    CHECK(c2.size() == 1);
+
+    // Garbage data for a hash we have already merged is never even decrypted, but still reported
+    // as accepted, just as the real message would be:
+    auto garbage = "not a config message"_bytes;
+    CHECK(c2.merge(merge_list{{"fakehash1", garbage}}) == std::vector{{"fakehash1"s}});
+    CHECK(c2.merge(merge_list{{"fakehash3", garbage}}).empty());
+
+    // A mix of known and new messages comes back in input order, with the stale one obsoleted:
+    CHECK(c2.merge(merge_list{
+                  {"fakehash3", garbage}, {"fakehash1", garbage}, {"fakehash2", data2}}) ==
+          std::vector{{"fakehash1"s, "fakehash2"s}});
+    CHECK(c2.size() == 2);
+    CHECK(c2.current_hashes() == std::vector{{"fakehash2"s}});
+    CHECK_FALSE(c2.needs_push());
+
+    // The set of known hashes survives a dump:
+    session::config::Contacts c3{ustring_view{seed}, c2.dump()};
+    CHECK(c3.merge(merge_list{{"fakehash1", garbage}, {"fakehash2", garbage}}) ==
+          std::vector{{"fakehash1"s, "fakehash2"s}});
+    CHECK(c3.size() == 2);
+}
+
+TEST_CASE("delta config messages", "[config][merge][delta]") {
+    const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
+    using merge_list = std::vector<std::pair<std::string, ustring_view>>;
+    auto sid = [](int i) { return "05" + std::string(60, '0') + std::to_string(1000 + i); };
+
+    session::config::Contacts c1{ustring_view{seed}, std::nullopt};
+    c1.set_delta_snapshot_interval(3);
+    for (int i = 0; i < 100; i++)
+        c1.set_name(sid(i), "Contact number " + std::to_string(i));
+    auto [seqno1, data1, obs1] = c1.push();
+    c1.confirm_pushed(seqno1, "fakehash1");
+
+    session::config::Contacts c2{ustring_view{seed}, std::nullopt};
+    session::config::Contacts c3{ustring_view{seed}, std::nullopt};
+    CHECK(c2.merge(merge_list{{"fakehash1", data1}}) == std::vector{{"fakehash1"s}});
+    CHECK(c3.merge(merge_list{{"fakehash1", data1}}) == std::vector{{"fakehash1"s}});
+
+    // A small change on top of a pushed message is pushed as a (much smaller) delta, which doesn't
+    // obsolete the message it is based on:
+    c1.set_name(sid(5), "Renamed");
+    auto [seqno2, data2, obs2] = c1.push();
+    CHECK(seqno2 == seqno1 + 1);
+    CHECK(data2.size() < data1.size());
+    CHECK(obs2.empty());
+    c1.confirm_pushed(seqno2, "fakehash2");
+    CHECK(c1.current_hashes() == std::vector{{"fakehash1"s, "fakehash2"s}});
+
+    CHECK(c2.merge(merge_list{{"fakehash2", data2}}) == std::vector{{"fakehash2"s}});
+    CHECK_FALSE(c2.needs_full_message());
+    CHECK_FALSE(c2.needs_push());
+    CHECK(c2.get(sid(5))->name == "Renamed");
+    CHECK(c2.size() == 100);
+    CHECK(c2.current_hashes() == std::vector{{"fakehash1"s, "fakehash2"s}});
+
+    // A new client needs the whole chain:
+    session::config::Contacts c4{ustring_view{seed}, std::nullopt};
+    CHECK(c4.merge(merge_list{{"fakehash2", data2}, {"fakehash1", data1}}) ==
+          std::vector{{"fakehash2"s, "fakehash1"s}});
+    CHECK(c4.get(sid(5))->name == "Renamed");
+    CHECK(c4.current_hashes() == std::vector{{"fakehash1"s, "fakehash2"s}});
+
+    // A client with local changes doesn't have the delta's base, so can't apply it:
+    c3.set_name(sid(6), "Local change");
+    CHECK(c3.merge(merge_list{{"fakehash2", data2}}).empty());
+    CHECK(c3.needs_full_message());
+    CHECK(c3.get(sid(5))->name == "Contact number 5");
+
+    // ... until it re-fetches everything, which includes the (already merged) base of the delta:
+    CHECK(c3.merge(merge_list{{"fakehash1", data1}, {"fakehash2", data2}}) ==
+          std::vector{{"fakehash1"s, "fakehash2"s}});
+    CHECK_FALSE(c3.needs_full_message());
+    CHECK(c3.get(sid(5))->name == "Renamed");
+    CHECK(c3.get(sid(6))->name == "Local change");
+    CHECK(c3.needs_push());
+
+    // Merging the same messages again skips them, and doesn't need anything more:
+    CHECK(c3.merge(merge_list{{"fakehash1", data1}, {"fakehash2", data2}}) ==
+          std::vector{{"fakehash1"s, "fakehash2"s}});
+    CHECK_FALSE(c3.needs_full_message());
+
+    // The already-merged base also gets used if it arrives in the same batch as the delta:
+    session::config::Contacts c6{ustring_view{seed}, std::nullopt};
+    CHECK(c6.merge(merge_list{{"fakehash1", data1}}) == std::vector{{"fakehash1"s}});
+    c6.set_name(sid(6), "Local change");
+    CHECK(c6.merge(merge_list{{"fakehash1", data1}, {"fakehash2", data2}}) ==
+          std::vector{{"fakehash1"s, "fakehash2"s}});
+    CHECK_FALSE(c6.needs_full_message());
+    CHECK(c6.get(sid(5))->name == "Renamed");
+    CHECK(c6.get(sid(6))->name == "Local change");
+
+    // The chain survives a dump:
+    session::config::Contacts c5{ustring_view{seed}, c2.dump()};
+    CHECK(c5.current_hashes() == std::vector{{"fakehash1"s, "fakehash2"s}});
+
+    c1.set_name(sid(7), "Renamed again");
+    auto [seqno3, data3, obs3] = c1.push();
+    CHECK(data3.size() < data1.size());
+    CHECK(obs3.empty());
+    c1.confirm_pushed(seqno3, "fakehash3");
+    CHECK(c5.merge(merge_list{{"fakehash3", data3}}) == std::vector{{"fakehash3"s}});
+    CHECK(c5.get(sid(7))->name == "Renamed again");
+    CHECK(c5.current_hashes() == std::vector{{"fakehash1"s, "fakehash2"s, "fakehash3"s}});
+
+    // That's as long as the chain can get, so the next push is a full message that obsoletes it:
+    c1.set_name(sid(8), "Full again");
+    auto [seqno4, data4, obs4] = c1.push();
+    CHECK(data4.size() > data3.size());
+    std::sort(obs4.begin(), obs4.end());
+    CHECK(obs4 == std::vector{{"fakehash1"s, "fakehash2"s, "fakehash3"s}});
+    c1.confirm_pushed(seqno4, "fakehash4");
+    CHECK(c1.current_hashes() == std::vector{{"fakehash4"s}});
+
+    CHECK(c5.merge(merge_list{{"fakehash4", data4}}) == std::vector{{"fakehash4"s}});
+    CHECK(c5.get(sid(8))->name == "Full again");
+    CHECK(c5.current_hashes() == std::vector{{"fakehash4"s}});
+}
+
+TEST_CASE("lagged diff budget", "[config][lag]") {
+    const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
+    const auto sid = "050000000000000000000000000000000000000000000000000000000000000000"sv;
+
+    session::config::Contacts c1{ustring_view{seed}, std::nullopt};
+    session::config::Contacts c2{ustring_view{seed}, std::nullopt};
+    c2.set_lagged_diff_budget(1);
+    CHECK(c1.last_push_size().serialized == 0);
+
+    std::vector<std::pair<std::string, ustring>> pushed;
+    for (int i = 0; i < 5; i++) {
+        auto name = "name " + std::to_string(i);
+        c1.set_name(sid, name);
+        c2.set_name(sid, name);
+        auto [seqno1, data1, obs1] = c1.push();
+        auto [seqno2, data2, obs2] = c2.push();
+        c1.confirm_pushed(seqno1, "hash1-" + std::to_string(i));
+        c2.confirm_pushed(seqno2, "hash2-" + std::to_string(i));
+        pushed.emplace_back("hash2-" + std::to_string(i), std::move(data2));
+        CHECK(c1.last_push_size().pushed == data1.size());
+    }
+
+    // Repeatedly changing the same value collapses down to just the latest change:
+    CHECK(c1.last_push_size().lagged_diffs > 0);
+    CHECK(c1.last_push_size().lagged_diffs < c1.last_push_size().serialized);
+    CHECK(c2.last_push_size().lagged_diffs < c1.last_push_size().lagged_diffs);
+    CHECK(c2.last_push_size().serialized < c1.last_push_size().serialized);
+
+    // Other clients load the collapsed messages normally:
+    session::config::Contacts c3{ustring_view{seed}, std::nullopt};
+    CHECK(c3.merge(pushed).size() == 5);
+    CHECK(c3.get(sid)->name == "name 4");
+    CHECK_FALSE(c3.needs_push());
+}
+
+TEST_CASE("lagged diff budget with delta messages", "[config][lag][delta]") {
+    const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
+    using merge_list = std::vector<std::pair<std::string, ustring_view>>;
+    auto sid = [](int i) { return "05" + std::string(60, '0') + std::to_string(1000 + i); };
+
+    session::config::Contacts c1{ustring_view{seed}, std::nullopt};
+    c1.set_delta_snapshot_interval(3);
+    c1.set_lagged_diff_budget(1);
+    for (int i = 0; i < 100; i++)
+        c1.set_name(sid(i), "Contact number " + std::to_string(i));
+    auto [seqno1, data1, obs1] = c1.push();
+    c1.confirm_pushed(seqno1, "fakehash1");
+
+    session::config::Contacts c2{ustring_view{seed}, std::nullopt};
+    CHECK(c2.merge(merge_list{{"fakehash1", data1}}) == std::vector{{"fakehash1"s}});
+
+    // Nothing to collapse yet, so this is still pushed as a delta:
+    c1.set_name(sid(5), "Renamed");
+    auto [seqno2, data2, obs2] = c1.push();
+    CHECK(data2.size() < data1.size());
+    CHECK(obs2.empty());
+    c1.confirm_pushed(seqno2, "fakehash2");
+    CHECK(c2.merge(merge_list{{"fakehash2", data2}}) == std::vector{{"fakehash2"s}});
+    CHECK_FALSE(c2.needs_full_message());
+    CHECK(c2.get(sid(5))->name == "Renamed");
+
+    // Changing the same value again collapses the older change out of the lagged diffs, which the
+    // recipient of a delta couldn't reproduce, so this gets pushed as a full message:
+    c1.set_name(sid(5), "Renamed again");
+    auto [seqno3, data3, obs3] = c1.push();
+    CHECK(data3.size() > data2.size());
+    std::sort(obs3.begin(), obs3.end());
+    CHECK(obs3 == std::vector{{"fakehash1"s, "fakehash2"s}});
+    c1.confirm_pushed(seqno3, "fakehash3");
+    CHECK(c1.current_hashes() == std::vector{{"fakehash3"s}});
+
+    CHECK(c2.merge(merge_list{{"fakehash3", data3}}) == std::vector{{"fakehash3"s}});
+    CHECK_FALSE(c2.needs_full_message());
+    CHECK_FALSE(c2.needs_push());
+    CHECK(c2.get(sid(5))->name == "Renamed again");
+    CHECK(c2.size() == 100);
+    CHECK(c2.current_hashes() == std::vector{{"fakehash3"s}});
+}
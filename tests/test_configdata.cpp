@@ -957,6 +957,104 @@ TEST_CASE("config message example 3 - simple conflict", "[config][example][confl
     CHECK(printable(m_alt4.serialize()) == printable(m.serialize()));
 }
 
+TEST_CASE("config message deltas", "[config][delta]") {
+    MutableConfigMessage m124{m123_expected};
+    updates_124(m124);
+    REQUIRE(m124.delta_base());
+    CHECK(m124.delta_base()->first == 123);
+    CHECK(view_hex(m124.delta_base()->second) == to_hex(h123));
+
+    ustring delta;
+    m124.serialize_delta([&](ustring_view d) { delta = d; });
+    auto full = m124.serialize();
+    CHECK(config::is_delta_message(delta));
+    CHECK_FALSE(config::is_delta_message(full));
+    CHECK(delta.size() < full.size());
+
+    // A delta can't be loaded without its base:
+    CHECK_THROWS_AS(ConfigMessage{delta}, config::missing_delta_base);
+
+    // With its base, it reproduces the full message exactly:
+    ConfigMessage m{{m123_expected, delta}};
+    CHECK_FALSE(m.merged());
+    CHECK(m.unmerged_index() == 1);
+    CHECK(m.delta_chain() == std::vector<int>{0});
+    CHECK(view_hex(m.hash()) == to_hex(h124));
+    CHECK(printable(m.serialize()) == printable(full));
+
+    // Deltas can be based on other deltas, in any order:
+    auto m125 = m124.increment();
+    m125.data()["int1"] = 5;
+    d(m125.data()["dictB"]).erase("foo");
+    ustring delta2;
+    m125.serialize_delta([&](ustring_view d) { delta2 = d; });
+    ConfigMessage m2{{delta2, m123_expected, delta}};
+    CHECK(m2.unmerged_index() == 0);
+    CHECK(m2.delta_chain() == std::vector<int>{1, 2});
+    CHECK(printable(m2.serialize()) == printable(m125.serialize()));
+
+    // A delta whose base isn't available gets passed to the error handler and skipped:
+    std::vector<size_t> missing;
+    ConfigMessage m3{
+            {m123_expected, delta2},
+            nullptr,
+            nullptr,
+            ConfigMessage::DEFAULT_DIFF_LAGS,
+            [&](size_t i, const config::config_error& e) {
+                CHECK(dynamic_cast<const config::missing_delta_base*>(&e));
+                missing.push_back(i);
+            }};
+    CHECK(missing == std::vector<size_t>{1});
+    CHECK(m3.seqno() == 123);
+
+    // Merged messages aren't increments of anything, so can't be sent as deltas:
+    MutableConfigMessage merged{{m125.serialize(), m124.increment().serialize()}};
+    CHECK(merged.merged());
+    CHECK_FALSE(merged.delta_base());
+    CHECK_THROWS_AS(merged.serialize_delta([](ustring_view) {}), std::logic_error);
+}
+
+TEST_CASE("config message lagged diff collapsing", "[config][lag]") {
+    MutableConfigMessage m124{m123_expected};
+    updates_124(m124);
+    auto m125 = m124.increment();
+    m125.data()["int1"] = 1;
+    m125.data()["string2"] = "a";
+    auto m126 = m125.increment();
+    m126.data()["int1"] = 2;
+    d(m126.data()["dictB"])["changed"] = 2;
+    auto m127 = m126.increment();
+    m127.data()["int1"] = 3;
+    m127.data()["string2"] = "b";
+
+    auto collapsed = m127;
+    auto before = collapsed.lagged_diffs_bytes();
+    auto saved = collapsed.collapse_lagged_diffs();
+    CHECK(saved > 0);
+    CHECK(collapsed.lagged_diffs_bytes() == before - saved);
+    CHECK(collapsed.serialize().size() == m127.serialize().size() - saved);
+    CHECK(collapsed.data() == m127.data());
+
+    // Collapsing again doesn't find anything else to remove:
+    CHECK(collapsed.collapse_lagged_diffs() == 0);
+
+    // The collapsed message still includes the messages it was built from:
+    ConfigMessage r{{m125.serialize(), collapsed.serialize()}};
+    CHECK_FALSE(r.merged());
+    CHECK(r.unmerged_index() == 1);
+
+    // And merges with a conflicting message just as it would have without collapsing:
+    auto alt = m125.increment();
+    alt.data()["int1"] = 99;
+    alt.data()["string3"] = "conflict";
+    d(alt.data()["dictB"])["changed"] = 3;
+    ConfigMessage a{{m127.serialize(), alt.serialize()}};
+    ConfigMessage b{{collapsed.serialize(), alt.serialize()}};
+    CHECK(a.merged());
+    CHECK(b.merged());
+    CHECK(a.data() == b.data());
+}
+
 TEST_CASE("config message example 4 - complex conflict resolution", "[config][example][conflict]") {
     /// This is the "Complex conflict resolution" example described in
     /// docs/config-merge-logic.md
@@ -1,5 +1,6 @@
 #include <oxenc/hex.h>
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <session/util.hpp>
 
@@ -86,3 +87,136 @@ TEST_CASE("Ed25519", "[ed25519][signature]") {
     CHECK_THROWS(session::ed25519::verify(ed_invalid, ed_pk, to_unsigned_sv("hello")));
     CHECK_THROWS(session::ed25519::verify(ed_pk, ed_invalid, to_unsigned_sv("hello")));
 }
+
+namespace {
+
+struct signed_batch {
+    std::vector<ustring> sigs, pubkeys, msgs;
+    std::vector<ustring_view> sig_views, pubkey_views, msg_views;
+
+    // Generates `n` signatures over random-ish messages, cycling through `n_keys` signing keys.
+    signed_batch(size_t n, size_t n_keys) {
+        std::vector<std::pair<std::array<unsigned char, 32>, std::array<unsigned char, 64>>> keys;
+        for (size_t i = 0; i < n_keys; i++)
+            keys.push_back(session::ed25519::ed25519_key_pair());
+        for (size_t i = 0; i < n; i++) {
+            auto& [pk, sk] = keys[i % n_keys];
+            auto& msg = msgs.emplace_back(
+                    to_usv("message #" + std::to_string(i) + std::string(i % 50, 'x')));
+            sigs.push_back(session::ed25519::sign(to_usv(sk), msg));
+            pubkeys.emplace_back(pk.data(), pk.size());
+        }
+        update_views();
+    }
+
+    void update_views() {
+        sig_views.assign(sigs.begin(), sigs.end());
+        pubkey_views.assign(pubkeys.begin(), pubkeys.end());
+        msg_views.assign(msgs.begin(), msgs.end());
+    }
+
+    std::vector<size_t> verify_batch() const {
+        return session::ed25519::verify_batch(sig_views, pubkey_views, msg_views);
+    }
+
+    std::vector<size_t> verify_each() const {
+        std::vector<size_t> failed;
+        for (size_t i = 0; i < sigs.size(); i++)
+            if (!session::ed25519::verify(sig_views[i], pubkey_views[i], msg_views[i]))
+                failed.push_back(i);
+        return failed;
+    }
+};
+
+}  // namespace
+
+TEST_CASE("Ed25519 batch verification", "[ed25519][verify_batch]") {
+    using namespace session;
+
+    for (size_t n : {0, 1, 3, 4, 17, 64}) {
+        for (size_t n_keys : {1, 3, 64}) {
+            signed_batch b{n, std::min(n_keys, std::max<size_t>(n, 1))};
+            CHECK(b.verify_batch().empty());
+        }
+    }
+
+    signed_batch b{40, 5};
+    b.sigs[3][10] ^= 0x01;          // Corrupt R
+    b.sigs[17][40] ^= 0x20;         // Corrupt s
+    b.msgs[21][0] ^= 0x01;          // Wrong message
+    b.pubkeys[30] = b.pubkeys[31];  // Wrong (but valid) pubkey
+    b.sigs[39].pop_back();          // Wrong size
+    b.update_views();
+    std::vector<size_t> expected{3, 17, 21, 30, 39};
+    CHECK(b.verify_batch() == expected);
+
+    // Should agree with individual verification (once we replace the wrong-size sig, which
+    // `verify` would throw on, with a valid-sized but wrong one):
+    b.sigs[39] = b.sigs[38];
+    b.update_views();
+    CHECK(b.verify_batch() == expected);
+    CHECK(b.verify_each() == expected);
+
+    // Non-canonical s (s + L) verifies mathematically but is rejected by libsodium, and must
+    // be rejected by the batch verification as well.
+    signed_batch c{8, 2};
+    const unsigned char L[32] = {0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7,
+                                 0xa2, 0xde, 0xf9, 0xde, 0x14, 0,    0,    0,    0,    0,    0,
+                                 0,    0,    0,    0,    0,    0,    0,    0,    0,    0x10};
+    unsigned int carry = 0;
+    for (size_t i = 0; i < 32; i++) {
+        carry += c.sigs[5][32 + i] + L[i];
+        c.sigs[5][32 + i] = carry & 0xff;
+        carry >>= 8;
+    }
+    // A small order pubkey (the identity) with a signature that trivially satisfies the equation
+    c.pubkeys[6] = "0100000000000000000000000000000000000000000000000000000000000000"_hexbytes;
+    c.sigs[6] = c.pubkeys[6] + ustring(32, 0);
+    c.update_views();
+    CHECK(c.verify_batch() == std::vector<size_t>{5, 6});
+    CHECK(c.verify_each() == std::vector<size_t>{5, 6});
+
+    CHECK_THROWS_AS(
+            ed25519::verify_batch(b.sig_views, b.pubkey_views, c.msg_views),
+            std::invalid_argument);
+}
+
+TEST_CASE("Ed25519 batch verification (C API)", "[ed25519][verify_batch]") {
+    signed_batch b{10, 2};
+    b.msgs[4][0] ^= 0x01;
+    b.update_views();
+
+    std::vector<const unsigned char*> sigs, pubkeys, msgs;
+    std::vector<size_t> lens;
+    for (size_t i = 0; i < 10; i++) {
+        sigs.push_back(b.sigs[i].data());
+        pubkeys.push_back(b.pubkeys[i].data());
+        msgs.push_back(b.msgs[i].data());
+        lens.push_back(b.msgs[i].size());
+    }
+    bool valid[10];
+    CHECK(session_ed25519_verify_batch(
+                  sigs.data(), pubkeys.data(), msgs.data(), lens.data(), 10, valid) == 1);
+    for (size_t i = 0; i < 10; i++)
+        CHECK(valid[i] == (i != 4));
+    CHECK(session_ed25519_verify_batch(
+                  sigs.data(), pubkeys.data(), msgs.data(), lens.data(), 4, nullptr) == 0);
+}
+
+TEST_CASE("Ed25519 batch verification benchmark", "[ed25519][verify_batch][!benchmark]") {
+    for (size_t n : {16, 64, 256}) {
+        signed_batch b{n, n};
+        signed_batch same_key{n, 1};
+        auto N = std::to_string(n);
+
+        BENCHMARK("verify x" + N) {
+            return b.verify_each();
+        };
+        BENCHMARK("verify_batch x" + N) {
+            return b.verify_batch();
+        };
+        BENCHMARK("verify_batch x" + N + " (one pubkey)") {
+            return same_key.verify_batch();
+        };
+    }
+}
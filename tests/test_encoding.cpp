@@ -0,0 +1,131 @@
+#include <oxenc/base64.h>
+#include <oxenc/hex.h>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cctype>
+#include <cstring>
+
+#include "session/encoding.hpp"
+#include "session/random.hpp"
+#include "utils.hpp"
+
+using namespace session;
+
+TEST_CASE("Hex encoding", "[encoding][hex]") {
+    CHECK(encoding::to_hex(""_hexbytes) == "");
+    CHECK(encoding::to_hex("00ff10a9"_hexbytes) == "00ff10a9");
+    CHECK(encoding::from_hex("00FF10a9") == "00ff10a9"_hexbytes);
+    CHECK(encoding::is_hex(""));
+    CHECK(encoding::is_hex("0123456789abcdefABCDEF"));
+    CHECK_FALSE(encoding::is_hex("abc"));
+    CHECK_FALSE(encoding::is_hex("0g"));
+    CHECK_THROWS_AS(encoding::from_hex("abc"), std::invalid_argument);
+    CHECK_THROWS_AS(encoding::from_hex("zz"), std::invalid_argument);
+    CHECK(encoding::to_prefixed_hex(0x05, ""_hexbytes) == "05");
+    auto x_pk = "d2ad010eeb72d72e561d9de7bd7b6989af77dcabffa03a5111a6c859ae5c3a72"_hexbytes;
+    CHECK(encoding::to_prefixed_hex(0x05, x_pk) ==
+          "05d2ad010eeb72d72e561d9de7bd7b6989af77dcabffa03a5111a6c859ae5c3a72");
+    CHECK(encoding::to_prefixed_hex(0xa3, "00ff10a9"_hexbytes) == "a300ff10a9");
+
+    // Lengths here cover the scalar code and each SIMD block size, with and without a tail:
+    for (size_t len = 0; len < 140; len++) {
+        auto data = random::random(len);
+        auto hex = encoding::to_hex(data);
+        REQUIRE(hex == oxenc::to_hex(data.begin(), data.end()));
+        REQUIRE(encoding::is_hex(hex));
+        REQUIRE(encoding::from_hex(hex) == data);
+        std::string upper = hex;
+        for (auto& c : upper)
+            c = std::toupper(c);
+        REQUIRE(encoding::from_hex(upper) == data);
+
+        if (len == 0)
+            continue;
+        // An invalid character anywhere must be detected:
+        ustring out(len, 0);
+        for (size_t i : {size_t{0}, hex.size() / 3, hex.size() - 1}) {
+            for (char bad : {'g', 'G', '/', ':', '@', '`', ' ', '\0', '\x80', '\xb0', '\xe1'}) {
+                auto h = hex;
+                h[i] = bad;
+                CHECK_FALSE(encoding::is_hex(h));
+                CHECK_FALSE(encoding::from_hex(h, out.data()));
+            }
+        }
+    }
+}
+
+TEST_CASE("Base64 encoding", "[encoding][base64]") {
+    CHECK(encoding::to_base64(to_usv("")) == "");
+    CHECK(encoding::to_base64(to_usv("f")) == "Zg==");
+    CHECK(encoding::to_base64(to_usv("fo")) == "Zm8=");
+    CHECK(encoding::to_base64(to_usv("foo")) == "Zm9v");
+    CHECK(encoding::to_base64(to_usv("foobar")) == "Zm9vYmFy");
+    CHECK(encoding::from_base64("Zm9vYg==") == to_usv("foob"));
+    CHECK(encoding::from_base64("Zm9vYg") == to_usv("foob"));
+    CHECK(encoding::from_base64("Zm9vYmE=") == to_usv("fooba"));
+    CHECK(encoding::from_base64("Zm9vYmE") == to_usv("fooba"));
+    CHECK(encoding::base64_encoded_size(32) == 44);
+    CHECK(encoding::base64_decoded_size("Zm9vYmE=") == 5);
+    CHECK(encoding::base64_decoded_size("Zm9vYmE") == 5);
+    CHECK_THROWS_AS(encoding::from_base64("Z"), std::invalid_argument);
+    CHECK_THROWS_AS(encoding::from_base64("Zm9=="), std::invalid_argument);
+    CHECK_THROWS_AS(encoding::from_base64("Zm9vY==="), std::invalid_argument);
+    CHECK_THROWS_AS(encoding::from_base64("Zm9v Yg=="), std::invalid_argument);
+
+    for (size_t len = 0; len < 140; len++) {
+        auto data = random::random(len);
+        auto b64 = encoding::to_base64(data);
+        REQUIRE(b64 == oxenc::to_base64(data.begin(), data.end()));
+        REQUIRE(encoding::is_base64(b64));
+        REQUIRE(encoding::from_base64(b64) == data);
+        auto unpadded = b64;
+        while (!unpadded.empty() && unpadded.back() == '=')
+            unpadded.pop_back();
+        REQUIRE(encoding::from_base64(unpadded) == data);
+
+        if (len == 0)
+            continue;
+        ustring out(len, 0);
+        for (size_t i : {size_t{0}, unpadded.size() / 2, unpadded.size() - 1}) {
+            for (char bad : {'-', '_', '.', ':', '@', '[', '`', '{', ' ', '\0', '\x80', '\xfb'}) {
+                auto b = unpadded;
+                b[i] = bad;
+                CHECK_FALSE(encoding::is_base64(b));
+                CHECK_FALSE(encoding::from_base64(b, out.data()));
+            }
+        }
+    }
+}
+
+TEST_CASE("Encoding benchmarks", "[encoding][!benchmark]") {
+    auto session_id = "05"_hexbytes + random::random(32);
+    auto hex = encoding::to_hex(session_id);
+    auto sig = random::random(64);
+    auto sig_b64 = encoding::to_base64(sig);
+
+    BENCHMARK("oxenc::to_hex (session id)") {
+        return oxenc::to_hex(session_id.begin(), session_id.end());
+    };
+    BENCHMARK("encoding::to_hex (session id)") {
+        return encoding::to_hex(session_id);
+    };
+    BENCHMARK("oxenc::from_hex (session id)") {
+        return oxenc::is_hex(hex) ? oxenc::from_hex(hex) : "";
+    };
+    BENCHMARK("encoding::from_hex (session id)") {
+        return encoding::from_hex(hex);
+    };
+    BENCHMARK("oxenc::to_base64 (signature)") {
+        return oxenc::to_base64(sig.begin(), sig.end());
+    };
+    BENCHMARK("encoding::to_base64 (signature)") {
+        return encoding::to_base64(sig);
+    };
+    BENCHMARK("oxenc::from_base64 (signature)") {
+        return oxenc::is_base64(sig_b64) ? oxenc::from_base64(sig_b64) : "";
+    };
+    BENCHMARK("encoding::from_base64 (signature)") {
+        return encoding::from_base64(sig_b64);
+    };
+}
@@ -43,6 +43,67 @@ TEST_CASE("config message encryption", "[config][encrypt]") {
     CHECK_THROWS_AS(config::decrypt(enc1, key1, "test-suite1"), config::decrypt_error);
 }
 
+TEST_CASE("config message batch decryption", "[config][encrypt]") {
+    auto key1 = "abcdef0123456789abcdef0123456789abcdef0123456789abcdef0123456789"_hexbytes;
+    auto key2 = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"_hexbytes;
+
+    std::vector<ustring> plain, enc;
+    for (int i = 0; i < 9; i++) {
+        plain.emplace_back(to_usv("message " + std::string(i * 30, 'x')));
+        enc.push_back(config::encrypt(plain.back(), i == 4 ? key2 : key1, "test-suite1"));
+    }
+    enc[6][10] ^= 0x01;
+    enc.push_back("short"_bytes);
+    enc.push_back(config::encrypt(""_bytes, key1, "test-suite1"));
+
+    std::vector<ustring_view> views{enc.begin(), enc.end()};
+    auto dec = config::decrypt_multi(views, key1, "test-suite1");
+    REQUIRE(dec.size() == enc.size());
+    for (size_t i = 0; i < 9; i++) {
+        if (i == 4 || i == 6)
+            CHECK_FALSE(dec[i]);
+        else {
+            REQUIRE(dec[i]);
+            CHECK(*dec[i] == plain[i]);
+        }
+    }
+    CHECK_FALSE(dec[9]);
+    REQUIRE(dec[10]);
+    CHECK(dec[10]->empty());
+
+    auto dec2 = config::decrypt_multi(views, key2, "test-suite1");
+    REQUIRE(dec2[4]);
+    CHECK(*dec2[4] == plain[4]);
+    CHECK_FALSE(dec2[0]);
+
+    CHECK_THROWS_AS(
+            config::decrypt_multi(views, key1.substr(1), "test-suite1"), std::invalid_argument);
+    CHECK(config::decrypt_multi({}, key1, "test-suite1").empty());
+}
+
+TEST_CASE("config message padded encryption", "[config][encrypt][padding]") {
+    auto key = "abcdef0123456789abcdef0123456789abcdef0123456789abcdef0123456789"_hexbytes;
+
+    for (size_t len : {0, 1, 215, 216, 217, 1000, 5000, 20000, 50000}) {
+        ustring data(len, 'x');
+        for (size_t i = 0; i < len; i++)
+            data[i] = static_cast<unsigned char>(i * 7);
+
+        ustring expected = data;
+        config::pad_message(expected);
+        config::encrypt_inplace(expected, key, "test-suite1");
+
+        auto enc = config::encrypt_padded(data, key, "test-suite1");
+        CHECK(enc.size() == config::padded_size(len) + config::ENCRYPT_DATA_OVERHEAD);
+        CHECK(to_hex(enc) == to_hex(expected));
+
+        auto dec = config::decrypt(enc, key, "test-suite1");
+        CHECK(dec.substr(dec.size() - len) == data);
+    }
+
+    CHECK_THROWS_AS(config::encrypt_padded("abc"_bytes, key.substr(1), "x"), std::invalid_argument);
+}
+
 TEST_CASE("config message padding", "[config][padding]") {
     static_assert(config::padded_size(1, 0) == 256);
     static_assert(config::padded_size(1, 10) == 256 - 10);
@@ -8,6 +8,8 @@
 #include <sodium/crypto_sign_ed25519.h>
 
 #include <algorithm>
+#include <atomic>
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators_range.hpp>
 #include <catch2/matchers/catch_matchers.hpp>
@@ -17,6 +19,7 @@
 #include <session/config/groups/members.hpp>
 #include <session/config/user_groups.hpp>
 #include <string_view>
+#include <thread>
 
 #include "utils.hpp"
 
@@ -880,6 +883,87 @@ TEST_CASE("Group Keys - swarm authentication", "[config][groups][keys][swarm]")
     CHECK(session::config::groups::Keys::swarm_verify_subaccount(
             member.info.id, to_usv(member.secret_key), auth_data));
 
+    // A reusable signer should give identical results, both singly and in batches:
+    auto signer = member.keys.swarm_subaccount_signer(auth_data);
+    auto subauth_b64_2 = signer.sign(to_sign);
+    CHECK(subauth_b64_2.subaccount == subauth_b64.subaccount);
+    CHECK(subauth_b64_2.subaccount_sig == subauth_b64.subaccount_sig);
+    CHECK(subauth_b64_2.signature == subauth_b64.signature);
+    CHECK(signer.subaccount() == subauth_b64.subaccount);
+    CHECK(signer.subaccount_sig(true) == subauth.subaccount_sig);
+
+    std::vector<std::string> reqs;
+    for (int i = 0; i < 11; i++)
+        reqs.push_back("retrieve" + std::to_string(i) + "1693340111" + std::string(i * 20, 'x'));
+    std::vector<ustring_view> req_views;
+    for (auto& r : reqs)
+        req_views.push_back(to_usv(r));
+    req_views.push_back(to_sign);
+    req_views.emplace_back();
+
+    auto multi = signer.sign_multi(req_views);
+    auto multi_bin = signer.sign_multi(req_views, true);
+    REQUIRE(multi.size() == req_views.size());
+    REQUIRE(multi_bin.size() == req_views.size());
+    for (size_t i = 0; i < req_views.size(); i++) {
+        auto single = member.keys.swarm_subaccount_sign(req_views[i], auth_data);
+        CHECK(multi[i].subaccount == single.subaccount);
+        CHECK(multi[i].subaccount_sig == single.subaccount_sig);
+        CHECK(multi[i].signature == single.signature);
+        CHECK(oxenc::to_base64(multi_bin[i].signature) == single.signature);
+        CHECK(0 == crypto_sign_ed25519_verify_detached(
+                           reinterpret_cast<const unsigned char*>(multi_bin[i].signature.data()),
+                           req_views[i].data(),
+                           req_views[i].size(),
+                           reinterpret_cast<const unsigned char*>(
+                                   multi_bin[i].subaccount.substr(4).data())));
+    }
+    CHECK(multi[11].signature == subauth_b64.signature);
+    CHECK(signer.sign_multi({}).empty());
+
+    // C API (wrapping the existing C++ object, which the C wrapper does not take ownership of):
+    config_group_keys ckeys{};
+    ckeys.internals = &member.keys;
+    auto* csigner = groups_keys_swarm_signer_new(&ckeys, auth_data.data());
+    REQUIRE(csigner);
+    std::vector<const unsigned char*> cmsgs;
+    std::vector<size_t> cmsg_lens;
+    for (auto& v : req_views) {
+        cmsgs.push_back(v.data());
+        cmsg_lens.push_back(v.size());
+    }
+    char c_subacc[49], c_subacc_sig[89];
+    std::vector<char> c_sigs(89 * cmsgs.size());
+    REQUIRE(groups_keys_swarm_signer_sign(
+            csigner,
+            cmsgs.data(),
+            cmsg_lens.data(),
+            cmsgs.size(),
+            c_subacc,
+            c_subacc_sig,
+            c_sigs.data()));
+    CHECK(c_subacc == subauth_b64.subaccount);
+    CHECK(c_subacc_sig == subauth_b64.subaccount_sig);
+    for (size_t i = 0; i < multi.size(); i++)
+        CHECK(std::string{c_sigs.data() + 89 * i} == multi[i].signature);
+
+    unsigned char cb_subacc[36], cb_subacc_sig[64];
+    std::vector<unsigned char> cb_sigs(64 * cmsgs.size());
+    REQUIRE(groups_keys_swarm_signer_sign_binary(
+            csigner,
+            cmsgs.data(),
+            cmsg_lens.data(),
+            cmsgs.size(),
+            cb_subacc,
+            cb_subacc_sig,
+            cb_sigs.data()));
+    CHECK(printable(cb_subacc, 36) == printable(subauth.subaccount));
+    for (size_t i = 0; i < multi_bin.size(); i++)
+        CHECK(printable(cb_sigs.data() + 64 * i, 64) == printable(multi_bin[i].signature));
+    groups_keys_swarm_signer_free(csigner);
+
+    CHECK_THROWS_AS(member.keys.swarm_subaccount_signer(auth_data.substr(1)), std::logic_error);
+
     // Try flipping a bit in each position of the auth data and make sure it fails to validate:
     for (int i = 0; i < auth_data.size(); i++) {
         for (int b = 0; b < 8; b++) {
@@ -984,3 +1068,569 @@ TEST_CASE("Group Keys promotion", "[config][groups][keys][promotion]") {
 
     CHECK(admin.info.get_name() == "new name");
 }
+
+namespace {
+
+// A set of members, each with subaccount access to a group, signing storage server requests.
+struct subaccount_requests {
+    std::vector<std::string> session_ids;
+    std::vector<ustring> auth_data;
+    std::vector<groups::Keys::swarm_auth> auths;
+    std::vector<std::string> msgs;
+    std::vector<groups::Keys::swarm_subaccount_request> requests;
+
+    subaccount_requests(
+            groups::Keys& admin_keys,
+            const std::vector<ustring>& member_seeds,
+            size_t per_member,
+            const std::vector<bool>& write) {
+        std::vector<std::array<unsigned char, 64>> sks;
+        for (size_t m = 0; m < member_seeds.size(); m++) {
+            auto& sk = sks.emplace_back(sk_from_seed(member_seeds[m]));
+            session_ids.push_back(session_id_from_ed({sk.data() + 32, 32}));
+            auth_data.push_back(admin_keys.swarm_make_subaccount(session_ids.back(), write[m]));
+        }
+        for (size_t i = 0; i < per_member; i++)
+            for (size_t m = 0; m < member_seeds.size(); m++)
+                msgs.push_back(
+                        "retrieve" + std::to_string(m) + std::to_string(1700000000000 + i));
+        for (size_t i = 0; i < msgs.size(); i++) {
+            size_t m = i % member_seeds.size();
+            groups::Keys::subaccount_signer signer{to_usv(sks[m]), auth_data[m]};
+            auths.push_back(signer.sign(to_usv(msgs[i]), true));
+        }
+        for (size_t i = 0; i < msgs.size(); i++)
+            requests.push_back(
+                    {to_usv(auths[i].subaccount),
+                     to_usv(auths[i].subaccount_sig),
+                     to_usv(msgs[i]),
+                     to_usv(auths[i].signature)});
+    }
+};
+
+}  // namespace
+
+TEST_CASE("Group Keys - bulk subaccount verification", "[config][groups][keys][swarm]") {
+
+    const ustring group_seed =
+            "0123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210"_hexbytes;
+    const ustring admin_seed =
+            "0123456789abcdef0123456789abcdeffedcba9876543210fedcba9876543210"_hexbytes;
+    const std::vector<ustring> member_seeds = {
+            "000111222333444555666777888999aaabbbcccdddeeefff0123456789abcdef"_hexbytes,
+            "00011122435111155566677788811263446552465222efff0123456789abcdef"_hexbytes,
+            "00011129824754185548239498168169316979583253efff0123456789abcdef"_hexbytes,
+    };
+
+    std::array<unsigned char, 32> group_pk;
+    std::array<unsigned char, 64> group_sk;
+    crypto_sign_ed25519_seed_keypair(group_pk.data(), group_sk.data(), group_seed.data());
+
+    pseudo_client admin{admin_seed, true, group_pk.data(), group_sk.data()};
+    const auto& group_id = admin.info.id;
+
+    // The last member gets read-only access:
+    subaccount_requests sr{admin.keys, member_seeds, 5, {true, true, false}};
+    auto& reqs = sr.requests;
+    REQUIRE(reqs.size() == 15);
+
+    using Keys = groups::Keys;
+
+    CHECK(Keys::swarm_verify_subaccount_requests(group_id, reqs) == std::vector<bool>(15, true));
+
+    auto with_write = Keys::swarm_verify_subaccount_requests(group_id, reqs, true);
+    for (size_t i = 0; i < reqs.size(); i++)
+        CHECK(with_write[i] == (i % 3 != 2));
+
+    CHECK(Keys::swarm_verify_subaccount_requests(group_id, reqs, false, true) ==
+          std::vector<bool>(15, false));
+
+    // Results should agree with individually verifying the token and request signatures:
+    for (auto& r : reqs) {
+        CHECK(0 == crypto_sign_ed25519_verify_detached(
+                           r.subaccount_sig.data(),
+                           r.subaccount.data(),
+                           r.subaccount.size(),
+                           group_pk.data()));
+        CHECK(0 == crypto_sign_ed25519_verify_detached(
+                           r.signature.data(),
+                           r.msg.data(),
+                           r.msg.size(),
+                           r.subaccount.data() + 4));
+    }
+
+    // Tampering with a request should only invalidate that request:
+    auto bad_reqs = reqs;
+    auto other_msg = "retrieve01700000000999"s;
+    bad_reqs[3].msg = to_usv(other_msg);
+    ustring bad_subacc_sig{reqs[7].subaccount_sig};
+    bad_subacc_sig[10] ^= 0x10;
+    bad_reqs[7].subaccount_sig = bad_subacc_sig;
+    ustring bad_subacc{reqs[8].subaccount};
+    bad_subacc[20] ^= 0x01;
+    bad_reqs[8].subaccount = bad_subacc;
+    ustring bad_flags{reqs[9].subaccount};
+    bad_flags[1] = 0;
+    bad_reqs[9].subaccount = bad_flags;
+    bad_reqs[10].signature = bad_reqs[10].signature.substr(1);
+    // Swapped signatures between two requests of the same member:
+    std::swap(bad_reqs[12].signature, bad_reqs[0].signature);
+
+    auto results = Keys::swarm_verify_subaccount_requests(group_id, bad_reqs);
+    for (size_t i = 0; i < bad_reqs.size(); i++) {
+        bool expect_bad = i == 0 || i == 3 || i == 7 || i == 8 || i == 9 || i == 10 || i == 12;
+        CHECK(results[i] == !expect_bad);
+    }
+
+    // A different group should accept nothing:
+    std::string other_group = "03" + std::string(63, '0') + "1";
+    auto other = Keys::swarm_verify_subaccount_requests(other_group, reqs);
+    CHECK(std::count(other.begin(), other.end(), true) == 0);
+    CHECK_THROWS(Keys::swarm_verify_subaccount_requests("05" + group_id.substr(2), reqs));
+
+    CHECK(Keys::swarm_verify_subaccount_requests(group_id, {}).empty());
+
+    // C API:
+    std::vector<const unsigned char*> subaccs, subacc_sigs, msgs, sigs;
+    std::vector<size_t> msg_lens;
+    for (auto& r : bad_reqs) {
+        subaccs.push_back(r.subaccount.data());
+        subacc_sigs.push_back(r.subaccount_sig.data());
+        msgs.push_back(r.msg.data());
+        msg_lens.push_back(r.msg.size());
+        sigs.push_back(r.signature.data());
+    }
+    // The C API can't detect a short signature, so undo that bit of tampering:
+    sigs[10] = reqs[10].signature.data();
+    bool valid[15];
+    CHECK(groups_keys_swarm_verify_subaccount_requests(
+                  group_id.c_str(),
+                  subaccs.data(),
+                  subacc_sigs.data(),
+                  msgs.data(),
+                  msg_lens.data(),
+                  sigs.data(),
+                  subaccs.size(),
+                  false,
+                  false,
+                  valid) == 9);
+    for (size_t i = 0; i < bad_reqs.size(); i++)
+        CHECK(valid[i] == (i == 10 || results[i]));
+    CHECK(groups_keys_swarm_verify_subaccount_requests(
+                  "nope",
+                  subaccs.data(),
+                  subacc_sigs.data(),
+                  msgs.data(),
+                  msg_lens.data(),
+                  sigs.data(),
+                  subaccs.size(),
+                  false,
+                  false,
+                  valid) == 0);
+    CHECK(std::count(std::begin(valid), std::end(valid), true) == 0);
+}
+
+TEST_CASE(
+        "Group Keys - bulk subaccount verification benchmark",
+        "[config][groups][keys][!benchmark]") {
+
+    const ustring group_seed =
+            "0123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210"_hexbytes;
+    const ustring admin_seed =
+            "0123456789abcdef0123456789abcdeffedcba9876543210fedcba9876543210"_hexbytes;
+
+    std::array<unsigned char, 32> group_pk;
+    std::array<unsigned char, 64> group_sk;
+    crypto_sign_ed25519_seed_keypair(group_pk.data(), group_sk.data(), group_seed.data());
+
+    pseudo_client admin{admin_seed, true, group_pk.data(), group_sk.data()};
+
+    std::vector<ustring> member_seeds;
+    for (unsigned char m = 0; m < 8; m++)
+        member_seeds.emplace_back(32, m);
+
+    for (size_t per_member : {2, 8, 32}) {
+        subaccount_requests sr{admin.keys, member_seeds, per_member, std::vector<bool>(8, true)};
+        auto& reqs = sr.requests;
+
+        BENCHMARK("individual verification x" + std::to_string(reqs.size())) {
+            size_t good = 0;
+            for (auto& r : reqs)
+                if (0 == crypto_sign_ed25519_verify_detached(
+                                 r.subaccount_sig.data(),
+                                 r.subaccount.data(),
+                                 r.subaccount.size(),
+                                 group_pk.data()) &&
+                    0 == crypto_sign_ed25519_verify_detached(
+                                 r.signature.data(),
+                                 r.msg.data(),
+                                 r.msg.size(),
+                                 r.subaccount.data() + 4))
+                    good++;
+            return good;
+        };
+
+        BENCHMARK("bulk verification x" + std::to_string(reqs.size())) {
+            return groups::Keys::swarm_verify_subaccount_requests(admin.info.id, reqs);
+        };
+    }
+}
+
+TEST_CASE("Group Keys - bulk key message loading", "[config][groups][keys][bulk]") {
+    const ustring group_seed =
+            "0123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210"_hexbytes;
+    const ustring admin_seed =
+            "0123456789abcdef0123456789abcdeffedcba9876543210fedcba9876543210"_hexbytes;
+    const ustring member_seed =
+            "000111222333444555666777888999aaabbbcccdddeeefff0123456789abcdef"_hexbytes;
+
+    std::array<unsigned char, 32> group_pk;
+    std::array<unsigned char, 64> group_sk;
+    crypto_sign_ed25519_seed_keypair(group_pk.data(), group_sk.data(), group_seed.data());
+
+    pseudo_client admin{admin_seed, true, group_pk.data(), group_sk.data()};
+    pseudo_client seq{member_seed, false, group_pk.data(), std::nullopt};
+    pseudo_client bulk{member_seed, false, group_pk.data(), std::nullopt};
+
+    const auto now = get_timestamp_ms();
+    constexpr int64_t day = 24 * 60 * 60 * 1000;
+
+    // The admin's initial key (which the member can't read), then three more rekeys after adding
+    // the member.  The gap between the 2nd and 3rd is long enough that the 2nd expires.
+    std::vector<std::pair<ustring, int64_t>> key_msgs;
+    key_msgs.emplace_back(*admin.keys.pending_config(), now - 100 * day);
+    admin.keys.load_key_message(
+            "keyhash0", key_msgs.back().first, now - 100 * day, admin.info, admin.members);
+    {
+        auto m = admin.members.get_or_construct(seq.session_id);
+        m.name = "Member";
+        admin.members.set(m);
+    }
+    for (int64_t ago : {90, 80, 1}) {
+        key_msgs.emplace_back(admin.keys.rekey(admin.info, admin.members), now - ago * day);
+        admin.keys.load_key_message(
+                "keyhash" + std::to_string(key_msgs.size() - 1),
+                key_msgs.back().first,
+                key_msgs.back().second,
+                admin.info,
+                admin.members);
+    }
+
+    for (size_t i = 0; i < key_msgs.size(); i++)
+        seq.keys.load_key_message(
+                "keyhash" + std::to_string(i),
+                key_msgs[i].first,
+                key_msgs[i].second,
+                seq.info,
+                seq.members);
+
+    // A copy of the latest message with a broken signature:
+    ustring bad_msg = key_msgs.back().first;
+    bad_msg[bad_msg.size() - 2] ^= 0x01;
+
+    std::vector<std::string> hashes;
+    for (size_t i = 0; i < key_msgs.size(); i++)
+        hashes.push_back("keyhash" + std::to_string(i));
+    std::vector<groups::Keys::key_message> bulk_msgs;
+    bulk_msgs.push_back({"badhash", bad_msg, key_msgs.back().second});
+    for (size_t i : {2, 0, 3, 1})
+        bulk_msgs.push_back({hashes[i], key_msgs[i].first, key_msgs[i].second});
+    bulk_msgs.push_back({"junkhash", to_usv("d1:#i0ee"), now});
+
+    auto loaded = bulk.keys.load_key_messages(bulk_msgs, bulk.info, bulk.members);
+    std::sort(loaded.begin(), loaded.end());
+    CHECK(loaded == hashes);
+
+    CHECK(bulk.keys.size() == 2);
+    CHECK(bulk.keys.group_keys() == seq.keys.group_keys());
+    CHECK(bulk.keys.current_hashes() == seq.keys.current_hashes());
+    CHECK(bulk.keys.current_hashes() == std::unordered_set{{"keyhash2"s, "keyhash3"s}});
+    CHECK(bulk.keys.group_enc_key() == admin.keys.group_enc_key());
+
+    // The Info/Members key lists got updated, so the member can read the admin's configs:
+    auto [mseq, mdata, mobs] = admin.members.push();
+    admin.members.confirm_pushed(mseq, "memhash1");
+    CHECK(bulk.members.merge(std::vector<std::pair<std::string, ustring_view>>{
+                  {"memhash1", mdata}}) == std::vector{{"memhash1"s}});
+    CHECK(bulk.members.size() == 1);
+
+    // Loading the same messages again changes nothing:
+    CHECK(bulk.keys.load_key_messages(bulk_msgs, bulk.info, bulk.members).size() == 4);
+    CHECK(bulk.keys.group_keys() == seq.keys.group_keys());
+}
+
+TEST_CASE("Group Keys - memory usage", "[config][groups][keys][memory]") {
+
+    const ustring group_seed =
+            "0123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210"_hexbytes;
+    const ustring admin_seed =
+            "0123456789abcdef0123456789abcdeffedcba9876543210fedcba9876543210"_hexbytes;
+
+    std::array<unsigned char, 32> group_pk;
+    std::array<unsigned char, 64> group_sk;
+    crypto_sign_ed25519_seed_keypair(group_pk.data(), group_sk.data(), group_seed.data());
+
+    pseudo_client admin{admin_seed, true, group_pk.data(), group_sk.data()};
+
+    // The initial key config hasn't been confirmed yet:
+    auto usage = admin.keys.memory_usage();
+    CHECK(usage.pending == admin.keys.pending_config()->size());
+    CHECK(usage.keys >= 64 + 64);
+    CHECK(usage.total() ==
+          usage.data + usage.diffs + usage.pending + usage.hashes + usage.keys + usage.other);
+
+    for (int i = 0; i < 5; i++) {
+        auto msg = ustring{*admin.keys.pending_config()};
+        admin.keys.load_key_message(
+                std::string(64, 'a' + i), msg, get_timestamp_ms(), admin.info, admin.members);
+        if (i < 4)
+            admin.keys.rekey(admin.info, admin.members);
+    }
+
+    auto usage2 = admin.keys.memory_usage();
+    CHECK_FALSE(admin.keys.pending_config());
+    CHECK(usage2.pending >= usage.pending);
+    CHECK(usage2.keys >= usage.keys + 4 * 32);
+    CHECK(usage2.hashes >= 5 * 64);
+    CHECK(usage2.data == 0);
+
+    // The Info and Members objects track their own usage:
+    auto musage = admin.members.memory_usage();
+    CHECK(musage.keys >= 5 * 32);
+    CHECK(musage.total() > 0);
+}
+
+TEST_CASE("Group Keys - batched key supplements", "[config][groups][keys][supplement]") {
+    const ustring group_seed =
+            "0123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210"_hexbytes;
+    const ustring admin_seed =
+            "0123456789abcdef0123456789abcdeffedcba9876543210fedcba9876543210"_hexbytes;
+
+    std::array<unsigned char, 32> group_pk;
+    std::array<unsigned char, 64> group_sk;
+    crypto_sign_ed25519_seed_keypair(group_pk.data(), group_sk.data(), group_seed.data());
+
+    pseudo_client admin{admin_seed, true, group_pk.data(), group_sk.data()};
+    // Supplements only hand out confirmed keys, so confirm the initial rekey first:
+    admin.keys.load_key_message(
+            "keyhash1",
+            ustring{*admin.keys.pending_config()},
+            get_timestamp_ms(),
+            admin.info,
+            admin.members);
+
+    std::vector<ustring> member_seeds;
+    std::vector<std::string> sids;
+    for (int i = 0; i < 150; i++) {
+        auto& seed = member_seeds.emplace_back(32, static_cast<unsigned char>(i));
+        seed[0] = 0x42;
+        auto sk = sk_from_seed(seed);
+        sids.push_back(session_id_from_ed(ustring_view{sk.data() + 32, 32}));
+    }
+
+    CHECK(admin.keys.key_supplements({}).empty());
+    CHECK_THROWS_AS(admin.keys.key_supplements(sids, 100), std::invalid_argument);
+
+    // Everything fits in one message by default, and matches the single-message version:
+    auto all = admin.keys.key_supplements(sids);
+    REQUIRE(all.size() == 1);
+    CHECK(all[0] == admin.keys.key_supplement(sids));
+
+    // Multithreaded encryption gives exactly the same result:
+    CHECK(admin.keys.key_supplements(sids, MAX_MESSAGE_SIZE, 1) ==
+          admin.keys.key_supplements(sids, MAX_MESSAGE_SIZE, 4));
+
+    constexpr size_t max_size = 2000;
+    auto msgs = admin.keys.key_supplements(sids, max_size, 4);
+    REQUIRE(msgs.size() > 1);
+    for (auto& m : msgs)
+        CHECK(m.size() <= max_size);
+    // The split should be tight: one more member would have overflowed the message.
+    auto member_size = admin.keys.key_supplement(std::vector{sids[0], sids[1]}).size() -
+                       admin.keys.key_supplement(sids[0]).size();
+    CHECK(msgs[0].size() + member_size > max_size);
+
+    for (int i : {0, 1, 74, 75, 149}) {
+        pseudo_client member{member_seeds[i], false, group_pk.data(), std::nullopt};
+        REQUIRE(member.session_id == sids[i]);
+        int found = 0;
+        for (size_t j = 0; j < msgs.size(); j++)
+            if (member.keys.load_key_message(
+                        "supphash" + std::to_string(j),
+                        msgs[j],
+                        get_timestamp_ms(),
+                        member.info,
+                        member.members))
+                found++;
+        CHECK(found == 1);
+        CHECK(member.keys.group_enc_key() == admin.keys.group_enc_key());
+    }
+}
+
+TEST_CASE(
+        "Group Keys - batched key supplements benchmark",
+        "[config][groups][keys][supplement][!benchmark]") {
+
+    const ustring group_seed =
+            "0123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210"_hexbytes;
+    const ustring admin_seed =
+            "0123456789abcdef0123456789abcdeffedcba9876543210fedcba9876543210"_hexbytes;
+
+    std::array<unsigned char, 32> group_pk;
+    std::array<unsigned char, 64> group_sk;
+    crypto_sign_ed25519_seed_keypair(group_pk.data(), group_sk.data(), group_seed.data());
+
+    pseudo_client admin{admin_seed, true, group_pk.data(), group_sk.data()};
+
+    std::vector<std::string> sids;
+    for (int i = 0; i < 500; i++) {
+        ustring seed(32, static_cast<unsigned char>(i % 256));
+        seed[0] = static_cast<unsigned char>(i / 256);
+        auto sk = sk_from_seed(seed);
+        sids.push_back(session_id_from_ed(ustring_view{sk.data() + 32, 32}));
+    }
+
+    BENCHMARK("key_supplement per member x500") {
+        size_t total = 0;
+        for (auto& sid : sids)
+            total += admin.keys.key_supplement(sid).size();
+        return total;
+    };
+    BENCHMARK("key_supplement x500") { return admin.keys.key_supplement(sids); };
+    BENCHMARK("key_supplements x500, 1 thread") {
+        return admin.keys.key_supplements(sids, MAX_MESSAGE_SIZE, 1);
+    };
+    BENCHMARK("key_supplements x500, all threads") { return admin.keys.key_supplements(sids); };
+}
+
+namespace {
+struct concurrent_keys_fixture {
+    const ustring group_seed =
+            "0123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210"_hexbytes;
+    const ustring admin_seed =
+            "0123456789abcdef0123456789abcdeffedcba9876543210fedcba9876543210"_hexbytes;
+    const ustring member_seed =
+            "000111222333444555666777888999aaabbbcccdddeeefff0123456789abcdef"_hexbytes;
+
+    std::array<unsigned char, 32> group_pk;
+    std::array<unsigned char, 64> group_sk;
+    hacky_list<pseudo_client> clients;
+    pseudo_client* admin;
+    pseudo_client* member;
+
+    concurrent_keys_fixture() {
+        crypto_sign_ed25519_seed_keypair(group_pk.data(), group_sk.data(), group_seed.data());
+        admin = &clients.emplace_back(admin_seed, true, group_pk.data(), group_sk.data());
+        member = &clients.emplace_back(member_seed, false, group_pk.data(), std::nullopt);
+
+        auto m = admin->members.get_or_construct(member->session_id);
+        m.name = "Member";
+        admin->members.set(m);
+        rekey();
+    }
+
+    // Rekeys on the admin and loads the new key on both the admin and member.
+    void rekey() {
+        ustring msg{admin->keys.rekey(admin->info, admin->members)};
+        auto hash = "keyhash" + std::to_string(next_hash++);
+        auto now = get_timestamp_ms();
+        admin->keys.load_key_message(hash, msg, now, admin->info, admin->members);
+        member->keys.load_key_message(hash, msg, now, member->info, member->members);
+    }
+    int next_hash = 0;
+};
+}  // namespace
+
+TEST_CASE("Group Keys - concurrent decryption during key updates", "[config][groups][keys][mt]") {
+    concurrent_keys_fixture f;
+
+    // Messages encrypted with a range of (still-valid) key generations:
+    std::vector<ustring> ciphertexts;
+    for (int i = 0; i < 5; i++) {
+        ciphertexts.push_back(f.admin->keys.encrypt_message(to_usv("hello " + std::to_string(i))));
+        f.rekey();
+    }
+
+    std::atomic<bool> done = false;
+    std::atomic<int> decrypted = 0, failures = 0;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++)
+        readers.emplace_back([&, t] {
+            auto& keys = f.member->keys;
+            for (size_t n = 0; !done || n < 50; n++) {
+                auto i = (n + t) % ciphertexts.size();
+                try {
+                    auto [sender, plain] = keys.decrypt_message(ciphertexts[i]);
+                    if (sender != f.admin->session_id ||
+                        plain != to_usv("hello " + std::to_string(i)))
+                        failures++;
+                    // Also encrypt with whatever the current key is, and make sure we can read it:
+                    auto enc = keys.encrypt_message(to_usv("round trip"));
+                    if (keys.decrypt_message(enc).second != to_usv("round trip"))
+                        failures++;
+                    decrypted++;
+                } catch (const std::exception&) {
+                    failures++;
+                }
+            }
+        });
+
+    for (int i = 0; i < 25; i++) {
+        f.rekey();
+        if (i % 5 == 0)
+            f.member->keys.dump();
+    }
+    done = true;
+    for (auto& r : readers)
+        r.join();
+
+    CHECK(failures == 0);
+    CHECK(decrypted >= 4 * 50);
+    CHECK(f.member->keys.size() == f.admin->keys.size());
+    CHECK(f.member->keys.group_enc_key() == f.admin->keys.group_enc_key());
+}
+
+TEST_CASE(
+        "Group Keys - concurrent decryption benchmark", "[config][groups][keys][mt][!benchmark]") {
+    concurrent_keys_fixture f;
+
+    std::vector<ustring> ciphertexts;
+    for (int i = 0; i < 4; i++) {
+        f.rekey();
+        for (int j = 0; j < 256; j++)
+            ciphertexts.push_back(f.admin->keys.encrypt_message(
+                    to_usv("message " + std::to_string(i) + "/" + std::to_string(j))));
+    }
+
+    auto decrypt_all = [&](size_t threads, bool with_writer) {
+        std::atomic<size_t> decrypted = 0;
+        std::atomic<bool> done = false;
+        std::thread writer;
+        if (with_writer)
+            writer = std::thread{[&] {
+                while (!done)
+                    f.member->keys.dump();
+            }};
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++)
+            workers.emplace_back([&, t] {
+                for (size_t i = t; i < ciphertexts.size(); i += threads)
+                    decrypted += f.member->keys.decrypt_message(ciphertexts[i]).second.size();
+            });
+        for (auto& w : workers)
+            w.join();
+        done = true;
+        if (writer.joinable())
+            writer.join();
+        return decrypted.load();
+    };
+
+    for (size_t threads : {1, 4, 8}) {
+        BENCHMARK("decrypt x1024, " + std::to_string(threads) + " threads") {
+            return decrypt_all(threads, false);
+        };
+        BENCHMARK("decrypt x1024, " + std::to_string(threads) + " threads, with writer") {
+            return decrypt_all(threads, true);
+        };
+    }
+}
@@ -0,0 +1,186 @@
+#include <oxenc/hex.h>
+#include <sodium/crypto_sign_ed25519.h>
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <session/config/groups/manager.hpp>
+
+#include "utils.hpp"
+
+using namespace std::literals;
+using namespace oxenc::literals;
+using namespace session::config;
+
+TEST_CASE("Group manager hibernation", "[config][groups][manager]") {
+    const auto user_seed =
+            "0123456789abcdef0123456789abcdeffedcba9876543210fedcba9876543210"_hexbytes;
+    std::array<unsigned char, 32> user_pk;
+    std::array<unsigned char, 64> user_sk;
+    crypto_sign_ed25519_seed_keypair(user_pk.data(), user_sk.data(), user_seed.data());
+
+    struct group {
+        std::array<unsigned char, 32> pk;
+        std::array<unsigned char, 64> sk;
+        std::string id;
+    };
+    std::array<group, 3> gs;
+    for (size_t i = 0; i < gs.size(); i++) {
+        ustring seed(32, static_cast<unsigned char>(i + 1));
+        auto& g = gs[i];
+        crypto_sign_ed25519_seed_keypair(g.pk.data(), g.sk.data(), seed.data());
+        g.id = "03" + oxenc::to_hex(g.pk.begin(), g.pk.end());
+    }
+
+    groups::GroupManager mgr{to_usv(user_sk)};
+
+    std::vector<std::pair<std::string, groups::group_dumps>> dumped;
+    mgr.set_dump_callback([&](std::string_view id, const groups::group_dumps& d) {
+        dumped.emplace_back(id, d);
+    });
+
+    CHECK(mgr.add(gs[0].id, to_usv(gs[0].sk)));
+    CHECK(mgr.add(gs[1].id, to_usv(gs[1].sk)));
+    CHECK_FALSE(mgr.add(gs[1].id));
+    CHECK_THROWS_AS(mgr.add("05" + gs[2].id.substr(2)), std::invalid_argument);
+    CHECK_THROWS_AS(mgr.get(gs[2].id), std::out_of_range);
+    CHECK(mgr.size() == 2);
+    CHECK(mgr.resident_count() == 0);
+
+    // Groups are constructed on first access:
+    ustring ciphertext;
+    {
+        auto& g = mgr.get(gs[0].id);
+        CHECK(mgr.is_resident(gs[0].id));
+        auto keys_msg = g.keys.rekey(g.info, g.members);
+        g.keys.load_key_message("keyhash1", keys_msg, get_timestamp_ms(), g.info, g.members);
+        g.info.set_name("Group 0");
+        ciphertext = g.keys.encrypt_message(to_usv("hello"));
+    }
+    CHECK(mgr.resident_count() == 1);
+    CHECK(mgr.hibernated_memory() == 0);
+    CHECK(mgr.resident_memory() > 0);
+
+    // Hibernating flushes the un-dumped changes:
+    CHECK(mgr.hibernate(gs[0].id));
+    CHECK_FALSE(mgr.hibernate(gs[0].id));
+    CHECK_FALSE(mgr.is_resident(gs[0].id));
+    REQUIRE(dumped.size() == 1);
+    CHECK(dumped[0].first == gs[0].id);
+    CHECK_FALSE(dumped[0].second.info.empty());
+    CHECK_FALSE(dumped[0].second.keys.empty());
+    CHECK(mgr.hibernated_memory() == dumped[0].second.size());
+    CHECK(mgr.dumps(gs[0].id).info == dumped[0].second.info);
+
+    // ... and accessing the group transparently restores it:
+    {
+        auto& g = mgr.get(gs[0].id);
+        CHECK(g.info.get_name() == "Group 0");
+        CHECK(g.keys.size() == 1);
+        CHECK(g.keys.decrypt_message(ciphertext).second == to_usv("hello"));
+        CHECK_FALSE(g.needs_dump());
+    }
+    CHECK(mgr.hibernated_memory() == 0);
+
+    // Hibernating a group without changes doesn't invoke the callback:
+    CHECK(mgr.hibernate(gs[0].id));
+    CHECK(dumped.size() == 1);
+
+    // With a budget that only fits one group, accessing a group hibernates the least recently
+    // used one:
+    auto t0 = groups::GroupManager::clock::now();
+    auto g0_usage = mgr.get(gs[0].id).memory_usage();
+    mgr.get(gs[1].id).info.set_name("Group 1");
+    CHECK(mgr.resident_count() == 2);
+    mgr.set_memory_budget(g0_usage + mgr.get(gs[1].id).memory_usage() - 1);
+    CHECK(mgr.resident_count() == 1);
+    CHECK(mgr.is_resident(gs[1].id));
+    CHECK(dumped.size() == 1);  // The evicted group 0 had nothing new to dump
+
+    mgr.get(gs[0].id);
+    CHECK(mgr.is_resident(gs[0].id));
+    CHECK_FALSE(mgr.is_resident(gs[1].id));
+    REQUIRE(dumped.size() == 2);
+    CHECK(dumped[1].first == gs[1].id);
+
+    // Iteration visits (and restores) every group in turn, in group id order:
+    std::vector<std::string> names;
+    mgr.for_each([&](const std::string&, groups::group_state& g) {
+        names.emplace_back(g.info.get_name().value_or(""));
+    });
+    std::sort(names.begin(), names.end());
+    CHECK(names == std::vector{{"Group 0"s, "Group 1"s}});
+    CHECK(mgr.resident_count() == 1);
+
+    mgr.set_memory_budget(0);
+    mgr.get(gs[0].id);
+    mgr.get(gs[1].id);
+    CHECK(mgr.resident_count() == 2);
+    CHECK(mgr.hibernate_idle(1min, t0) == 0);
+    CHECK(mgr.hibernate_idle(1min, groups::GroupManager::clock::now() + 1min) == 2);
+    CHECK(mgr.resident_count() == 0);
+
+    CHECK(mgr.remove(gs[0].id));
+    CHECK_FALSE(mgr.remove(gs[0].id));
+    CHECK_FALSE(mgr.contains(gs[0].id));
+    CHECK(mgr.contains(gs[1].id));
+    CHECK(mgr.get(gs[1].id).info.get_name() == "Group 1");
+}
+
+TEST_CASE("Group manager restore callback", "[config][groups][manager]") {
+    const auto user_seed =
+            "0123456789abcdef0123456789abcdeffedcba9876543210fedcba9876543210"_hexbytes;
+    std::array<unsigned char, 32> user_pk;
+    std::array<unsigned char, 64> user_sk;
+    crypto_sign_ed25519_seed_keypair(user_pk.data(), user_sk.data(), user_seed.data());
+
+    ustring group_seed(32, 0x42);
+    std::array<unsigned char, 32> group_pk;
+    std::array<unsigned char, 64> group_sk;
+    crypto_sign_ed25519_seed_keypair(group_pk.data(), group_sk.data(), group_seed.data());
+    auto group_id = "03" + oxenc::to_hex(group_pk.begin(), group_pk.end());
+
+    groups::GroupManager mgr{to_usv(user_sk)};
+    REQUIRE(mgr.add(group_id, to_usv(group_sk)));
+
+    // Settings applied directly to the objects don't survive hibernation:
+    mgr.get(group_id).info.set_delta_snapshot_interval(5);
+    mgr.get(group_id).info.set_name("Group");
+    CHECK(mgr.hibernate(group_id));
+    CHECK(mgr.get(group_id).info.delta_snapshot_interval() == 0);
+
+    // ... but those applied by the restore callback do:
+    std::vector<std::string> restored;
+    std::vector<std::string> logged;
+    mgr.set_restore_callback([&](std::string_view id, groups::group_state& g) {
+        restored.emplace_back(id);
+        g.info.set_delta_snapshot_interval(5);
+        g.members.set_lagged_diff_budget(1000);
+        g.info.logger = [&](LogLevel, std::string msg) { logged.push_back(std::move(msg)); };
+    });
+    CHECK(mgr.hibernate(group_id));
+    CHECK(restored.empty());
+    {
+        auto& g = mgr.get(group_id);
+        CHECK(restored == std::vector{{group_id}});
+        CHECK(g.info.delta_snapshot_interval() == 5);
+        CHECK(g.members.lagged_diff_budget() == 1000);
+        CHECK(g.info.get_name() == "Group");
+        REQUIRE(g.info.logger);
+        g.info.logger(LogLevel::debug, "test");
+        CHECK(logged == std::vector{{"test"s}});
+    }
+
+    // Already-resident groups are handed out without invoking the callback again:
+    mgr.get(group_id);
+    CHECK(restored.size() == 1);
+
+    // A throwing callback leaves the group hibernated:
+    CHECK(mgr.hibernate(group_id));
+    mgr.set_restore_callback([](std::string_view, groups::group_state&) {
+        throw std::runtime_error{"nope"};
+    });
+    CHECK_THROWS_AS(mgr.get(group_id), std::runtime_error);
+    CHECK_FALSE(mgr.is_resident(group_id));
+    mgr.set_restore_callback(nullptr);
+    CHECK(mgr.get(group_id).info.get_name() == "Group");
+}
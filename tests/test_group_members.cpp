@@ -5,6 +5,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers.hpp>
 #include <iostream>
+#include <session/config/groups/members.h>
 #include <session/config/groups/members.hpp>
 #include <string_view>
 
@@ -284,3 +285,184 @@ TEST_CASE("Group Members", "[config][groups][members]") {
           "1234567890123456789012345678901234567890123456789012345678901234567890123456789012345678"
           "901234567890");
 }
+
+TEST_CASE("Group Members - status indexes", "[config][groups][members]") {
+
+    const auto seed = "0123456789abcdef0123456789abcdeffedcba9876543210fedcba9876543210"_hexbytes;
+    std::array<unsigned char, 32> ed_pk;
+    std::array<unsigned char, 64> ed_sk;
+    crypto_sign_ed25519_seed_keypair(
+            ed_pk.data(), ed_sk.data(), reinterpret_cast<const unsigned char*>(seed.data()));
+
+    const auto key = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"_hexbytes;
+    groups::Members gmem1{to_usv(ed_pk), to_usv(ed_sk), std::nullopt};
+    groups::Members gmem2{to_usv(ed_pk), to_usv(ed_sk), std::nullopt};
+    gmem1.add_key(key, false);
+    gmem2.add_key(key, false);
+
+    std::vector<std::string> sids;
+    while (sids.size() < 300) {
+        std::array<unsigned char, 33> sid;
+        for (auto& s : sid)
+            s = sids.size() % 256;
+        sid[1] = sids.size() / 256;
+        sid[0] = 0x05;
+        sids.push_back(oxenc::to_hex(sid.begin(), sid.end()));
+    }
+
+    using groups::member_status;
+    constexpr std::array all_statuses = {
+            member_status::invite_pending,
+            member_status::invite_not_sent,
+            member_status::invite_sent,
+            member_status::invite_failed,
+            member_status::promotion_pending,
+            member_status::promotion_not_sent,
+            member_status::promotion_sent,
+            member_status::promotion_failed,
+            member_status::removed,
+            member_status::removed_with_messages};
+
+    auto has_status = [](const groups::member& m, member_status s) {
+        switch (s) {
+            case member_status::invite_pending: return m.invite_pending();
+            case member_status::invite_not_sent: return m.invite_not_sent();
+            case member_status::invite_sent: return m.invite_status == groups::INVITE_SENT;
+            case member_status::invite_failed: return m.invite_failed();
+            case member_status::promotion_pending: return m.promotion_pending();
+            case member_status::promotion_not_sent: return m.promotion_not_sent();
+            case member_status::promotion_sent:
+                return m.admin && m.promotion_status == groups::INVITE_SENT;
+            case member_status::promotion_failed: return m.promotion_failed();
+            case member_status::removed: return m.is_removed();
+            case member_status::removed_with_messages: return m.should_remove_messages();
+        }
+        return false;
+    };
+
+    // Compares the indexed queries against a full iteration over the members:
+    auto check_indexes = [&](const groups::Members& gmem) {
+        for (auto s : all_statuses) {
+            std::vector<std::string> expected;
+            for (auto& m : gmem)
+                if (has_status(m, s))
+                    expected.push_back(m.session_id);
+
+            CHECK(gmem.status_count(s) == expected.size());
+            std::vector<std::string> all, paged;
+            for (auto& m : gmem.with_status(s))
+                all.push_back(m.session_id);
+            for (size_t offset = 0; offset < expected.size() + 7; offset += 7)
+                for (auto& m : gmem.with_status(s, offset, 7))
+                    paged.push_back(m.session_id);
+            CHECK(all == expected);
+            CHECK(paged == expected);
+        }
+    };
+
+    // Make the index before adding anything so that everything below gets applied incrementally:
+    CHECK(gmem1.status_count(member_status::invite_pending) == 0);
+    CHECK(gmem1.with_status(member_status::removed).empty());
+
+    for (int i = 0; i < 300; i++) {
+        auto m = gmem1.get_or_construct(sids[i]);
+        m.name = "Member " + std::to_string(i);
+        switch (i % 10) {
+            case 0: m.set_promotion_accepted(); break;
+            case 1: m.set_promoted(); break;
+            case 2: m.set_promotion_sent(); break;
+            case 3: m.set_promotion_failed(); break;
+            case 4: m.set_invited(); break;
+            case 5: m.set_invited(true); break;
+            case 6: m.set_removed(); break;
+            case 7: m.set_removed(true); break;
+            case 8: m.set_accepted(); break;
+            default: break;  // Invite not sent
+        }
+        gmem1.set(m);
+    }
+
+    CHECK(gmem1.status_count(member_status::invite_pending) == 90);
+    CHECK(gmem1.status_count(member_status::invite_failed) == 30);
+    CHECK(gmem1.status_count(member_status::promotion_pending) == 90);
+    CHECK(gmem1.status_count(member_status::promotion_failed) == 30);
+    CHECK(gmem1.status_count(member_status::removed) == 60);
+    CHECK(gmem1.status_count(member_status::removed_with_messages) == 30);
+    check_indexes(gmem1);
+
+    auto page = gmem1.with_status(member_status::invite_failed, 28, 5);
+    REQUIRE(page.size() == 2);
+    CHECK(page[0].session_id == sids[285]);
+    CHECK(page[0].name == "Member 285");
+    CHECK(page[1].session_id == sids[295]);
+    CHECK(gmem1.with_status(member_status::invite_failed, 30).empty());
+    CHECK_THROWS_AS(gmem1.status_count(static_cast<member_status>(10)), std::invalid_argument);
+
+    // Updates and removals:
+    for (int i = 0; i < 300; i += 3) {
+        if (i % 2) {
+            gmem1.erase(sids[i]);
+        } else {
+            auto m = gmem1.get(sids[i]).value();
+            if (m.invite_pending())
+                m.set_accepted();
+            else if (m.promotion_pending())
+                m.set_promotion_accepted();
+            else
+                m.set_removed(i % 4 == 0);
+            gmem1.set(m);
+        }
+    }
+    check_indexes(gmem1);
+
+    // The other object builds its index from merged data, and rebuilds it after further merges:
+    auto [s1, p1, o1] = gmem1.push();
+    gmem1.confirm_pushed(s1, "fakehash1");
+    CHECK(gmem2.merge(std::vector<std::pair<std::string, ustring_view>>{{"fakehash1", p1}}) ==
+          std::vector<std::string>{"fakehash1"});
+    check_indexes(gmem2);
+
+    for (int i = 1; i < 300; i += 10) {
+        if (auto m = gmem1.get(sids[i])) {
+            m->set_removed(true);
+            gmem1.set(*m);
+        }
+    }
+    auto [s2, p2, o2] = gmem1.push();
+    gmem1.confirm_pushed(s2, "fakehash2");
+    CHECK(gmem2.merge(std::vector<std::pair<std::string, ustring_view>>{{"fakehash2", p2}}) ==
+          std::vector<std::string>{"fakehash2"});
+    check_indexes(gmem1);
+    check_indexes(gmem2);
+    CHECK(gmem2.status_count(member_status::removed) ==
+          gmem1.status_count(member_status::removed));
+
+    // Paging through the C API:
+    auto dump = gmem2.dump();
+    config_object* conf;
+    int rv = groups_members_init(
+            &conf, ed_pk.data(), ed_sk.data(), dump.data(), dump.size(), NULL);
+    REQUIRE(rv == 0);
+    CHECK(groups_members_status_count(conf, GROUP_MEMBER_STATUS_REMOVED) ==
+          gmem2.status_count(member_status::removed));
+    CHECK(groups_members_status_count(conf, static_cast<GROUP_MEMBER_STATUS>(99)) == 0);
+
+    std::array<config_group_member, 8> buf;
+    std::vector<std::string> c_removed;
+    for (size_t offset = 0;;) {
+        auto n = groups_members_with_status(
+                conf, GROUP_MEMBER_STATUS_REMOVED, offset, buf.data(), buf.size());
+        for (size_t i = 0; i < n; i++) {
+            CHECK(buf[i].removed > 0);
+            c_removed.emplace_back(buf[i].session_id);
+        }
+        offset += n;
+        if (n < buf.size())
+            break;
+    }
+    std::vector<std::string> removed;
+    for (auto& m : gmem2.with_status(member_status::removed))
+        removed.push_back(m.session_id);
+    CHECK(c_removed == removed);
+    config_free(conf);
+}
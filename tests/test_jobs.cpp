@@ -0,0 +1,119 @@
+#include <oxenc/hex.h>
+#include <session/config/contacts.h>
+#include <session/jobs.h>
+#include <sodium/crypto_sign_ed25519.h>
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <session/jobs.hpp>
+#include <session/session_encrypt.hpp>
+
+#include "utils.hpp"
+
+using namespace std::literals;
+using namespace oxenc::literals;
+
+TEST_CASE("Job pool ordering", "[jobs]") {
+    std::vector<int> a, b, ab;
+    int obj_a, obj_b;
+    {
+        session::JobPool pool{4};
+        CHECK(pool.threads() == 4);
+        for (int i = 0; i < 1000; i++) {
+            pool.submit({&obj_a}, [&a, i] { a.push_back(i); });
+            pool.submit({&obj_a, &obj_b}, [&ab, i] { ab.push_back(i); });
+            pool.submit({&obj_b}, [&b, i] { b.push_back(i); });
+            pool.submit({}, [] { throw std::runtime_error{"ignored"}; });
+        }
+        // Destruction waits for everything to finish
+    }
+    REQUIRE(a.size() == 1000);
+    REQUIRE(b.size() == 1000);
+    REQUIRE(ab.size() == 1000);
+    for (int i = 0; i < 1000; i++) {
+        CHECK(a[i] == i);
+        CHECK(b[i] == i);
+        CHECK(ab[i] == i);
+    }
+}
+
+TEST_CASE("Job pool C API", "[jobs][c]") {
+    const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
+    std::array<unsigned char, 32> ed_pk, curve_pk;
+    std::array<unsigned char, 64> ed_sk;
+    crypto_sign_ed25519_seed_keypair(ed_pk.data(), ed_sk.data(), seed.data());
+    REQUIRE(0 == crypto_sign_ed25519_pk_to_curve25519(curve_pk.data(), ed_pk.data()));
+
+    config_object* conf;
+    REQUIRE(0 == contacts_init(&conf, ed_sk.data(), NULL, 0, NULL));
+    config_object* conf2;
+    REQUIRE(0 == contacts_init(&conf2, ed_sk.data(), NULL, 0, NULL));
+
+    contacts_contact c;
+    REQUIRE(contacts_get_or_construct(
+            conf, &c, "050000000000000000000000000000000000000000000000000000000000000000"));
+    strcpy(c.name, "Joe");
+    contacts_set(conf, &c);
+
+    session_job_pool* pool = session_job_pool_new(2);
+    REQUIRE(pool);
+
+    std::atomic<int> callbacks{0};
+    auto cb = [](session_job*, void* ctx) { ++*static_cast<std::atomic<int>*>(ctx); };
+
+    session_job* push = session_job_config_push(pool, conf, cb, &callbacks);
+    REQUIRE(session_job_wait(push) == SESSION_JOB_SUCCEEDED);
+    CHECK(session_job_error(push) == ""sv);
+    config_push_data* to_push = session_job_take_push_data(push);
+    REQUIRE(to_push);
+    CHECK(to_push->seqno == 1);
+    CHECK_FALSE(session_job_take_push_data(push));
+    CHECK_FALSE(session_job_take_string_list(push));
+    session_job_free(push);
+
+    const char* merge_hash[] = {"fakehash1"};
+    const unsigned char* merge_data[] = {to_push->config};
+    size_t merge_size[] = {to_push->config_len};
+    session_job* merge = session_job_config_merge(
+            pool, conf2, merge_hash, merge_data, merge_size, 1, cb, &callbacks);
+    free(to_push);  // The job has its own copy
+    REQUIRE(session_job_wait(merge) == SESSION_JOB_SUCCEEDED);
+    config_string_list* accepted = session_job_take_string_list(merge);
+    REQUIRE(accepted);
+    REQUIRE(accepted->len == 1);
+    CHECK(accepted->value[0] == "fakehash1"sv);
+    free(accepted);
+    session_job_free(merge);
+
+    // Decryption of something that isn't a valid message fails with an error:
+    auto garbage = "not an encrypted message"_bytes;
+    session_job* bad = session_job_decrypt_incoming(
+            pool, garbage.data(), garbage.size(), ed_sk.data(), nullptr, nullptr);
+    REQUIRE(session_job_wait(bad) == SESSION_JOB_FAILED);
+    CHECK(session_job_error(bad) != ""sv);
+    size_t len;
+    CHECK_FALSE(session_job_take_data(bad, &len));
+    char sid[67];
+    CHECK_FALSE(session_job_session_id(bad, sid));
+    session_job_free(bad);
+
+    auto enc = session::encrypt_for_recipient(to_usv(ed_sk), to_usv(curve_pk), to_usv("hello"));
+    session_job* good = session_job_decrypt_incoming(
+            pool, enc.data(), enc.size(), ed_sk.data(), nullptr, nullptr);
+    // Freeing the pool waits for the job to finish, but the job handle stays valid:
+    session_job_pool_free(pool);
+    CHECK(session_job_status(good) == SESSION_JOB_SUCCEEDED);
+    unsigned char* plaintext = session_job_take_data(good, &len);
+    REQUIRE(plaintext);
+    CHECK(ustring_view{plaintext, len} == to_usv("hello"));
+    free(plaintext);
+    REQUIRE(session_job_session_id(good, sid));
+    CHECK(sid == "05" + oxenc::to_hex(curve_pk.begin(), curve_pk.end()));
+    session_job_free(good);
+
+    CHECK(callbacks == 2);
+
+    config_free(conf);
+    config_free(conf2);
+}
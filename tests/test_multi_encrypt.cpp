@@ -187,6 +187,33 @@ TEST_CASE("Multi-recipient encryption", "[encrypt][multi]") {
             to_usv(x_keys[0].second),
             "test suite",
             [&](ustring_view enc) { encrypted.emplace_back(enc); }));
+
+    // An invalid recipient pubkey throws before any recipient has been passed to the callback,
+    // unless we ask to ignore invalid recipients:
+    std::array<unsigned char, 32> zero_pk{};
+    auto with_invalid = session::to_view_vector(recipients.begin(), std::prev(recipients.end()));
+    with_invalid[2] = ustring_view{zero_pk.data(), zero_pk.size()};
+    encrypted.clear();
+    CHECK_THROWS(session::encrypt_for_multiple(
+            msgs[0],
+            with_invalid,
+            nonce,
+            to_usv(x_keys[0].first),
+            to_usv(x_keys[0].second),
+            "test suite",
+            [&](ustring_view enc) { encrypted.emplace_back(enc); }));
+    CHECK(encrypted.empty());
+
+    session::encrypt_for_multiple(
+            msgs[0],
+            with_invalid,
+            nonce,
+            to_usv(x_keys[0].first),
+            to_usv(x_keys[0].second),
+            "test suite",
+            [&](ustring_view enc) { encrypted.emplace_back(enc); },
+            true);
+    CHECK(encrypted.size() == 3);
 }
 
 TEST_CASE("Multi-recipient encryption, simpler interface", "[encrypt][multi][simple]") {
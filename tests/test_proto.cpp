@@ -2,10 +2,14 @@
 
 #include <catch2/catch_all.hpp>
 #include <iostream>
+#include <session/config/encrypt.hpp>
 #include <session/config/namespaces.hpp>
 #include <session/config/protos.hpp>
 #include <session/config/user_profile.hpp>
+#include <session/session_encrypt.hpp>
 
+#include "SessionProtos.pb.h"
+#include "WebSocketResources.pb.h"
 #include "utils.hpp"
 
 using namespace session::config;
@@ -57,6 +61,53 @@ TEST_CASE("Protobuf Handling - Wrap, Unwrap", "[config][proto][wrap]") {
         CHECK(user_profile_parsed == msg);
         CHECK(contacts_parsed == msg);
     }
+
+    SECTION("Wrap/unwrap with a session identity") {
+        session::SessionIdentity id{ed_sk};
+        for (auto& n : groups) {
+            // Wrapping is deterministic, so this must match wrapping with the raw key exactly
+            auto wrapped = protos::wrap_config(id, msg, 1, n);
+            CHECK(wrapped == protos::wrap_config(ed_sk, msg, 1, n));
+            CHECK(protos::unwrap_config(id, wrapped, n) == msg);
+        }
+    }
+}
+
+TEST_CASE("Protobuf Handling - Wire compatibility", "[config][proto][wrap]") {
+    // We write the wrapping layers directly rather than via the protobuf types, so make sure that
+    // what we produce is exactly what protobuf would produce (and parses as expected).
+    auto msg = "Hello from the other side"_bytes;
+
+    for (auto& n : groups) {
+        auto wrapped = protos::wrap_config(ed_sk, msg, 123456789012, n);
+
+        WebSocketProtos::WebSocketMessage ws;
+        REQUIRE(ws.ParseFromArray(wrapped.data(), wrapped.size()));
+        CHECK(to_usv(ws.SerializeAsString()) == wrapped);
+        CHECK(ws.type() == WebSocketProtos::WebSocketMessage_Type_REQUEST);
+        CHECK(ws.request().verb() == "");
+        CHECK(ws.request().path() == "");
+        CHECK(ws.request().requestid() == 0);
+
+        SessionProtos::Envelope envelope;
+        REQUIRE(envelope.ParseFromString(ws.request().body()));
+        CHECK(envelope.SerializeAsString() == ws.request().body());
+        CHECK(envelope.type() == SessionProtos::Envelope_Type_SESSION_MESSAGE);
+        CHECK(envelope.timestamp() == 1);
+
+        auto [content, sender] = session::decrypt_incoming(ed_sk, to_usv(envelope.content()));
+        CHECK(sender == to_usv(ed_pk_raw));
+        REQUIRE(content.size() > 0);
+        CHECK(content.back() == 0x80);
+        content.pop_back();
+
+        SessionProtos::Content config;
+        REQUIRE(config.ParseFromArray(content.data(), content.size()));
+        CHECK(to_usv(config.SerializeAsString()) == content);
+        REQUIRE(config.has_sharedconfigmessage());
+        CHECK(config.sharedconfigmessage().seqno() == 123456789012);
+        CHECK(to_usv(config.sharedconfigmessage().data()) == msg);
+    }
 }
 
 TEST_CASE("Protobuf Handling - Error Handling", "[config][proto][error]") {
@@ -77,6 +128,50 @@ TEST_CASE("Protobuf Handling - Error Handling", "[config][proto][error]") {
     }
 }
 
+TEST_CASE("Protobuf Handling - Wrapping detection", "[config][proto][detect]") {
+    auto msg = "Hello from the other side"_bytes;
+
+    for (auto& n : groups) {
+        auto wrapped = protos::wrap_config(ed_sk, msg, 1, n);
+        CHECK(protos::is_protobuf_wrapped(wrapped));
+        CHECK_FALSE(protos::is_protobuf_wrapped(msg));
+
+        auto double_wrapped = protos::wrap_config(ed_sk, wrapped, 1, n);
+        CHECK(protos::is_protobuf_wrapped(double_wrapped));
+        auto unwrapped = protos::unwrap_config(ed_sk, double_wrapped, n);
+        CHECK(protos::is_protobuf_wrapped(unwrapped));
+        CHECK(protos::unwrap_config(ed_sk, unwrapped, n) == msg);
+
+        // Truncated or extended messages aren't well-formed protobuf anymore:
+        CHECK_FALSE(protos::is_protobuf_wrapped(
+                ustring_view{wrapped}.substr(0, wrapped.size() - 1)));
+        CHECK_FALSE(protos::is_protobuf_wrapped(wrapped + "\x01"_bytes));
+    }
+
+    // A raw, encrypted config message is not protobuf-wrapped:
+    auto raw = encrypt(msg, ustring_view{seed}.substr(0, 32), "UserProfile");
+    CHECK_FALSE(protos::is_protobuf_wrapped(raw));
+    CHECK_FALSE(protos::is_protobuf_wrapped(""_bytes));
+}
+
+TEST_CASE("Protobuf Handling - Unwrap with derived keys", "[config][proto][wrap]") {
+    auto msg = "Hello from the other side"_bytes;
+
+    std::array<unsigned char, 32> x_pk, x_sk;
+    crypto_sign_ed25519_pk_to_curve25519(x_pk.data(), ed_pk_raw.data());
+    crypto_sign_ed25519_sk_to_curve25519(x_sk.data(), ed_sk_raw.data());
+
+    for (auto& n : groups) {
+        auto wrapped = protos::wrap_config(ed_sk, msg, 1, n);
+        CHECK(protos::unwrap_config(to_usv(ed_pk_raw), to_usv(x_pk), to_usv(x_sk), wrapped, n) ==
+              msg);
+    }
+
+    auto wrapped = protos::wrap_config(ed_sk, msg, 1, Namespace::Contacts);
+    CHECK_THROWS(protos::unwrap_config(
+            to_usv(ed_pk_raw), to_usv(x_pk), to_usv(x_sk), wrapped, Namespace::UserProfile));
+}
+
 TEST_CASE("Protobuf old config loading test", "[config][proto][old]") {
 
     const auto seed = "f887566576de6c16d9ec251d55e24c1400000000000000000000000000000000"_hexbytes;
@@ -107,5 +202,6 @@ TEST_CASE("Protobuf old config loading test", "[config][proto][old]") {
             "db9aac0032c484062d7ba7bbe64e07bcd633eec8378d5d914732693c5e298f015ebde2ae45769ed319e267"
             "f0528f5cc6da268343b6647b20bae6e9ee8d92cca702"_hexbytes;
 
+    CHECK(protos::is_protobuf_wrapped(old_conf));
     CHECK_NOTHROW(protos::unwrap_config(ed_sk, old_conf, Namespace::UserProfile));
 }
@@ -0,0 +1,119 @@
+#include <oxenc/hex.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <session/config/contacts.hpp>
+#include <session/config/convo_info_volatile.hpp>
+#include <session/config/push_scheduler.hpp>
+
+#include "utils.hpp"
+
+using namespace std::literals;
+using namespace oxenc::literals;
+using namespace session::config;
+
+TEST_CASE("Push scheduler", "[config][push_scheduler]") {
+    const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
+
+    Contacts contacts{seed, std::nullopt};
+    ConvoInfoVolatile convos{seed, std::nullopt};
+    Contacts contacts2{seed, std::nullopt};
+
+    constexpr auto sid = "050000000000000000000000000000000000000000000000000000000000000000"sv;
+
+    PushScheduler sched{1s, 5s};
+    sched.add(contacts);
+    sched.add(convos);
+    sched.add(contacts);  // Duplicate; ignored
+
+    auto t0 = PushScheduler::clock::now();
+
+    auto adv = sched.advise(t0);
+    CHECK_FALSE(adv.push_now);
+    CHECK(adv.wait == 0ms);
+    CHECK(adv.configs.empty());
+
+    auto edit = [&](const std::string& name) {
+        auto c = contacts.get_or_construct(sid);
+        c.set_name(name);
+        contacts.set(c);
+    };
+
+    edit("A");
+    adv = sched.advise(t0);
+    CHECK_FALSE(adv.push_now);
+    CHECK(adv.wait == 1s);
+    CHECK(adv.configs.empty());
+
+    // Further edits push back the debounce deadline...
+    edit("AB");
+    adv = sched.advise(t0 + 600ms);
+    CHECK_FALSE(adv.push_now);
+    CHECK(adv.wait == 1s);
+    edit("ABC");
+    adv = sched.advise(t0 + 1200ms);
+    CHECK(adv.wait == 1s);
+
+    // ... but not beyond the max latency:
+    for (auto t = 1800ms; t < 5s; t += 600ms) {
+        edit("ABC" + std::to_string(t.count()));
+        adv = sched.advise(t0 + t);
+        CHECK_FALSE(adv.push_now);
+        CHECK(adv.wait == std::min<std::chrono::milliseconds>(1s, 5s - t));
+    }
+    edit("final");
+    adv = sched.advise(t0 + 5s);
+    CHECK(adv.push_now);
+    REQUIRE(adv.configs.size() == 1);
+    CHECK(adv.configs[0] == &contacts);
+
+    // All the edits went into a single seqno increment:
+    auto [seqno, data, obs] = contacts.push();
+    CHECK(seqno == 1);
+    contacts.confirm_pushed(seqno, "hash1");
+
+    adv = sched.advise(t0 + 5s);
+    CHECK_FALSE(adv.push_now);
+    CHECK(adv.wait == 0ms);
+
+    // Once something is due, everything pending goes with it:
+    edit("new");
+    adv = sched.advise(t0 + 10s);
+    CHECK(adv.wait == 1s);
+    {
+        auto c = convos.get_or_construct_1to1(sid);
+        c.unread = true;
+        convos.set(c);
+    }
+    adv = sched.advise(t0 + 10500ms);
+    CHECK(adv.wait == 500ms);
+    adv = sched.advise(t0 + 11s);
+    CHECK(adv.push_now);
+    CHECK(adv.configs == std::vector<ConfigBase*>{&contacts, &convos});
+
+    // Pushed (but not yet confirmed) configs are in flight and aren't advised again:
+    auto [seqno2, data2, obs2] = contacts.push();
+    auto [cseqno, cdata, cobs] = convos.push();
+    adv = sched.advise(t0 + 11s);
+    CHECK_FALSE(adv.push_now);
+    CHECK(adv.configs.empty());
+    contacts.confirm_pushed(seqno2, "hash2");
+    convos.confirm_pushed(cseqno, "hash3");
+
+    // A config that becomes dirty from a merge conflict should be pushed immediately:
+    {
+        auto c = contacts2.get_or_construct(sid);
+        c.set_nickname("conflict");
+        contacts2.set(c);
+    }
+    auto [seqno3, data3, obs3] = contacts2.push();
+    contacts2.confirm_pushed(seqno3, "hash4");
+    CHECK(contacts.merge(std::vector<std::pair<std::string, ustring_view>>{
+                  {"hash4", data3}}) == std::vector<std::string>{"hash4"});
+    REQUIRE(contacts.is_dirty());
+    adv = sched.advise(t0 + 20s);
+    CHECK(adv.push_now);
+    CHECK(adv.configs == std::vector<ConfigBase*>{&contacts});
+
+    CHECK(sched.remove(convos));
+    CHECK_FALSE(sched.remove(convos));
+}
@@ -2,6 +2,8 @@
 
 #include <catch2/catch_test_macros.hpp>
 #include <session/blinding.hpp>
+#include <session/identity.h>
+#include <session/identity.hpp>
 #include <session/session_encrypt.hpp>
 #include <session/util.hpp>
 
@@ -140,6 +142,106 @@ TEST_CASE("Session protocol deterministic encryption", "[session-protocol][encry
     CHECK(from_unsigned_sv(msg) == "hello");
 }
 
+TEST_CASE("Session identity", "[session-protocol][identity]") {
+
+    using namespace session;
+
+    const auto seed = "0123456789abcdef0123456789abcdef00000000000000000000000000000000"_hexbytes;
+    std::array<unsigned char, 32> ed_pk;
+    std::array<unsigned char, 64> ed_sk;
+    crypto_sign_ed25519_seed_keypair(ed_pk.data(), ed_sk.data(), seed.data());
+
+    const auto seed2 = "00112233445566778899aabbccddeeff00000000000000000000000000000000"_hexbytes;
+    std::array<unsigned char, 32> ed_pk2;
+    std::array<unsigned char, 64> ed_sk2;
+    crypto_sign_ed25519_seed_keypair(ed_pk2.data(), ed_sk2.data(), seed2.data());
+
+    SessionIdentity id{seed};
+    SessionIdentity id_full{to_sv(ed_sk)};
+    SessionIdentity id2{to_sv(ed_sk2)};
+
+    CHECK(id.ed25519_secret() == to_sv(ed_sk));
+    CHECK(id_full.ed25519_secret() == to_sv(ed_sk));
+    CHECK(id.ed25519_seed() == seed);
+    CHECK(id.ed25519_pubkey() == to_sv(ed_pk));
+    CHECK(oxenc::to_hex(id.x25519_pubkey()) ==
+          "d2ad010eeb72d72e561d9de7bd7b6989af77dcabffa03a5111a6c859ae5c3a72");
+    CHECK(id.x25519_secret() == id_full.x25519_secret());
+    CHECK(id.session_id() == "05d2ad010eeb72d72e561d9de7bd7b6989af77dcabffa03a5111a6c859ae5c3a72");
+    CHECK(id2.session_id() == "05aa654f00fc39fc69fd0db829410ca38177d7732a8d2f0934ab3872ac56d5aa74");
+
+    CHECK_THROWS_AS(SessionIdentity{to_unsigned_sv("too short")}, std::invalid_argument);
+    CHECK_THROWS_AS(SessionIdentity{ustring(63, 0)}, std::invalid_argument);
+
+    // Encrypting with the identity gives exactly the same result as with the raw key:
+    auto enc_det = encrypt_for_recipient_deterministic(
+            id, id2.x25519_pubkey(), to_unsigned_sv("hello"));
+    CHECK(enc_det == encrypt_for_recipient_deterministic(
+                             to_sv(ed_sk), id2.x25519_pubkey(), to_unsigned_sv("hello")));
+
+    auto [msg, sender] = decrypt_incoming(to_sv(ed_sk2), enc_det);
+    CHECK(sender == to_sv(ed_pk));
+    CHECK(from_unsigned_sv(msg) == "hello");
+
+    auto enc = encrypt_for_recipient(to_sv(ed_sk2), id.x25519_pubkey(), to_unsigned_sv("hi"));
+    auto [msg2, sender2] = decrypt_incoming(id, enc);
+    CHECK(sender2 == to_sv(ed_pk2));
+    CHECK(from_unsigned_sv(msg2) == "hi");
+    CHECK_THROWS(decrypt_incoming(id2, enc));
+
+    auto [msg3, sid3] = decrypt_incoming_session_id(id, enc);
+    CHECK(from_unsigned_sv(msg3) == "hi");
+    CHECK(sid3 == id2.session_id());
+
+    // Signing is deterministic, so the identity overload must match the raw key version exactly:
+    CHECK(sign_for_recipient(id, id2.x25519_pubkey(), to_unsigned_sv("signed")) ==
+          sign_for_recipient(to_sv(ed_sk), id2.x25519_pubkey(), to_unsigned_sv("signed")));
+
+    SECTION("C API") {
+        CHECK_FALSE(session_identity_new(ed_sk.data(), 63));
+
+        session_identity* c_id = session_identity_new(ed_sk.data(), 64);
+        session_identity* c_id2 = session_identity_new(seed2.data(), 32);
+        REQUIRE(c_id);
+        REQUIRE(c_id2);
+
+        unsigned char pk[32];
+        session_identity_ed25519_pubkey(c_id, pk);
+        CHECK(ustring_view{pk, 32} == to_sv(ed_pk));
+        session_identity_x25519_pubkey(c_id, pk);
+        CHECK(ustring_view{pk, 32} == id.x25519_pubkey());
+        char sid[67];
+        session_identity_session_id(c_id, sid);
+        CHECK(sid == id.session_id());
+
+        unsigned char* ciphertext;
+        size_t ciphertext_len;
+        REQUIRE(session_identity_encrypt_for_recipient_deterministic(
+                reinterpret_cast<const unsigned char*>("hello"),
+                5,
+                c_id,
+                id2.x25519_pubkey().data(),
+                &ciphertext,
+                &ciphertext_len));
+        CHECK(ustring_view{ciphertext, ciphertext_len} == enc_det);
+
+        unsigned char* plaintext;
+        size_t plaintext_len;
+        REQUIRE(session_identity_decrypt_incoming(
+                ciphertext, ciphertext_len, c_id2, sid, &plaintext, &plaintext_len));
+        CHECK(from_unsigned_sv(ustring_view{plaintext, plaintext_len}) == "hello");
+        CHECK(sid == id.session_id());
+        free(plaintext);
+
+        CHECK_FALSE(session_identity_decrypt_incoming(
+                ciphertext, ciphertext_len, c_id, sid, &plaintext, &plaintext_len));
+        free(ciphertext);
+
+        session_identity_free(c_id);
+        session_identity_free(c_id2);
+    }
+}
+
 static std::array<unsigned char, 33> prefixed(unsigned char prefix, const session::uc32& pubkey) {
     std::array<unsigned char, 33> result;
     result[0] = prefix;
@@ -409,6 +511,96 @@ TEST_CASE("Session blinding protocol encryption", "[session-blinding-protocol][e
                 {blind25_pk2_prefixed.data(), 33},
                 broken));
     }
+    SECTION("session identity") {
+        SessionIdentity id{to_sv(ed_sk)};
+        SessionIdentity id2{seed2};
+
+        for (auto [from, to] :
+             {std::pair{to_sv(blind15_pk_prefixed), to_sv(blind15_pk2_prefixed)},
+              std::pair{to_sv(blind25_pk_prefixed), to_sv(blind25_pk2_prefixed)}}) {
+            // The nonce is random, so we can't compare ciphertexts, but messages encrypted with
+            // either overload decrypt (to the same thing) with either overload:
+            auto enc_id = encrypt_for_blinded_recipient(
+                    id, to_unsigned_sv(server_pk), to, to_unsigned_sv("hello"));
+            auto enc_raw = encrypt_for_blinded_recipient(
+                    to_sv(ed_sk), to_unsigned_sv(server_pk), to, to_unsigned_sv("hello"));
+
+            for (const auto& enc : {enc_id, enc_raw}) {
+                auto dec_id = decrypt_from_blinded_recipient(
+                        id2, to_unsigned_sv(server_pk), from, to, enc);
+                CHECK(dec_id == decrypt_from_blinded_recipient(
+                                        to_sv(ed_sk2), to_unsigned_sv(server_pk), from, to, enc));
+                CHECK(from_unsigned_sv(dec_id.first) == "hello");
+                CHECK(dec_id.second == sid);
+
+                // The sender can decrypt its own outgoing message, too:
+                auto dec_out = decrypt_from_blinded_recipient(
+                        id, to_unsigned_sv(server_pk), from, to, enc);
+                CHECK(dec_out == decrypt_from_blinded_recipient(
+                                         to_sv(ed_sk), to_unsigned_sv(server_pk), from, to, enc));
+                CHECK(from_unsigned_sv(dec_out.first) == "hello");
+            }
+
+            auto broken = enc_id;
+            broken[7] ^= 0x80;
+            CHECK_THROWS(decrypt_from_blinded_recipient(
+                    id2, to_unsigned_sv(server_pk), from, to, broken));
+
+            // C API:
+            session_identity* c_id = session_identity_new(ed_sk.data(), 64);
+            session_identity* c_id2 = session_identity_new(seed2.data(), 32);
+            REQUIRE(c_id);
+            REQUIRE(c_id2);
+
+            unsigned char* ciphertext;
+            size_t ciphertext_len;
+            REQUIRE(session_identity_encrypt_for_blinded_recipient(
+                    reinterpret_cast<const unsigned char*>("hello"),
+                    5,
+                    c_id,
+                    server_pk.data(),
+                    to.data(),
+                    &ciphertext,
+                    &ciphertext_len));
+            ustring c_enc{ciphertext, ciphertext_len};
+            free(ciphertext);
+            CHECK(decrypt_from_blinded_recipient(
+                          to_sv(ed_sk2), to_unsigned_sv(server_pk), from, to, c_enc)
+                          .first == to_unsigned_sv("hello"));
+
+            char c_sid[67];
+            unsigned char* plaintext;
+            size_t plaintext_len;
+            for (const auto& enc : {c_enc, enc_raw}) {
+                REQUIRE(session_identity_decrypt_for_blinded_recipient(
+                        enc.data(),
+                        enc.size(),
+                        c_id2,
+                        server_pk.data(),
+                        from.data(),
+                        to.data(),
+                        c_sid,
+                        &plaintext,
+                        &plaintext_len));
+                CHECK(from_unsigned_sv(ustring_view{plaintext, plaintext_len}) == "hello");
+                CHECK(c_sid == sid);
+                free(plaintext);
+            }
+            CHECK_FALSE(session_identity_decrypt_for_blinded_recipient(
+                    broken.data(),
+                    broken.size(),
+                    c_id2,
+                    server_pk.data(),
+                    from.data(),
+                    to.data(),
+                    c_sid,
+                    &plaintext,
+                    &plaintext_len));
+
+            session_identity_free(c_id);
+            session_identity_free(c_id2);
+        }
+    }
 }
 
 TEST_CASE("Session ONS response decryption", "[session-ons][decrypt]") {
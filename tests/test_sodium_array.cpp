@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+
+#include "session/sodium_array.hpp"
+#include "utils.hpp"
+
+using namespace session;
+
+TEST_CASE("Secure buffer allocation", "[sodium][alloc]") {
+    // Small allocations come from the pool and should get reused once freed:
+    auto* p1 = sodium_buffer_allocate(48);
+    REQUIRE(p1);
+    std::memset(p1, 0xab, 48);
+    sodium_buffer_deallocate(p1);
+    auto* p2 = sodium_buffer_allocate(40);  // Same 64-byte slot size
+    CHECK(p2 == p1);
+    // The freed slot is zeroed (apart from what we write into it when reallocating it, which is
+    // re-zeroed on allocation):
+    auto* bytes = static_cast<unsigned char*>(p2);
+    CHECK(std::all_of(bytes, bytes + 48, [](unsigned char c) { return c == 0; }));
+    sodium_buffer_deallocate(p2);
+
+    // Different sizes come from different slot sizes, and don't overlap:
+    std::vector<unsigned char*> ptrs;
+    for (size_t size : {1, 16, 17, 100, 1000, 4096})
+        for (int i = 0; i < 100; i++) {
+            auto* p = static_cast<unsigned char*>(sodium_buffer_allocate(size));
+            std::memset(p, static_cast<int>(ptrs.size() & 0xff), size);
+            ptrs.push_back(p);
+        }
+    CHECK(as_set(ptrs).size() == ptrs.size());
+    for (auto* p : ptrs)
+        sodium_buffer_deallocate(p);
+
+    // Larger allocations go straight to sodium:
+    auto* big = static_cast<unsigned char*>(sodium_buffer_allocate(100'000));
+    REQUIRE(big);
+    std::memset(big, 0x42, 100'000);
+    sodium_buffer_deallocate(big);
+
+    sodium_buffer_deallocate(nullptr);
+}
+
+TEST_CASE("sodium_vector growth", "[sodium][alloc][vector]") {
+    sodium_vector<std::array<unsigned char, 48>> v;
+    for (int i = 0; i < 1000; i++) {
+        auto& x = v.emplace_back();
+        x.fill(static_cast<unsigned char>(i));
+    }
+    REQUIRE(v.size() == 1000);
+    bool all_good = true;
+    for (int i = 0; i < 1000; i++)
+        all_good &= v[i][0] == static_cast<unsigned char>(i) &&
+                    v[i][47] == static_cast<unsigned char>(i);
+    CHECK(all_good);
+
+    sodium_array<unsigned char> a{100};
+    CHECK(a.size() == 100);
+    CHECK(std::all_of(a.begin(), a.end(), [](unsigned char c) { return c == 0; }));
+    a.reset();
+    CHECK(a.empty());
+}
@@ -190,3 +190,70 @@ TEST_CASE("XEd25519 verification (C wrapper)", "[xed25519][verify][c]") {
     REQUIRE(session_xed25519_verify(xed_sig1.data(), xpub1.data(), msg.data(), msg.size()));
     REQUIRE(session_xed25519_verify(xed_sig2.data(), xpub2.data(), msg.data(), msg.size()));
 }
+
+TEST_CASE("XEd25519 caching verifier", "[xed25519][verify][verifier]") {
+    std::array<unsigned char, 32> xsk1, xsk2;
+    REQUIRE(crypto_sign_ed25519_sk_to_curve25519(xsk1.data(), seed1.data()) == 0);
+    REQUIRE(crypto_sign_ed25519_sk_to_curve25519(xsk2.data(), seed2.data()) == 0);
+
+    const auto msg = view("hello world");
+    auto xed_sig1 = session::xed25519::sign(view(xsk1), msg);
+    auto xed_sig2 = session::xed25519::sign(view(xsk2), msg);
+
+    session::xed25519::verifier v{1};
+    CHECK(v.capacity() == 1);
+    CHECK(v.size() == 0);
+    CHECK(v.pubkey(view(xpub1)) == session::xed25519::pubkey(view(xpub1)));
+    CHECK(v.size() == 1);
+    // Repeat lookups hit the cache:
+    CHECK(v.verify(view(xed_sig1), view(xpub1), msg));
+    CHECK(v.verify(view(xed_sig1), view(xpub1), msg));
+    CHECK_FALSE(v.verify(view(xed_sig1), view(xpub1), view("hello World")));
+    CHECK(v.size() == 1);
+    // A different pubkey evicts the least recently used one:
+    CHECK(v.verify(view(xed_sig2), view(xpub2), msg));
+    CHECK_FALSE(v.verify(view(xed_sig1), view(xpub2), msg));
+    CHECK(v.size() == 1);
+    CHECK(v.verify(view(xed_sig1), view(xpub1), msg));
+    CHECK(v.size() == 1);
+
+    session::xed25519::verifier v2{8};
+    CHECK(v2.verify(view(xed_sig1), view(xpub1), msg));
+    CHECK(v2.verify(view(xed_sig2), view(xpub2), msg));
+    CHECK(v2.size() == 2);
+    v2.clear();
+    CHECK(v2.size() == 0);
+
+    session::xed25519::verifier uncached{0};
+    CHECK(uncached.verify(view(xed_sig2), view(xpub2), msg));
+    CHECK(uncached.size() == 0);
+
+    CHECK_THROWS_AS(v.pubkey(view(xpub1).substr(0, 31)), std::invalid_argument);
+}
+
+TEST_CASE("XEd25519 batch verification", "[xed25519][verify][verifier]") {
+    std::array<unsigned char, 32> xsk1, xsk2;
+    REQUIRE(crypto_sign_ed25519_sk_to_curve25519(xsk1.data(), seed1.data()) == 0);
+    REQUIRE(crypto_sign_ed25519_sk_to_curve25519(xsk2.data(), seed2.data()) == 0);
+
+    std::vector<std::string> msgs;
+    std::vector<std::array<unsigned char, 64>> sigs;
+    std::vector<ustring_view> sig_views, pk_views, msg_views;
+    for (int i = 0; i < 20; i++)
+        msgs.push_back("message " + std::to_string(i));
+    for (int i = 0; i < 20; i++) {
+        sigs.push_back(session::xed25519::sign(view(i % 2 ? xsk2 : xsk1), view(msgs[i])));
+        msg_views.push_back(view(msgs[i]));
+        pk_views.push_back(view(i % 2 ? xpub2 : xpub1));
+    }
+    for (auto& s : sigs)
+        sig_views.push_back(view(s));
+
+    session::xed25519::verifier v;
+    CHECK(v.verify_batch(sig_views, pk_views, msg_views).empty());
+    CHECK(v.size() == 2);
+
+    std::swap(pk_views[4], pk_views[5]);
+    pk_views[11] = pk_views[11].substr(0, 31);
+    CHECK(v.verify_batch(sig_views, pk_views, msg_views) == std::vector<size_t>{4, 5, 11});
+}